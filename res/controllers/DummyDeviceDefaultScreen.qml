@@ -40,6 +40,8 @@ Item {
     }
 
     // function transformFrame(input: ArrayBuffer, timestamp: date) {
+    // A third argument `area: rect` can be declared to only receive the
+    // area of the frame that has changed since the previous frame.
     function transformFrame(input, timestamp) {
         return new ArrayBuffer(0);
     }
@@ -21,6 +21,53 @@ declare interface ScriptConnection {
 }
 
 
+/** ScriptControlHandle */
+
+declare interface ControlHandle {
+    /** Group of the control e.g. "[Channel1]" */
+    readonly group: string;
+    /** Name of the control e.g. "play_indicator" */
+    readonly name: string;
+
+    /**
+     * Gets the control value, like {@link engine.getValue}
+     */
+    getValue(): number;
+
+    /**
+     * Sets the control value, like {@link engine.setValue}
+     *
+     * Respects soft takeover, if enabled for the control.
+     */
+    setValue(newValue: number): void;
+
+    /**
+     * Gets the control value normalized to a range of 0..1, like {@link engine.getParameter}
+     */
+    getParameter(): number;
+
+    /**
+     * Sets the control value specified with normalized range of 0..1, like {@link engine.setParameter}
+     */
+    setParameter(newValue: number): void;
+
+    /**
+     * Resets the control to its default value, like {@link engine.reset}
+     */
+    reset(): void;
+
+    /**
+     * Connects the control with a callback function, like {@link engine.makeConnection}
+     */
+    makeConnection(callback: engine.CoCallback): ScriptConnection | undefined;
+
+    /**
+     * Connects the control with a callback function, like {@link engine.makeUnbufferedConnection}
+     */
+    makeUnbufferedConnection(callback: engine.CoCallback): ScriptConnection | undefined;
+}
+
+
 /** ControllerScriptInterfaceLegacy */
 
 declare namespace engine {
@@ -111,6 +158,38 @@ declare namespace engine {
      */
     function getDefaultParameter(group: string, name: string): number;
 
+    /**
+     * Looks up a control once and returns a handle for accessing it
+     *
+     * Accessing a control through its handle is faster than through {@link engine.getValue}
+     * and {@link engine.setValue}, which look up the control on each call. Mappings that
+     * access controls very often, e.g. for jog wheels or LEDs, should get the handles
+     * once in their init function.
+     *
+     * @param group Group of the control e.g. "[Channel1]"
+     * @param name Name of the control e.g. "play_indicator"
+     * @returns Returns a control handle on success, otherwise 'undefined'
+     */
+    function getControlHandle(group: string, name: string): ControlHandle | undefined;
+
+    /**
+     * Gets the values of multiple controls at once
+     *
+     * @param handles Handles returned by {@link engine.getControlHandle}
+     * @returns Values of the controls in the same order as the handles
+     */
+    function getValues(handles: ControlHandle[]): number[];
+
+    /**
+     * Sets the values of multiple controls at once
+     *
+     * Respects soft takeover, if enabled for a control.
+     *
+     * @param handles Handles returned by {@link engine.getControlHandle}
+     * @param values Values to be set, one for each handle
+     */
+    function setValues(handles: ControlHandle[], values: number[]): void;
+
     type CoCallback = (value: number, group: string, name: string) => void
 
     /**
@@ -7,11 +7,22 @@ declare namespace midi {
     /**
      * Sends a 3 byte MIDI short message
      *
+     * Messages that would not change the state of an output, e.g. an LED,
+     * are dropped unless they are forced.
+     *
      * @param status Status byte
      * @param byte1 Data byte 1
      * @param byte2 Data byte 2
+     * @param force Send the message even if the output already has this state [default = false]
+     */
+    function sendShortMsg(status: number, byte1: number, byte2: number, force?: boolean): void;
+
+    /**
+     * Sends the state of all outputs again, e.g. after the device has cleared its LEDs.
+     * The outputs of the XML mapping are sent immediately. The next message of every
+     * output that is sent by the script is not dropped, even if the state didn't change.
      */
-    function sendShortMsg(status: number, byte1: number, byte2: number): void;
+    function resendOutputs(): void;
 
     /**
      * Alias for {@link sendSysexMsg}
@@ -1,5 +1,7 @@
 #include "analyzer/analyzerthread.h"
 
+#include <QtConcurrentRun>
+#include <algorithm>
 #include <mutex>
 
 #include "analyzer/analyzerbeats.h"
@@ -34,6 +36,26 @@ mixxx::Logger kLogger("AnalyzerThread");
 // continuous feedback.
 const mixxx::Duration kBusyProgressInhibitDuration = mixxx::Duration::fromMillis(60);
 
+// Decode the next chunk while the analyzers process the current one, and
+// run the analyzers concurrently. Never applied to low priority analysis
+// that is running in the background, e.g. while performing.
+const ConfigKey kPipelinedAnalysisConfigKey =
+        ConfigKey{QStringLiteral("[Library]"), QStringLiteral("AnalyzerPipelining")};
+
+// The analyzers of all pipelined analyzer threads share a single pool with
+// one thread per core. A pool per analyzer thread would run the analyzers of
+// all threads at once and oversubscribe the CPU.
+QThreadPool* sharedAnalyzerPool() {
+    static QThreadPool* const s_pPool = [] {
+        // Never deleted, because the threads of a static pool would only
+        // be joined after the application has been shut down
+        auto* pPool = new QThreadPool();
+        pPool->setMaxThreadCount(std::max(QThread::idealThreadCount(), 1));
+        return pPool;
+    }();
+    return s_pPool;
+}
+
 void deleteAnalyzerThread(AnalyzerThread* plainPtr) {
     if (plainPtr) {
         plainPtr->deleteAfterFinished();
@@ -82,7 +104,9 @@ AnalyzerThread::AnalyzerThread(
           m_pConfig(pConfig),
           m_modeFlags(modeFlags),
           m_nextTrack(2), // minimum capacity
-          m_sampleBuffer(mixxx::kAnalysisSamplesPerChunk),
+          m_pAnalyzerPool(nullptr),
+          m_sampleBuffers{mixxx::SampleBuffer(mixxx::kAnalysisSamplesPerChunk),
+                  mixxx::SampleBuffer(mixxx::kAnalysisSamplesPerChunk)},
           m_emittedState(AnalyzerThreadState::Void) {
     std::call_once(registerMetaTypesOnceFlag, registerMetaTypesOnce);
 }
@@ -118,6 +142,13 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_analyzers.empty());
     kLogger.debug() << "Activated" << m_analyzers.size() << "analyzers";
 
+    if (!(m_modeFlags & AnalyzerModeFlags::LowPriority) &&
+            m_pConfig->getValue(kPipelinedAnalysisConfigKey, true)) {
+        m_pAnalyzerPool = sharedAnalyzerPool();
+        m_pendingAnalysis.reserve(m_analyzers.size());
+        kLogger.debug() << "Pipelining decoding and analysis";
+    }
+
     m_lastBusyProgressEmittedTimer.start();
 
     mixxx::AudioSource::OpenParams openParams;
@@ -179,6 +210,8 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_currentTrack);
     DEBUG_ASSERT(isStopping());
 
+    DEBUG_ASSERT(m_pendingAnalysis.empty());
+    m_pAnalyzerPool = nullptr;
     m_analyzers.clear();
 
     kLogger.debug() << "Exiting worker thread";
@@ -230,10 +263,13 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
     // Analysis starts now
     emitBusyProgress(kAnalyzerProgressNone);
 
+    // Alternates between both sample buffers in pipelined mode
+    int sampleBufferIndex = 0;
     mixxx::IndexRange remainingFrameRange = audioSource->frameIndexRange();
     while (!remainingFrameRange.empty()) {
         sleepWhileSuspended();
         if (isStopping()) {
+            waitForPendingAnalysis();
             return AnalysisResult::Cancelled;
         }
 
@@ -250,7 +286,8 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
                 audioSourceProxy.readSampleFrames(
                         mixxx::WritableSampleFrames(
                                 chunkFrameRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+                                mixxx::SampleBuffer::WritableSlice(
+                                        m_sampleBuffers[sampleBufferIndex])));
         // The returned range fits into the requested range
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
@@ -290,15 +327,21 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
 
         sleepWhileSuspended();
         if (isStopping()) {
+            waitForPendingAnalysis();
             return AnalysisResult::Cancelled;
         }
 
         // 2nd: step: Analyze chunk of decoded audio data
         if (!readableSampleFrames.frameIndexRange().empty()) {
-            for (auto&& analyzer : m_analyzers) {
-                analyzer.processSamples(
-                        readableSampleFrames.readableData(),
-                        readableSampleFrames.readableLength());
+            // All analyzers need to be done with the previous chunk before
+            // they receive the next one.
+            waitForPendingAnalysis();
+            analyzeChunk(
+                    readableSampleFrames.readableData(),
+                    readableSampleFrames.readableLength());
+            if (m_pAnalyzerPool) {
+                // Decode the next chunk while this one is being analyzed
+                sampleBufferIndex = 1 - sampleBufferIndex;
             }
         }
 
@@ -324,9 +367,39 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
         }
     }
 
+    waitForPendingAnalysis();
     return AnalysisResult::Finished;
 }
 
+void AnalyzerThread::analyzeChunk(const CSAMPLE* pSamples, SINT sampleCount) {
+    if (!m_pAnalyzerPool) {
+        for (auto&& analyzer : m_analyzers) {
+            analyzer.processSamples(pSamples, sampleCount);
+        }
+        return;
+    }
+    DEBUG_ASSERT(m_pendingAnalysis.empty());
+    // The analyzers are independent of each other and only read from
+    // the shared chunk of samples.
+    for (auto&& analyzer : m_analyzers) {
+        if (!analyzer.isActive()) {
+            continue;
+        }
+        AnalyzerWithState* pAnalyzer = &analyzer;
+        m_pendingAnalysis.push_back(QtConcurrent::run(m_pAnalyzerPool,
+                [pAnalyzer, pSamples, sampleCount] {
+                    pAnalyzer->processSamples(pSamples, sampleCount);
+                }));
+    }
+}
+
+void AnalyzerThread::waitForPendingAnalysis() {
+    for (auto& future : m_pendingAnalysis) {
+        future.waitForFinished();
+    }
+    m_pendingAnalysis.clear();
+}
+
 void AnalyzerThread::emitBusyProgress(AnalyzerProgress busyProgress) {
     DEBUG_ASSERT(m_currentTrack.has_value());
     if ((m_emittedState == AnalyzerThreadState::Busy) &&
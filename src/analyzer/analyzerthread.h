@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QFuture>
+#include <QThreadPool>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -118,7 +120,13 @@ class AnalyzerThread : public WorkerThread {
 
     std::vector<AnalyzerWithState> m_analyzers;
 
-    mixxx::SampleBuffer m_sampleBuffer;
+    // Decoding and analysis are pipelined if this pool is set: While the
+    // analyzers process one buffer concurrently the next chunk is decoded
+    // into the other buffer. The pool is shared by all analyzer threads.
+    QThreadPool* m_pAnalyzerPool;
+    std::vector<QFuture<void>> m_pendingAnalysis;
+
+    mixxx::SampleBuffer m_sampleBuffers[2];
 
     std::optional<AnalyzerTrack> m_currentTrack;
 
@@ -134,6 +142,12 @@ class AnalyzerThread : public WorkerThread {
     AnalysisResult analyzeAudioSource(
             const mixxx::AudioSourcePointer& audioSource);
 
+    // Passes a chunk of decoded samples to all analyzers. In pipelined mode
+    // this returns immediately and the samples must not be modified before
+    // waitForPendingAnalysis() has returned.
+    void analyzeChunk(const CSAMPLE* pSamples, SINT sampleCount);
+    void waitForPendingAnalysis();
+
     // Blocks the worker thread until a next track becomes available
     TrackPointer receiveNextTrack();
 
@@ -3,6 +3,7 @@
 #include "analyzer/analyzertrack.h"
 #include "engine/filters/enginefilterbessel4.h"
 #include "track/track.h"
+#include "util/db/sqltransaction.h"
 #include "util/logger.h"
 #include "waveform/waveformfactory.h"
 
@@ -64,6 +65,14 @@ bool AnalyzerWaveform::initialize(const AnalyzerTrack& track,
             sampleRate, frameLength, mainWaveformSampleRate, -1));
     m_waveformSummary = WaveformPointer(new Waveform(
             sampleRate, frameLength, mainWaveformSampleRate, summaryWaveformSamples));
+    // The waveforms must not be saved before they are complete. The version
+    // and description can't be changed after they have been shared.
+    m_waveform->setSaveState(Waveform::SaveState::NotSaved);
+    m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
+    m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
+    m_waveformSummary->setSaveState(Waveform::SaveState::NotSaved);
+    m_waveformSummary->setVersion(WaveformFactory::currentWaveformSummaryVersion());
+    m_waveformSummary->setDescription(WaveformFactory::currentWaveformSummaryDescription());
 
     // Now, that the Waveform memory is initialized, we can set set them to
     // the TIO. Be aware that other threads of Mixxx can touch them from
@@ -138,6 +147,14 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
     // If we don't need to calculate the waveform/wavesummary, skip.
     if (!missingWaveform && !missingWavesummary) {
         kLogger.debug() << "loadStored - Stored waveform loaded";
+        if (pLoadedTrackWaveform && pLoadedTrackWaveformSummary) {
+            // Mapped on the next load
+            m_analysisDao.migrateTrackAnalyses(trackId,
+                    pLoadedTrackWaveform,
+                    pLoadedTrackWaveformSummary);
+            // Without a transaction, i.e. the changes are already committed
+            m_analysisDao.finishTransaction(true);
+        }
         if (pLoadedTrackWaveform) {
             tio->setWaveform(pLoadedTrackWaveform);
         }
@@ -190,9 +207,6 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, SINT count) {
     m_filter[Mid]->process(buffer, &m_buffers[Mid][0], count);
     m_filter[High]->process(buffer, &m_buffers[High][0], count);
 
-    m_waveform->setSaveState(Waveform::SaveState::NotSaved);
-    m_waveformSummary->setSaveState(Waveform::SaveState::NotSaved);
-
     for (SINT i = 0; i < count; i += 2) {
         // Take max value, not average of data
         CSAMPLE cover[2] = {fabs(buffer[i]), fabs(buffer[i + 1])};
@@ -230,7 +244,6 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, SINT count) {
             }
             m_stride.store(m_waveformData + m_currentStride);
             m_currentStride += ChannelCount;
-            m_waveform->setCompletion(m_currentStride);
         }
 
         if (fmod(m_stride.m_position, m_stride.m_averageLength) < 1) {
@@ -240,7 +253,6 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, SINT count) {
             }
             m_stride.averageStore(m_waveformSummaryData + m_currentSummaryStride);
             m_currentSummaryStride += ChannelCount;
-            m_waveformSummary->setCompletion(m_currentSummaryStride);
 
 #ifdef TEST_HEAT_MAP
             QPointF point(m_stride.m_filteredData[Right][High],
@@ -255,6 +267,10 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, SINT count) {
         }
     }
 
+    // Publish the strides of this block at once
+    m_waveform->setCompletion(m_currentStride);
+    m_waveformSummary->setCompletion(m_currentSummaryStride);
+
     //kLogger.debug() << "process - m_waveform->getCompletion()" << m_waveform->getCompletion() << "off" << m_waveform->getDataSize();
     //kLogger.debug() << "process - m_waveformSummary->getCompletion()" << m_waveformSummary->getCompletion() << "off" << m_waveformSummary->getDataSize();
     return true;
@@ -272,8 +288,6 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     if (m_waveform) {
         m_waveform->setSaveState(Waveform::SaveState::SavePending);
         m_waveform->setCompletion(m_waveform->getDataSize());
-        m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
-        m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
     }
     tio->setWaveform(m_waveform);
 
@@ -281,8 +295,6 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     if (m_waveformSummary) {
         m_waveformSummary->setSaveState(Waveform::SaveState::SavePending);
         m_waveformSummary->setCompletion(m_waveformSummary->getDataSize());
-        m_waveformSummary->setVersion(WaveformFactory::currentWaveformSummaryVersion());
-        m_waveformSummary->setDescription(WaveformFactory::currentWaveformSummaryDescription());
     }
     tio->setWaveformSummary(m_waveformSummary);
 
@@ -294,10 +306,16 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     // waveforms (i.e. if the config setting was disabled in a previous scan)
     // and then it is not called. The other analyzers have signals which control
     // the update of their data.
+    // Both analyses are written in a single transaction to keep the
+    // database locked only once.
+    SqlTransaction transaction(m_analysisDao.database());
     m_analysisDao.saveTrackAnalyses(
             tio->getId(),
             m_waveform,
             m_waveformSummary);
+    // The replaced files are deleted only after the commit
+    const bool committed = !transaction || transaction.commit();
+    m_analysisDao.finishTransaction(committed);
 
     kLogger.debug() << "Waveform generation for track" << tio->getId() << "done"
                     << m_timer.elapsed().debugSecondsWithUnit();
@@ -26,6 +26,12 @@ class ControlObjectScript : public ControlProxy {
             return m_scriptConnections.first(); };
     void disconnectAllConnectionsToFunction(const QJSValue& function);
 
+    // The ControlObject of this control without looking it up by its key,
+    // e.g. for soft takeover
+    ControlObject* getCreatorCO() const {
+        return m_pControl->getCreatorCO();
+    }
+
     // Called from update();
     void emitValueChanged() override {
         emit trigger(get(), this);
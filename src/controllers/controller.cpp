@@ -7,6 +7,7 @@
 #include "moc_controller.cpp"
 #include "util/cmdlineargs.h"
 #include "util/screensaver.h"
+#include "util/time.h"
 
 namespace {
 QString loggingCategoryPrefix(const QString& deviceName) {
@@ -26,6 +27,9 @@ Controller::Controller(const QString& deviceName)
           m_bIsOpen(false),
           m_bLearning(false) {
     m_userActivityInhibitTimer.start();
+    if (CmdlineArgs::Instance().getDeveloper()) {
+        m_pInputLatencyHistogram = std::make_unique<mixxx::LogLinearHistogram>();
+    }
 }
 
 Controller::~Controller() {
@@ -58,6 +62,18 @@ void Controller::stopEngine() {
         qCWarning(m_logBase) << "Controller::stopEngine(): No engine exists!";
         return;
     }
+    if (m_pInputLatencyHistogram && m_pInputLatencyHistogram->count() > 0) {
+        qCInfo(m_logBase).noquote()
+                << QStringLiteral(
+                           "  Input latency: %1 events, p50 %2 us, p99 %3 us, "
+                           "p999 %4 us, max %5 us")
+                           .arg(QString::number(m_pInputLatencyHistogram->count()),
+                                   QString::number(m_pInputLatencyHistogram->percentile(0.5)),
+                                   QString::number(m_pInputLatencyHistogram->percentile(0.99)),
+                                   QString::number(m_pInputLatencyHistogram->percentile(0.999)),
+                                   QString::number(m_pInputLatencyHistogram->max()));
+        m_pInputLatencyHistogram->reset();
+    }
     m_pScriptEngineLegacy.reset();
     emit engineStopped();
 }
@@ -127,6 +143,16 @@ void Controller::triggerActivity()
         m_userActivityInhibitTimer.start();
     }
 }
+
+void Controller::recordInputLatency(mixxx::Duration readAt) {
+    if (!m_pInputLatencyHistogram) {
+        return;
+    }
+    const auto latency = mixxx::Time::elapsed() - readAt;
+    m_pInputLatencyHistogram->record(
+            static_cast<quint64>(std::max(qint64(0), latency.toIntegerMicros())));
+}
+
 void Controller::receive(const QByteArray& data, mixxx::Duration timestamp) {
     if (!m_pScriptEngineLegacy) {
         //qWarning() << "Controller::receive called with no active engine!";
@@ -163,6 +189,9 @@ void Controller::receive(const QByteArray& data, mixxx::Duration timestamp) {
     }
 
     m_pScriptEngineLegacy->handleIncomingData(data);
+    // The timestamp of HID and bulk devices is the time when the data has
+    // been read
+    recordInputLatency(timestamp);
 }
 void Controller::slotBeforeEngineShutdown() {
     /* Override this to get called before the JS engine shuts down */
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <memory>
 
 #include "controllers/controllermappinginfo.h"
 #include "util/duration.h"
+#include "util/loglinearhistogram.h"
 #include "util/runtimeloggingcategory.h"
 
 class ControllerJSProxy;
@@ -120,6 +122,14 @@ class Controller : public QObject {
     // To be called when receiving events
     void triggerActivity();
 
+    /// To be called after the mapping has processed an input event, with
+    /// the time when the event has been read from the device, see
+    /// mixxx::Time::elapsed(). Records the latency between reading the
+    /// event and the resulting control updates if the measurement is
+    /// enabled, which is done in developer mode. The statistics are logged
+    /// when the engine is stopped.
+    void recordInputLatency(mixxx::Duration readAt);
+
     inline void setDeviceCategory(const QString& deviceCategory) {
         m_sDeviceCategory = deviceCategory;
     }
@@ -148,15 +158,6 @@ class Controller : public QObject {
 
     virtual int open() = 0;
     virtual int close() = 0;
-    // Requests that the device poll if it is a polling device. Returns true
-    // if events were handled.
-    virtual bool poll() { return false; }
-
-    // Returns true if this device should receive polling signals via calls to
-    // its poll() method.
-    virtual bool isPolling() const {
-        return false;
-    }
 
   private:
     /// Controllers have multiple ownership over an engine.
@@ -175,6 +176,9 @@ class Controller : public QObject {
     bool m_bLearning;
     QElapsedTimer m_userActivityInhibitTimer;
 
+    /// Input latency in microseconds
+    std::unique_ptr<mixxx::LogLinearHistogram> m_pInputLatencyHistogram;
+
     friend class ControllerJSProxy;
     // accesses lots of our stuff, but in the same thread
     friend class ControllerManager;
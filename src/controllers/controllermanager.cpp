@@ -10,8 +10,6 @@
 #include "moc_controllermanager.cpp"
 #include "util/cmdlineargs.h"
 #include "util/compatibility/qmutex.h"
-#include "util/duration.h"
-#include "util/time.h"
 
 #ifdef __PORTMIDI__
 #include "controllers/midi/portmidienumerator.h"
@@ -31,15 +29,6 @@
 
 // http://developer.qt.nokia.com/wiki/Threads_Events_QObjects
 
-// Poll every 1ms (where possible) for good controller response
-#ifdef __LINUX__
-// Many Linux distros ship with the system tick set to 250Hz so 1ms timer
-// reportedly causes CPU hosage. See Bug #990992 rryan 6/2012
-const mixxx::Duration ControllerManager::kPollInterval = mixxx::Duration::fromMillis(5);
-#else
-const mixxx::Duration ControllerManager::kPollInterval = mixxx::Duration::fromMillis(1);
-#endif
-
 namespace {
 /// Strip slashes and spaces from device name, so that it can be used as config
 /// key or a filename.
@@ -91,9 +80,7 @@ ControllerManager::ControllerManager(UserSettingsPointer pConfig)
           // WARNING: Do not parent m_pControllerLearningEventFilter to
           // ControllerManager because the CM is moved to its own thread and runs
           // its own event loop.
-          m_pControllerLearningEventFilter(new ControllerLearningEventFilter()),
-          m_pollTimer(this),
-          m_skipPoll(false) {
+          m_pControllerLearningEventFilter(new ControllerLearningEventFilter()) {
     qRegisterMetaType<std::shared_ptr<LegacyControllerMapping>>(
             "std::shared_ptr<LegacyControllerMapping>");
 
@@ -104,13 +91,10 @@ ControllerManager::ControllerManager(UserSettingsPointer pConfig)
         QDir().mkpath(userMappings);
     }
 
-    m_pollTimer.setInterval(kPollInterval.toIntegerMillis());
-    connect(&m_pollTimer, &QTimer::timeout, this, &ControllerManager::pollDevices);
-
     m_pThread = new QThread;
     m_pThread->setObjectName("Controller");
 
-    // Moves all children (including the poll timer) to m_pThread
+    // Moves all children to m_pThread
     moveToThread(m_pThread);
 
     // Controller processing needs to be prioritized since it can affect the
@@ -167,8 +151,6 @@ void ControllerManager::slotInitialize() {
 }
 
 void ControllerManager::slotShutdown() {
-    stopPolling();
-
     // Clear m_enumerators before deleting the enumerators to prevent other code
     // paths from accessing them.
     auto locker = lockMutex(&m_mutex);
@@ -302,81 +284,6 @@ void ControllerManager::slotSetUpDevices() {
         }
         pController->applyMapping(m_pConfig->getResourcePath());
     }
-
-    pollIfAnyControllersOpen();
-}
-
-void ControllerManager::pollIfAnyControllersOpen() {
-    auto locker = lockMutex(&m_mutex);
-    QList<Controller*> controllers = m_controllers;
-    locker.unlock();
-
-    bool shouldPoll = false;
-    for (Controller* pController : controllers) {
-        if (pController->isOpen() && pController->isPolling()) {
-            shouldPoll = true;
-        }
-    }
-    if (shouldPoll) {
-        startPolling();
-    } else {
-        stopPolling();
-    }
-}
-
-void ControllerManager::startPolling() {
-    // Start the polling timer.
-    if (!m_pollTimer.isActive()) {
-        m_pollTimer.start();
-        qDebug() << "Controller polling started.";
-    }
-}
-
-void ControllerManager::stopPolling() {
-    m_pollTimer.stop();
-    qDebug() << "Controller polling stopped.";
-}
-
-void ControllerManager::pollDevices() {
-    // Note: this function is called from a high priority thread which
-    // may stall the GUI or may reduce the available CPU time for other
-    // High Priority threads like caching reader or broadcasting more
-    // then desired, if it is called endless loop like.
-    //
-    // This especially happens if a controller like the 3x Speed
-    // Stanton SCS.1D emits more massages than Mixxx is able to handle
-    // or a controller like Hercules RMX2 goes wild. In such a case the
-    // receive buffer is stacked up every call to insane values > 500 messages.
-    //
-    // To avoid this we pick here a strategies similar like the audio
-    // thread. In case pollDevice() takes longer than a call cycle
-    // we are cooperative a skip the next cycle to free at least some
-    // CPU time
-    //
-    // Some random test data form a i5-3317U CPU @ 1.70GHz Running
-    // Ubuntu Trusty:
-    // * Idle poll: ~5 µs.
-    // * 5 messages burst (full midi bandwidth): ~872 µs.
-
-    if (m_skipPoll) {
-        // skip poll in overload situation
-        m_skipPoll = false;
-        //qDebug() << "ControllerManager::pollDevices() skip";
-        return;
-    }
-
-    mixxx::Duration start = mixxx::Time::elapsed();
-    for (Controller* pDevice : std::as_const(m_controllers)) {
-        if (pDevice->isOpen() && pDevice->isPolling()) {
-            pDevice->poll();
-        }
-    }
-
-    mixxx::Duration duration = mixxx::Time::elapsed() - start;
-    if (duration > kPollInterval) {
-        m_skipPoll = true;
-    }
-    //qDebug() << "ControllerManager::pollDevices()" << duration << start;
 }
 
 void ControllerManager::openController(Controller* pController) {
@@ -387,7 +294,6 @@ void ControllerManager::openController(Controller* pController) {
         pController->close();
     }
     int result = pController->open();
-    pollIfAnyControllersOpen();
 
     // If successfully opened the device, apply the mapping and save the
     // preference setting.
@@ -405,7 +311,6 @@ void ControllerManager::closeController(Controller* pController) {
         return;
     }
     pController->close();
-    pollIfAnyControllersOpen();
     // Update configuration to reflect controller is disabled.
     m_pConfig->setValue(
             ConfigKey("[Controller]", sanitizeDeviceName(pController->getName())), 0);
@@ -6,6 +6,7 @@
 #include "control/controlobject.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/midi/midioutputhandler.h"
+#include "controllers/midi/midioutputscheduler.h"
 #include "controllers/midi/midiutils.h"
 #include "controllers/scripting/legacy/controllerscriptenginelegacy.h"
 #include "defs_urls.h"
@@ -31,7 +32,12 @@ bool MidiInputHandleJSProxy::disconnect() {
 }
 
 MidiController::MidiController(const QString& deviceName)
-        : Controller(deviceName) {
+        : Controller(deviceName),
+          m_pOutputScheduler(new MidiOutputScheduler(
+                  [this](unsigned char status, unsigned char byte1, unsigned char byte2) {
+                      sendShortMsg(status, byte1, byte2);
+                  },
+                  this)) {
     setDeviceCategory(tr("MIDI Controller"));
 }
 
@@ -66,10 +72,31 @@ std::shared_ptr<LegacyControllerMapping> MidiController::cloneMapping() {
 }
 
 int MidiController::close() {
+    // Send the messages of the shutdown code of the mapping before the
+    // device is closed
+    m_pOutputScheduler->flush();
+    m_pOutputScheduler->reset();
     destroyOutputHandlers();
     return 0;
 }
 
+void MidiController::scheduleShortMsg(unsigned char status,
+        unsigned char byte1,
+        unsigned char byte2,
+        bool force) {
+    m_pOutputScheduler->sendShortMsg(status, byte1, byte2, force);
+}
+
+void MidiController::resendOutputs() {
+    m_pOutputScheduler->invalidateAll();
+    updateAllOutputs();
+}
+
+void MidiController::send(const QList<int>& data, unsigned int length) {
+    m_pOutputScheduler->flush();
+    Controller::send(data, length);
+}
+
 bool MidiController::matchMapping(const MappingInfo& mapping) {
     // Product info mapping not implemented for MIDI devices yet
     Q_UNUSED(mapping);
@@ -248,6 +275,8 @@ void MidiController::receivedShortMessage(unsigned char status,
         unsigned char control,
         unsigned char value,
         mixxx::Duration timestamp) {
+    m_pOutputScheduler->invalidate(status, control);
+
     // The rest of this function is for legacy mappings
     unsigned char channel = MidiUtils::channelFromStatus(status);
     MidiOpCode opCode = MidiUtils::opCodeFromStatus(status);
@@ -9,6 +9,7 @@
 #include "controllers/softtakeover.h"
 
 class MidiOutputHandler;
+class MidiOutputScheduler;
 
 class MidiInputHandleJSProxy final : public QObject {
     Q_OBJECT
@@ -59,6 +60,24 @@ class MidiController : public Controller {
             unsigned char byte1,
             unsigned char byte2) = 0;
 
+    /// Sends a short message through the output scheduler, which coalesces
+    /// the messages of outputs that change fast. Used for all output of
+    /// mappings. A forced message is sent even if the output already has
+    /// the same state.
+    void scheduleShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2,
+            bool force = false);
+
+    /// Sends the current state of all outputs again, even if it has not
+    /// changed, e.g. after the device has cleared its LEDs. The outputs
+    /// of the XML mapping are updated, and the next message of every
+    /// output that is sent by the script is not dropped.
+    void resendOutputs();
+
+    /// Sends the pending short messages before the data.
+    void send(const QList<int>& data, unsigned int length = 0) override;
+
     /// Alias for send()
     /// The length parameter is here for backwards compatibility for when scripts
     /// were required to specify it.
@@ -108,9 +127,10 @@ class MidiController : public Controller {
     QList<MidiOutputHandler*> m_outputs;
     std::shared_ptr<LegacyMidiControllerMapping> m_pMapping;
     SoftTakeoverCtrl m_st;
+    MidiOutputScheduler* m_pOutputScheduler;
     QList<QPair<MidiInputMapping, unsigned char>> m_fourteen_bit_queued_mappings;
 
-    // So it can access sendShortMsg()
+    // So it can access scheduleShortMsg()
     friend class MidiOutputHandler;
     friend class MidiControllerTest;
     friend class MidiControllerJSProxy;
@@ -129,8 +149,13 @@ class MidiControllerJSProxy : public ControllerJSProxy {
 
     Q_INVOKABLE void sendShortMsg(unsigned char status,
             unsigned char byte1,
-            unsigned char byte2) {
-        m_pMidiController->sendShortMsg(status, byte1, byte2);
+            unsigned char byte2,
+            bool force = false) {
+        m_pMidiController->scheduleShortMsg(status, byte1, byte2, force);
+    }
+
+    Q_INVOKABLE void resendOutputs() {
+        m_pMidiController->resendOutputs();
     }
 
     Q_INVOKABLE void sendSysexMsg(const QList<int>& data, unsigned int length = 0) {
@@ -27,6 +27,9 @@ bool MidiOutputHandler::validate() {
 }
 
 void MidiOutputHandler::update() {
+    // Unchanged states are dropped by the output scheduler of the
+    // controller, unless they have been invalidated
+    m_lastVal = -1;
     controlChanged(m_cos.get());
 }
 
@@ -50,8 +53,9 @@ void MidiOutputHandler::controlChanged(double value) {
         qCDebug(m_logger) << "sending MIDI bytes:" << m_mapping.output.status
                           << "," << m_mapping.output.control << ","
                           << byte3;
-        m_pController->sendShortMsg(m_mapping.output.status,
-                                    m_mapping.output.control, byte3);
+        m_pController->scheduleShortMsg(m_mapping.output.status,
+                m_mapping.output.control,
+                byte3);
         m_lastVal = static_cast<int>(byte3);
     }
 }
@@ -0,0 +1,225 @@
+#include "controllers/midi/midioutputscheduler.h"
+
+#include "controllers/midi/midimessage.h"
+#include "moc_midioutputscheduler.cpp"
+#include "util/time.h"
+
+namespace {
+
+constexpr quint32 kNoMessage = 0xFFFFFFFF;
+
+quint32 packMessage(unsigned char status, unsigned char byte1, unsigned char byte2) {
+    return static_cast<quint32>(status) |
+            (static_cast<quint32>(byte1) << 8) |
+            (static_cast<quint32>(byte2) << 16);
+}
+
+/// Returns true if the message sets the state of an output, like an LED,
+/// i.e. if only the last message of an output needs to be sent.
+bool isStateMessage(unsigned char status, unsigned char byte1) {
+    switch (static_cast<MidiOpCode>(status & 0xF0)) {
+    case MidiOpCode::NoteOff:
+    case MidiOpCode::NoteOn:
+    case MidiOpCode::PolyphonicKeyPressure:
+    case MidiOpCode::ChannelPressure:
+    case MidiOpCode::PitchBendChange:
+        return true;
+    case MidiOpCode::ControlChange:
+        switch (byte1) {
+        case 6:   // Data Entry MSB
+        case 38:  // Data Entry LSB
+        case 96:  // Data Increment
+        case 97:  // Data Decrement
+        case 98:  // NRPN LSB
+        case 99:  // NRPN MSB
+        case 100: // RPN LSB
+        case 101: // RPN MSB
+            // Parameter numbers select the target of the data entry
+            // messages that follow
+            return false;
+        default:
+            // Controller numbers 120-127 are channel mode messages
+            return byte1 < 120;
+        }
+    default:
+        // Program changes and system messages
+        return false;
+    }
+}
+
+/// Returns true for the controllers 32-63 that are the LSB of the 14-bit
+/// value of the controllers 0-31
+bool isLsbControlChange(unsigned char status, unsigned char byte1) {
+    return static_cast<MidiOpCode>(status & 0xF0) == MidiOpCode::ControlChange &&
+            byte1 >= 32 && byte1 < 64;
+}
+
+/// Identifies the output that is set by a state message
+quint32 outputKey(unsigned char status, unsigned char byte1) {
+    const auto opCode = static_cast<MidiOpCode>(status & 0xF0);
+    const quint32 channel = status & 0x0F;
+    if (isLsbControlChange(status, byte1)) {
+        // The LSB sets the same output as the MSB
+        byte1 -= 32;
+    }
+    switch (opCode) {
+    case MidiOpCode::NoteOff:
+        // Note off sets the same output as note on
+        return (static_cast<quint32>(MidiOpCode::NoteOn) << 16) | (channel << 8) | byte1;
+    case MidiOpCode::ChannelPressure:
+    case MidiOpCode::PitchBendChange:
+        // The first byte is part of the value
+        return (static_cast<quint32>(opCode) << 16) | (channel << 8);
+    default:
+        return (static_cast<quint32>(opCode) << 16) | (channel << 8) | byte1;
+    }
+}
+
+/// Identifies the part of the output that is set by a state message
+int outputPart(unsigned char status, unsigned char byte1) {
+    return isLsbControlChange(status, byte1) ? 1 : 0;
+}
+
+} // namespace
+
+bool MidiOutputScheduler::OutputState::isPending() const {
+    for (const auto pendingMessage : pendingMessages) {
+        if (pendingMessage != kNoMessage) {
+            return true;
+        }
+    }
+    return false;
+}
+
+MidiOutputScheduler::MidiOutputScheduler(SendFunction sendFunction, QObject* pParent)
+        : QObject(pParent),
+          m_sendFunction(std::move(sendFunction)),
+          m_frameTimer(this),
+          m_frame(-1),
+          m_messagesSentInFrame(0) {
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(kFrameDuration.toIntegerMillis());
+    connect(&m_frameTimer,
+            &QTimer::timeout,
+            this,
+            &MidiOutputScheduler::sendPendingMessages);
+}
+
+void MidiOutputScheduler::sendShortMsg(unsigned char status,
+        unsigned char byte1,
+        unsigned char byte2,
+        bool force) {
+    updateFrame();
+    if (!isStateMessage(status, byte1)) {
+        flush();
+        m_sendFunction(status, byte1, byte2);
+        ++m_messagesSentInFrame;
+        return;
+    }
+
+    const quint32 message = packMessage(status, byte1, byte2);
+    const quint32 key = outputKey(status, byte1);
+    const int part = outputPart(status, byte1);
+    auto it = m_outputs.find(key);
+    if (it == m_outputs.end()) {
+        it = m_outputs.insert(key,
+                OutputState{{kNoMessage, kNoMessage}, {kNoMessage, kNoMessage}, {-1, -1}});
+    }
+    OutputState& output = it.value();
+    if (force) {
+        output.lastSentMessages[part] = kNoMessage;
+    }
+    if (output.isPending()) {
+        // Superseded before it has been sent, or held back behind the
+        // pending message of the other part to preserve their order
+        output.pendingMessages[part] = message;
+        return;
+    }
+    if (output.lastSentMessages[part] == message) {
+        return;
+    }
+    if (output.lastSentFrames[part] == m_frame ||
+            m_messagesSentInFrame >= kMaxMessagesPerFrame) {
+        output.pendingMessages[part] = message;
+        m_pendingOutputKeys.append(key);
+        if (!m_frameTimer.isActive()) {
+            m_frameTimer.start();
+        }
+        return;
+    }
+    send(&output, part, message);
+}
+
+void MidiOutputScheduler::flush() {
+    m_frameTimer.stop();
+    for (const auto key : std::as_const(m_pendingOutputKeys)) {
+        sendPending(&m_outputs[key]);
+    }
+    m_pendingOutputKeys.clear();
+}
+
+void MidiOutputScheduler::invalidate(unsigned char status, unsigned char byte1) {
+    if (!isStateMessage(status, byte1)) {
+        return;
+    }
+    const auto it = m_outputs.find(outputKey(status, byte1));
+    if (it != m_outputs.end()) {
+        it.value().lastSentMessages[outputPart(status, byte1)] = kNoMessage;
+    }
+}
+
+void MidiOutputScheduler::invalidateAll() {
+    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+        for (auto& lastSentMessage : it.value().lastSentMessages) {
+            lastSentMessage = kNoMessage;
+        }
+    }
+}
+
+void MidiOutputScheduler::reset() {
+    m_frameTimer.stop();
+    m_outputs.clear();
+    m_pendingOutputKeys.clear();
+}
+
+void MidiOutputScheduler::sendPendingMessages() {
+    updateFrame();
+    int sentCount = 0;
+    for (; sentCount < m_pendingOutputKeys.size() &&
+            m_messagesSentInFrame < kMaxMessagesPerFrame;
+            ++sentCount) {
+        sendPending(&m_outputs[m_pendingOutputKeys[sentCount]]);
+    }
+    m_pendingOutputKeys.remove(0, sentCount);
+    if (!m_pendingOutputKeys.isEmpty()) {
+        m_frameTimer.start();
+    }
+}
+
+void MidiOutputScheduler::updateFrame() {
+    const qint64 frame = mixxx::Time::elapsed().toIntegerNanos() /
+            kFrameDuration.toIntegerNanos();
+    if (frame != m_frame) {
+        m_frame = frame;
+        m_messagesSentInFrame = 0;
+    }
+}
+
+void MidiOutputScheduler::sendPending(OutputState* pOutput) {
+    for (int part = 0; part < kPartCount; ++part) {
+        const quint32 message = pOutput->pendingMessages[part];
+        pOutput->pendingMessages[part] = kNoMessage;
+        if (message != kNoMessage && message != pOutput->lastSentMessages[part]) {
+            send(pOutput, part, message);
+        }
+    }
+}
+
+void MidiOutputScheduler::send(OutputState* pOutput, int part, quint32 message) {
+    m_sendFunction(static_cast<unsigned char>(message & 0xFF),
+            static_cast<unsigned char>((message >> 8) & 0xFF),
+            static_cast<unsigned char>((message >> 16) & 0xFF));
+    pOutput->lastSentMessages[part] = message;
+    pOutput->lastSentFrames[part] = m_frame;
+    ++m_messagesSentInFrame;
+}
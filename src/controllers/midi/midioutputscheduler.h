@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+#include "util/duration.h"
+
+/// Coalesces the short MIDI messages that are sent to a device.
+///
+/// Mappings send a message on every change of the controls that they are
+/// connected to, which floods the device when a control changes fast, like
+/// a VU meter or the play position. The scheduler keeps the state of each
+/// output, i.e. the note, controller or pitch bend of a channel:
+/// - A message that would not change the last sent state is dropped,
+///   unless it is forced or the state has been invalidated.
+/// - An output is sent at most once per frame. Later changes within the
+///   same frame replace each other and are sent with the next frame.
+/// - At most kMaxMessagesPerFrame messages are sent per frame. Outputs
+///   that exceed the budget are sent with the following frames in the
+///   order of their first change.
+/// - The controllers n and n + 32 of a channel are the MSB and LSB of a
+///   14-bit value. They share the output, so that while a message of
+///   either of them is pending the other one is held back as well. The MSB
+///   is always sent before the LSB.
+///
+/// Messages that are events rather than states, e.g. program changes,
+/// channel mode and (N)RPN messages, are sent immediately after all
+/// pending messages to preserve their order.
+class MidiOutputScheduler : public QObject {
+    Q_OBJECT
+  public:
+    using SendFunction = std::function<void(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2)>;
+
+    static constexpr mixxx::Duration kFrameDuration = mixxx::Duration::fromMillis(10);
+    /// ~3200 messages per second, which is the bandwidth of a MIDI device
+    /// with the triple speed of a standard MIDI device, like the SCS.1d
+    static constexpr int kMaxMessagesPerFrame = 32;
+
+    MidiOutputScheduler(SendFunction sendFunction, QObject* pParent = nullptr);
+
+    /// Sends or schedules the message. A forced message is sent even if
+    /// it would not change the last sent state of the output, e.g. when
+    /// the device has cleared its LEDs on its own.
+    void sendShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2,
+            bool force = false);
+
+    /// Sends all pending messages, regardless of the budget. Must be called
+    /// before sending any other data, e.g. SysEx messages, and before the
+    /// device is closed.
+    void flush();
+
+    /// Forgets the last sent state of the output that corresponds to the
+    /// received input message. Some devices update their LEDs locally when
+    /// a button is pressed, so the state needs to be sent again even if
+    /// the value did not change.
+    void invalidate(unsigned char status, unsigned char byte1);
+    /// Forgets the last sent state of all outputs, so the next message of
+    /// every output is sent, e.g. after the device has been reset.
+    void invalidateAll();
+
+    /// Forgets all pending messages and states, e.g. when the device has
+    /// been closed.
+    void reset();
+
+    /// Sends the pending messages within the budget of the current frame.
+    /// Called by the frame timer.
+    void sendPendingMessages();
+
+  private:
+    /// Each output has up to two parts that are set by separate messages,
+    /// the MSB (or the only part) and the LSB of a 14-bit controller.
+    static constexpr int kPartCount = 2;
+
+    struct OutputState {
+        quint32 lastSentMessages[kPartCount];
+        quint32 pendingMessages[kPartCount];
+        qint64 lastSentFrames[kPartCount];
+
+        bool isPending() const;
+    };
+
+    void updateFrame();
+    /// Sends the pending messages of the output in the order of its parts
+    void sendPending(OutputState* pOutput);
+    void send(OutputState* pOutput, int part, quint32 message);
+
+    const SendFunction m_sendFunction;
+    QTimer m_frameTimer;
+
+    QHash<quint32, OutputState> m_outputs;
+    /// The keys of the outputs with a pending message, in the order of
+    /// their first change
+    QVector<quint32> m_pendingOutputKeys;
+
+    qint64 m_frame;
+    int m_messagesSentInFrame;
+};
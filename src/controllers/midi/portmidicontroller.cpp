@@ -18,10 +18,6 @@ PortMidiController::PortMidiController(const PmDeviceInfo* inputDeviceInfo,
                           : kUnknownControllerName),
           m_cReceiveMsg_index(0),
           m_bInSysex(false) {
-    for (int k = 0; k < MIXXX_PORTMIDI_BUFFER_LEN; ++k) {
-        m_midiBuffer[k] = {0, 0};
-    }
-
     // Note: We prepend the input stream's index to the device's name to prevent
     // duplicate devices from causing mayhem.
     //setDeviceName(QString("%1. %2").arg(QString::number(m_iInputDeviceIndex), inputDeviceInfo->name));
@@ -81,6 +77,20 @@ int PortMidiController::open() {
 
     setOpen(true);
     startEngine();
+
+    if (m_pInputDevice && m_pInputDevice->isOpen()) {
+        m_pInputThread = std::make_unique<PortMidiInputThread>(
+                m_pInputDevice.data(), getName());
+        m_pInputThread->setObjectName(QStringLiteral("PortMidiInputThread ") + getName());
+        connect(m_pInputThread.get(),
+                &PortMidiInputThread::eventsAvailable,
+                this,
+                &PortMidiController::slotInputEventsAvailable,
+                Qt::QueuedConnection);
+        // Controller input needs to be prioritized since it can affect the
+        // audio directly, like when scratching
+        m_pInputThread->start(QThread::HighPriority);
+    }
     return 0;
 }
 
@@ -90,6 +100,13 @@ int PortMidiController::close() {
         return -1;
     }
 
+    if (m_pInputThread) {
+        m_pInputThread->requestInterruption();
+        m_pInputThread->wait();
+        // Events that have not been processed yet are discarded
+        m_pInputThread.reset();
+    }
+
     stopEngine();
     MidiController::close();
 
@@ -115,24 +132,20 @@ int PortMidiController::close() {
     return result;
 }
 
-bool PortMidiController::poll() {
-    // Poll the controller for new data if it's an input device
-    if (m_pInputDevice.isNull() || !m_pInputDevice->isOpen()) {
-        return false;
-    }
-
-    int numEvents = m_pInputDevice->read(m_midiBuffer, MIXXX_PORTMIDI_BUFFER_LEN);
-
-    //qDebug() << "PortMidiController::poll()" << numEvents;
-
-    if (numEvents < 0) {
-        qCWarning(m_logInput) << "PortMidi error:" << Pm_GetErrorText((PmError)numEvents);
-        return false;
+void PortMidiController::slotInputEventsAvailable() {
+    if (!m_pInputThread) {
+        // Queued signal of a closed device
+        return;
     }
+    processInputEvents(m_pInputThread->takeEvents());
+}
 
-    for (int i = 0; i < numEvents; i++) {
-        unsigned char status = Pm_MessageStatus(m_midiBuffer[i].message);
-        mixxx::Duration timestamp = mixxx::Duration::fromMillis(m_midiBuffer[i].timestamp);
+void PortMidiController::processInputEvents(
+        const QVector<PortMidiInputThread::Event>& events) {
+    for (const auto& inputEvent : events) {
+        const PmEvent& event = inputEvent.event;
+        unsigned char status = Pm_MessageStatus(event.message);
+        mixxx::Duration timestamp = mixxx::Duration::fromMillis(event.timestamp);
 
         if ((status & 0xF8) == 0xF8) {
             // Handle real-time MIDI messages at any time
@@ -148,8 +161,8 @@ bool PortMidiController::poll() {
                 status = 0;
             } else {
                 //unsigned char channel = status & 0x0F;
-                unsigned char note = Pm_MessageData1(m_midiBuffer[i].message);
-                unsigned char velocity = Pm_MessageData2(m_midiBuffer[i].message);
+                unsigned char note = Pm_MessageData1(event.message);
+                unsigned char velocity = Pm_MessageData2(event.message);
                 receivedShortMessage(status, note, velocity, timestamp);
             }
         }
@@ -172,7 +185,7 @@ bool PortMidiController::poll() {
                 // TODO(rryan): This prevents buffer overflow if the sysex is
                 // larger than 1024 bytes. I don't want to radically change
                 // anything before the 2.0 release so this will do for now.
-                data = (m_midiBuffer[i].message >> shift) & 0xFF;
+                data = (event.message >> shift) & 0xFF;
                 if (m_cReceiveMsg_index < MIXXX_SYSEX_BUFFER_LEN) {
                     m_cReceiveMsg[m_cReceiveMsg_index++] = data;
                 }
@@ -188,7 +201,12 @@ bool PortMidiController::poll() {
             }
         }
     }
-    return numEvents > 0;
+
+    // The events of a batch are processed at once, i.e. the control updates
+    // of all events are done when the last event has been processed
+    for (const auto& inputEvent : events) {
+        recordInputLatency(inputEvent.readAt);
+    }
 }
 
 void PortMidiController::sendShortMsg(unsigned char status, unsigned char byte1,
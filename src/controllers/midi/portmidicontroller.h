@@ -3,9 +3,11 @@
 #include <portmidi.h>
 
 #include <QScopedPointer>
+#include <memory>
 
 #include "controllers/midi/midicontroller.h"
 #include "controllers/midi/portmididevice.h"
+#include "controllers/midi/portmidiinputthread.h"
 
 // Note:
 // A standard Midi device runs at 31.25 kbps, with 10 bits / byte
@@ -58,7 +60,7 @@ class PortMidiController : public MidiController {
   private slots:
     int open() override;
     int close() override;
-    bool poll() override;
+    void slotInputEventsAvailable();
 
   protected:
     // MockPortMidiController needs this to not be private.
@@ -70,9 +72,7 @@ class PortMidiController : public MidiController {
     // 0xf7.
     void sendBytes(const QByteArray& data) override;
 
-    bool isPolling() const override {
-        return true;
-    }
+    void processInputEvents(const QVector<PortMidiInputThread::Event>& events);
 
     // For testing only so that test fixtures can install mock PortMidiDevices.
     void setPortMidiInputDevice(PortMidiDevice* device) {
@@ -85,7 +85,7 @@ class PortMidiController : public MidiController {
     QScopedPointer<PortMidiDevice> m_pInputDevice;
     QScopedPointer<PortMidiDevice> m_pOutputDevice;
 
-    PmEvent m_midiBuffer[MIXXX_PORTMIDI_BUFFER_LEN];
+    std::unique_ptr<PortMidiInputThread> m_pInputThread;
 
     // Storage for SysEx messages
     unsigned char m_cReceiveMsg[MIXXX_SYSEX_BUFFER_LEN];
@@ -2,6 +2,16 @@
 
 #include <portmidi.h>
 
+#include <QMutex>
+
+#include "util/compatibility/qmutex.h"
+
+/// Wraps a PortMidi stream.
+///
+/// PortMidi is not thread-safe and all streams share the connection to the
+/// backend, e.g. the ALSA sequencer client on Linux. The input of a stream
+/// is read by a PortMidiInputThread while other threads send output, so all
+/// calls into PortMidi are serialized.
 class PortMidiDevice {
   public:
     PortMidiDevice(const PmDeviceInfo* deviceInfo,
@@ -27,6 +37,7 @@ class PortMidiDevice {
     }
 
     virtual PmError openInput(int32_t bufferSize) {
+        const auto locker = lockMutex(apiMutex());
         return Pm_OpenInput(&m_pStream, m_deviceIndex,
                             NULL, // no drive hacks
                             bufferSize,
@@ -35,6 +46,7 @@ class PortMidiDevice {
     }
 
     virtual PmError openOutput() {
+        const auto locker = lockMutex(apiMutex());
         return Pm_OpenOutput(&m_pStream,
                              m_deviceIndex,
                              NULL, // No driver hacks
@@ -45,28 +57,38 @@ class PortMidiDevice {
     }
 
     virtual PmError close() {
+        const auto locker = lockMutex(apiMutex());
         PmError err = Pm_Close(m_pStream);
         m_pStream = NULL;
         return err;
     }
 
     virtual PmError poll() {
+        const auto locker = lockMutex(apiMutex());
         return Pm_Poll(m_pStream);
     }
 
     virtual int read(PmEvent* buffer, int32_t length) {
+        const auto locker = lockMutex(apiMutex());
         return Pm_Read(m_pStream, buffer, length);
     }
 
     virtual PmError writeShort(int32_t message) {
+        const auto locker = lockMutex(apiMutex());
         return Pm_WriteShort(m_pStream, 0, message);
     }
 
     virtual PmError writeSysEx(unsigned char* message) {
+        const auto locker = lockMutex(apiMutex());
         return Pm_WriteSysEx(m_pStream, 0, message);
     }
 
   private:
+    static QMutex* apiMutex() {
+        static QMutex s_mutex;
+        return &s_mutex;
+    }
+
     const PmDeviceInfo* m_pDeviceInfo;
     int m_deviceIndex;
     PortMidiStream* m_pStream;
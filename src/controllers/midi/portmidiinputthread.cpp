@@ -0,0 +1,95 @@
+#include "controllers/midi/portmidiinputthread.h"
+
+#include "controllers/midi/portmidicontroller.h"
+#include "controllers/midi/portmididevice.h"
+#include "moc_portmidiinputthread.cpp"
+#include "util/compatibility/qmutex.h"
+#include "util/time.h"
+
+namespace {
+
+// Sleep time of the run loop while the device is in use, e.g. while a jog
+// wheel is turned. This is the upper bound of the delay until an event is
+// read and should be well below the rate of MIDI messages, which is ~1kHz
+// for a standard MIDI device.
+constexpr int kSleepTimeWhenActiveMicros = 250;
+
+// Sleep time of the run loop shortly after the device has been in use, e.g.
+// between the moves of a fader.
+constexpr int kSleepTimeWhenQuietMicros = 1000;
+
+// Sleep time of the run loop when no events have been received for a while.
+// The CPU wakes up half as often as with the 5 ms poll timer that has been
+// used before. Only the first event after the idle period might be delayed
+// by up to this time.
+constexpr int kSleepTimeWhenIdleMicros = 10000;
+
+constexpr mixxx::Duration kActiveTimeout = mixxx::Duration::fromSeconds(1);
+constexpr mixxx::Duration kQuietTimeout = mixxx::Duration::fromSeconds(10);
+
+QString loggingCategoryPrefix(const QString& deviceName) {
+    return QStringLiteral("controller.") +
+            RuntimeLoggingCategory::removeInvalidCharsFromCategory(deviceName.toLower());
+}
+
+} // namespace
+
+PortMidiInputThread::PortMidiInputThread(
+        PortMidiDevice* pInputDevice, const QString& deviceName)
+        : m_pInputDevice(pInputDevice),
+          m_logInput(loggingCategoryPrefix(deviceName) + QStringLiteral(".input")),
+          m_buffer(MIXXX_PORTMIDI_BUFFER_LEN, PmEvent{0, 0}) {
+}
+
+void PortMidiInputThread::run() {
+    mixxx::Duration lastEventAt = mixxx::Time::elapsed() - kQuietTimeout;
+    while (!isInterruptionRequested()) {
+        const int numEvents = readEvents();
+        if (numEvents < 0) {
+            qCWarning(m_logInput) << "PortMidi error:"
+                                  << Pm_GetErrorText(static_cast<PmError>(numEvents));
+        } else if (numEvents > 0) {
+            lastEventAt = mixxx::Time::elapsed();
+            if (numEvents == static_cast<int>(m_buffer.size())) {
+                // More events might be pending
+                continue;
+            }
+        }
+        const auto timeSinceLastEvent = mixxx::Time::elapsed() - lastEventAt;
+        if (timeSinceLastEvent < kActiveTimeout) {
+            usleep(kSleepTimeWhenActiveMicros);
+        } else if (timeSinceLastEvent < kQuietTimeout) {
+            usleep(kSleepTimeWhenQuietMicros);
+        } else {
+            usleep(kSleepTimeWhenIdleMicros);
+        }
+    }
+}
+
+int PortMidiInputThread::readEvents() {
+    const int numEvents = m_pInputDevice->read(
+            m_buffer.data(), static_cast<int32_t>(m_buffer.size()));
+    if (numEvents <= 0) {
+        return numEvents;
+    }
+    const auto readAt = mixxx::Time::elapsed();
+    bool wasEmpty;
+    {
+        const auto locker = lockMutex(&m_eventsMutex);
+        wasEmpty = m_events.isEmpty();
+        for (int i = 0; i < numEvents; ++i) {
+            m_events.append(Event{m_buffer[i], readAt});
+        }
+    }
+    if (wasEmpty) {
+        emit eventsAvailable();
+    }
+    return numEvents;
+}
+
+QVector<PortMidiInputThread::Event> PortMidiInputThread::takeEvents() {
+    const auto locker = lockMutex(&m_eventsMutex);
+    QVector<Event> events;
+    events.swap(m_events);
+    return events;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <portmidi.h>
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <vector>
+
+#include "util/duration.h"
+#include "util/runtimeloggingcategory.h"
+
+class PortMidiDevice;
+
+/// Reads the input stream of a PortMidi device on a thread of its own.
+///
+/// PortMidi provides neither a file descriptor nor a blocking read for
+/// its input streams. The stream is read in a loop that sleeps briefly
+/// while no events are pending, like the HidIoThread does, and backs off
+/// to longer sleeps once the device has been idle for a while. The events are
+/// handed to the controller thread as soon as they have been read, instead
+/// of waiting for the next cycle of a poll timer on the controller thread.
+class PortMidiInputThread : public QThread {
+    Q_OBJECT
+  public:
+    struct Event {
+        PmEvent event;
+        /// The time when the event has been read, see mixxx::Time
+        mixxx::Duration readAt;
+    };
+
+    PortMidiInputThread(PortMidiDevice* pInputDevice, const QString& deviceName);
+    ~PortMidiInputThread() override = default;
+
+    void run() override;
+
+    /// Reads the pending events of the input stream, up to the size of the
+    /// buffer, and queues them. Returns the number of events or a negative
+    /// PmError.
+    int readEvents();
+
+    /// Returns and removes all queued events.
+    QVector<Event> takeEvents();
+
+  signals:
+    /// Emitted when events have been queued while the queue was empty,
+    /// i.e. once for all events that are queued until the next call of
+    /// takeEvents().
+    void eventsAvailable();
+
+  private:
+    PortMidiDevice* const m_pInputDevice;
+    const RuntimeLoggingCategory m_logInput;
+
+    std::vector<PmEvent> m_buffer;
+
+    QMutex m_eventsMutex;
+    QVector<Event> m_events;
+};
@@ -10,6 +10,7 @@
 #include <QQuickRenderTarget>
 #include <QQuickWindow>
 #include <QThread>
+#include <cstring>
 
 #include "controllers/controller.h"
 #include "controllers/controllerenginethreadcontrol.h"
@@ -42,6 +43,7 @@ ControllerRenderingEngine::ControllerRenderingEngine(
         gsl::not_null<ControllerEngineThreadControl*> engineThreadControl)
         : QObject(),
           m_screenInfo(info),
+          m_sceneChanged(true),
           m_GLDataFormat(GL_RGBA),
           m_GLDataType(GL_UNSIGNED_BYTE),
           m_isValid(true),
@@ -206,6 +208,25 @@ void ControllerRenderingEngine::setup(std::shared_ptr<QQmlEngine> qmlEngine) {
     m_renderControl = std::make_unique<QQuickRenderControl>(this);
     m_quickWindow = std::make_unique<QQuickWindow>(m_renderControl.get());
 
+    // The scene is changed by the controller thread, so only flag it here
+    // and let the next frame pick it up.
+    connect(
+            m_renderControl.get(),
+            &QQuickRenderControl::sceneChanged,
+            this,
+            [this]() {
+                m_sceneChanged.store(true);
+            },
+            Qt::DirectConnection);
+    connect(
+            m_renderControl.get(),
+            &QQuickRenderControl::renderRequested,
+            this,
+            [this]() {
+                m_sceneChanged.store(true);
+            },
+            Qt::DirectConnection);
+
     if (!qmlEngine->incubationController()) {
         qmlEngine->setIncubationController(m_quickWindow->incubationController());
     }
@@ -250,6 +271,14 @@ void ControllerRenderingEngine::renderFrame() {
         return;
     }
 
+    // Nothing to do until the scene changes, e.g. because a control that
+    // is displayed has changed or an animation is running.
+    if (m_fbo && !m_sceneChanged.exchange(false)) {
+        m_nextFrameStart = Clock::now();
+        scheduleNextFrame();
+        return;
+    }
+
     VERIFY_OR_TERMINATE(m_offscreenSurface->isValid(), "OffscreenSurface isn't valid anymore.");
     VERIFY_OR_TERMINATE(m_context->isValid(), "GLContext isn't valid anymore.");
     VERIFY_OR_TERMINATE(m_context->makeCurrent(m_offscreenSurface.get()),
@@ -352,9 +381,72 @@ void ControllerRenderingEngine::renderFrame() {
 
     fboImage.mirror(false, true);
 
-    emit frameRendered(m_screenInfo, fboImage.copy(), timestamp);
-
     m_context->doneCurrent();
+
+    const QRect area = changedArea(m_previousFrame, fboImage);
+    if (area.isEmpty()) {
+        // A change of the scene doesn't necessarily change any pixel
+        scheduleNextFrame();
+        return;
+    }
+    // The image is never modified once it has been emitted, so it can
+    // be shared with the receiver without copying it.
+    m_previousFrame = fboImage;
+    emit frameRendered(m_screenInfo, fboImage, area, timestamp);
+}
+
+// static
+QRect ControllerRenderingEngine::changedArea(const QImage& previous, const QImage& current) {
+    if (previous.size() != current.size() || previous.format() != current.format()) {
+        return current.rect();
+    }
+    const int width = current.width();
+    const int height = current.height();
+    const int bytesPerPixel = current.depth() / 8;
+    const auto lineSize = static_cast<std::size_t>(width) * bytesPerPixel;
+
+    // Whole lines are compared with memcmp, which is vectorized, to find
+    // the changed lines. Only the changed lines are compared pixel by pixel.
+    int top = 0;
+    while (top < height &&
+            std::memcmp(previous.constScanLine(top), current.constScanLine(top), lineSize) ==
+                    0) {
+        ++top;
+    }
+    if (top == height) {
+        return QRect();
+    }
+    int bottom = height - 1;
+    while (bottom > top &&
+            std::memcmp(previous.constScanLine(bottom),
+                    current.constScanLine(bottom),
+                    lineSize) == 0) {
+        --bottom;
+    }
+
+    int left = width;
+    int right = -1;
+    for (int y = top; y <= bottom; ++y) {
+        const uchar* pPrevious = previous.constScanLine(y);
+        const uchar* pCurrent = current.constScanLine(y);
+        int x = 0;
+        while (x < left &&
+                std::memcmp(pPrevious + x * bytesPerPixel,
+                        pCurrent + x * bytesPerPixel,
+                        bytesPerPixel) == 0) {
+            ++x;
+        }
+        left = x;
+        x = width - 1;
+        while (x > right &&
+                std::memcmp(pPrevious + x * bytesPerPixel,
+                        pCurrent + x * bytesPerPixel,
+                        bytesPerPixel) == 0) {
+            --x;
+        }
+        right = x;
+    }
+    return QRect(QPoint(left, top), QPoint(right, bottom));
 }
 
 bool ControllerRenderingEngine::stop() {
@@ -380,6 +472,10 @@ void ControllerRenderingEngine::send(Controller* controller, const QByteArray& f
                 << "milliseconds and frame has" << frame.size() << "bytes";
     }
 
+    scheduleNextFrame();
+}
+
+void ControllerRenderingEngine::scheduleNextFrame() {
     m_nextFrameStart += std::chrono::microseconds(1000000 / m_screenInfo.target_fps);
 
     auto durationToWaitBeforeFrame =
@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QOpenGLContext>
 #include <QOpenGLFramebufferObject>
+#include <atomic>
 #include <chrono>
 #include <gsl/pointers>
 
@@ -52,6 +53,12 @@ class ControllerRenderingEngine : public QObject {
         return m_screenInfo;
     }
 
+    /// Returns the bounding rectangle of the pixels that differ between
+    /// both frames, or an empty rectangle if the frames are identical. The
+    /// whole frame is returned if the size or format of the frames differ,
+    /// e.g. if there is no previous frame.
+    static QRect changedArea(const QImage& previous, const QImage& current);
+
   public slots:
     // Request sending frame data to the device. The task will be run in the
     // rendering event loop. This method should only be called once received the
@@ -72,8 +79,14 @@ class ControllerRenderingEngine : public QObject {
     void send(Controller* controller, const QByteArray& frame);
 
   signals:
+    /// @brief Emitted when a frame has been rendered that differs from the
+    /// previous one.
+    /// @param frame the whole frame.
+    /// @param changedArea the area of the frame that has changed since the
+    /// previous frame.
     void frameRendered(const LegacyControllerMapping::ScreenInfo& screeninfo,
             QImage frame,
+            const QRect& changedArea,
             const QDateTime& timestamp);
     void stopping();
     /// @brief Request the screen thread to send a frame to the device.
@@ -83,6 +96,7 @@ class ControllerRenderingEngine : public QObject {
 
   private:
     virtual void prepare();
+    void scheduleNextFrame();
 
     std::chrono::time_point<std::chrono::steady_clock> m_nextFrameStart;
 
@@ -97,6 +111,13 @@ class ControllerRenderingEngine : public QObject {
 
     std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
 
+    // The last frame that has been emitted, to detect the changed area
+    QImage m_previousFrame;
+    // Set when the scene has changed since the last frame has been rendered.
+    // Frames are only rendered when needed, so a static scene doesn't cost
+    // anything but a timer per frame.
+    std::atomic<bool> m_sceneChanged;
+
     GLenum m_GLDataFormat;
     GLenum m_GLDataType;
 
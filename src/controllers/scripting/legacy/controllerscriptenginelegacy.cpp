@@ -33,6 +33,13 @@ const QByteArray kScreenTransformFunctionUntypedSignature =
                 "transformFrame(QVariant,QVariant)");
 const QByteArray kScreenTransformFunctionTypedSignature =
         QMetaObject::normalizedSignature("transformFrame(QVariant,QDateTime)");
+// Transform functions with a third argument receive the changed area of the
+// frame and only the data of that area.
+const QByteArray kScreenTransformAreaFunctionUntypedSignature =
+        QMetaObject::normalizedSignature(
+                "transformFrame(QVariant,QVariant,QVariant)");
+const QByteArray kScreenTransformAreaFunctionTypedSignature =
+        QMetaObject::normalizedSignature("transformFrame(QVariant,QDateTime,QRectF)");
 const QByteArray kScreenInitFunctionUntypedSignature =
         QMetaObject::normalizedSignature(
                 "init(QVariant,QVariant)");
@@ -40,6 +47,20 @@ const QByteArray kScreenInitFunctionTypedSignature =
         QMetaObject::normalizedSignature("init(QString,bool)");
 const QByteArray kScreenShutdownFunctionSignature =
         QMetaObject::normalizedSignature("shutdown()");
+
+/// Returns the pixel data of the area, line by line without padding
+QByteArray frameAreaData(const QImage& frame, const QRect& area) {
+    const int bytesPerPixel = frame.depth() / 8;
+    const int lineSize = area.width() * bytesPerPixel;
+    QByteArray data;
+    data.reserve(lineSize * area.height());
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        data.append(reinterpret_cast<const char*>(frame.constScanLine(y)) +
+                        area.left() * bytesPerPixel,
+                lineSize);
+    }
+    return data;
+}
 } // anonymous namespace
 #endif
 
@@ -551,7 +572,22 @@ void ControllerScriptEngineLegacy::extractTransformFunction(
 
     QMetaMethod transformFunction;
     bool typed = false;
-    int methodIdx = metaObject->indexOfMethod(kScreenTransformFunctionUntypedSignature);
+    bool withArea = true;
+    int methodIdx = metaObject->indexOfMethod(kScreenTransformAreaFunctionUntypedSignature);
+
+    if (methodIdx == -1 || !metaObject->method(methodIdx).isValid()) {
+        methodIdx = metaObject->indexOfMethod(kScreenTransformAreaFunctionTypedSignature);
+        typed = true;
+    }
+
+    if (methodIdx == -1 || !metaObject->method(methodIdx).isValid()) {
+        qCDebug(m_logger) << "QML Scene for screen" << screenIdentifier
+                          << "has no valid transformFrame method that accepts "
+                             "the changed area.";
+        methodIdx = metaObject->indexOfMethod(kScreenTransformFunctionUntypedSignature);
+        typed = false;
+        withArea = false;
+    }
 
     if (methodIdx == -1 || !metaObject->method(methodIdx).isValid()) {
         qCDebug(m_logger) << "QML Scene for screen" << screenIdentifier
@@ -575,7 +611,7 @@ void ControllerScriptEngineLegacy::extractTransformFunction(
     }
 
     m_transformScreenFrameFunctions.insert(screenIdentifier,
-            TransformScreenFrameFunction{transformFunction, typed});
+            TransformScreenFrameFunction{transformFunction, typed, withArea});
 }
 
 bool ControllerScriptEngineLegacy::bindSceneToScreen(
@@ -618,6 +654,7 @@ bool ControllerScriptEngineLegacy::bindSceneToScreen(
 void ControllerScriptEngineLegacy::handleScreenFrame(
         const LegacyControllerMapping::ScreenInfo& screenInfo,
         const QImage& frame,
+        const QRect& changedArea,
         const QDateTime& timestamp) {
     VERIFY_OR_DEBUG_ASSERT(
             m_transformScreenFrameFunctions.contains(screenInfo.identifier) ||
@@ -654,13 +691,13 @@ void ControllerScriptEngineLegacy::handleScreenFrame(
         emit previewRenderedScreen(screenInfo, screenDebug);
     }
 
-    // TODO: Refactor this to a `std::bit_cast` once we drop support for older
-    // compilers that don't support it (e.g. older than Xcode 14.3/macOS 13)
-    QByteArray input(reinterpret_cast<const char*>(frame.constBits()), frame.sizeInBytes());
     const TransformScreenFrameFunction& transformMethod =
             m_transformScreenFrameFunctions[screenInfo.identifier];
 
     if (!transformMethod.method.isValid() && screenInfo.rawData) {
+        // TODO: Refactor this to a `std::bit_cast` once we drop support for older
+        // compilers that don't support it (e.g. older than Xcode 14.3/macOS 13)
+        QByteArray input(reinterpret_cast<const char*>(frame.constBits()), frame.sizeInBytes());
         m_renderingScreens[screenInfo.identifier]->requestSendingFrameData(m_pController, input);
         return;
     }
@@ -673,6 +710,11 @@ void ControllerScriptEngineLegacy::handleScreenFrame(
         return;
     }
 
+    QByteArray input = transformMethod.withArea && changedArea != frame.rect()
+            ? frameAreaData(frame, changedArea)
+            : QByteArray(reinterpret_cast<const char*>(frame.constBits()),
+                      frame.sizeInBytes());
+
     QVariant returnedValue;
 
     VERIFY_OR_DEBUG_ASSERT(!m_pJSEngine->hasError()) {
@@ -681,19 +723,38 @@ void ControllerScriptEngineLegacy::handleScreenFrame(
     }
     // During the frame transformation, any QML errors are considered fatal.
     setErrorsAreFatal(true);
-    bool isSuccessful = transformMethod.typed
-            ? transformMethod.method.invoke(
-                      m_rootItems.value(screenInfo.identifier).get(),
-                      Qt::DirectConnection,
-                      Q_RETURN_ARG(QVariant, returnedValue),
-                      Q_ARG(QVariant, input),
-                      Q_ARG(QDateTime, timestamp))
-            : transformMethod.method.invoke(
-                      m_rootItems.value(screenInfo.identifier).get(),
-                      Qt::DirectConnection,
-                      Q_RETURN_ARG(QVariant, returnedValue),
-                      Q_ARG(QVariant, input),
-                      Q_ARG(QVariant, timestamp));
+    bool isSuccessful;
+    if (transformMethod.withArea) {
+        isSuccessful = transformMethod.typed
+                ? transformMethod.method.invoke(
+                          m_rootItems.value(screenInfo.identifier).get(),
+                          Qt::DirectConnection,
+                          Q_RETURN_ARG(QVariant, returnedValue),
+                          Q_ARG(QVariant, input),
+                          Q_ARG(QDateTime, timestamp),
+                          Q_ARG(QRectF, QRectF(changedArea)))
+                : transformMethod.method.invoke(
+                          m_rootItems.value(screenInfo.identifier).get(),
+                          Qt::DirectConnection,
+                          Q_RETURN_ARG(QVariant, returnedValue),
+                          Q_ARG(QVariant, input),
+                          Q_ARG(QVariant, timestamp),
+                          Q_ARG(QVariant, QVariant(changedArea)));
+    } else {
+        isSuccessful = transformMethod.typed
+                ? transformMethod.method.invoke(
+                          m_rootItems.value(screenInfo.identifier).get(),
+                          Qt::DirectConnection,
+                          Q_RETURN_ARG(QVariant, returnedValue),
+                          Q_ARG(QVariant, input),
+                          Q_ARG(QDateTime, timestamp))
+                : transformMethod.method.invoke(
+                          m_rootItems.value(screenInfo.identifier).get(),
+                          Qt::DirectConnection,
+                          Q_RETURN_ARG(QVariant, returnedValue),
+                          Q_ARG(QVariant, input),
+                          Q_ARG(QVariant, timestamp));
+    }
     setErrorsAreFatal(false);
 
     if (!isSuccessful) {
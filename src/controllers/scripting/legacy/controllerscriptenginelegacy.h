@@ -61,6 +61,7 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
     void handleScreenFrame(
             const LegacyControllerMapping::ScreenInfo& screeninfo,
             const QImage& frame,
+            const QRect& changedArea,
             const QDateTime& timestamp);
 
   signals:
@@ -91,6 +92,8 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
     struct TransformScreenFrameFunction {
         QMetaMethod method;
         bool typed;
+        // Whether the function accepts the changed area as third argument
+        bool withArea;
     };
 #endif
 
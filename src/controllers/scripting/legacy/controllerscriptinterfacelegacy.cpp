@@ -4,6 +4,7 @@
 #include "control/controlobjectscript.h"
 #include "controllers/scripting/legacy/controllerscriptenginelegacy.h"
 #include "controllers/scripting/legacy/scriptconnectionjsproxy.h"
+#include "controllers/scripting/legacy/scriptcontrolhandle.h"
 #include "mixer/playermanager.h"
 #include "moc_controllerscriptinterfacelegacy.cpp"
 #include "util/fpclassify.h"
@@ -144,23 +145,27 @@ double ControllerScriptInterfaceLegacy::getValue(const QString& group, const QSt
 
 void ControllerScriptInterfaceLegacy::setValue(
         const QString& group, const QString& name, double newValue) {
+    ControlObjectScript* coScript = getControlObjectScript(group, name);
+
+    if (coScript != nullptr) {
+        setControlValue(coScript, newValue);
+    }
+}
+
+void ControllerScriptInterfaceLegacy::setControlValue(
+        ControlObjectScript* pControl, double newValue) {
     if (util_isnan(newValue)) {
         m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
                 "Script tried setting (%1, %2) to NotANumber (NaN)")
-                                                       .arg(group, name));
+                                                       .arg(pControl->getKey().group,
+                                                               pControl->getKey().item));
         return;
     }
-
-    ControlObjectScript* coScript = getControlObjectScript(group, name);
-
-    if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
-        if (pControl &&
-                !m_st.ignore(
-                        pControl, coScript->getParameterForValue(newValue))) {
-            coScript->set(newValue);
-        }
+    ControlObject* pCreatorCO = pControl->getCreatorCO();
+    if (pCreatorCO &&
+            !m_st.ignore(
+                    pCreatorCO, pControl->getParameterForValue(newValue))) {
+        pControl->set(newValue);
     }
 }
 
@@ -177,21 +182,25 @@ double ControllerScriptInterfaceLegacy::getParameter(const QString& group, const
 
 void ControllerScriptInterfaceLegacy::setParameter(
         const QString& group, const QString& name, double newParameter) {
+    ControlObjectScript* coScript = getControlObjectScript(group, name);
+
+    if (coScript != nullptr) {
+        setControlParameter(coScript, newParameter);
+    }
+}
+
+void ControllerScriptInterfaceLegacy::setControlParameter(
+        ControlObjectScript* pControl, double newParameter) {
     if (util_isnan(newParameter)) {
         m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
                 "Script tried setting (%1, %2) to NotANumber (NaN)")
-                                                       .arg(group, name));
+                                                       .arg(pControl->getKey().group,
+                                                               pControl->getKey().item));
         return;
     }
-
-    ControlObjectScript* coScript = getControlObjectScript(group, name);
-
-    if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
-        if (pControl && !m_st.ignore(pControl, newParameter)) {
-            coScript->setParameter(newParameter);
-        }
+    ControlObject* pCreatorCO = pControl->getCreatorCO();
+    if (pCreatorCO && !m_st.ignore(pCreatorCO, newParameter)) {
+        pControl->setParameter(newParameter);
     }
 }
 
@@ -250,6 +259,86 @@ double ControllerScriptInterfaceLegacy::getDefaultParameter(
     return coScript->getParameterForValue(coScript->getDefault());
 }
 
+QJSValue ControllerScriptInterfaceLegacy::getControlHandle(
+        const QString& group, const QString& name) {
+    auto pJsEngine = m_pScriptEngineLegacy->jsEngine();
+    VERIFY_OR_DEBUG_ASSERT(pJsEngine) {
+        return QJSValue();
+    }
+
+    ControlObjectScript* coScript = getControlObjectScript(group, name);
+    if (coScript == nullptr) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control (%1, %2) returning undefined")
+                        .arg(group, name));
+        return QJSValue();
+    }
+    return pJsEngine->newQObject(new ScriptControlHandle(this, coScript));
+}
+
+ControlObjectScript* ControllerScriptInterfaceLegacy::controlFromHandle(
+        const QJSValue& handle) const {
+    const auto* pHandle = qobject_cast<ScriptControlHandle*>(handle.toQObject());
+    if (pHandle == nullptr) {
+        return nullptr;
+    }
+    return pHandle->control();
+}
+
+QJSValue ControllerScriptInterfaceLegacy::getValues(const QJSValue& handles) {
+    auto pJsEngine = m_pScriptEngineLegacy->jsEngine();
+    VERIFY_OR_DEBUG_ASSERT(pJsEngine) {
+        return QJSValue();
+    }
+    if (!handles.isArray()) {
+        m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
+                "getValues expects an array of control handles"));
+        return QJSValue();
+    }
+
+    const auto length = handles.property(QStringLiteral("length")).toUInt();
+    QJSValue values = pJsEngine->newArray(length);
+    for (quint32 i = 0; i < length; ++i) {
+        ControlObjectScript* coScript = controlFromHandle(handles.property(i));
+        if (coScript == nullptr) {
+            m_pScriptEngineLegacy->logOrThrowError(
+                    QStringLiteral("getValues: element %1 is not a control "
+                                   "handle, returning 0.0")
+                            .arg(i));
+            values.setProperty(i, 0.0);
+            continue;
+        }
+        values.setProperty(i, coScript->get());
+    }
+    return values;
+}
+
+void ControllerScriptInterfaceLegacy::setValues(
+        const QJSValue& handles, const QJSValue& values) {
+    if (!handles.isArray() || !values.isArray()) {
+        m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
+                "setValues expects an array of control handles and an array of values"));
+        return;
+    }
+    const auto length = handles.property(QStringLiteral("length")).toUInt();
+    if (values.property(QStringLiteral("length")).toUInt() != length) {
+        m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
+                "setValues expects as many values as control handles"));
+        return;
+    }
+
+    for (quint32 i = 0; i < length; ++i) {
+        ControlObjectScript* coScript = controlFromHandle(handles.property(i));
+        if (coScript == nullptr) {
+            m_pScriptEngineLegacy->logOrThrowError(
+                    QStringLiteral("setValues: element %1 is not a control handle")
+                            .arg(i));
+            continue;
+        }
+        setControlValue(coScript, values.property(i).toNumber());
+    }
+}
+
 QJSValue ControllerScriptInterfaceLegacy::makeConnection(
         const QString& group, const QString& name, const QJSValue& callback) {
     return ControllerScriptInterfaceLegacy::makeConnectionInternal(group, name, callback, false);
@@ -32,6 +32,14 @@ class ControllerScriptInterfaceLegacy : public QObject {
     Q_INVOKABLE void reset(const QString& group, const QString& name);
     Q_INVOKABLE double getDefaultValue(const QString& group, const QString& name);
     Q_INVOKABLE double getDefaultParameter(const QString& group, const QString& name);
+    /// Looks up a control once and returns a ScriptControlHandle for
+    /// accessing it directly, or undefined if the control does not exist.
+    Q_INVOKABLE QJSValue getControlHandle(const QString& group, const QString& name);
+    /// Returns an array with the values of an array of control handles
+    Q_INVOKABLE QJSValue getValues(const QJSValue& handles);
+    /// Sets the controls of an array of control handles to the values
+    /// at the same positions in the second array
+    Q_INVOKABLE void setValues(const QJSValue& handles, const QJSValue& values);
     Q_INVOKABLE QJSValue makeConnection(const QString& group,
             const QString& name,
             const QJSValue& callback);
@@ -70,6 +78,10 @@ class ControllerScriptInterfaceLegacy : public QObject {
             const double rate = -10.0);
     Q_INVOKABLE void softStart(const int deck, bool activate, double factor = 1.0);
 
+    /// Set a control from a script, unless it is ignored by soft takeover
+    void setControlValue(ControlObjectScript* pControl, double newValue);
+    void setControlParameter(ControlObjectScript* pControl, double newParameter);
+
     bool removeScriptConnection(const ScriptConnection& conn);
     /// Execute a ScriptConnection's JS callback
     void triggerScriptConnection(const ScriptConnection& conn);
@@ -84,6 +96,9 @@ class ControllerScriptInterfaceLegacy : public QObject {
             bool skipSuperseded = false);
     QHash<ConfigKey, ControlObjectScript*> m_controlCache;
     ControlObjectScript* getControlObjectScript(const QString& group, const QString& name);
+    /// Returns the control of a ScriptControlHandle or nullptr if the value
+    /// is not a handle
+    ControlObjectScript* controlFromHandle(const QJSValue& handle) const;
 
     SoftTakeoverCtrl m_st;
 
@@ -0,0 +1,61 @@
+#include "controllers/scripting/legacy/scriptcontrolhandle.h"
+
+#include "controllers/scripting/legacy/controllerscriptinterfacelegacy.h"
+#include "moc_scriptcontrolhandle.cpp"
+
+ScriptControlHandle::ScriptControlHandle(
+        ControllerScriptInterfaceLegacy* pInterface,
+        ControlObjectScript* pControl)
+        : m_pInterface(pInterface),
+          m_pControl(pControl),
+          m_key(pControl->getKey()) {
+}
+
+double ScriptControlHandle::getValue() const {
+    if (!m_pControl) {
+        return 0.0;
+    }
+    return m_pControl->get();
+}
+
+void ScriptControlHandle::setValue(double newValue) {
+    if (!m_pControl) {
+        return;
+    }
+    m_pInterface->setControlValue(m_pControl, newValue);
+}
+
+double ScriptControlHandle::getParameter() const {
+    if (!m_pControl) {
+        return 0.0;
+    }
+    return m_pControl->getParameter();
+}
+
+void ScriptControlHandle::setParameter(double newParameter) {
+    if (!m_pControl) {
+        return;
+    }
+    m_pInterface->setControlParameter(m_pControl, newParameter);
+}
+
+void ScriptControlHandle::reset() {
+    if (!m_pControl) {
+        return;
+    }
+    m_pControl->reset();
+}
+
+QJSValue ScriptControlHandle::makeConnection(const QJSValue& callback) {
+    if (!m_pControl) {
+        return QJSValue();
+    }
+    return m_pInterface->makeConnection(m_key.group, m_key.item, callback);
+}
+
+QJSValue ScriptControlHandle::makeUnbufferedConnection(const QJSValue& callback) {
+    if (!m_pControl) {
+        return QJSValue();
+    }
+    return m_pInterface->makeUnbufferedConnection(m_key.group, m_key.item, callback);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QJSValue>
+#include <QObject>
+#include <QPointer>
+
+#include "control/controlobjectscript.h"
+
+class ControllerScriptInterfaceLegacy;
+
+/// ScriptControlHandle provides scripts with direct access to a control that
+/// has been looked up once by engine.getControlHandle(). Unlike the functions
+/// of the engine object it does not look up the control on each access, which
+/// matters for mappings that access controls thousands of times per second.
+class ScriptControlHandle : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString group READ readGroup CONSTANT)
+    Q_PROPERTY(QString name READ readName CONSTANT)
+  public:
+    ScriptControlHandle(ControllerScriptInterfaceLegacy* pInterface,
+            ControlObjectScript* pControl);
+
+    QString readGroup() const {
+        return m_key.group;
+    }
+    QString readName() const {
+        return m_key.item;
+    }
+
+    /// Returns nullptr after the script engine has been shut down
+    ControlObjectScript* control() const {
+        return m_pControl.data();
+    }
+
+    Q_INVOKABLE double getValue() const;
+    Q_INVOKABLE void setValue(double newValue);
+    Q_INVOKABLE double getParameter() const;
+    Q_INVOKABLE void setParameter(double newParameter);
+    Q_INVOKABLE void reset();
+    Q_INVOKABLE QJSValue makeConnection(const QJSValue& callback);
+    Q_INVOKABLE QJSValue makeUnbufferedConnection(const QJSValue& callback);
+
+  private:
+    ControllerScriptInterfaceLegacy* const m_pInterface;
+    // Owned by m_pInterface, which deletes all controls when shutting down
+    const QPointer<ControlObjectScript> m_pControl;
+    const ConfigKey m_key;
+};
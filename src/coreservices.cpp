@@ -46,6 +46,7 @@
 #include "qml/qmlplayerproxy.h"
 #endif
 #include "soundio/soundmanager.h"
+#include "sources/seekindex.h"
 #include "sources/soundsourceproxy.h"
 #include "util/clipboard.h"
 #include "util/db/dbconnectionpooled.h"
@@ -254,6 +255,10 @@ void CoreServices::initialize(QApplication* pApp) {
 
     Sandbox::setPermissionsFilePath(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
 
+    // Stored next to the analysis data, see AnalysisDao
+    mixxx::SeekIndex::setStorageDirectory(
+            QDir(pConfig->getSettingsPath()).filePath("analysis/seekindex"));
+
     QString resourcePath = pConfig->getResourcePath();
 
     emit initializationProgressUpdate(0, tr("fonts"));
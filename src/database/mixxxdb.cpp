@@ -12,7 +12,11 @@
 const QString MixxxDb::kDefaultSchemaFile(":/schema.xml");
 
 //static
-const int MixxxDb::kRequiredSchemaVersion = 39;
+const int MixxxDb::kRequiredSchemaVersion = 40;
+
+//static
+const ConfigKey MixxxDb::kWriteAheadLogConfigKey =
+        ConfigKey(QStringLiteral("[Library]"), QStringLiteral("WriteAheadLog"));
 
 namespace {
 
@@ -30,6 +34,24 @@ const QString kUserName = QStringLiteral("mixxx");
 
 const QString kPassword = QStringLiteral("mixxx");
 
+// Each connection caches up to 16 MiB of pages and maps up to 256 MiB
+// of the database file into memory, which serves most reads of the
+// library views without any system calls. In WAL mode only checkpoints
+// are synced, which is still safe against corruption.
+const QStringList kWriteAheadLogStatements = {
+        QStringLiteral("PRAGMA journal_mode=WAL"),
+        QStringLiteral("PRAGMA synchronous=NORMAL"),
+        QStringLiteral("PRAGMA cache_size=-16384"),
+        QStringLiteral("PRAGMA mmap_size=268435456"),
+        QStringLiteral("PRAGMA temp_store=MEMORY"),
+};
+
+// The journal mode is stored persistently in the database file and
+// needs to be reset after opting out of the write-ahead log
+const QStringList kRollbackJournalStatements = {
+        QStringLiteral("PRAGMA journal_mode=DELETE"),
+};
+
 // The connection parameters for the main Mixxx DB
 mixxx::DbConnection::Params dbConnectionParams(
         const UserSettingsPointer& pConfig,
@@ -58,6 +80,12 @@ mixxx::DbConnection::Params dbConnectionParams(
     }
     params.userName = kUserName;
     params.password = kPassword;
+    if (!inMemoryConnection) {
+        params.initStatements =
+                pConfig->getValue(MixxxDb::kWriteAheadLogConfigKey, false)
+                ? kWriteAheadLogStatements
+                : kRollbackJournalStatements;
+    }
     return params;
 }
 
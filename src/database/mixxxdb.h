@@ -13,6 +13,12 @@ class MixxxDb : public QObject {
 
     static const int kRequiredSchemaVersion;
 
+    /// Opt-in to the write-ahead log of SQLite. Reading the library no
+    /// longer waits for the scanner and the analyzers while they are
+    /// writing and vice versa, at the cost of two additional files next
+    /// to the database.
+    static const ConfigKey kWriteAheadLogConfigKey;
+
     static bool initDatabaseSchema(
             const QSqlDatabase& database,
             int schemaVersion = kRequiredSchemaVersion,
@@ -1,7 +1,11 @@
 #include "engine/cachingreader/cachingreader.h"
 
 #include <QtDebug>
+#include <algorithm>
+#include <cmath>
 
+#include "control/controlobject.h"
+#include "engine/cachingreader/cachingreaderdecodedtrack.h"
 #include "moc_cachingreader.cpp"
 #include "util/assert.h"
 #include "util/compatibility/qatomic.h"
@@ -21,19 +25,37 @@ constexpr SINT kDefaultHintFrames = 1024;
 // With CachingReaderChunk::kFrames = 8192 each chunk consumes
 // 8192 frames * 2 channels/frame * 4-bytes per sample = 65 kB for stereo frame.
 //
-//     80 chunks ->  5120 KB =  5 MB
+//    256 chunks -> 16384 KB = 16 MB
 //
 // Each deck (including sample decks) will use their own CachingReader.
-// Consequently the total memory required for all allocated chunks depends
-// on the number of decks. The amount of memory reserved for a single
-// CachingReader must be multiplied by the number of decks to calculate
-// the total amount!
+// The memory of the chunks is only allocated on demand and the total
+// amount for all decks is limited by the CachingReaderChunkBudget.
+// kMaxChunks only limits the number of chunks of a single deck.
 //
-// NOTE(uklotzde, 2019-09-05): Reduce this number to just few chunks
-// (kNumberOfCachedChunksInMemory = 1, 2, 3, ...) for testing purposes
-// to verify that the MRU/LRU cache works as expected. Even though
-// massive drop outs are expected to occur Mixxx should run reliably!
-constexpr SINT kNumberOfCachedChunksInMemory = 80;
+// NOTE(uklotzde, 2019-09-05): Reduce the budget to just few chunks
+// for testing purposes to verify that the MRU/LRU cache works as
+// expected. Even though massive drop outs are expected to occur Mixxx
+// should run reliably!
+constexpr int kMaxChunks = 256;
+
+// The number of chunks that each deck may allocate regardless of the
+// budget. Enough to play without drop outs at the current position.
+constexpr int kMinChunks = 8;
+
+// The number of chunks that a deck needs ahead of the current position
+// while playing at the original rate.
+constexpr int kReadAheadChunks = 8;
+constexpr double kMaxReadAheadRate = 4.0;
+
+// Releasing is spread over multiple callbacks to not flood the worker
+constexpr int kMaxReleasedChunksPerCallback = 2;
+
+// Limit the number of in-flight requests to the worker
+constexpr SINT kMaxPendingRequests = 20;
+constexpr SINT kMaxPendingPrefetchRequests = 32;
+
+const QString kMemoryBudgetConfigGroup = QStringLiteral("[Soundcard]");
+const QString kMemoryBudgetConfigItem = QStringLiteral("CachingReaderMemoryBudgetMB");
 
 } // anonymous namespace
 
@@ -41,6 +63,12 @@ CachingReader::CachingReader(const QString& group,
         UserSettingsPointer config,
         mixxx::audio::ChannelCount maxSupportedChannel)
         : m_pConfig(config),
+          m_readStage(EngineProfiler::registerStage(
+                  group + QStringLiteral(" CachingReader::read"))),
+          m_budget(CachingReaderChunkBudget::global()),
+          m_chunkBytes(static_cast<qint64>(sizeof(CSAMPLE)) *
+                  CachingReaderChunk::frames2samples(
+                          CachingReaderChunk::kFrames, maxSupportedChannel)),
           // Limit the number of in-flight requests to the worker. This should
           // prevent to overload the worker when it is not able to fetch those
           // requests from the FIFO timely. Otherwise outdated requests pile up
@@ -50,31 +78,50 @@ CachingReader::CachingReader(const QString& group,
           // buffer, where new requests replace old requests when full. Those
           // old requests need to be returned immediately to the CachingReader
           // that must take ownership and free them!!!
-          m_chunkReadRequestFIFO(kNumberOfCachedChunksInMemory / 4),
+          m_chunkReadRequestFIFO(kMaxPendingRequests),
+          m_chunkPrefetchRequestFIFO(kMaxPendingPrefetchRequests),
           // The capacity of the back channel must be equal to the number of
           // allocated chunks, because the worker use writeBlocking(). Otherwise
           // the worker could get stuck in a hot loop!!!
-          m_readerStatusUpdateFIFO(kNumberOfCachedChunksInMemory),
+          m_readerStatusUpdateFIFO(kMaxChunks),
           m_state(STATE_IDLE),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kFrames * maxSupportedChannel *
-                  kNumberOfCachedChunksInMemory),
+          m_reservedChunkCount(0),
+          m_cacheHitCount(0),
+          m_cacheMissCount(0),
+          m_cacheUnderrunCount(0),
+          m_pCacheHitCount(std::make_unique<ControlObject>(
+                  ConfigKey(group, QStringLiteral("cache_hit_count")))),
+          m_pCacheMissCount(std::make_unique<ControlObject>(
+                  ConfigKey(group, QStringLiteral("cache_miss_count")))),
+          m_pCacheUnderrunCount(std::make_unique<ControlObject>(
+                  ConfigKey(group, QStringLiteral("cache_underrun_count")))),
+          m_pCacheChunkCount(std::make_unique<ControlObject>(
+                  ConfigKey(group, QStringLiteral("cache_chunk_count")))),
+          m_pDecodedTrack(nullptr),
           m_worker(group,
                   &m_chunkReadRequestFIFO,
+                  &m_chunkPrefetchRequestFIFO,
                   &m_readerStatusUpdateFIFO,
                   maxSupportedChannel) {
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
-        CachingReaderChunkForOwner* c =
-                new CachingReaderChunkForOwner(
-                        mixxx::SampleBuffer::WritableSlice(
-                                m_sampleBuffer,
-                                CachingReaderChunk::kFrames * maxSupportedChannel * i,
-                                CachingReaderChunk::kFrames * maxSupportedChannel));
+    if (m_pConfig) {
+        const int memoryBudgetMB = m_pConfig->getValue(
+                ConfigKey(kMemoryBudgetConfigGroup, kMemoryBudgetConfigItem),
+                static_cast<int>(CachingReaderChunkBudget::kDefaultLimitBytes >> 20));
+        m_budget.setLimit(qint64(memoryBudgetMB) << 20);
+    }
+
+    m_pCacheHitCount->setReadOnly();
+    m_pCacheMissCount->setReadOnly();
+    m_pCacheUnderrunCount->setReadOnly();
+    m_pCacheChunkCount->setReadOnly();
+
+    m_allocatedCachingReaderChunks.reserve(kMaxChunks);
+    // Initialize each chunk to hold nothing and add it to the free list.
+    // The memory of the chunks is allocated by the worker on demand.
+    for (int i = 0; i < kMaxChunks; ++i) {
+        CachingReaderChunkForOwner* c = new CachingReaderChunkForOwner();
         m_chunks.push_back(c);
         m_freeChunks.push_back(c);
     }
@@ -95,6 +142,7 @@ CachingReader::CachingReader(const QString& group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    m_budget.release(m_reservedChunkCount * m_chunkBytes);
     qDeleteAll(m_chunks);
 }
 
@@ -103,7 +151,12 @@ void CachingReader::freeChunkFromList(CachingReaderChunkForOwner* pChunk) {
             &m_mruCachingReaderChunk,
             &m_lruCachingReaderChunk);
     pChunk->free();
-    m_freeChunks.push_back(pChunk);
+    // Chunks with reserved memory are reused first
+    if (pChunk->isReserved()) {
+        m_freeChunks.push_front(pChunk);
+    } else {
+        m_freeChunks.push_back(pChunk);
+    }
 }
 
 void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
@@ -142,6 +195,13 @@ CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
         return nullptr;
     }
     CachingReaderChunkForOwner* pChunk = m_freeChunks.front();
+    if (!pChunk->isReserved()) {
+        // There are no free chunks with reserved memory left
+        if (!reserveChunk()) {
+            return nullptr;
+        }
+        pChunk->setReserved(true);
+    }
     m_freeChunks.pop_front();
 
     pChunk->init(chunkIndex);
@@ -154,8 +214,13 @@ CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
 CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkIndex) {
     auto* pChunk = allocateChunk(chunkIndex);
     if (!pChunk) {
-        if (m_lruCachingReaderChunk) {
-            freeChunk(m_lruCachingReaderChunk);
+        auto* pLRUChunk = lookupUnpinnedLRUChunk();
+        if (!pLRUChunk) {
+            // Pinned chunks are only expired if there is no other choice
+            pLRUChunk = m_lruCachingReaderChunk;
+        }
+        if (pLRUChunk) {
+            freeChunk(pLRUChunk);
             pChunk = allocateChunk(chunkIndex);
         } else {
             kLogger.warning() << "No cached LRU chunk available for freeing";
@@ -167,6 +232,79 @@ CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkInde
     return pChunk;
 }
 
+CachingReaderChunkForOwner* CachingReader::lookupUnpinnedLRUChunk() const {
+    auto* pChunk = m_lruCachingReaderChunk;
+    while (pChunk && pChunk->isPinned()) {
+        pChunk = pChunk->moreRecentlyUsed();
+    }
+    return pChunk;
+}
+
+bool CachingReader::reserveChunk() {
+    if (m_reservedChunkCount < kMinChunks) {
+        m_budget.forceReserve(m_chunkBytes);
+    } else if (!m_budget.tryReserve(m_chunkBytes)) {
+        return false;
+    }
+    ++m_reservedChunkCount;
+    return true;
+}
+
+void CachingReader::pinChunk(CachingReaderChunkForOwner* pChunk) {
+    if (pChunk->isPinned() || m_pinnedChunks.size() >= kMaxPinnedChunks) {
+        return;
+    }
+    pChunk->setPinned(true);
+    m_pinnedChunks.append(pChunk);
+}
+
+void CachingReader::unpinAllChunks() {
+    for (auto* pChunk : std::as_const(m_pinnedChunks)) {
+        pChunk->setPinned(false);
+    }
+    m_pinnedChunks.clear();
+}
+
+bool CachingReader::releaseSurplusChunks(int count) {
+    bool shouldWake = false;
+    for (int i = 0; i < count; ++i) {
+        if (m_freeChunks.empty() || !m_freeChunks.front()->isReserved()) {
+            // Expire the LRU chunk, which moves it to the front of the
+            // free list
+            auto* pLRUChunk = lookupUnpinnedLRUChunk();
+            if (!pLRUChunk) {
+                break;
+            }
+            freeChunk(pLRUChunk);
+        }
+        CachingReaderChunkForOwner* pChunk = m_freeChunks.front();
+        DEBUG_ASSERT(pChunk->isReserved());
+        CachingReaderChunkReadRequest request;
+        request.giveToWorkerForRelease(pChunk);
+        if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
+            // Revoke the chunk from the worker and keep it
+            pChunk->takeFromWorker();
+            pChunk->free();
+            break;
+        }
+        m_freeChunks.pop_front();
+        shouldWake = true;
+    }
+    return shouldWake;
+}
+
+void CachingReader::updateCacheControls() {
+    const auto updateControl = [](ControlObject* pControl, double value) {
+        if (pControl->get() != value) {
+            pControl->forceSet(value);
+        }
+    };
+    updateControl(m_pCacheHitCount.get(), static_cast<double>(m_cacheHitCount));
+    updateControl(m_pCacheMissCount.get(), static_cast<double>(m_cacheMissCount));
+    updateControl(m_pCacheUnderrunCount.get(), static_cast<double>(m_cacheUnderrunCount));
+    updateControl(m_pCacheChunkCount.get(), m_reservedChunkCount);
+}
+
 CachingReaderChunkForOwner* CachingReader::lookupChunk(SINT chunkIndex) {
     // Defaults to nullptr if it's not in the hash.
     auto* pChunk = m_allocatedCachingReaderChunks.value(chunkIndex, nullptr);
@@ -228,7 +366,16 @@ void CachingReader::process() {
     ReaderStatusUpdate update;
     while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
         auto* pChunk = update.takeFromWorker();
-        if (pChunk) {
+        if (pChunk && update.status == CHUNK_BUFFER_RELEASED) {
+            // The memory of a free chunk has been released by the worker
+            DEBUG_ASSERT(!pChunk->hasBuffer());
+            DEBUG_ASSERT(pChunk->isReserved());
+            pChunk->free();
+            pChunk->setReserved(false);
+            m_budget.release(m_chunkBytes);
+            --m_reservedChunkCount;
+            m_freeChunks.push_back(pChunk);
+        } else if (pChunk) {
             // Result of a read request (with a chunk)
             DEBUG_ASSERT(atomicLoadRelaxed(m_state) != STATE_IDLE);
             DEBUG_ASSERT(
@@ -276,9 +423,11 @@ void CachingReader::process() {
                 }
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
+                m_pDecodedTrack = update.getDecodedTrack();
                 m_state.storeRelease(STATE_TRACK_LOADED);
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
+                m_pDecodedTrack = nullptr;
                 // This message could be processed later when a new
                 // track is already loading! In this case the TRACK_LOADED will
                 // be the very next status update.
@@ -297,6 +446,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
         bool reverse,
         CSAMPLE* buffer,
         mixxx::audio::ChannelCount channelCount) {
+    ScopedEngineStage stage(m_readStage);
     // Check for bad inputs
     // Refuse to read from an invalid position
     VERIFY_OR_DEBUG_ASSERT(startSample % channelCount == 0) {
@@ -345,12 +495,16 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
         sample -= numSamples;
     }
 
-    SINT samplesRemaining = numSamples;
-
     // Process new messages from the reader thread before looking up
     // the first chunk and to update m_readableFrameIndexRange
     process();
 
+    if (m_pDecodedTrack) {
+        return readDecodedTrack(sample, numSamples, reverse, buffer, channelCount);
+    }
+
+    SINT samplesRemaining = numSamples;
+
     auto remainingFrameIndexRange =
             mixxx::IndexRange::forward(
                     CachingReaderChunk::samples2frames(sample, channelCount),
@@ -441,7 +595,10 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
 
                 mixxx::IndexRange bufferedFrameIndexRange;
                 const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
-                if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                const bool cacheHit = pChunk &&
+                        (pChunk->getState() == CachingReaderChunkForOwner::READY);
+                if (cacheHit) {
+                    ++m_cacheHitCount;
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -461,6 +618,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
                     // pending.
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
+                    ++m_cacheMissCount;
                     Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
@@ -472,6 +630,9 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
                     DEBUG_ASSERT(bufferedFrameIndexRange.empty());
                 }
                 if (bufferedFrameIndexRange.empty()) {
+                    if (!cacheHit) {
+                        ++m_cacheUnderrunCount;
+                    }
                     if (samplesRemaining == numSamples) {
                         DEBUG_ASSERT(chunkIndex == firstChunkIndex);
                         // We have not read a single frame caused by a cache miss of
@@ -528,15 +689,58 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
     return result;
 }
 
-void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
+CachingReader::ReadResult CachingReader::readDecodedTrack(SINT sample,
+        SINT numSamples,
+        bool reverse,
+        CSAMPLE* buffer,
+        mixxx::audio::ChannelCount channelCount) {
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            CachingReaderChunk::samples2frames(sample, channelCount),
+            CachingReaderChunk::samples2frames(numSamples, channelCount));
+    const auto copiedFrameIndexRange = reverse
+            ? m_pDecodedTrack->readSampleFramesReverse(
+                      buffer + numSamples, channelCount, frameIndexRange)
+            : m_pDecodedTrack->readSampleFrames(
+                      buffer, channelCount, frameIndexRange);
+    if (copiedFrameIndexRange == frameIndexRange) {
+        return ReadResult::AVAILABLE;
+    }
+    if (copiedFrameIndexRange.empty()) {
+        SampleUtil::clear(buffer, numSamples);
+        return ReadResult::PARTIALLY_AVAILABLE;
+    }
+    // Fill the frames before and after the track with silence. In reverse
+    // the frames before the track are at the end of the buffer.
+    SINT leadingSamples = CachingReaderChunk::frames2samples(
+            copiedFrameIndexRange.start() - frameIndexRange.start(), channelCount);
+    SINT trailingSamples = CachingReaderChunk::frames2samples(
+            frameIndexRange.end() - copiedFrameIndexRange.end(), channelCount);
+    if (reverse) {
+        std::swap(leadingSamples, trailingSamples);
+    }
+    SampleUtil::clear(buffer, leadingSamples);
+    SampleUtil::clear(buffer + numSamples - trailingSamples, trailingSamples);
+    return ReadResult::PARTIALLY_AVAILABLE;
+}
+
+void CachingReader::hintAndMaybeWake(const HintVector& hintList, double rate) {
     // If no file is loaded, skip.
     if (atomicLoadRelaxed(m_state) != STATE_TRACK_LOADED) {
         return;
     }
 
+    // Decoded tracks do not need any chunks
+    if (m_pDecodedTrack) {
+        return;
+    }
+
+    // The cue points may have moved since the last callback
+    unpinAllChunks();
+
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
+    int hintedChunkCount = 0;
 
     for (const auto& hint: hintList) {
         SINT hintFrame = hint.frame;
@@ -571,9 +775,19 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
 
         const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
         const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
+        hintedChunkCount += lastChunkIndex - firstChunkIndex + 1;
+        const bool prefetch = hint.isPrefetch();
+        auto* const pRequestFIFO = prefetch
+                ? &m_chunkPrefetchRequestFIFO
+                : &m_chunkReadRequestFIFO;
         for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
             CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
             if (!pChunk) {
+                if (prefetch && pRequestFIFO->writeAvailable() <= 0) {
+                    // Retry with the next callback instead of expiring
+                    // another chunk just to revoke it immediately
+                    continue;
+                }
                 shouldWake = true;
                 pChunk = allocateChunkExpireLRU(chunkIndex);
                 if (!pChunk) {
@@ -592,22 +806,42 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                             << "Requesting read of chunk"
                             << request.chunk;
                 }
-                if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
+                if (pRequestFIFO->write(&request, 1) != 1) {
                     kLogger.warning()
                             << "Failed to submit read request for chunk"
                             << chunkIndex;
                     // Revoke the chunk from the worker and free it
                     pChunk->takeFromWorker();
                     freeChunk(pChunk);
+                    continue;
                 }
             } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
                 // This will cause the chunk to be 'freshened' in the cache. The
                 // chunk will be moved to the end of the LRU list.
                 freshenChunk(pChunk);
             }
+            if (hint.isPinned()) {
+                pinChunk(pChunk);
+            }
+        }
+    }
+
+    // Hand back the memory that is not needed for the current play state
+    // if other decks may need it.
+    int targetChunkCount = kMinChunks + hintedChunkCount;
+    if (rate != 0.0) {
+        targetChunkCount += static_cast<int>(std::ceil(
+                kReadAheadChunks * std::min(std::abs(rate), kMaxReadAheadRate)));
+    }
+    if (m_reservedChunkCount > targetChunkCount && m_budget.isUnderPressure()) {
+        if (releaseSurplusChunks(std::min(m_reservedChunkCount - targetChunkCount,
+                    kMaxReleasedChunksPerCallback))) {
+            shouldWake = true;
         }
     }
 
+    updateCacheControls();
+
     // If there are chunks to be read, wake up.
     if (shouldWake) {
         m_worker.workReady();
@@ -6,13 +6,18 @@
 #include <QVarLengthArray>
 #include <QVector>
 #include <list>
+#include <memory>
 
+#include "engine/cachingreader/cachingreaderchunkbudget.h"
 #include "engine/cachingreader/cachingreaderworker.h"
+#include "engine/engineprofiler.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
 #include "util/fifo.h"
 #include "util/types.h"
 
+class ControlObject;
+
 // A Hint is an indication to the CachingReader that a certain section of a
 // SoundSource will be used 'soon' and so it should be brought into memory by
 // the reader work thread.
@@ -28,7 +33,8 @@ typedef struct Hint {
         FirstSound,
         IntroStart,
         IntroEnd,
-        OutroStart
+        OutroStart,
+        BeatJump
     };
 
     // The frame to ensure is present in memory.
@@ -43,6 +49,21 @@ typedef struct Hint {
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
+
+    // Hints for positions that the user may jump to. Their chunks are pinned.
+    bool isPinned() const {
+        return type != Type::CurrentPosition &&
+                type != Type::SlipPosition;
+    }
+
+    // The boundaries of an enabled loop will be reached soon, all other
+    // positions are only reached if the user jumps there. Their chunks are
+    // prefetched at a low priority.
+    bool isPrefetch() const {
+        return isPinned() &&
+                type != Type::LoopStartEnabled &&
+                type != Type::LoopEndEnabled;
+    }
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -76,6 +97,17 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// Hints for positions that the user may jump to, e.g. cue points, inactive
+// loops or beatjump targets, are prefetched: The worker reads them
+// only while there are no requests for the chunks around the play position.
+//
+// The memory of the chunks is taken from a budget that is shared by all
+// readers (see CachingReaderChunkBudget), so that a playing deck may cache
+// more of its track than an idle sampler. Chunks that are hinted as cue
+// points, loop boundaries or intro/outro markers are pinned and survive the
+// LRU eviction. When the budget runs short each reader hands back the chunks
+// it does not need for its current play state.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -109,15 +141,24 @@ class CachingReader : public QObject {
 
     // Issue a list of hints, but check whether any of the hints request a chunk
     // that is not in the cache. If any hints do request a chunk not in cache,
-    // then wake the reader so that it can process them. Must only be called
-    // from the engine callback.
-    void hintAndMaybeWake(const HintVector& hintList);
+    // then wake the reader so that it can process them. The rate is used to
+    // estimate the number of chunks needed for the current play state. Must
+    // only be called from the engine callback.
+    void hintAndMaybeWake(const HintVector& hintList, double rate);
 
     // Request that the CachingReader load a new track. These requests are
     // processed in the work thread, so the reader must be woken up via wake()
     // for this to take effect.
     void newTrack(TrackPointer pTrack);
 
+    // Tracks up to this duration are decoded completely into memory when
+    // loaded, e.g. the one-shot samples of sampler decks. The engine reads
+    // them directly without any chunks or worker involved. Samplers that
+    // load the same file share the decoded data.
+    void setMaxDecodedTrackDuration(double seconds) {
+        m_worker.setMaxDecodedTrackDuration(seconds);
+    }
+
     void setScheduler(EngineWorkerScheduler* pScheduler) {
         m_worker.setScheduler(pScheduler);
     }
@@ -133,10 +174,16 @@ class CachingReader : public QObject {
 
   private:
     const UserSettingsPointer m_pConfig;
+    const EngineProfiler::StageId m_readStage;
+
+    CachingReaderChunkBudget& m_budget;
+    // The memory of a single chunk in bytes
+    const qint64 m_chunkBytes;
 
     // Thread-safe FIFOs for communication between the engine callback and
     // reader thread.
     FIFO<CachingReaderChunkReadRequest> m_chunkReadRequestFIFO;
+    FIFO<CachingReaderChunkReadRequest> m_chunkPrefetchRequestFIFO;
     FIFO<ReaderStatusUpdate> m_readerStatusUpdateFIFO;
 
     // Looks for the provided chunk number in the index of in-memory chunks and
@@ -164,6 +211,30 @@ class CachingReader : public QObject {
     // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
     CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
 
+    // Returns the least recently used chunk that is not pinned, or nullptr
+    // if all chunks in the MRU/LRU list are pinned.
+    CachingReaderChunkForOwner* lookupUnpinnedLRUChunk() const;
+
+    // Reserves the memory for another chunk from the budget
+    bool reserveChunk();
+
+    // Pins the chunks of the cue hints, see hintAndMaybeWake()
+    void pinChunk(CachingReaderChunkForOwner* pChunk);
+    void unpinAllChunks();
+
+    // Hands the buffers of up to count chunks, which are not needed for
+    // the current play state, over to the worker for releasing them.
+    // Returns true if the worker needs to be woken up.
+    bool releaseSurplusChunks(int count);
+
+    void updateCacheControls();
+
+    ReadResult readDecodedTrack(SINT sample,
+            SINT numSamples,
+            bool reverse,
+            CSAMPLE* buffer,
+            mixxx::audio::ChannelCount channelCount);
+
     enum State {
         STATE_IDLE,
         STATE_TRACK_LOADING,
@@ -187,11 +258,28 @@ class CachingReader : public QObject {
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
-    // The raw memory buffer which is divided up into chunks.
-    mixxx::SampleBuffer m_sampleBuffer;
+    // Number of chunks with reserved memory, including those that are
+    // currently owned by the worker.
+    int m_reservedChunkCount;
+
+    static constexpr int kMaxPinnedChunks = 64;
+    QVarLengthArray<CachingReaderChunkForOwner*, kMaxPinnedChunks> m_pinnedChunks;
+
+    // Cache statistics, only accessed from the engine thread
+    quint64 m_cacheHitCount;
+    quint64 m_cacheMissCount;
+    quint64 m_cacheUnderrunCount;
+    std::unique_ptr<ControlObject> m_pCacheHitCount;
+    std::unique_ptr<ControlObject> m_pCacheMissCount;
+    std::unique_ptr<ControlObject> m_pCacheUnderrunCount;
+    std::unique_ptr<ControlObject> m_pCacheChunkCount;
 
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // The decoded track as reported by the worker, if the track has been
+    // decoded completely. Owned by the worker.
+    const CachingReaderDecodedTrack* m_pDecodedTrack;
+
     CachingReaderWorker m_worker;
 };
@@ -16,10 +16,18 @@ constexpr SINT kInvalidChunkIndex = -1;
 
 } // anonymous namespace
 
-CachingReaderChunk::CachingReaderChunk(
-        mixxx::SampleBuffer::WritableSlice sampleBuffer)
-        : m_index(kInvalidChunkIndex),
-          m_sampleBuffer(std::move(sampleBuffer)) {
+CachingReaderChunk::CachingReaderChunk()
+        : m_index(kInvalidChunkIndex) {
+}
+
+void CachingReaderChunk::allocateBuffer(SINT size) {
+    DEBUG_ASSERT(!hasBuffer());
+    mixxx::SampleBuffer(size).swap(m_sampleBuffer);
+}
+
+void CachingReaderChunk::releaseBuffer() {
+    mixxx::SampleBuffer().swap(m_sampleBuffer);
+    m_bufferedSampleFrames.frameIndexRange() = mixxx::IndexRange();
 }
 
 void CachingReaderChunk::init(SINT index) {
@@ -47,6 +55,7 @@ mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
         const mixxx::AudioSourcePointer& pAudioSource,
         mixxx::SampleBuffer::WritableSlice tempOutputBuffer) {
     DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+    DEBUG_ASSERT(hasBuffer());
     const auto sourceFrameIndexRange = frameIndexRange(pAudioSource);
 
     if (pAudioSource->getSignalInfo().getChannelCount() %
@@ -127,10 +136,10 @@ mixxx::IndexRange CachingReaderChunk::readBufferedSampleFramesReverse(
     return copyableFrameIndexRange;
 }
 
-CachingReaderChunkForOwner::CachingReaderChunkForOwner(
-        mixxx::SampleBuffer::WritableSlice sampleBuffer)
-        : CachingReaderChunk(std::move(sampleBuffer)),
-          m_state(FREE),
+CachingReaderChunkForOwner::CachingReaderChunkForOwner()
+        : m_state(FREE),
+          m_reserved(false),
+          m_pinned(false),
           m_pPrev(nullptr),
           m_pNext(nullptr) {
 }
@@ -155,6 +164,7 @@ void CachingReaderChunkForOwner::free() {
 
     CachingReaderChunk::init(kInvalidChunkIndex);
     m_state = FREE;
+    m_pinned = false;
 }
 
 void CachingReaderChunkForOwner::insertIntoListBefore(
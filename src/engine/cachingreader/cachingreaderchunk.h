@@ -71,9 +71,16 @@ public:
             mixxx::audio::ChannelCount channelCount,
             const mixxx::IndexRange& frameIndexRange) const;
 
+    // The sample buffer is allocated and freed by the worker thread on
+    // demand, because the engine thread must not allocate memory.
+    bool hasBuffer() const noexcept {
+        return m_sampleBuffer.data() != nullptr;
+    }
+    void allocateBuffer(SINT size);
+    void releaseBuffer();
+
   protected:
-    explicit CachingReaderChunk(
-            mixxx::SampleBuffer::WritableSlice sampleBuffer);
+    CachingReaderChunk();
     virtual ~CachingReaderChunk() = default;
 
     void init(SINT index);
@@ -87,7 +94,7 @@ public:
 
     // The worker thread will fill the sample buffer and
     // set the corresponding frame index range.
-    mixxx::SampleBuffer::WritableSlice m_sampleBuffer;
+    mixxx::SampleBuffer m_sampleBuffer;
     mixxx::ReadableSampleFrames m_bufferedSampleFrames;
 };
 
@@ -96,8 +103,7 @@ public:
 // the worker thread is in control.
 class CachingReaderChunkForOwner: public CachingReaderChunk {
 public:
-  explicit CachingReaderChunkForOwner(
-          mixxx::SampleBuffer::WritableSlice sampleBuffer);
+  CachingReaderChunkForOwner();
   ~CachingReaderChunkForOwner() override = default;
 
   void init(SINT index);
@@ -121,6 +127,13 @@ public:
         DEBUG_ASSERT(m_state == READY);
         m_state = READ_PENDING;
     }
+    // Hands a free chunk over to the worker for releasing its buffer
+    void giveToWorkerForRelease() {
+        DEBUG_ASSERT(!m_pPrev);
+        DEBUG_ASSERT(!m_pNext);
+        DEBUG_ASSERT(m_state == FREE);
+        m_state = READ_PENDING;
+    }
     void takeFromWorker() {
         // Must not be referenced in MRU/LRU list!
         DEBUG_ASSERT(!m_pPrev);
@@ -129,6 +142,30 @@ public:
         m_state = READY;
     }
 
+    // The memory of the chunk has been reserved from the budget. This
+    // is the case from the allocation of the chunk until the worker has
+    // released its buffer, i.e. also while the worker is allocating it.
+    bool isReserved() const noexcept {
+        return m_reserved;
+    }
+    void setReserved(bool reserved) {
+        m_reserved = reserved;
+    }
+
+    // Pinned chunks are not expired by the LRU policy as long as there
+    // are any unpinned chunks. Freeing a chunk unpins it.
+    bool isPinned() const noexcept {
+        return m_pinned;
+    }
+    void setPinned(bool pinned) {
+        m_pinned = pinned;
+    }
+
+    // The next item in the MRU/LRU list towards the MRU head
+    CachingReaderChunkForOwner* moreRecentlyUsed() const noexcept {
+        return m_pPrev;
+    }
+
     // Inserts a chunk into the double-linked list before the
     // given chunk and adjusts the head/tail pointers. The
     // chunk is inserted at the tail of the list if
@@ -145,6 +182,8 @@ public:
 
 private:
   State m_state;
+  bool m_reserved;
+  bool m_pinned;
 
   CachingReaderChunkForOwner* m_pPrev; // previous item in double-linked list
   CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
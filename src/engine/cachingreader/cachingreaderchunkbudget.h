@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+
+#include "util/assert.h"
+
+// The memory budget for the decoded chunks of all CachingReaders, i.e. of
+// all decks, samplers and preview decks together.
+//
+// Each reader reserves the memory for a chunk before the worker allocates
+// it and releases it after the worker has freed it. Reserving and releasing
+// is lock-free and may be done from the engine callback.
+class CachingReaderChunkBudget {
+  public:
+    static constexpr qint64 kDefaultLimitBytes = qint64(128) << 20;
+
+    explicit CachingReaderChunkBudget(qint64 limitBytes = kDefaultLimitBytes)
+            : m_limitBytes(limitBytes),
+              m_usedBytes(0) {
+    }
+
+    // The budget that is shared by all CachingReaders
+    static CachingReaderChunkBudget& global() {
+        static CachingReaderChunkBudget s_budget;
+        return s_budget;
+    }
+
+    // Reserves the given number of bytes if it fits into the limit.
+    bool tryReserve(qint64 bytes) {
+        const qint64 limitBytes = m_limitBytes.load(std::memory_order_relaxed);
+        qint64 usedBytes = m_usedBytes.load(std::memory_order_relaxed);
+        do {
+            if (usedBytes + bytes > limitBytes) {
+                return false;
+            }
+        } while (!m_usedBytes.compare_exchange_weak(
+                usedBytes, usedBytes + bytes, std::memory_order_relaxed));
+        return true;
+    }
+
+    // Reserves the given number of bytes even if this exceeds the limit.
+    // Used for the few chunks that each reader needs to play at all.
+    void forceReserve(qint64 bytes) {
+        m_usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void release(qint64 bytes) {
+        const qint64 usedBytes = m_usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        Q_UNUSED(usedBytes); // only used in DEBUG_ASSERT
+        DEBUG_ASSERT(usedBytes >= bytes);
+    }
+
+    // A lower limit does not release any memory, but the readers will
+    // release their surplus chunks, see isUnderPressure().
+    void setLimit(qint64 bytes) {
+        m_limitBytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    qint64 limit() const {
+        return m_limitBytes.load(std::memory_order_relaxed);
+    }
+
+    qint64 used() const {
+        return m_usedBytes.load(std::memory_order_relaxed);
+    }
+
+    // Returns true if more than 7/8 of the budget are used. Readers then
+    // release the chunks they do not need for the current play state, which
+    // makes room for other readers.
+    bool isUnderPressure() const {
+        const qint64 limitBytes = limit();
+        return used() > limitBytes - limitBytes / 8;
+    }
+
+  private:
+    std::atomic<qint64> m_limitBytes;
+    std::atomic<qint64> m_usedBytes;
+};
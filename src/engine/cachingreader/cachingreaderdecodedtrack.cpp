@@ -0,0 +1,170 @@
+#include "engine/cachingreader/cachingreaderdecodedtrack.h"
+
+#include <QHash>
+#include <QMutex>
+#include <algorithm>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderDecodedTrack");
+
+// Decoded tracks that are loaded by any reader, so that multiple samplers
+// that load the same file share a single copy.
+QMutex s_decodedTracksMutex;
+QHash<QString, std::weak_ptr<const CachingReaderDecodedTrack>> s_decodedTracks;
+
+std::shared_ptr<const CachingReaderDecodedTrack> lookupDecodedTrack(const QString& cacheKey) {
+    const auto locker = lockMutex(&s_decodedTracksMutex);
+    return s_decodedTracks.value(cacheKey).lock();
+}
+
+std::shared_ptr<const CachingReaderDecodedTrack> insertDecodedTrack(
+        const QString& cacheKey,
+        std::shared_ptr<const CachingReaderDecodedTrack> pDecodedTrack) {
+    const auto locker = lockMutex(&s_decodedTracksMutex);
+    // Another reader might have decoded the same file concurrently
+    auto pExistingTrack = s_decodedTracks.value(cacheKey).lock();
+    if (pExistingTrack) {
+        return pExistingTrack;
+    }
+    // Purge the entries of unloaded tracks
+    for (auto it = s_decodedTracks.begin(); it != s_decodedTracks.end();) {
+        if (it.value().expired()) {
+            it = s_decodedTracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    s_decodedTracks.insert(cacheKey, pDecodedTrack);
+    return pDecodedTrack;
+}
+
+} // anonymous namespace
+
+// static
+std::shared_ptr<const CachingReaderDecodedTrack> CachingReaderDecodedTrack::decode(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        const QString& cacheKey) {
+    auto pDecodedTrack = lookupDecodedTrack(cacheKey);
+    if (pDecodedTrack) {
+        return pDecodedTrack;
+    }
+
+    // Odd channel counts are converted to stereo, like in the chunks
+    mixxx::AudioSourcePointer pReadableSource = pAudioSource;
+    if (pAudioSource->getSignalInfo().getChannelCount() %
+                    mixxx::audio::ChannelCount::stereo() !=
+            0) {
+        pReadableSource = mixxx::AudioSourceStereoProxy::create(
+                pAudioSource, CachingReaderChunk::kFrames);
+    }
+    const auto channelCount = pReadableSource->getSignalInfo().getChannelCount();
+    const auto sourceFrameIndexRange = pReadableSource->frameIndexRange();
+    mixxx::SampleBuffer sampleBuffer(
+            CachingReaderChunk::frames2samples(sourceFrameIndexRange.length(), channelCount));
+    if (sampleBuffer.size() == 0) {
+        return nullptr;
+    }
+
+    // Decode in blocks of the chunk size and stop at the first unreadable
+    // frame, like the chunks do with the readable frame index range.
+    SINT frameIndex = sourceFrameIndexRange.start();
+    while (frameIndex < sourceFrameIndexRange.end()) {
+        const auto blockFrameIndexRange = mixxx::IndexRange::forward(frameIndex,
+                std::min(CachingReaderChunk::kFrames,
+                        sourceFrameIndexRange.end() - frameIndex));
+        const SINT sampleOffset = CachingReaderChunk::frames2samples(
+                frameIndex - sourceFrameIndexRange.start(), channelCount);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                blockFrameIndexRange.length(), channelCount);
+        const auto readableSampleFrames = pReadableSource->readSampleFrames(
+                mixxx::WritableSampleFrames(blockFrameIndexRange,
+                        mixxx::SampleBuffer::WritableSlice(
+                                sampleBuffer, sampleOffset, sampleCount)));
+        if (readableSampleFrames.frameIndexRange().empty() ||
+                readableSampleFrames.frameIndexRange().start() != frameIndex) {
+            break;
+        }
+        const SINT readableSampleCount = CachingReaderChunk::frames2samples(
+                readableSampleFrames.frameIndexRange().length(), channelCount);
+        if (readableSampleFrames.readableData() != sampleBuffer.data(sampleOffset)) {
+            SampleUtil::copy(sampleBuffer.data(sampleOffset),
+                    readableSampleFrames.readableData(),
+                    readableSampleCount);
+        }
+        frameIndex = readableSampleFrames.frameIndexRange().end();
+        if (readableSampleFrames.frameIndexRange() != blockFrameIndexRange) {
+            break;
+        }
+    }
+    const auto decodedFrameIndexRange = mixxx::IndexRange::between(
+            sourceFrameIndexRange.start(), frameIndex);
+    if (decodedFrameIndexRange.empty()) {
+        kLogger.warning() << "Failed to decode" << cacheKey;
+        return nullptr;
+    }
+
+    return insertDecodedTrack(cacheKey,
+            std::make_shared<const CachingReaderDecodedTrack>(
+                    std::move(sampleBuffer), channelCount, decodedFrameIndexRange));
+}
+
+CachingReaderDecodedTrack::CachingReaderDecodedTrack(
+        mixxx::SampleBuffer sampleBuffer,
+        mixxx::audio::ChannelCount channelCount,
+        mixxx::IndexRange frameIndexRange)
+        : m_sampleBuffer(std::move(sampleBuffer)),
+          m_channelCount(channelCount),
+          m_frameIndexRange(frameIndexRange) {
+}
+
+mixxx::IndexRange CachingReaderDecodedTrack::readSampleFrames(
+        CSAMPLE* sampleBuffer,
+        mixxx::audio::ChannelCount channelCount,
+        const mixxx::IndexRange& frameIndexRange) const {
+    const auto copyableFrameIndexRange = intersect(frameIndexRange, m_frameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start(),
+                channelCount);
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start(),
+                channelCount);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length(), channelCount);
+        SampleUtil::copy(
+                sampleBuffer + dstSampleOffset,
+                m_sampleBuffer.data(srcSampleOffset),
+                sampleCount);
+    }
+    return copyableFrameIndexRange;
+}
+
+mixxx::IndexRange CachingReaderDecodedTrack::readSampleFramesReverse(
+        CSAMPLE* reverseSampleBuffer,
+        mixxx::audio::ChannelCount channelCount,
+        const mixxx::IndexRange& frameIndexRange) const {
+    const auto copyableFrameIndexRange = intersect(frameIndexRange, m_frameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start(),
+                channelCount);
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start(),
+                channelCount);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length(), channelCount);
+        SampleUtil::copyReverse(
+                reverseSampleBuffer - dstSampleOffset - sampleCount,
+                m_sampleBuffer.data(srcSampleOffset),
+                sampleCount,
+                channelCount);
+    }
+    return copyableFrameIndexRange;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+#include <memory>
+
+#include "audio/types.h"
+#include "sources/audiosource.h"
+#include "util/samplebuffer.h"
+
+// The fully decoded audio data of a short track, e.g. a one-shot sample.
+//
+// The worker decodes short tracks of sampler and preview decks once into
+// a single buffer that the engine reads from directly, bypassing the chunks
+// and the worker. The data is immutable and shared between all readers that
+// have loaded the same file.
+class CachingReaderDecodedTrack {
+  public:
+    // Returns the decoded track for the given cache key, which identifies
+    // the file, if it is still loaded by another reader. Otherwise decodes
+    // the whole audio source. Returns nullptr if decoding failed.
+    static std::shared_ptr<const CachingReaderDecodedTrack> decode(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            const QString& cacheKey);
+
+    CachingReaderDecodedTrack(
+            mixxx::SampleBuffer sampleBuffer,
+            mixxx::audio::ChannelCount channelCount,
+            mixxx::IndexRange frameIndexRange);
+
+    mixxx::audio::ChannelCount channelCount() const {
+        return m_channelCount;
+    }
+
+    mixxx::IndexRange frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+
+    // Copies the available frames of the given range into the buffer and
+    // returns their range, like CachingReaderChunk::readBufferedSampleFrames().
+    mixxx::IndexRange readSampleFrames(CSAMPLE* sampleBuffer,
+            mixxx::audio::ChannelCount channelCount,
+            const mixxx::IndexRange& frameIndexRange) const;
+    mixxx::IndexRange readSampleFramesReverse(
+            CSAMPLE* reverseSampleBuffer,
+            mixxx::audio::ChannelCount channelCount,
+            const mixxx::IndexRange& frameIndexRange) const;
+
+  private:
+    const mixxx::SampleBuffer m_sampleBuffer;
+    const mixxx::audio::ChannelCount m_channelCount;
+    const mixxx::IndexRange m_frameIndexRange;
+};
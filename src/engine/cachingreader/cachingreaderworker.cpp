@@ -4,6 +4,7 @@
 #include <QtDebug>
 
 #include "analyzer/analyzersilence.h"
+#include "engine/cachingreader/cachingreaderdecodedtrack.h"
 #include "moc_cachingreaderworker.cpp"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
@@ -25,13 +26,18 @@ constexpr SINT kNumSoundFrameToVerify = 2;
 CachingReaderWorker::CachingReaderWorker(
         const QString& group,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
+        FIFO<CachingReaderChunkReadRequest>* pChunkPrefetchRequestFIFO,
         FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
         mixxx::audio::ChannelCount maxSupportedChannel)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
+          m_pChunkPrefetchRequestFIFO(pChunkPrefetchRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
-          m_maxSupportedChannel(maxSupportedChannel) {
+          m_maxDecodedTrackSeconds(0.0),
+          m_maxSupportedChannel(maxSupportedChannel),
+          m_chunkBufferSize(CachingReaderChunk::frames2samples(
+                  CachingReaderChunk::kFrames, maxSupportedChannel)) {
 }
 
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
@@ -39,6 +45,11 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     CachingReaderChunk* pChunk = request.chunk;
     DEBUG_ASSERT(pChunk);
 
+    if (request.releaseBuffer) {
+        pChunk->releaseBuffer();
+        return ReaderStatusUpdate::bufferReleased(pChunk);
+    }
+
     // Before trying to read any data we need to check if the audio source
     // is available and if any audio data that is needed by the chunk is
     // actually available.
@@ -51,6 +62,11 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         return result;
     }
 
+    // The memory for the buffer has already been reserved by the reader
+    if (!pChunk->hasBuffer()) {
+        pChunk->allocateBuffer(m_chunkBufferSize);
+    }
+
     // Try to read the data required for the chunk from the audio source
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
             m_pAudioSource,
@@ -127,8 +143,11 @@ void CachingReaderWorker::run() {
                 // here, the engine is already stopped
                 unloadTrack();
             }
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
+        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1 ||
+                m_pChunkPrefetchRequestFIFO->read(&request, 1) == 1) {
+            // Read the requested chunk and send the result. A single
+            // prefetch request is served at a time, so that new read
+            // requests for the play position do not have to wait.
             const ReaderStatusUpdate update = processReadRequest(request);
             m_pReaderStatusFIFO->writeBlocking(&update, 1);
         } else {
@@ -141,7 +160,8 @@ void CachingReaderWorker::run() {
 
 void CachingReaderWorker::discardAllPendingRequests() {
     CachingReaderChunkReadRequest request;
-    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1 ||
+            m_pChunkPrefetchRequestFIFO->read(&request, 1) == 1) {
         const auto update = ReaderStatusUpdate::readDiscarded(request.chunk);
         m_pReaderStatusFIFO->writeBlocking(&update, 1);
     }
@@ -155,10 +175,13 @@ void CachingReaderWorker::closeAudioSource() {
         m_pAudioSource->close();
         m_pAudioSource.reset();
     }
+    // The engine does not access the decoded track while it is stopped
+    m_pDecodedTrack.reset();
 
     // This function has to be called with the engine stopped only
     // to avoid collecting new requests for the old track
     DEBUG_ASSERT(!m_pChunkReadRequestFIFO->readAvailable());
+    DEBUG_ASSERT(!m_pChunkPrefetchRequestFIFO->readAvailable());
 }
 
 void CachingReaderWorker::unloadTrack() {
@@ -248,9 +271,26 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
     }
 
+    // Short tracks are decoded completely, so that the engine can read them
+    // without any latency or disk I/O
+    const double maxDecodedTrackSeconds =
+            m_maxDecodedTrackSeconds.load(std::memory_order_relaxed);
+    if (maxDecodedTrackSeconds > 0 &&
+            m_pAudioSource->frameLength() <=
+                    maxDecodedTrackSeconds *
+                            m_pAudioSource->getSignalInfo().getSampleRate()) {
+        const QString cacheKey = pTrack->getLocation() + QChar('|') +
+                QString::number(pTrack->getFileInfo().lastModified().toMSecsSinceEpoch()) +
+                QChar('|') + QString::number(m_maxSupportedChannel);
+        m_pDecodedTrack = CachingReaderDecodedTrack::decode(m_pAudioSource, cacheKey);
+    }
+
     const auto update =
             ReaderStatusUpdate::trackLoaded(
-                    m_pAudioSource->frameIndexRange());
+                    m_pDecodedTrack
+                            ? m_pDecodedTrack->frameIndexRange()
+                            : m_pAudioSource->frameIndexRange(),
+                    m_pDecodedTrack.get());
     m_pReaderStatusFIFO->writeBlocking(&update, 1);
 
     // Emit that the track is loaded.
@@ -266,6 +306,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // The engine must not request any chunks before receiving the
     // trackLoaded() signal
     DEBUG_ASSERT(!m_pChunkReadRequestFIFO->readAvailable());
+    DEBUG_ASSERT(!m_pChunkPrefetchRequestFIFO->readAvailable());
 
     emit trackLoaded(
             pTrack,
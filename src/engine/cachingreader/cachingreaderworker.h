@@ -2,6 +2,8 @@
 
 #include <QMutex>
 #include <QString>
+#include <atomic>
+#include <memory>
 
 #include "audio/frame.h"
 #include "audio/types.h"
@@ -12,16 +14,27 @@
 
 template<class DataType>
 class FIFO;
+class CachingReaderDecodedTrack;
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // Instead of reading the chunk the worker frees its buffer
+    bool releaseBuffer;
 
     void giveToWorker(CachingReaderChunkForOwner* chunkForOwner) {
         DEBUG_ASSERT(chunkForOwner);
         chunk = chunkForOwner;
+        releaseBuffer = false;
         chunkForOwner->giveToWorker();
     }
+
+    void giveToWorkerForRelease(CachingReaderChunkForOwner* chunkForOwner) {
+        DEBUG_ASSERT(chunkForOwner);
+        chunk = chunkForOwner;
+        releaseBuffer = true;
+        chunkForOwner->giveToWorkerForRelease();
+    }
 } CachingReaderChunkReadRequest;
 
 enum ReaderStatus {
@@ -31,12 +44,14 @@ enum ReaderStatus {
     CHUNK_READ_EOF,
     CHUNK_READ_INVALID,
     CHUNK_READ_DISCARDED, // response without frame index range!
+    CHUNK_BUFFER_RELEASED, // response without frame index range!
 };
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct ReaderStatusUpdate {
   private:
     CachingReaderChunk* chunk;
+    const CachingReaderDecodedTrack* decodedTrack;
     SINT readableFrameIndexRangeStart;
     SINT readableFrameIndexRangeEnd;
 
@@ -49,6 +64,7 @@ typedef struct ReaderStatusUpdate {
             const mixxx::IndexRange& readableFrameIndexRangeArg) {
         status = statusArg;
         chunk = chunkArg;
+        decodedTrack = nullptr;
         readableFrameIndexRangeStart = readableFrameIndexRangeArg.start();
         readableFrameIndexRangeEnd = readableFrameIndexRangeArg.end();
     }
@@ -60,11 +76,22 @@ typedef struct ReaderStatusUpdate {
         return update;
     }
 
+    static ReaderStatusUpdate bufferReleased(
+            CachingReaderChunk* chunk) {
+        ReaderStatusUpdate update;
+        update.init(CHUNK_BUFFER_RELEASED, chunk, mixxx::IndexRange());
+        return update;
+    }
+
+    // The decoded track, if any, is owned by the worker and stays valid
+    // until the engine has been stopped for loading the next track.
     static ReaderStatusUpdate trackLoaded(
-            const mixxx::IndexRange& readableFrameIndexRange) {
+            const mixxx::IndexRange& readableFrameIndexRange,
+            const CachingReaderDecodedTrack* pDecodedTrack) {
         DEBUG_ASSERT(!readableFrameIndexRange.empty());
         ReaderStatusUpdate update;
         update.init(TRACK_LOADED, nullptr, readableFrameIndexRange);
+        update.decodedTrack = pDecodedTrack;
         return update;
     }
 
@@ -85,6 +112,10 @@ typedef struct ReaderStatusUpdate {
         return pChunk;
     }
 
+    const CachingReaderDecodedTrack* getDecodedTrack() const {
+        return decodedTrack;
+    }
+
     mixxx::IndexRange readableFrameIndexRange() const {
         return mixxx::IndexRange::between(
                 readableFrameIndexRangeStart,
@@ -99,6 +130,7 @@ class CachingReaderWorker : public EngineWorker {
     // Construct a CachingReader with the given group.
     CachingReaderWorker(const QString& group,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
+            FIFO<CachingReaderChunkReadRequest>* pChunkPrefetchRequestFIFO,
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
             mixxx::audio::ChannelCount maxSupportedChannel);
     ~CachingReaderWorker() override = default;
@@ -106,6 +138,12 @@ class CachingReaderWorker : public EngineWorker {
     // Request to load a new track. wake() must be called afterwards.
     void newTrack(TrackPointer pTrack);
 
+    // Tracks up to this duration are decoded completely when loaded.
+    // 0 disables decoding in memory.
+    void setMaxDecodedTrackDuration(double seconds) {
+        m_maxDecodedTrackSeconds.store(seconds, std::memory_order_relaxed);
+    }
+
     // Run upkeep operations like loading tracks and reading from file. Run by a
     // thread pool via the EngineWorkerScheduler.
     void run() override;
@@ -126,8 +164,10 @@ class CachingReaderWorker : public EngineWorker {
     QString m_tag;
 
     // Thread-safe FIFOs for communication between the engine callback and
-    // reader thread.
+    // reader thread. Prefetch requests are only served while there are no
+    // other read requests.
     FIFO<CachingReaderChunkReadRequest>* m_pChunkReadRequestFIFO;
+    FIFO<CachingReaderChunkReadRequest>* m_pChunkPrefetchRequestFIFO;
     FIFO<ReaderStatusUpdate>* m_pReaderStatusFIFO;
 
     // Queue of Tracks to load, and the corresponding lock. Must acquire the
@@ -158,6 +198,11 @@ class CachingReaderWorker : public EngineWorker {
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
+    // The completely decoded audio data of a short track, which is read by
+    // the engine directly
+    std::shared_ptr<const CachingReaderDecodedTrack> m_pDecodedTrack;
+    std::atomic<double> m_maxDecodedTrackSeconds;
+
     mixxx::audio::FramePos m_firstSoundFrameToVerify;
 
     // Temporary buffer for reading samples from all channels
@@ -167,5 +212,8 @@ class CachingReaderWorker : public EngineWorker {
     // The maximum number of channel that this reader can support
     mixxx::audio::ChannelCount m_maxSupportedChannel;
 
+    // The size of the sample buffer of each chunk
+    const SINT m_chunkBufferSize;
+
     QAtomicInt m_stop;
 };
@@ -1,9 +1,41 @@
 #include "engine/channelmixer.h"
 
+#include <algorithm>
+
 #include "engine/effects/engineeffectsmanager.h"
 #include "util/sample.h"
 #include "util/timer.h"
 
+namespace {
+
+struct ChannelGain {
+    CSAMPLE_GAIN oldGain;
+    CSAMPLE_GAIN newGain;
+    bool fadeout;
+};
+
+// Calculates the gain of the channel for this callback, which is ramped to
+// from the gain of the last callback.
+ChannelGain updateChannelGain(const EngineMixer::GainCalculator& gainCalculator,
+        EngineMixer::ChannelInfo* pChannelInfo,
+        EngineMixer::GainCache* pGainCache) {
+    ChannelGain gain;
+    gain.oldGain = pGainCache->m_gain;
+    gain.fadeout = pGainCache->m_fadeout ||
+            (pChannelInfo->m_pChannel &&
+                    !pChannelInfo->m_pChannel->isActive());
+    if (gain.fadeout) {
+        gain.newGain = 0;
+        pGainCache->m_fadeout = false;
+    } else {
+        gain.newGain = gainCalculator.getGain(pChannelInfo);
+    }
+    pGainCache->m_gain = gain.newGain;
+    return gain;
+}
+
+} // anonymous namespace
+
 // static
 void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator& gainCalculator,
         const QVarLengthArray<EngineMixer::ChannelInfo*, kPreallocatedChannels>& activeChannels,
@@ -14,30 +46,55 @@ void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator&
         mixxx::audio::SampleRate sampleRate,
         EngineEffectsManager* pEngineEffectsManager) {
     // Signal flow overview:
-    // 1. Clear pOutput buffer
-    // 2. Calculate gains for each channel
-    // 3. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
+    // 1. Calculate gains for each channel
+    // 2. Mix all channels without enabled postfader effects with their gains
+    //    into pOutput in a single pass, overwriting the pOutput buffer from
+    //    the last engine callback
+    // 3. Pass the calculated gain and input buffer of each remaining channel
+    //    to pEngineEffectsManager, which then:
     //     A) Copies each channel input buffer to a temporary buffer
     //     B) Applies gain to the temporary buffer
     //     C) Processes effects on the temporary buffer
     //     D) Mixes the temporary buffer into pOutput
     // The original channel input buffers are not modified.
-    SampleUtil::clear(pOutput, iBufferSize);
     ScopedTimer t(QStringLiteral("EngineMixer::applyEffectsAndMixChannels"));
+    QVarLengthArray<ChannelGain, kPreallocatedChannels> gains;
+    QVarLengthArray<bool, kPreallocatedChannels> bypassed;
+    QVarLengthArray<const CSAMPLE*, kPreallocatedChannels> mixBuffers;
+    QVarLengthArray<CSAMPLE_GAIN, kPreallocatedChannels> mixOldGains;
+    QVarLengthArray<CSAMPLE_GAIN, kPreallocatedChannels> mixNewGains;
     for (auto* pChannelInfo : activeChannels) {
-        EngineMixer::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
-        CSAMPLE_GAIN oldGain = gainCache.m_gain;
-        CSAMPLE_GAIN newGain;
-        bool fadeout = gainCache.m_fadeout ||
-                (pChannelInfo->m_pChannel &&
-                        !pChannelInfo->m_pChannel->isActive());
-        if (fadeout) {
-            newGain = 0;
-            gainCache.m_fadeout = false;
-        } else {
-            newGain = gainCalculator.getGain(pChannelInfo);
+        const ChannelGain gain = updateChannelGain(gainCalculator,
+                pChannelInfo,
+                &(*channelGainCache)[pChannelInfo->m_index]);
+        gains.append(gain);
+        // The chains stay bypassed while the other channels are processed
+        // below, because only the own channel can leave the disabled state.
+        const bool isBypassed = pEngineEffectsManager->isPostFaderBypassed(
+                pChannelInfo->m_handle, outputHandle);
+        bypassed.append(isBypassed);
+        if (isBypassed) {
+            mixBuffers.append(pChannelInfo->m_pBuffer.data());
+            mixOldGains.append(gain.oldGain);
+            mixNewGains.append(gain.newGain);
         }
-        gainCache.m_gain = newGain;
+    }
+    SampleUtil::copyMultipleWithRampingGain(pOutput,
+            mixBuffers.constData(),
+            mixOldGains.constData(),
+            mixNewGains.constData(),
+            static_cast<int>(mixBuffers.size()),
+            iBufferSize);
+
+    for (int i = 0; i < activeChannels.size(); ++i) {
+        EngineMixer::ChannelInfo* pChannelInfo = activeChannels[i];
+        const ChannelGain& gain = gains[i];
+        if (bypassed[i]) {
+            pEngineEffectsManager->skipPostFader(
+                    pChannelInfo->m_handle, outputHandle, gain.fadeout);
+            continue;
+        }
+        ScopedEngineStage stage(pChannelInfo->m_effectsStage);
         pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
                 outputHandle,
                 pChannelInfo->m_pBuffer.data(),
@@ -45,9 +102,9 @@ void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator&
                 iBufferSize,
                 sampleRate,
                 pChannelInfo->m_features,
-                oldGain,
-                newGain,
-                fadeout);
+                gain.oldGain,
+                gain.newGain,
+                gain.fadeout);
     }
 }
 
@@ -67,32 +124,35 @@ void ChannelMixer::applyEffectsInPlaceAndMixChannels(
     // 2. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
     //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
     //    B) Applies effects to the buffer, modifying the original input buffer
-    // 4. Mix the channel buffers together to make pOutput, overwriting the pOutput buffer from the last engine callback
+    // 3. Mix the channel buffers together in a single pass to make pOutput,
+    //    overwriting the pOutput buffer from the last engine callback
     ScopedTimer t(QStringLiteral("EngineMixer::applyEffectsInPlaceAndMixChannels"));
-    SampleUtil::clear(pOutput, iBufferSize);
+    QVarLengthArray<const CSAMPLE*, kPreallocatedChannels> mixBuffers;
     for (auto* pChannelInfo : activeChannels) {
-        EngineMixer::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
-        CSAMPLE_GAIN oldGain = gainCache.m_gain;
-        CSAMPLE_GAIN newGain;
-        bool fadeout = gainCache.m_fadeout ||
-                (pChannelInfo->m_pChannel &&
-                        !pChannelInfo->m_pChannel->isActive());
-        if (fadeout) {
-            newGain = 0;
-            gainCache.m_fadeout = false;
-        } else {
-            newGain = gainCalculator.getGain(pChannelInfo);
+        const ChannelGain gain = updateChannelGain(gainCalculator,
+                pChannelInfo,
+                &(*channelGainCache)[pChannelInfo->m_index]);
+        {
+            ScopedEngineStage stage(pChannelInfo->m_effectsStage);
+            pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
+                    outputHandle,
+                    pChannelInfo->m_pBuffer.data(),
+                    iBufferSize,
+                    sampleRate,
+                    pChannelInfo->m_features,
+                    gain.oldGain,
+                    gain.newGain,
+                    gain.fadeout);
         }
-        gainCache.m_gain = newGain;
-        pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
-                outputHandle,
-                pChannelInfo->m_pBuffer.data(),
-                iBufferSize,
-                sampleRate,
-                pChannelInfo->m_features,
-                oldGain,
-                newGain,
-                fadeout);
-        SampleUtil::add(pOutput, pChannelInfo->m_pBuffer.data(), iBufferSize);
+        mixBuffers.append(pChannelInfo->m_pBuffer.data());
     }
+    // The gains have already been applied
+    QVarLengthArray<CSAMPLE_GAIN, kPreallocatedChannels> unityGains(mixBuffers.size());
+    std::fill(unityGains.begin(), unityGains.end(), CSAMPLE_GAIN_ONE);
+    SampleUtil::copyMultipleWithRampingGain(pOutput,
+            mixBuffers.constData(),
+            unityGains.constData(),
+            unityGains.constData(),
+            static_cast<int>(mixBuffers.size()),
+            iBufferSize);
 }
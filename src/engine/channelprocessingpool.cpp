@@ -0,0 +1,174 @@
+#include "engine/channelprocessingpool.h"
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ChannelProcessingPool");
+
+// Number of polls before a helper parks itself on the semaphore. A buffer of
+// 128 frames at 48 kHz is less than 3 ms, so helpers that have just finished
+// a callback will usually pick up the next one while still spinning.
+// We intentionally don't use std::atomic::wait() here, it is prone to lost
+// wake-ups with some standard library versions.
+constexpr int kHelperSpinCount = 2000;
+
+// Number of polls before the joining thread starts to yield its time slice.
+constexpr int kJoinSpinCount = 10000;
+
+constexpr std::uint32_t stateGeneration(std::uint64_t state) {
+    return static_cast<std::uint32_t>(state >> 32);
+}
+
+constexpr int stateNumTasks(std::uint64_t state) {
+    return static_cast<int>((state >> 16) & 0xFFFF);
+}
+
+constexpr int stateNextTask(std::uint64_t state) {
+    return static_cast<int>(state & 0xFFFF);
+}
+
+} // namespace
+
+ChannelProcessingPool::ChannelProcessingPool(int numHelpers, bool pinToCores)
+        : m_pFunction(nullptr),
+          m_pContext(nullptr),
+          m_state(packState(0, 0, 0)),
+          m_pendingTasks(0),
+          m_generation(0),
+          m_sleepingHelpers(0),
+          m_quit(false) {
+    DEBUG_ASSERT(numHelpers >= 0);
+    m_helpers.reserve(numHelpers);
+    for (int i = 0; i < numHelpers; ++i) {
+        QThread* pThread = QThread::create([this, i, pinToCores]() {
+            helperLoop(i, pinToCores);
+        });
+        pThread->setObjectName(QStringLiteral("EngineHelper %1").arg(i + 1));
+        pThread->start(QThread::TimeCriticalPriority);
+        m_helpers.push_back(pThread);
+    }
+    kLogger.info() << "Started" << numHelpers << "engine helper threads";
+}
+
+ChannelProcessingPool::~ChannelProcessingPool() {
+    m_quit.store(true);
+    m_wakeSemaphore.release(numHelpers());
+    for (QThread* pThread : m_helpers) {
+        pThread->wait();
+        delete pThread;
+    }
+}
+
+void ChannelProcessingPool::run(TaskFunction pFunction, void* pContext, int numTasks) {
+    VERIFY_OR_DEBUG_ASSERT(numTasks <= kMaxTasks) {
+        numTasks = kMaxTasks;
+    }
+    if (numTasks <= 0) {
+        return;
+    }
+    if (m_helpers.empty() || numTasks == 1) {
+        for (int i = 0; i < numTasks; ++i) {
+            pFunction(pContext, i);
+        }
+        return;
+    }
+
+    // Publish the new generation. All previous tasks have been claimed and
+    // completed, so nobody reads the job description while we write it.
+    const std::uint32_t generation = m_generation.load(std::memory_order_relaxed) + 1;
+    m_pFunction = pFunction;
+    m_pContext = pContext;
+    m_pendingTasks.store(numTasks, std::memory_order_relaxed);
+    m_state.store(packState(generation, numTasks, 0), std::memory_order_release);
+    m_generation.store(generation);
+    // Either we see the helper going to sleep here, or the helper sees the
+    // new generation before parking.
+    const int sleepingHelpers = m_sleepingHelpers.exchange(0);
+    if (sleepingHelpers > 0) {
+        m_wakeSemaphore.release(sleepingHelpers);
+    }
+
+    // Help out instead of idling.
+    processTasks(generation);
+
+    // Join: the remaining tasks are in flight on the helpers.
+    int spins = 0;
+    while (m_pendingTasks.load(std::memory_order_acquire) > 0) {
+        if (++spins > kJoinSpinCount) {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+void ChannelProcessingPool::processTasks(std::uint32_t generation) {
+    std::uint64_t state = m_state.load(std::memory_order_acquire);
+    while (true) {
+        if (stateGeneration(state) != generation) {
+            return;
+        }
+        const int numTasks = stateNumTasks(state);
+        const int taskIndex = stateNextTask(state);
+        if (taskIndex >= numTasks) {
+            return;
+        }
+        if (!m_state.compare_exchange_weak(state,
+                    packState(generation, numTasks, taskIndex + 1),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire)) {
+            continue;
+        }
+        // The task is ours. run() is blocked until we report completion, so
+        // the job description is stable.
+        m_pFunction(m_pContext, taskIndex);
+        m_pendingTasks.fetch_sub(1, std::memory_order_release);
+        state = m_state.load(std::memory_order_acquire);
+    }
+}
+
+void ChannelProcessingPool::helperLoop(int helperIndex, bool pinToCore) {
+#ifdef Q_OS_LINUX
+    if (pinToCore) {
+        // Leave core 0 to the rest of the system. The engine thread itself
+        // is not pinned and may run on any core.
+        const int numCores = QThread::idealThreadCount();
+        if (numCores > 1) {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(1 + (helperIndex % (numCores - 1)), &cpuSet);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+                kLogger.warning() << "Failed to pin engine helper thread" << helperIndex;
+            }
+        }
+    }
+#else
+    Q_UNUSED(helperIndex);
+    Q_UNUSED(pinToCore);
+#endif
+
+    std::uint32_t seenGeneration = m_generation.load();
+    int spins = 0;
+    while (!m_quit.load()) {
+        const std::uint32_t generation = m_generation.load(std::memory_order_acquire);
+        if (generation != seenGeneration) {
+            seenGeneration = generation;
+            spins = 0;
+            processTasks(generation);
+            continue;
+        }
+        if (++spins < kHelperSpinCount) {
+            continue;
+        }
+        spins = 0;
+        m_sleepingHelpers.fetch_add(1);
+        if (m_generation.load() == seenGeneration && !m_quit.load()) {
+            m_wakeSemaphore.acquire();
+        }
+    }
+}
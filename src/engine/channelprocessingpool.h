@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "util/class.h"
+
+/// ChannelProcessingPool is a fork/join helper for the audio callback. It owns
+/// a fixed set of helper threads that are spawned once on construction and
+/// then spin briefly or park on a semaphore between callbacks.
+///
+/// A call to run() hands out task indices to the helpers and to the calling
+/// thread, which participates in the work instead of idling, and returns once
+/// all tasks have completed. No memory is allocated and no mutex is taken on
+/// the calling thread, so it is safe to use from the engine callback.
+class ChannelProcessingPool {
+  public:
+    /// Invoked once for every task index in [0, numTasks).
+    typedef void (*TaskFunction)(void* pContext, int taskIndex);
+
+    /// Tasks are claimed through a packed 16-bit counter.
+    static constexpr int kMaxTasks = 0xFFFF;
+
+    /// Spawns numHelpers threads. If pinToCores is true the helpers are
+    /// bound to distinct cores (currently only supported on Linux).
+    ChannelProcessingPool(int numHelpers, bool pinToCores);
+    ~ChannelProcessingPool();
+
+    int numHelpers() const {
+        return static_cast<int>(m_helpers.size());
+    }
+
+    /// Runs pFunction for every task index and blocks until all of them have
+    /// returned. Must only be called from a single thread at a time.
+    void run(TaskFunction pFunction, void* pContext, int numTasks);
+
+  private:
+    void helperLoop(int helperIndex, bool pinToCore);
+    /// Claims and executes tasks of the given generation until none are left.
+    void processTasks(std::uint32_t generation);
+
+    static constexpr std::uint64_t packState(
+            std::uint32_t generation, int numTasks, int nextTask) {
+        return (static_cast<std::uint64_t>(generation) << 32) |
+                (static_cast<std::uint64_t>(numTasks) << 16) |
+                static_cast<std::uint64_t>(nextTask);
+    }
+
+    std::vector<QThread*> m_helpers;
+
+    // Only written by run() before a new generation is published, and only
+    // read by a thread that has successfully claimed a task of that
+    // generation. run() does not return (and can thus not overwrite them)
+    // before all claimed tasks have completed.
+    TaskFunction m_pFunction;
+    void* m_pContext;
+
+    // generation (32 bit) | number of tasks (16 bit) | next task (16 bit)
+    std::atomic<std::uint64_t> m_state;
+    // Number of tasks of the current generation that have not finished yet.
+    std::atomic<int> m_pendingTasks;
+    // Helpers poll this value for a new generation to be published.
+    std::atomic<std::uint32_t> m_generation;
+    // Number of helpers that are about to park on m_wakeSemaphore. The count
+    // is conservative, spurious wake-ups are harmless.
+    std::atomic<int> m_sleepingHelpers;
+    QSemaphore m_wakeSemaphore;
+    std::atomic<bool> m_quit;
+
+    DISALLOW_COPY_AND_ASSIGN(ChannelProcessingPool);
+};
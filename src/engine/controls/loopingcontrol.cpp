@@ -578,23 +578,44 @@ void LoopingControl::hintReader(gsl::not_null<HintVector*> pHintList) {
             loop_hint.frameCount = Hint::kFrameCountForward;
             pHintList->append(loop_hint);
         }
+    }
+
+    mixxx::BeatsPointer pBeats = m_pBeats;
+    const auto currentPosition = m_currentPosition.getValue();
+    if (!pBeats || !currentPosition.isValid()) {
+        return;
+    }
+    if (!m_bLoopingEnabled) {
         // We anticipate a potential loop being set from its end point
-        mixxx::BeatsPointer pBeats = m_pBeats;
-        if (!pBeats) {
-            return;
-        }
         double beats = m_pCOBeatLoopSize->get();
         bool quantize = m_pQuantizeEnabled->toBool();
-        auto currentPosition = !quantize
-                ? m_currentPosition.getValue()
-                : findQuantizedBeatloopStart(
-                          pBeats, m_currentPosition.getValue(), beats);
-        loop_hint.type = Hint::Type::LoopStart;
-        loop_hint.frame = static_cast<SINT>(
-                pBeats->findNBeatsFromPosition(currentPosition, -beats)
-                        .toLowerFrameBoundary()
-                        .value());
-        loop_hint.frameCount = Hint::kFrameCountForward;
+        auto loopEndPosition = !quantize
+                ? currentPosition
+                : findQuantizedBeatloopStart(pBeats, currentPosition, beats);
+        const auto loopStartPosition =
+                pBeats->findNBeatsFromPosition(loopEndPosition, -beats);
+        if (loopStartPosition.isValid()) {
+            loop_hint.type = Hint::Type::LoopStart;
+            loop_hint.frame = static_cast<SINT>(
+                    loopStartPosition.toLowerFrameBoundary().value());
+            loop_hint.frameCount = Hint::kFrameCountForward;
+            pHintList->append(loop_hint);
+        }
+    }
+
+    // The targets of the beatjump buttons. Inside an active loop the loop
+    // is moved along with the play position by the same number of beats.
+    const double beatJumpSize = m_pCOBeatJumpSize->get();
+    for (const double beats : {beatJumpSize, -beatJumpSize}) {
+        const auto targetPosition = pBeats->findNBeatsFromPosition(currentPosition, beats);
+        if (targetPosition.isValid()) {
+            Hint beatJumpHint;
+            beatJumpHint.type = Hint::Type::BeatJump;
+            beatJumpHint.frame = static_cast<SINT>(
+                    targetPosition.toLowerFrameBoundary().value());
+            beatJumpHint.frameCount = Hint::kFrameCountForward;
+            pHintList->append(beatJumpHint);
+        }
     }
 }
 
@@ -190,23 +190,8 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     // when it gets the intermediate disabling signal.
 
     ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
-    EffectEnableState effectiveChainEnableState = channelStatus.enableState;
-
-    if (fadeout && channelStatus.enableState == EffectEnableState::Enabled) {
-        // This is the last callback before pause
-        // It can start again without further notice
-        // make use the effect is paused
-        effectiveChainEnableState = EffectEnableState::Disabling;
-    }
-
-    // If the channel is fully disabled, do not let intermediate
-    // enabling/disabling signals from the chain's enable switch override
-    // the channel's state.
-    if (effectiveChainEnableState != EffectEnableState::Disabled) {
-        if (m_enableState != EffectEnableState::Enabled) {
-            effectiveChainEnableState = m_enableState;
-        }
-    }
+    const EffectEnableState effectiveChainEnableState =
+            effectiveEnableState(channelStatus, fadeout);
 
     CSAMPLE currentMixKnob = m_dMix;
     CSAMPLE lastCallbackMixKnob = channelStatus.oldMixKnob;
@@ -304,20 +289,64 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     }
 
     channelStatus.oldMixKnob = currentMixKnob;
+    advanceEnableStates(&channelStatus, fadeout);
+
+    return processingOccured;
+}
+
+bool EngineEffectChain::isBypassed(const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) {
+    // The fadeout flag can only turn an enabled state into disabling
+    return effectiveEnableState(
+                   m_chainStatusForChannelMatrix[inputHandle][outputHandle], false) ==
+            EffectEnableState::Disabled;
+}
 
+void EngineEffectChain::skipProcessing(const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle,
+        bool fadeout) {
+    ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    DEBUG_ASSERT(effectiveEnableState(channelStatus, fadeout) == EffectEnableState::Disabled);
+    channelStatus.oldMixKnob = m_dMix;
+    advanceEnableStates(&channelStatus, fadeout);
+}
+
+EffectEnableState EngineEffectChain::effectiveEnableState(
+        const ChannelStatus& channelStatus, bool fadeout) const {
+    EffectEnableState effectiveChainEnableState = channelStatus.enableState;
+
+    if (fadeout && channelStatus.enableState == EffectEnableState::Enabled) {
+        // This is the last callback before pause
+        // It can start again without further notice
+        // make use the effect is paused
+        effectiveChainEnableState = EffectEnableState::Disabling;
+    }
+
+    // If the channel is fully disabled, do not let intermediate
+    // enabling/disabling signals from the chain's enable switch override
+    // the channel's state.
+    if (effectiveChainEnableState != EffectEnableState::Disabled) {
+        if (m_enableState != EffectEnableState::Enabled) {
+            effectiveChainEnableState = m_enableState;
+        }
+    }
+    return effectiveChainEnableState;
+}
+
+void EngineEffectChain::advanceEnableStates(ChannelStatus* pChannelStatus, bool fadeout) {
     // If the EffectProcessors have been sent a signal for the intermediate
     // enabling/disabling state, set the channel state or chain state
     // to the fully enabled/disabled state for the next engine callback.
 
-    if (channelStatus.enableState == EffectEnableState::Disabling) {
-        channelStatus.enableState = EffectEnableState::Disabled;
-    } else if (channelStatus.enableState == EffectEnableState::Enabling) {
-        channelStatus.enableState = EffectEnableState::Enabled;
+    if (pChannelStatus->enableState == EffectEnableState::Disabling) {
+        pChannelStatus->enableState = EffectEnableState::Disabled;
+    } else if (pChannelStatus->enableState == EffectEnableState::Enabling) {
+        pChannelStatus->enableState = EffectEnableState::Enabled;
     }
 
-    if (fadeout && channelStatus.enableState == EffectEnableState::Enabled) {
+    if (fadeout && pChannelStatus->enableState == EffectEnableState::Enabled) {
         // Effect is paused now, ramp up next callback which may happen later
-        channelStatus.enableState = EffectEnableState::Enabling;
+        pChannelStatus->enableState = EffectEnableState::Enabling;
     }
 
     if (m_enableState == EffectEnableState::Disabling) {
@@ -325,6 +354,4 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     } else if (m_enableState == EffectEnableState::Enabling) {
         m_enableState = EffectEnableState::Enabled;
     }
-
-    return processingOccured;
 }
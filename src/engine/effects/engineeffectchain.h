@@ -45,6 +45,20 @@ class EngineEffectChain final : public EffectsRequestHandler {
             const GroupFeatureState& groupFeatures,
             bool fadeout);
 
+    /// called from audio thread
+    /// Returns true if process() would neither process nor modify any
+    /// buffer for the input channel routed to the output, because the chain
+    /// or the input channel is disabled.
+    bool isBypassed(const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle);
+
+    /// called from audio thread
+    /// Replaces the process() call for a bypassed input channel and only
+    /// updates the states like process() would do.
+    void skipProcessing(const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle,
+            bool fadeout);
+
   private:
     struct ChannelStatus {
         ChannelStatus()
@@ -59,6 +73,10 @@ class EngineEffectChain final : public EffectsRequestHandler {
         return QString("EngineEffectChain(%1)").arg(m_group);
     }
 
+    EffectEnableState effectiveEnableState(
+            const ChannelStatus& channelStatus, bool fadeout) const;
+    void advanceEnableStates(ChannelStatus* pChannelStatus, bool fadeout);
+
     bool updateParameters(const EffectsRequest& message);
     bool addEffect(EngineEffect* pEffect, int iIndex);
     bool removeEffect(EngineEffect* pEffect, int iIndex);
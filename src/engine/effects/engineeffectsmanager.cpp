@@ -157,6 +157,32 @@ void EngineEffectsManager::processPostFaderAndMix(
             fadeout);
 }
 
+bool EngineEffectsManager::isPostFaderBypassed(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) {
+    const QList<EngineEffectChain*>& chains =
+            m_chainsByStage.value(SignalProcessingStage::Postfader);
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain && !pChain->isBypassed(inputHandle, outputHandle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void EngineEffectsManager::skipPostFader(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle,
+        bool fadeout) {
+    const QList<EngineEffectChain*>& chains =
+            m_chainsByStage.value(SignalProcessingStage::Postfader);
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain) {
+            pChain->skipProcessing(inputHandle, outputHandle, fadeout);
+        }
+    }
+}
+
 void EngineEffectsManager::processInner(
         const SignalProcessingStage stage,
         const ChannelHandle& inputHandle,
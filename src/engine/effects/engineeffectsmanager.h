@@ -64,6 +64,21 @@ class EngineEffectsManager final : public EffectsRequestHandler {
             CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE,
             bool fadeout = false);
 
+    /// Returns true if none of the postfader EngineEffectChains processes the
+    /// input channel routed to the output. The caller can then mix the input
+    /// buffer with its gain by itself, but must call skipPostFader() instead
+    /// of processPostFaderAndMix().
+    bool isPostFaderBypassed(
+            const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle);
+
+    /// Updates the states of the postfader EngineEffectChains like
+    /// processPostFaderAndMix() does for a bypassed input channel.
+    void skipPostFader(
+            const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle,
+            bool fadeout = false);
+
     bool processEffectsRequest(
             EffectsRequest& message,
             EffectsResponsePipe* pResponsePipe) override;
@@ -52,6 +52,10 @@ constexpr int kPlaypositionUpdateRate = 15; // updates per second
 
 const QString kAppGroup = QStringLiteral("[App]");
 
+// Tracks of sampler and preview decks up to this duration are decoded
+// completely when loaded, see CachingReader::setMaxDecodedTrackDuration()
+constexpr int kDefaultMaxDecodedTrackSeconds = 20;
+
 } // anonymous namespace
 
 EngineBuffer::EngineBuffer(const QString& group,
@@ -85,6 +89,7 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_pRepeat(nullptr),
           m_startButton(nullptr),
           m_endButton(nullptr),
+          m_scaleStage(EngineProfiler::registerStage(group + QStringLiteral(" scale"))),
           m_bScalerOverride(false),
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
@@ -104,6 +109,12 @@ EngineBuffer::EngineBuffer(const QString& group,
     SampleUtil::clear(m_pCrossfadeBuffer, kMaxEngineFrames * mixxx::kMaxEngineChannelInputCount);
 
     m_pReader = new CachingReader(group, pConfig, maxSupportedChannel);
+    if (pConfig && pChannel && !pChannel->isPrimaryDeck()) {
+        m_pReader->setMaxDecodedTrackDuration(pConfig->getValue(
+                ConfigKey(QStringLiteral("[Sampler]"),
+                        QStringLiteral("DecodeInMemoryMaxSeconds")),
+                kDefaultMaxDecodedTrackSeconds));
+    }
     connect(m_pReader, &CachingReader::trackLoading,
             this, &EngineBuffer::slotTrackLoading,
             Qt::DirectConnection);
@@ -875,7 +886,9 @@ void EngineBuffer::processTrackLocked(
     }
 
     // Sync requests can affect rate, so process those first.
-    processSyncRequests();
+    if (!m_bSyncRequestsDeferred) {
+        processSyncRequests();
+    }
 
     // Note: play is also active during cue preview
     bool paused = !m_playButton->toBool();
@@ -1093,8 +1106,13 @@ void EngineBuffer::processTrackLocked(
 
     // If the buffer is not paused, then scale the audio.
     if (!bCurBufferPaused) {
-        // Perform scaling of Reader buffer into buffer.
-        const double framesRead = m_pScale->scaleBuffer(pOutput, iBufferSize);
+        // Perform scaling of Reader buffer into buffer. Includes the time
+        // spent in CachingReader::read().
+        double framesRead;
+        {
+            ScopedEngineStage stage(m_scaleStage);
+            framesRead = m_pScale->scaleBuffer(pOutput, iBufferSize);
+        }
 
         // TODO(XXX): The result framesRead might not be an integer value.
         // Converting to samples here does not make sense. All positional
@@ -1287,6 +1305,11 @@ void EngineBuffer::processSlip(int iBufferSize) {
     }
 }
 
+bool EngineBuffer::hasQueuedSyncRequests() const {
+    return atomicLoadAcquire(m_iEnableSyncQueued) != SYNC_REQUEST_NONE ||
+            atomicLoadAcquire(m_iSyncModeQueued) != static_cast<int>(SyncMode::Invalid);
+}
+
 void EngineBuffer::processSyncRequests() {
     SyncRequestQueued enable_request =
             static_cast<SyncRequestQueued>(
@@ -1536,7 +1559,7 @@ void EngineBuffer::hintReader(const double dRate) {
     for (const auto& pControl : std::as_const(m_engineControls)) {
         pControl->hintReader(&m_hintList);
     }
-    m_pReader->hintAndMaybeWake(m_hintList);
+    m_pReader->hintAndMaybeWake(m_hintList, dRate);
 }
 
 // WARNING: This method runs in the GUI thread
@@ -11,6 +11,7 @@
 #include "control/controlvalue.h"
 #include "engine/cachingreader/cachingreader.h"
 #include "engine/engineobject.h"
+#include "engine/engineprofiler.h"
 #include "engine/slipmodestate.h"
 #include "engine/sync/syncable.h"
 #include "preferences/usersettings.h"
@@ -134,6 +135,14 @@ class EngineBuffer : public EngineObject {
     void requestSyncPhase();
     void requestEnableSync(bool enabled);
     void requestSyncMode(SyncMode mode);
+    /// Checks if a sync request has been queued but not yet processed.
+    bool hasQueuedSyncRequests() const;
+    /// While deferred, process() leaves the queued sync requests for a
+    /// later callback. EngineSync is not thread-safe, so sync requests must
+    /// not be processed while the channels are processed in parallel.
+    void setSyncRequestsDeferred(bool deferred) {
+        m_bSyncRequestsDeferred = deferred;
+    }
 
     // The process methods all run in the audio callback.
     void process(CSAMPLE* pOut, const int iBufferSize) override;
@@ -420,6 +429,7 @@ class EngineBuffer : public EngineObject {
     // Object used to perform waveform scaling (sample rate conversion).  These
     // three pointers may be reassigned depending on configuration and tests.
     EngineBufferScale* m_pScale;
+    const EngineProfiler::StageId m_scaleStage;
     FRIEND_TEST(EngineBufferTest, SlowRubberBand);
     FRIEND_TEST(EngineBufferTest, ResetPitchAdjustUsesLinear);
     FRIEND_TEST(EngineBufferTest, VinylScalerRampZero);
@@ -447,6 +457,9 @@ class EngineBuffer : public EngineObject {
     QAtomicInt m_iSeekPhaseQueued;
     QAtomicInt m_iEnableSyncQueued;
     QAtomicInt m_iSyncModeQueued;
+    // Only accessed by the engine thread before and after the parallel
+    // processing of the channels.
+    bool m_bSyncRequestsDeferred = false;
     ControlValueAtomic<QueuedSeek> m_queuedSeek;
     bool m_previousBufferSeek = false;
 
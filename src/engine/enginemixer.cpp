@@ -1,11 +1,14 @@
 #include "engine/enginemixer.h"
 
+#include <algorithm>
+
 #include "audio/types.h"
 #include "control/controlaudiotaperpot.h"
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
 #include "engine/channelmixer.h"
+#include "engine/channelprocessingpool.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
@@ -21,11 +24,23 @@
 #include "preferences/usersettings.h"
 #include "util/defs.h"
 #include "util/sample.h"
+#include "util/timer.h"
 
 namespace {
 const QString kAppGroup = QStringLiteral("[App]");
 const QString kLegacyGroup = QStringLiteral("[Master]");
 const QString kMainGroup = QStringLiteral("[Main]");
+
+// Upper bound for the number of engine helper threads when the count is not
+// configured explicitly.
+constexpr int kMaxDefaultChannelProcessingHelpers = 7;
+
+int defaultChannelProcessingHelpers() {
+    // The engine thread itself processes channels too.
+    return std::clamp(QThread::idealThreadCount() - 1,
+            0,
+            kMaxDefaultChannelProcessingHelpers);
+}
 } // namespace
 
 EngineMixer::EngineMixer(
@@ -42,6 +57,10 @@ EngineMixer::EngineMixer(
           m_headphoneGainOld(1.0),
           m_balleftOld(1.0),
           m_balrightOld(1.0),
+          m_parallelChannelsStartIndex(0),
+          m_parallelBufferSize(0),
+          m_sidechainStage(EngineProfiler::registerStage(
+                  QStringLiteral("EngineSideChain::writeSamples"))),
           m_numMicsConfigured(0),
           m_mainHandle(registerChannelGroup(group)),
           m_headphoneHandle(registerChannelGroup("[Headphone]")),
@@ -187,6 +206,32 @@ EngineMixer::EngineMixer(
             pConfig->getValue(ConfigKey(group, "keylock_engine"),
                     EngineBuffer::defaultKeylockEngine())));
 
+    // Parallel processing of the channels that do not depend on each other.
+    // The helper threads are only spawned if the feature is enabled on
+    // startup, afterwards the control allows switching back and forth
+    // between serial and parallel processing for comparison.
+    m_pParallelChannelProcessing = new ControlObject(
+            ConfigKey(kAppGroup, QStringLiteral("parallel_channel_processing")),
+            true,
+            false,
+            true); // persist = true
+    if (m_pParallelChannelProcessing->toBool()) {
+        const int numHelpers = pConfig->getValue(
+                ConfigKey(kAppGroup, QStringLiteral("parallel_channel_processing_threads")),
+                defaultChannelProcessingHelpers());
+        const bool pinToCores = pConfig->getValue(
+                ConfigKey(kAppGroup, QStringLiteral("parallel_channel_processing_pinned")),
+                true);
+        if (numHelpers > 0) {
+            m_pChannelProcessingPool = std::make_unique<ChannelProcessingPool>(
+                    numHelpers, pinToCores);
+        }
+    }
+
+    // Collects the timing of the engine stages recorded on the audio thread
+    m_pEngineProfiler = std::make_unique<EngineProfiler>();
+    m_pEngineProfiler->start(QThread::LowPriority);
+
     // TODO: Make this read only and make EngineMixer decide whether
     // processing the main mix is necessary.
     m_pMainEnabled = new ControlObject(ConfigKey(group, "enabled"),
@@ -210,6 +255,7 @@ EngineMixer::EngineMixer(
 EngineMixer::~EngineMixer() {
     // qDebug() << "in ~EngineMixer()";
     delete m_pKeylockEngine;
+    delete m_pParallelChannelProcessing;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -244,6 +290,9 @@ EngineMixer::~EngineMixer() {
     delete m_pHeadphoneEnabled;
 
     delete m_pWorkerScheduler;
+    // Join the helper threads before the channels are deleted.
+    m_pChannelProcessingPool.reset();
+    m_pEngineProfiler.reset();
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -281,7 +330,12 @@ void EngineMixer::processChannels(int iBufferSize) {
     m_activeTalkoverChannels.clear();
     m_activeChannels.clear();
 
-    // ScopedTimer timer(QStringLiteral("EngineMixer::processChannels"));
+    const bool processInParallel = m_pChannelProcessingPool &&
+            m_pParallelChannelProcessing->toBool();
+    // Only reports in developer mode. Separate keys allow comparing both modes.
+    ScopedTimer timer(processInParallel
+                    ? QStringLiteral("EngineMixer::processChannels parallel")
+                    : QStringLiteral("EngineMixer::processChannels serial"));
     EngineChannel* pLeaderChannel = m_pEngineSync->getLeaderChannel();
     // Reserve the first place for the main channel which
     // should be processed first
@@ -359,18 +413,29 @@ void EngineMixer::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        DEBUG_ASSERT(pChannelInfo->m_pBuffer.size() >= iBufferSize);
-        pChannel->process(pChannelInfo->m_pBuffer.data(), iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+    if (processInParallel && !hasQueuedFollowerSyncRequests()) {
+        // The sync leader has to be processed before all followers, but the
+        // remaining channels do not depend on each other.
+        if (activeChannelsStartIndex == 0) {
+            processChannel(m_activeChannels[0], iBufferSize);
+        }
+        // EngineSync is not thread-safe. Sync requests that are queued
+        // while the followers are processed in parallel are left for the
+        // next callback.
+        setFollowerSyncRequestsDeferred(true);
+        m_parallelChannelsStartIndex = 1;
+        m_parallelBufferSize = iBufferSize;
+        m_pChannelProcessingPool->run(&EngineMixer::processChannelTask,
+                this,
+                m_activeChannels.size() - m_parallelChannelsStartIndex);
+        setFollowerSyncRequestsDeferred(false);
+    } else {
+        // Sync requests, e.g. a leader election, modify the shared state
+        // of EngineSync and are processed serially.
+        for (int i = activeChannelsStartIndex;
+                i < m_activeChannels.size();
+                ++i) {
+            processChannel(m_activeChannels[i], iBufferSize);
         }
     }
 
@@ -399,6 +464,51 @@ void EngineMixer::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMixer::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    DEBUG_ASSERT(pChannelInfo->m_pBuffer.size() >= iBufferSize);
+    {
+        ScopedEngineStage stage(pChannelInfo->m_processStage);
+        pChannel->process(pChannelInfo->m_pBuffer.data(), iBufferSize);
+    }
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
+bool EngineMixer::hasQueuedFollowerSyncRequests() const {
+    // The sync leader at index 0 is always processed serially
+    for (int i = 1; i < m_activeChannels.size(); ++i) {
+        const EngineBuffer* pBuffer = m_activeChannels[i]->m_pChannel->getEngineBuffer();
+        if (pBuffer && pBuffer->hasQueuedSyncRequests()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EngineMixer::setFollowerSyncRequestsDeferred(bool deferred) {
+    for (int i = 1; i < m_activeChannels.size(); ++i) {
+        EngineBuffer* pBuffer = m_activeChannels[i]->m_pChannel->getEngineBuffer();
+        if (pBuffer) {
+            pBuffer->setSyncRequestsDeferred(deferred);
+        }
+    }
+}
+
+// static
+void EngineMixer::processChannelTask(void* pContext, int taskIndex) {
+    auto* pEngineMixer = static_cast<EngineMixer*>(pContext);
+    pEngineMixer->processChannel(
+            pEngineMixer->m_activeChannels[pEngineMixer->m_parallelChannelsStartIndex +
+                    taskIndex],
+            pEngineMixer->m_parallelBufferSize);
+}
+
 void EngineMixer::process(const int iBufferSize) {
     DEBUG_ASSERT(iBufferSize <= static_cast<int>(kMaxEngineSamples));
 
@@ -408,6 +518,11 @@ void EngineMixer::process(const int iBufferSize) {
         haveSetName = true;
     }
     // Trace t("EngineMixer::process");
+    EngineProfiler::beginCallback();
+    PerformanceTimer callbackTimer;
+    if (EngineProfiler::isActive()) {
+        callbackTimer.start();
+    }
 
     bool mainEnabled = m_pMainEnabled->toBool();
     bool boothEnabled = m_pBoothEnabled->toBool();
@@ -754,6 +869,7 @@ void EngineMixer::process(const int iBufferSize) {
         // EngineSideChain::receiveBuffer has copied the input buffer to m_pSidechainMix
         // via before (called by SoundManager::pushInputBuffers())
         if (m_pEngineSideChain) {
+            ScopedEngineStage stage(m_sidechainStage);
             m_pEngineSideChain->writeSamples(m_sidechainMix.data(), iFrames);
         }
 
@@ -819,6 +935,12 @@ void EngineMixer::process(const int iBufferSize) {
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
     m_pWorkerScheduler->runWorkers();
+
+    if (callbackTimer.running()) {
+        EngineProfiler::endCallback(callbackTimer.elapsed(),
+                mixxx::Duration::fromSeconds(
+                        static_cast<double>(iFrames) / m_sampleRate.value()));
+    }
 }
 
 void EngineMixer::applyMainEffects(int bufferSize) {
@@ -881,6 +1003,8 @@ void EngineMixer::addChannel(EngineChannel* pChannel) {
     pChannelInfo->m_pChannel = pChannel;
     const QString& group = pChannel->getGroup();
     pChannelInfo->m_handle = m_pChannelHandleFactory->getOrCreateHandle(group);
+    pChannelInfo->m_processStage = EngineProfiler::registerStage(group + QStringLiteral(" process"));
+    pChannelInfo->m_effectsStage = EngineProfiler::registerStage(group + QStringLiteral(" effects"));
     pChannelInfo->m_pVolumeControl = new ControlAudioTaperPot(
             ConfigKey(group, "volume"), -20, 0, 1);
     pChannelInfo->m_pVolumeControl->setDefaultValue(1.0);
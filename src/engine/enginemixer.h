@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QVarLengthArray>
 #include <atomic>
+#include <memory>
 
 #include "audio/types.h"
 #include "control/controlobject.h"
@@ -11,12 +12,14 @@
 #include "engine/channels/enginechannel.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/engineobject.h"
+#include "engine/engineprofiler.h"
 #include "preferences/usersettings.h"
 #include "recording/recordingmanager.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
 #include "util/samplebuffer.h"
 
+class ChannelProcessingPool;
 class EngineWorkerScheduler;
 class EngineVuMeter;
 class ControlPotmeter;
@@ -110,7 +113,9 @@ class EngineMixer : public QObject, public AudioSource {
                 : m_pChannel(NULL),
                   m_pVolumeControl(NULL),
                   m_pMuteControl(NULL),
-                  m_index(index) {
+                  m_index(index),
+                  m_processStage(EngineProfiler::kInvalidStage),
+                  m_effectsStage(EngineProfiler::kInvalidStage) {
         }
         ChannelHandle m_handle;
         EngineChannel* m_pChannel;
@@ -119,6 +124,8 @@ class EngineMixer : public QObject, public AudioSource {
         ControlPushButton* m_pMuteControl;
         GroupFeatureState m_features;
         int m_index;
+        EngineProfiler::StageId m_processStage;
+        EngineProfiler::StageId m_effectsStage;
     };
 
     struct GainCache {
@@ -257,6 +264,15 @@ class EngineMixer : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    // Processes a single channel and collects its features for effects.
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
+    // ChannelProcessingPool::TaskFunction for m_activeChannels, offset by
+    // m_parallelChannelsStartIndex.
+    static void processChannelTask(void* pContext, int taskIndex);
+    // Checks the active channels after the sync leader for queued sync
+    // requests that need to be processed serially.
+    bool hasQueuedFollowerSyncRequests() const;
+    void setFollowerSyncRequestsDeferred(bool deferred);
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMainEffects(int bufferSize);
@@ -293,6 +309,14 @@ class EngineMixer : public QObject, public AudioSource {
     mixxx::SampleBuffer m_sidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // Helper threads for processing independent channels in parallel. Null
+    // if parallel processing has been disabled in the config.
+    std::unique_ptr<ChannelProcessingPool> m_pChannelProcessingPool;
+    // Only valid during the parallel section of processChannels.
+    int m_parallelChannelsStartIndex;
+    int m_parallelBufferSize;
+    std::unique_ptr<EngineProfiler> m_pEngineProfiler;
+    EngineProfiler::StageId m_sidechainStage;
     EngineSync* m_pEngineSync;
 
     ControlObject* m_pMainGain;
@@ -321,6 +345,7 @@ class EngineMixer : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlObject* m_pParallelChannelProcessing;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
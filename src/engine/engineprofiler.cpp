@@ -0,0 +1,436 @@
+#include "engine/engineprofiler.h"
+
+#include <QHash>
+#include <QStringList>
+#include <algorithm>
+
+#include "control/controlobject.h"
+#include "control/controlpushbutton.h"
+#include "util/assert.h"
+#include "util/cmdlineargs.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("EngineProfiler");
+
+const QString kGroup = QStringLiteral("[EngineProfiler]");
+
+// Enough for several hundred callbacks with all stages of a large setup,
+// i.e. for several collect intervals at the lowest latency.
+constexpr size_t kRingCapacity = 1 << 14;
+// Callbacks can be collected until their samples are aggregated, see collect()
+constexpr int kPendingCallbacks = 1 << 10;
+constexpr unsigned long kCollectIntervalMillis = 50;
+
+struct StageRegistry {
+    QMutex mutex;
+    QStringList names{QStringLiteral("EngineMixer::process")};
+    QHash<QString, EngineProfiler::StageId> ids{{names.first(), EngineProfiler::kCallbackStage}};
+};
+
+StageRegistry& stageRegistry() {
+    static StageRegistry s_registry;
+    return s_registry;
+}
+
+std::atomic<quint64> s_nextGeneration(1);
+
+// The ring of the current thread. The generation detects rings of an
+// EngineProfiler that has been destroyed in the meantime.
+struct ThreadRing {
+    quint64 generation = 0;
+    void* pRing = nullptr;
+};
+thread_local ThreadRing t_threadRing;
+
+// Callback ids wrap around
+bool isBefore(quint32 callback, quint32 otherCallback) {
+    return static_cast<qint32>(callback - otherCallback) < 0;
+}
+
+} // anonymous namespace
+
+// static
+std::atomic<EngineProfiler*> EngineProfiler::s_pInstance(nullptr);
+
+EngineProfiler::EngineProfiler()
+        : m_generation(s_nextGeneration.fetch_add(1)),
+          m_enabled(CmdlineArgs::Instance().getDeveloper()),
+          m_callback(0),
+          m_xrun(false),
+          m_droppedSamples(0),
+          m_stageStats(kMaxStages),
+          m_pendingCallbacks(kPendingCallbacks),
+          m_lastCompletedCallback(0),
+          m_lastCompletedCallbackBefore(0),
+          m_hasCompletedCallback(false),
+          m_hasCompletedCallbackBefore(false),
+          m_xrunCount(0),
+          m_quit(false) {
+    setObjectName("EngineProfiler");
+
+    m_pEnabledControl = std::make_unique<ControlPushButton>(ConfigKey(kGroup, "enabled"));
+    m_pEnabledControl->setButtonMode(ControlPushButton::TOGGLE);
+    m_pEnabledControl->set(m_enabled ? 1.0 : 0.0);
+    connect(m_pEnabledControl.get(),
+            &ControlObject::valueChanged,
+            this,
+            [this](double value) {
+                m_enabled.store(value > 0, std::memory_order_relaxed);
+            },
+            Qt::DirectConnection);
+
+    m_pDumpControl = std::make_unique<ControlPushButton>(ConfigKey(kGroup, "dump"));
+    connect(m_pDumpControl.get(),
+            &ControlObject::valueChanged,
+            this,
+            [this](double value) {
+                if (value > 0) {
+                    dump();
+                }
+            },
+            Qt::DirectConnection);
+
+    m_pResetControl = std::make_unique<ControlPushButton>(ConfigKey(kGroup, "reset"));
+    connect(m_pResetControl.get(),
+            &ControlObject::valueChanged,
+            this,
+            [this](double value) {
+                if (value > 0) {
+                    reset();
+                }
+            },
+            Qt::DirectConnection);
+
+    // The percentiles of the callback duration in microseconds
+    m_pCallbackP50Control = std::make_unique<ControlObject>(ConfigKey(kGroup, "callback_p50"));
+    m_pCallbackP50Control->setReadOnly();
+    m_pCallbackP99Control = std::make_unique<ControlObject>(ConfigKey(kGroup, "callback_p99"));
+    m_pCallbackP99Control->setReadOnly();
+    m_pCallbackP999Control = std::make_unique<ControlObject>(ConfigKey(kGroup, "callback_p999"));
+    m_pCallbackP999Control->setReadOnly();
+    m_pXrunCountControl = std::make_unique<ControlObject>(ConfigKey(kGroup, "xrun_count"));
+    m_pXrunCountControl->setReadOnly();
+    m_pLateCallbackCountControl = std::make_unique<ControlObject>(
+            ConfigKey(kGroup, "late_callback_count"));
+    m_pLateCallbackCountControl->setReadOnly();
+
+    EngineProfiler* pExpected = nullptr;
+    VERIFY_OR_DEBUG_ASSERT(s_pInstance.compare_exchange_strong(pExpected, this)) {
+        kLogger.warning() << "Only the first EngineProfiler records samples";
+    }
+}
+
+EngineProfiler::~EngineProfiler() {
+    EngineProfiler* pExpected = this;
+    s_pInstance.compare_exchange_strong(pExpected, nullptr);
+
+    {
+        const auto locker = lockMutex(&m_quitMutex);
+        m_quit = true;
+        m_quitCondition.wakeAll();
+    }
+    wait();
+
+    if (CmdlineArgs::Instance().getDeveloper()) {
+        collect();
+        dump();
+    }
+}
+
+// static
+EngineProfiler::StageId EngineProfiler::registerStage(const QString& name) {
+    StageRegistry& registry = stageRegistry();
+    const auto locker = lockMutex(&registry.mutex);
+    const auto it = registry.ids.constFind(name);
+    if (it != registry.ids.constEnd()) {
+        return it.value();
+    }
+    VERIFY_OR_DEBUG_ASSERT(registry.names.size() < kMaxStages) {
+        kLogger.warning() << "Too many stages, not profiling" << name;
+        return kInvalidStage;
+    }
+    const StageId stage = static_cast<StageId>(registry.names.size());
+    registry.names.append(name);
+    registry.ids.insert(name, stage);
+    return stage;
+}
+
+// static
+QString EngineProfiler::stageName(StageId stage) {
+    StageRegistry& registry = stageRegistry();
+    const auto locker = lockMutex(&registry.mutex);
+    return registry.names.value(stage);
+}
+
+// static
+void EngineProfiler::push(Sample sample) {
+    EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+    if (!pProfiler || !pProfiler->m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!pProfiler->ringForThread()->try_push(sample)) {
+        // The EngineProfiler thread has fallen behind
+        pProfiler->m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+EngineProfiler::Ring* EngineProfiler::ringForThread() {
+    if (t_threadRing.generation == m_generation) {
+        return static_cast<Ring*>(t_threadRing.pRing);
+    }
+    // First sample of this thread. Threads are only added when the engine
+    // is (re-)started, so the lock and allocation do not hurt.
+    auto pRing = std::make_unique<Ring>(kRingCapacity);
+    t_threadRing.generation = m_generation;
+    t_threadRing.pRing = pRing.get();
+    const auto locker = lockMutex(&m_ringsMutex);
+    m_rings.push_back(std::move(pRing));
+    return static_cast<Ring*>(t_threadRing.pRing);
+}
+
+// static
+void EngineProfiler::record(StageId stage, mixxx::Duration duration) {
+    if (stage == kInvalidStage) {
+        return;
+    }
+    EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+    if (!pProfiler) {
+        return;
+    }
+    push(Sample{pProfiler->m_callback.load(std::memory_order_relaxed),
+            static_cast<qint16>(stage),
+            0,
+            duration.toIntegerNanos()});
+}
+
+// static
+void EngineProfiler::beginCallback() {
+    EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+    if (!pProfiler) {
+        return;
+    }
+    const quint32 lastCallback = pProfiler->m_callback.load(std::memory_order_relaxed);
+    if (pProfiler->m_xrun.exchange(false, std::memory_order_relaxed)) {
+        push(Sample{lastCallback, kCallbackStage, kXrun, -1});
+    }
+    // The channel processing threads are started by the engine thread after
+    // this, so they see the new value.
+    pProfiler->m_callback.store(lastCallback + 1, std::memory_order_relaxed);
+}
+
+// static
+void EngineProfiler::endCallback(mixxx::Duration duration, mixxx::Duration budget) {
+    EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+    if (!pProfiler) {
+        return;
+    }
+    quint16 flags = kEndOfCallback;
+    if (duration > budget) {
+        flags |= kOverrun;
+    }
+    push(Sample{pProfiler->m_callback.load(std::memory_order_relaxed),
+            kCallbackStage,
+            flags,
+            duration.toIntegerNanos()});
+}
+
+// static
+void EngineProfiler::reportXrun() {
+    EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+    if (pProfiler) {
+        pProfiler->m_xrun.store(true, std::memory_order_relaxed);
+    }
+}
+
+void EngineProfiler::setEnabled(bool enabled) {
+    m_pEnabledControl->set(enabled ? 1.0 : 0.0);
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void EngineProfiler::run() {
+    auto locker = lockMutex(&m_quitMutex);
+    while (!m_quit) {
+        m_quitCondition.wait(&m_quitMutex, kCollectIntervalMillis);
+        locker.unlock();
+        collect();
+        locker.relock();
+    }
+}
+
+void EngineProfiler::collect() {
+    const auto locker = lockMutex(&m_collectMutex);
+    std::vector<Ring*> rings;
+    {
+        const auto ringsLocker = lockMutex(&m_ringsMutex);
+        rings.reserve(m_rings.size());
+        for (const auto& pRing : m_rings) {
+            rings.push_back(pRing.get());
+        }
+    }
+    for (Ring* pRing : rings) {
+        while (const Sample* pSample = pRing->front()) {
+            collectSample(*pSample);
+            pRing->pop();
+        }
+    }
+
+    // All samples of a callback have been pushed before the end of the
+    // callback and the xrun flag before the end of the next callback. So
+    // once a later callback had ended before the previous collect(), all
+    // samples of a callback have been collected now, no matter in which order
+    // the rings are drained.
+    if (m_hasCompletedCallbackBefore) {
+        for (auto& pending : m_pendingCallbacks) {
+            if (pending.used && isBefore(pending.callback, m_lastCompletedCallbackBefore)) {
+                aggregateCallback(&pending);
+            }
+        }
+    }
+    m_lastCompletedCallbackBefore = m_lastCompletedCallback;
+    m_hasCompletedCallbackBefore = m_hasCompletedCallback;
+
+    updateControls();
+}
+
+void EngineProfiler::collectSample(const Sample& sample) {
+    PendingCallback& pending = m_pendingCallbacks[sample.callback % kPendingCallbacks];
+    if (!pending.used || pending.callback != sample.callback) {
+        if (pending.used) {
+            // Collecting has fallen far behind, aggregate what we have
+            aggregateCallback(&pending);
+        }
+        pending.used = true;
+        pending.callback = sample.callback;
+        pending.flags = 0;
+    }
+    pending.flags |= sample.flags;
+    if (sample.flags & kEndOfCallback) {
+        if (!m_hasCompletedCallback || isBefore(m_lastCompletedCallback, sample.callback)) {
+            m_lastCompletedCallback = sample.callback;
+            m_hasCompletedCallback = true;
+        }
+    }
+    if (sample.nanos >= 0) {
+        pending.stages.emplace_back(sample.stage, sample.nanos);
+    }
+}
+
+void EngineProfiler::aggregateCallback(PendingCallback* pPending) {
+    // A stage may be processed several times per callback, e.g. the effects
+    // of a channel for each output.
+    std::sort(pPending->stages.begin(), pPending->stages.end());
+    const bool late = pPending->flags & (kOverrun | kXrun);
+    auto it = pPending->stages.cbegin();
+    while (it != pPending->stages.cend()) {
+        const StageId stage = it->first;
+        qint64 nanos = 0;
+        for (; it != pPending->stages.cend() && it->first == stage; ++it) {
+            nanos += it->second;
+        }
+        auto& pStats = m_stageStats[stage];
+        if (!pStats) {
+            pStats = std::make_unique<StageStats>();
+        }
+        pStats->histogram.record(nanos);
+        if (late) {
+            pStats->lateHistogram.record(nanos);
+        }
+    }
+    if (pPending->flags & kXrun) {
+        ++m_xrunCount;
+    }
+    pPending->used = false;
+    pPending->stages.clear();
+}
+
+void EngineProfiler::updateControls() {
+    const auto& pCallbackStats = m_stageStats[kCallbackStage];
+    if (pCallbackStats) {
+        const auto& histogram = pCallbackStats->histogram;
+        m_pCallbackP50Control->forceSet(
+                mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.5))).toDoubleMicros());
+        m_pCallbackP99Control->forceSet(
+                mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.99))).toDoubleMicros());
+        m_pCallbackP999Control->forceSet(
+                mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.999))).toDoubleMicros());
+        m_pLateCallbackCountControl->forceSet(
+                static_cast<double>(pCallbackStats->lateHistogram.count()));
+    } else {
+        m_pCallbackP50Control->forceSet(0);
+        m_pCallbackP99Control->forceSet(0);
+        m_pCallbackP999Control->forceSet(0);
+        m_pLateCallbackCountControl->forceSet(0);
+    }
+    m_pXrunCountControl->forceSet(static_cast<double>(m_xrunCount));
+}
+
+QList<EngineProfiler::StageReport> EngineProfiler::stageReports() {
+    const auto locker = lockMutex(&m_collectMutex);
+    return stageReportsLocked();
+}
+
+QList<EngineProfiler::StageReport> EngineProfiler::stageReportsLocked() const {
+    QList<StageReport> reports;
+    for (StageId stage = 0; stage < kMaxStages; ++stage) {
+        const auto& pStats = m_stageStats[stage];
+        if (!pStats || pStats->histogram.count() == 0) {
+            continue;
+        }
+        const auto& histogram = pStats->histogram;
+        const auto& lateHistogram = pStats->lateHistogram;
+        StageReport report;
+        report.name = stageName(stage);
+        report.callbacks = histogram.count();
+        report.p50 = mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.5)));
+        report.p99 = mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.99)));
+        report.p999 = mixxx::Duration::fromNanos(static_cast<qint64>(histogram.percentile(0.999)));
+        report.max = mixxx::Duration::fromNanos(static_cast<qint64>(histogram.max()));
+        report.mean = mixxx::Duration::fromNanos(static_cast<qint64>(histogram.mean()));
+        report.lateCallbacks = lateHistogram.count();
+        report.lateMean = mixxx::Duration::fromNanos(static_cast<qint64>(lateHistogram.mean()));
+        report.lateMax = mixxx::Duration::fromNanos(static_cast<qint64>(lateHistogram.max()));
+        reports.append(report);
+    }
+    std::stable_sort(reports.begin(),
+            reports.end(),
+            [](const StageReport& lhs, const StageReport& rhs) {
+                return lhs.p99 > rhs.p99;
+            });
+    return reports;
+}
+
+void EngineProfiler::dump() {
+    const auto locker = lockMutex(&m_collectMutex);
+    const QList<StageReport> reports = stageReportsLocked();
+    kLogger.info() << "=====================================";
+    kLogger.info() << "ENGINE PROFILE (time per callback)";
+    kLogger.info() << "=====================================";
+    for (const auto& report : reports) {
+        kLogger.info() << report.name
+                       << "callbacks" << report.callbacks
+                       << "p50" << report.p50.formatMicrosWithUnit()
+                       << "p99" << report.p99.formatMicrosWithUnit()
+                       << "p999" << report.p999.formatMicrosWithUnit()
+                       << "max" << report.max.formatMicrosWithUnit()
+                       << "mean" << report.mean.formatMicrosWithUnit()
+                       << "| late callbacks" << report.lateCallbacks
+                       << "mean" << report.lateMean.formatMicrosWithUnit()
+                       << "max" << report.lateMax.formatMicrosWithUnit();
+    }
+    kLogger.info() << "xruns" << m_xrunCount
+                   << "dropped samples" << m_droppedSamples.load(std::memory_order_relaxed);
+    kLogger.info() << "=====================================";
+}
+
+void EngineProfiler::reset() {
+    const auto locker = lockMutex(&m_collectMutex);
+    for (auto& pStats : m_stageStats) {
+        pStats.reset();
+    }
+    m_xrunCount = 0;
+    m_droppedSamples.store(0, std::memory_order_relaxed);
+    updateControls();
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rigtorp/SPSCQueue.h"
+#include "util/duration.h"
+#include "util/loglinearhistogram.h"
+#include "util/performancetimer.h"
+
+class ControlObject;
+class ControlPushButton;
+
+/// Measures the time spent in named stages of the engine callback, e.g. the
+/// processing of each channel, its effects or the scaler of a deck.
+///
+/// Unlike ScopedTimer, recording a sample is cheap enough for the callback:
+/// Each thread pushes its samples into a wait-free ring of its own. The
+/// EngineProfiler thread collects the samples, groups them by callback and
+/// aggregates the time spent in each stage per callback into histograms.
+/// Callbacks that exceeded their time budget or were followed by an xrun
+/// are aggregated separately, which reveals the stages that blow the budget.
+///
+/// The results are exposed as control objects in the [EngineProfiler] group
+/// and logged when [EngineProfiler],dump is set. Profiling is enabled by
+/// default in developer mode and can be toggled with [EngineProfiler],enabled.
+/// While it is disabled, measuring a stage costs a single atomic load.
+class EngineProfiler : public QThread {
+  public:
+    using StageId = int;
+
+    static constexpr StageId kInvalidStage = -1;
+    /// The complete engine callback, see endCallback()
+    static constexpr StageId kCallbackStage = 0;
+    static constexpr int kMaxStages = 256;
+
+    struct StageReport {
+        QString name;
+        /// Number of callbacks in which the stage has been processed.
+        /// All other values are the time spent in the stage per callback.
+        quint64 callbacks = 0;
+        mixxx::Duration p50;
+        mixxx::Duration p99;
+        mixxx::Duration p999;
+        mixxx::Duration max;
+        mixxx::Duration mean;
+        /// Callbacks that exceeded the budget or were followed by an xrun
+        quint64 lateCallbacks = 0;
+        mixxx::Duration lateMean;
+        mixxx::Duration lateMax;
+    };
+
+    EngineProfiler();
+    ~EngineProfiler() override;
+
+    /// Returns the id of the stage with the given name, which is registered
+    /// on the first call. Not real-time safe, so stages are registered
+    /// up front, e.g. in the constructor of the measured object. Returns
+    /// kInvalidStage if there are already kMaxStages stages.
+    static StageId registerStage(const QString& name);
+    static QString stageName(StageId stage);
+
+    /// Returns true if samples are recorded, i.e. if an EngineProfiler
+    /// exists and is enabled.
+    static bool isActive() {
+        EngineProfiler* pProfiler = s_pInstance.load(std::memory_order_acquire);
+        return pProfiler && pProfiler->m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Records the time spent in a stage during the current callback. This is
+    /// wait-free, except for the first sample of each thread that allocates
+    /// the ring of the thread.
+    static void record(StageId stage, mixxx::Duration duration);
+
+    /// Called by the engine at the start and the end of each callback. The
+    /// budget is the duration of the audio of the callback.
+    static void beginCallback();
+    static void endCallback(mixxx::Duration duration, mixxx::Duration budget);
+    /// Called by the sound devices when an xrun has happened. The xrun is
+    /// accounted to the last completed callback.
+    static void reportXrun();
+
+    void setEnabled(bool enabled);
+
+    /// Aggregates all samples that have been recorded so far. Called
+    /// periodically by the EngineProfiler thread.
+    void collect();
+    /// Returns the stages that have been processed, ordered by their
+    /// 99th percentile from slowest to fastest.
+    QList<StageReport> stageReports();
+    /// Logs the stage reports
+    void dump();
+    /// Discards all aggregated samples
+    void reset();
+
+  protected:
+    void run() override;
+
+  private:
+    enum SampleFlag : quint16 {
+        kEndOfCallback = 1,
+        kOverrun = 2,
+        kXrun = 4,
+    };
+
+    struct Sample {
+        quint32 callback;
+        qint16 stage;
+        quint16 flags;
+        qint64 nanos;
+    };
+    using Ring = rigtorp::SPSCQueue<Sample>;
+
+    struct StageStats {
+        mixxx::LogLinearHistogram histogram;
+        mixxx::LogLinearHistogram lateHistogram;
+    };
+
+    // The samples of a callback that has not been aggregated yet
+    struct PendingCallback {
+        quint32 callback = 0;
+        bool used = false;
+        quint16 flags = 0;
+        std::vector<std::pair<StageId, qint64>> stages;
+    };
+
+    static void push(Sample sample);
+    Ring* ringForThread();
+
+    void collectSample(const Sample& sample);
+    void aggregateCallback(PendingCallback* pPending);
+    void updateControls();
+    QList<StageReport> stageReportsLocked() const;
+
+    static std::atomic<EngineProfiler*> s_pInstance;
+
+    const quint64 m_generation;
+    std::atomic<bool> m_enabled;
+    std::atomic<quint32> m_callback;
+    std::atomic<bool> m_xrun;
+    std::atomic<quint64> m_droppedSamples;
+
+    QMutex m_ringsMutex;
+    std::vector<std::unique_ptr<Ring>> m_rings;
+
+    // Only accessed while holding m_collectMutex
+    QMutex m_collectMutex;
+    std::vector<std::unique_ptr<StageStats>> m_stageStats;
+    std::vector<PendingCallback> m_pendingCallbacks;
+    // The last callback that has been completed, and the one that had been
+    // completed before the current collect()
+    quint32 m_lastCompletedCallback;
+    quint32 m_lastCompletedCallbackBefore;
+    bool m_hasCompletedCallback;
+    bool m_hasCompletedCallbackBefore;
+    quint64 m_xrunCount;
+
+    QMutex m_quitMutex;
+    QWaitCondition m_quitCondition;
+    bool m_quit;
+
+    std::unique_ptr<ControlPushButton> m_pEnabledControl;
+    std::unique_ptr<ControlPushButton> m_pDumpControl;
+    std::unique_ptr<ControlPushButton> m_pResetControl;
+    std::unique_ptr<ControlObject> m_pCallbackP50Control;
+    std::unique_ptr<ControlObject> m_pCallbackP99Control;
+    std::unique_ptr<ControlObject> m_pCallbackP999Control;
+    std::unique_ptr<ControlObject> m_pXrunCountControl;
+    std::unique_ptr<ControlObject> m_pLateCallbackCountControl;
+};
+
+/// Records the time until it goes out of scope for a stage of the engine
+/// callback, see EngineProfiler.
+class ScopedEngineStage {
+  public:
+    explicit ScopedEngineStage(EngineProfiler::StageId stage)
+            : m_stage(stage) {
+        if (EngineProfiler::isActive()) {
+            m_timer.start();
+        }
+    }
+
+    ~ScopedEngineStage() {
+        if (m_timer.running()) {
+            EngineProfiler::record(m_stage, m_timer.elapsed());
+        }
+    }
+
+  private:
+    const EngineProfiler::StageId m_stage;
+    PerformanceTimer m_timer;
+};
@@ -18,7 +18,7 @@ EngineWorkerScheduler::~EngineWorkerScheduler() {
 }
 
 void EngineWorkerScheduler::workerReady() {
-    m_bWakeScheduler = true;
+    m_bWakeScheduler.store(true, std::memory_order_relaxed);
 }
 
 void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
@@ -28,11 +28,12 @@ void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
 }
 
 void EngineWorkerScheduler::runWorkers() {
-    // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
+    // Wake the scheduler if a worker-ready message has been written to the
+    // scheduler. workerReady() might be called concurrently by the helper
+    // threads that process the channels, so the flag is cleared atomically.
+    // runWorkers() is called by the callback thread after the channels have
+    // been processed.
+    if (m_bWakeScheduler.exchange(false, std::memory_order_relaxed)) {
         m_waitCondition.wakeAll();
     }
 }
@@ -3,6 +3,7 @@
 #include <QMutex>
 #include <QThread>
 #include <QWaitCondition>
+#include <atomic>
 
 // The max engine workers that can be expected to run within a callback
 // (e.g. the max that we will schedule). Must be a power of 2.
@@ -25,8 +26,9 @@ class EngineWorkerScheduler : public QThread {
 
   private:
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run. Set by the engine callback and by the helper
+    // threads of the ChannelProcessingPool that process the channels.
+    std::atomic<bool> m_bWakeScheduler;
 
     std::vector<EngineWorker*> m_workers;
 
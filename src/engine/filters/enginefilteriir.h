@@ -10,6 +10,12 @@
 #include "engine/engineobject.h"
 #include "util/sample.h"
 
+#if defined(__SSE2__) && !defined(__EMSCRIPTEN__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 // set to 1 to print some analysis data using qDebug()
 // It prints the resulting delay after 50 % of impulse have passed
 // and the gain and phase shift at some sample frequencies
@@ -32,6 +38,152 @@ class EngineFilterIIRBase : public EngineObjectConstIn {
     virtual void assumeSettled() = 0;
 };
 
+// Two doubles in one SSE2 or NEON register, or a plain array if neither
+// instruction set has been selected with the OPTIMIZE build option.
+struct IIRLanePair {
+#if defined(__SSE2__) && !defined(__EMSCRIPTEN__)
+    __m128d v;
+
+    static IIRLanePair set(double lane0, double lane1) {
+        return IIRLanePair{_mm_set_pd(lane1, lane0)};
+    }
+    static IIRLanePair broadcast(double value) {
+        return IIRLanePair{_mm_set1_pd(value)};
+    }
+    double lane0() const {
+        return _mm_cvtsd_f64(v);
+    }
+    double lane1() const {
+        return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v));
+    }
+    IIRLanePair operator-() const {
+        return IIRLanePair{_mm_sub_pd(_mm_setzero_pd(), v)};
+    }
+    IIRLanePair operator+(IIRLanePair other) const {
+        return IIRLanePair{_mm_add_pd(v, other.v)};
+    }
+    IIRLanePair operator-(IIRLanePair other) const {
+        return IIRLanePair{_mm_sub_pd(v, other.v)};
+    }
+    IIRLanePair operator*(IIRLanePair other) const {
+        return IIRLanePair{_mm_mul_pd(v, other.v)};
+    }
+#elif defined(__aarch64__)
+    float64x2_t v;
+
+    static IIRLanePair set(double lane0, double lane1) {
+        return IIRLanePair{vsetq_lane_f64(lane1, vdupq_n_f64(lane0), 1)};
+    }
+    static IIRLanePair broadcast(double value) {
+        return IIRLanePair{vdupq_n_f64(value)};
+    }
+    double lane0() const {
+        return vgetq_lane_f64(v, 0);
+    }
+    double lane1() const {
+        return vgetq_lane_f64(v, 1);
+    }
+    IIRLanePair operator-() const {
+        return IIRLanePair{vnegq_f64(v)};
+    }
+    IIRLanePair operator+(IIRLanePair other) const {
+        return IIRLanePair{vaddq_f64(v, other.v)};
+    }
+    IIRLanePair operator-(IIRLanePair other) const {
+        return IIRLanePair{vsubq_f64(v, other.v)};
+    }
+    IIRLanePair operator*(IIRLanePair other) const {
+        return IIRLanePair{vmulq_f64(v, other.v)};
+    }
+#else
+    double v[2];
+
+    static IIRLanePair set(double lane0, double lane1) {
+        return IIRLanePair{{lane0, lane1}};
+    }
+    static IIRLanePair broadcast(double value) {
+        return IIRLanePair{{value, value}};
+    }
+    double lane0() const {
+        return v[0];
+    }
+    double lane1() const {
+        return v[1];
+    }
+    IIRLanePair operator-() const {
+        return IIRLanePair{{-v[0], -v[1]}};
+    }
+    IIRLanePair operator+(IIRLanePair other) const {
+        return IIRLanePair{{v[0] + other.v[0], v[1] + other.v[1]}};
+    }
+    IIRLanePair operator-(IIRLanePair other) const {
+        return IIRLanePair{{v[0] - other.v[0], v[1] - other.v[1]}};
+    }
+    IIRLanePair operator*(IIRLanePair other) const {
+        return IIRLanePair{{v[0] * other.v[0], v[1] * other.v[1]}};
+    }
+#endif
+};
+
+// The values of N independent filters with the same structure, e.g. of the
+// left and the right channel, that are processed with one instruction per
+// pair of lanes. The filters stay in double precision, because the poles of
+// the low corner frequencies of the EQs are too close to the unit circle for
+// single precision.
+template<int N>
+struct IIRLanes {
+    static_assert(N % 2 == 0, "IIRLanes are processed in pairs");
+
+    IIRLanePair pairs[N / 2];
+
+    static IIRLanes broadcast(double value) {
+        IIRLanes lanes;
+        for (int i = 0; i < N / 2; ++i) {
+            lanes.pairs[i] = IIRLanePair::broadcast(value);
+        }
+        return lanes;
+    }
+    double lane(int i) const {
+        return i % 2 == 0 ? pairs[i / 2].lane0() : pairs[i / 2].lane1();
+    }
+
+    IIRLanes operator-() const {
+        IIRLanes lanes;
+        for (int i = 0; i < N / 2; ++i) {
+            lanes.pairs[i] = -pairs[i];
+        }
+        return lanes;
+    }
+    IIRLanes& operator+=(const IIRLanes& other) {
+        for (int i = 0; i < N / 2; ++i) {
+            pairs[i] = pairs[i] + other.pairs[i];
+        }
+        return *this;
+    }
+    IIRLanes& operator-=(const IIRLanes& other) {
+        for (int i = 0; i < N / 2; ++i) {
+            pairs[i] = pairs[i] - other.pairs[i];
+        }
+        return *this;
+    }
+    IIRLanes& operator*=(const IIRLanes& other) {
+        for (int i = 0; i < N / 2; ++i) {
+            pairs[i] = pairs[i] * other.pairs[i];
+        }
+        return *this;
+    }
+
+    friend IIRLanes operator+(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs += rhs;
+    }
+    friend IIRLanes operator-(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs -= rhs;
+    }
+    friend IIRLanes operator*(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs *= rhs;
+    }
+};
+
 
 // length of the 3rd argument to fid_design_coef
 #define FIDSPEC_LENGTH 40
@@ -85,11 +237,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     void initBuffers() {
         // Copy the current buffers into the old buffers
-        memcpy(m_oldBuf1, m_buf1, sizeof(m_buf1));
-        memcpy(m_oldBuf2, m_buf2, sizeof(m_buf2));
+        memcpy(m_oldBuf, m_buf, sizeof(m_buf));
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
     }
 
@@ -234,12 +384,51 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput,
                          const int iBufferSize) {
+        // Both channels are processed together in the lanes of one vector
+        Lanes coef[SIZE + 1];
+        broadcastCoefs(coef, m_coef);
         if (!m_doRamping) {
+            // A local copy of the state can be kept in registers
+            Lanes buf[SIZE];
+            memcpy(buf, m_buf, sizeof(buf));
             for (int i = 0; i < iBufferSize; i += 2) {
-                pOutput[i] = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                pOutput[i + 1] = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
+                const Lanes out = processSample(coef, buf, stereoLanes(pIn + i));
+                pOutput[i] = static_cast<CSAMPLE>(out.lane(0));
+                pOutput[i + 1] = static_cast<CSAMPLE>(out.lane(1));
             }
+            memcpy(m_buf, buf, sizeof(buf));
+        } else if (m_doStart) {
+            // The old filter is invalid, fade in from dry or silence
+            double cross_mix = 0.0;
+            double cross_inc = 4.0 / static_cast<double>(iBufferSize);
+            for (int i = 0; i < iBufferSize; i += 2) {
+                double old1 = 0;
+                double old2 = 0;
+                if (m_startFromDry) {
+                    old1 = pIn[i];
+                    old2 = pIn[i + 1];
+                }
+                const Lanes out = processSample(coef, m_buf, stereoLanes(pIn + i));
+                const double new1 = static_cast<CSAMPLE>(out.lane(0));
+                const double new2 = static_cast<CSAMPLE>(out.lane(1));
+                crossfade(pOutput + i, i < iBufferSize / 2, &cross_mix, cross_inc,
+                        old1, old2, new1, new2);
+            }
+            m_doRamping = false;
+            m_doStart = false;
         } else {
+            // The old and the new filter are processed together in four lanes:
+            // old left, old right, new left, new right.
+            RampLanes rampCoef[SIZE + 1];
+            RampLanes rampBuf[SIZE];
+            for (unsigned int j = 0; j < SIZE + 1; ++j) {
+                rampCoef[j].pairs[0] = IIRLanePair::broadcast(m_oldCoef[j]);
+                rampCoef[j].pairs[1] = IIRLanePair::broadcast(m_coef[j]);
+            }
+            for (unsigned int j = 0; j < SIZE; ++j) {
+                rampBuf[j].pairs[0] = m_oldBuf[j].pairs[0];
+                rampBuf[j].pairs[1] = m_buf[j].pairs[0];
+            }
             double cross_mix = 0.0;
             double cross_inc = 4.0 / static_cast<double>(iBufferSize);
             for (int i = 0; i < iBufferSize; i += 2) {
@@ -254,33 +443,22 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                 // of the new filter but it turns out that this produces
                 // a gain drop due to the filter delay which is more
                 // conspicuous than the settling noise.
-                double old1;
-                double old2;
-                if (!m_doStart) {
-                    // Process old filter, but only if we do not do a fresh start
-                    old1 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf1, pIn[i]));
-                    old2 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf2, pIn[i + 1]));
-                } else {
-                    if (m_startFromDry) {
-                        old1 = pIn[i];
-                        old2 = pIn[i + 1];
-                    } else {
-                        old1 = 0;
-                        old2 = 0;
-                    }
-                }
-                double new1 = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                double new2 = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
-
-                if (i < iBufferSize / 2) {
-                    pOutput[i] = static_cast<CSAMPLE>(old1);
-                    pOutput[i + 1] = static_cast<CSAMPLE>(old2);
-                } else {
-                    pOutput[i] = static_cast<CSAMPLE>(new1 * cross_mix + old1 * (1.0 - cross_mix));
-                    pOutput[i + 1] = static_cast<CSAMPLE>(
-                            new2 * cross_mix + old2 * (1.0 - cross_mix));
-                    cross_mix += cross_inc;
-                }
+                const Lanes in = stereoLanes(pIn + i);
+                const RampLanes out = processSample(rampCoef,
+                        rampBuf,
+                        RampLanes{{in.pairs[0], in.pairs[0]}});
+                crossfade(pOutput + i,
+                        i < iBufferSize / 2,
+                        &cross_mix,
+                        cross_inc,
+                        static_cast<CSAMPLE>(out.lane(0)),
+                        static_cast<CSAMPLE>(out.lane(1)),
+                        static_cast<CSAMPLE>(out.lane(2)),
+                        static_cast<CSAMPLE>(out.lane(3)));
+            }
+            for (unsigned int j = 0; j < SIZE; ++j) {
+                m_oldBuf[j].pairs[0] = rampBuf[j].pairs[0];
+                m_buf[j].pairs[0] = rampBuf[j].pairs[1];
             }
             m_doRamping = false;
             m_doStart = false;
@@ -288,11 +466,46 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     }
 
   protected:
-    inline double processSample(double* coef, double* buf, double val);
+    typedef IIRLanes<2> Lanes;
+    typedef IIRLanes<4> RampLanes;
+
+    // Processes one sample of each lane, T is either a scalar double or
+    // IIRLanes with the same coefficients in all lanes or different ones.
+    template<typename T>
+    static inline T processSample(const T* coef, T* buf, T val);
+
+    static inline Lanes stereoLanes(const CSAMPLE* pIn) {
+        return Lanes{{IIRLanePair::set(pIn[0], pIn[1])}};
+    }
+
+    static void broadcastCoefs(Lanes* pLanes, const double* coef) {
+        for (unsigned int j = 0; j < SIZE + 1; ++j) {
+            pLanes[j] = Lanes::broadcast(coef[j]);
+        }
+    }
+
+    static inline void crossfade(CSAMPLE* pOutput,
+            bool firstHalf,
+            double* pCrossMix,
+            double crossInc,
+            double old1,
+            double old2,
+            double new1,
+            double new2) {
+        if (firstHalf) {
+            pOutput[0] = static_cast<CSAMPLE>(old1);
+            pOutput[1] = static_cast<CSAMPLE>(old2);
+        } else {
+            const double crossMix = *pCrossMix;
+            pOutput[0] = static_cast<CSAMPLE>(new1 * crossMix + old1 * (1.0 - crossMix));
+            pOutput[1] = static_cast<CSAMPLE>(new2 * crossMix + old2 * (1.0 - crossMix));
+            *pCrossMix += crossInc;
+        }
+    }
+
     inline void pauseFilterInner() {
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
         m_doStart = true;
     }
@@ -301,15 +514,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     // Old coefficients needed for ramping
     double m_oldCoef[SIZE + 1];
 
-    // Channel 1 state
-    double m_buf1[SIZE];
-    // Old channel 1 buffer needed for ramping
-    double m_oldBuf1[SIZE];
-
-    // Channel 2 state
-    double m_buf2[SIZE];
-    // Old channel 2 buffer needed for ramping
-    double m_oldBuf2[SIZE];
+    // State of both channels
+    Lanes m_buf[SIZE];
+    // Old state of both channels needed for ramping
+    Lanes m_oldBuf[SIZE];
 
     // Flag set to true if ramping needs to be done
     bool m_doRamping;
@@ -320,10 +528,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 };
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -334,10 +542,10 @@ inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_BP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = -tmp;
@@ -348,10 +556,10 @@ inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -362,10 +570,10 @@ inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -381,10 +589,10 @@ inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_BP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -411,10 +619,10 @@ inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir= val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -430,10 +638,10 @@ inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_LP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -460,10 +668,10 @@ inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
-                                                         double* buf,
-                                                         double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<16, IIR_BP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     buf[7] = buf[8]; buf[8] = buf[9]; buf[9] = buf[10]; buf[10] = buf[11];
@@ -512,10 +720,10 @@ inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_HP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -543,10 +751,10 @@ inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
 
 // IIR_LP and IIR_HP use the same processSample routine
 template<>
-inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<5, IIR_BP>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = coef[2] * tmp;
@@ -557,10 +765,10 @@ inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LPMO>::processSample(
+        const T* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= tmp;
@@ -583,10 +791,10 @@ inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HPMO>::processSample(
+        const T* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= -tmp;
@@ -608,10 +816,10 @@ inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP2>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -629,10 +837,10 @@ inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP2>::processSample(
+        const T* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * -coef[0]; // swap gain to be in phase with LP2
     iir -= coef[1] * tmp; fir = -tmp;
@@ -15,6 +15,7 @@ static PgGetSystemTimeFn s_pfpgGetSystemTimeFn = NULL;
 
 #include "broadcast/defs_broadcast.h"
 #include "engine/sidechain/networkinputstreamworker.h"
+#include "util/compatibility/qmutex.h"
 #include "util/fifo.h"
 #include "util/logger.h"
 #include "util/sample.h"
@@ -45,7 +46,9 @@ EngineNetworkStream::EngineNetworkStream(int numOutputChannels,
           m_inputStreamStartTimeUs(-1),
           m_inputStreamFramesWritten(0),
           m_inputStreamFramesRead(0),
-          m_outputWorkers(BROADCAST_MAX_CONNECTIONS) {
+          // Each connection might use a SharedBroadcastEncoder, which is
+          // an output worker, too
+          m_outputWorkers(2 * BROADCAST_MAX_CONNECTIONS) {
     if (numInputChannels) {
         m_pInputFifo = new FIFO<CSAMPLE>(numInputChannels * kBufferFrames);
     }
@@ -179,6 +182,7 @@ qint64 EngineNetworkStream::getNetworkTimeUs() {
 }
 
 void EngineNetworkStream::addOutputWorker(NetworkOutputStreamWorkerPtr pWorker) {
+    const auto locker = lockMutex(&m_outputWorkersMutex);
     if (nextOutputSlotAvailable() < 0) {
         kLogger.warning() << "addWorker: can't add worker:"
                           << "no free slot left in internal list";
@@ -201,6 +205,7 @@ void EngineNetworkStream::addOutputWorker(NetworkOutputStreamWorkerPtr pWorker)
 }
 
 void EngineNetworkStream::removeOutputWorker(NetworkOutputStreamWorkerPtr pWorker) {
+    const auto locker = lockMutex(&m_outputWorkersMutex);
     int index = m_outputWorkers.indexOf(pWorker);
     if(index > -1) {
         m_outputWorkers[index].clear();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QMutex>
 #include <QVector>
 
 #include "engine/sidechain/networkoutputstreamworker.h"
@@ -60,4 +61,8 @@ class EngineNetworkStream {
     // the workers are then performed on thread-safe QSharedPointers and not
     // onto the thread-unsafe QVector
     QVector<NetworkOutputStreamWorkerPtr> m_outputWorkers;
+    // Serializes adding and removing workers, which happens on the GUI
+    // thread for connections and on the connection threads for the
+    // shared encoders
+    QMutex m_outputWorkersMutex;
 };
@@ -0,0 +1,243 @@
+#include "engine/sidechain/sharedbroadcastencoder.h"
+
+#include "audio/types.h"
+#include "engine/sidechain/enginenetworkstream.h"
+#include "moc_sharedbroadcastencoder.cpp"
+#include "util/assert.h"
+#include "util/compatibility/qatomic.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SharedBroadcastEncoder");
+
+QMutex s_encodersMutex;
+QHash<QString, QSharedPointer<SharedBroadcastEncoder>> s_encoders;
+
+QString encoderKey(const EncoderSettings& settings, mixxx::audio::SampleRate sampleRate) {
+    return QStringLiteral("%1/%2/%3/%4")
+            .arg(settings.getFormat(),
+                    QString::number(settings.getQuality()),
+                    QString::number(static_cast<int>(settings.getChannelMode())),
+                    QString::number(sampleRate.value()));
+}
+
+} // namespace
+
+SharedBroadcastEncoder::SharedBroadcastEncoder()
+        : m_numHolders(0),
+          m_threadWaiting(false),
+          m_stop(false) {
+}
+
+SharedBroadcastEncoder::~SharedBroadcastEncoder() {
+    stop();
+}
+
+// static
+QSharedPointer<SharedBroadcastEncoder> SharedBroadcastEncoder::acquire(
+        const QSharedPointer<EngineNetworkStream>& pNetworkStream,
+        const EncoderSettingsPointer& pSettings,
+        mixxx::audio::SampleRate sampleRate,
+        QString* pUserErrorMessage) {
+    VERIFY_OR_DEBUG_ASSERT(pNetworkStream && pSettings) {
+        return nullptr;
+    }
+    const QString key = encoderKey(*pSettings, sampleRate);
+
+    const auto locker = lockMutex(&s_encodersMutex);
+    auto pSharedEncoder = s_encoders.value(key);
+    if (pSharedEncoder) {
+        kLogger.debug() << "Sharing encoder" << key;
+        ++pSharedEncoder->m_numHolders;
+        return pSharedEncoder;
+    }
+
+    pSharedEncoder = QSharedPointer<SharedBroadcastEncoder>::create();
+    EncoderPointer pEncoder = EncoderFactory::getFactory().createEncoder(
+            pSettings, pSharedEncoder.data());
+    if (!pEncoder || pEncoder->initEncoder(sampleRate, pUserErrorMessage) < 0) {
+        return nullptr;
+    }
+    pSharedEncoder->setEncoder(std::move(pEncoder));
+    pSharedEncoder->m_key = key;
+    pSharedEncoder->m_numHolders = 1;
+    s_encoders.insert(key, pSharedEncoder);
+    // Receives the samples in its own FIFO, like a connection
+    pNetworkStream->addOutputWorker(pSharedEncoder);
+    pSharedEncoder->start(QThread::HighPriority);
+    kLogger.debug() << "Created encoder" << key;
+    return pSharedEncoder;
+}
+
+// static
+void SharedBroadcastEncoder::release(
+        const QSharedPointer<EngineNetworkStream>& pNetworkStream,
+        QSharedPointer<SharedBroadcastEncoder>* ppSharedEncoder) {
+    DEBUG_ASSERT(ppSharedEncoder);
+    if (!*ppSharedEncoder) {
+        return;
+    }
+    const auto locker = lockMutex(&s_encodersMutex);
+    SharedBroadcastEncoder* pSharedEncoder = ppSharedEncoder->data();
+    DEBUG_ASSERT(pSharedEncoder->m_numHolders > 0);
+    if (--pSharedEncoder->m_numHolders == 0) {
+        s_encoders.remove(pSharedEncoder->m_key);
+        if (pNetworkStream) {
+            pNetworkStream->removeOutputWorker(*ppSharedEncoder);
+        }
+        pSharedEncoder->stop();
+        kLogger.debug() << "Released encoder" << pSharedEncoder->m_key;
+    }
+    ppSharedEncoder->reset();
+}
+
+void SharedBroadcastEncoder::setEncoder(EncoderPointer pEncoder) {
+    DEBUG_ASSERT(!isRunning());
+    m_pEncoder = std::move(pEncoder);
+}
+
+void SharedBroadcastEncoder::subscribe(EncoderCallback* pSubscriber) {
+    const auto locker = lockMutex(&m_subscribersMutex);
+    if (!m_packetQueues.contains(pSubscriber)) {
+        m_packetQueues.insert(pSubscriber, PacketQueue());
+    }
+}
+
+void SharedBroadcastEncoder::unsubscribe(EncoderCallback* pSubscriber) {
+    const auto locker = lockMutex(&m_subscribersMutex);
+    m_packetQueues.remove(pSubscriber);
+}
+
+void SharedBroadcastEncoder::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    setFunctionCode(6);
+    if (m_pEncoder && iBufferSize > 0) {
+        // The encoded packets are received by the write() callback
+        m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+    }
+}
+
+void SharedBroadcastEncoder::writeEncodedData(EncoderCallback* pSubscriber) {
+    QQueue<QByteArray> packets;
+    {
+        const auto locker = lockMutex(&m_subscribersMutex);
+        auto it = m_packetQueues.find(pSubscriber);
+        if (it == m_packetQueues.end() || it.value().packets.isEmpty()) {
+            return;
+        }
+        packets.swap(it.value().packets);
+        it.value().numBytes = 0;
+    }
+    // Not locked, the network I/O of one subscriber must neither block
+    // the encoder nor the other subscribers
+    for (const auto& packet : std::as_const(packets)) {
+        pSubscriber->write(nullptr,
+                reinterpret_cast<const unsigned char*>(packet.constData()),
+                0,
+                static_cast<int>(packet.size()));
+    }
+}
+
+void SharedBroadcastEncoder::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    QByteArray packet;
+    packet.reserve(headerLen + bodyLen);
+    if (headerLen > 0) {
+        packet.append(reinterpret_cast<const char*>(header), headerLen);
+    }
+    if (bodyLen > 0) {
+        packet.append(reinterpret_cast<const char*>(body), bodyLen);
+    }
+    if (packet.isEmpty()) {
+        return;
+    }
+    const int packetSize = static_cast<int>(packet.size());
+    const auto locker = lockMutex(&m_subscribersMutex);
+    for (auto it = m_packetQueues.begin(); it != m_packetQueues.end(); ++it) {
+        PacketQueue& queue = it.value();
+        int numDroppedBytes = 0;
+        while (!queue.packets.isEmpty() &&
+                queue.numBytes + packetSize > kMaxQueuedBytes) {
+            const int droppedBytes = static_cast<int>(queue.packets.dequeue().size());
+            queue.numBytes -= droppedBytes;
+            numDroppedBytes += droppedBytes;
+        }
+        if (numDroppedBytes > 0) {
+            kLogger.warning() << "Dropping" << numDroppedBytes
+                              << "bytes of encoded data, the connection doesn't keep up";
+        }
+        // Implicitly shared by all queues
+        queue.packets.enqueue(packet);
+        queue.numBytes += packetSize;
+    }
+}
+
+void SharedBroadcastEncoder::outputAvailable() {
+    m_readSema.release();
+}
+
+void SharedBroadcastEncoder::setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) {
+    m_pOutputFifo = pOutputFifo;
+}
+
+QSharedPointer<FIFO<CSAMPLE>> SharedBroadcastEncoder::getOutputFifo() {
+    return m_pOutputFifo;
+}
+
+bool SharedBroadcastEncoder::threadWaiting() {
+    return atomicLoadRelaxed(m_threadWaiting);
+}
+
+void SharedBroadcastEncoder::stop() {
+    m_stop = true;
+    m_readSema.release();
+    wait();
+}
+
+void SharedBroadcastEncoder::run() {
+    QThread::currentThread()->setObjectName(
+            QStringLiteral("SharedBroadcastEncoder '%1'").arg(m_key));
+    VERIFY_OR_DEBUG_ASSERT(m_pOutputFifo) {
+        kLogger.warning() << "run: Broadcast FIFO handle is not available. Aborting";
+        return;
+    }
+    // Discard the samples that have been received before starting
+    if (m_pOutputFifo->readAvailable()) {
+        m_pOutputFifo->flushReadData(m_pOutputFifo->readAvailable());
+    }
+    m_threadWaiting = true;
+    setState(NETWORKSTREAMWORKER_STATE_READY);
+
+    while (!atomicLoadRelaxed(m_stop)) {
+        setFunctionCode(1);
+        incRunCount();
+        if (!m_readSema.tryAcquire(1, 1000)) {
+            continue;
+        }
+
+        const int readAvailable = m_pOutputFifo->readAvailable();
+        if (readAvailable) {
+            setFunctionCode(3);
+            CSAMPLE* dataPtr1;
+            ring_buffer_size_t size1;
+            CSAMPLE* dataPtr2;
+            ring_buffer_size_t size2;
+
+            // We use size1 and size2, so we can ignore the return value
+            (void)m_pOutputFifo->aquireReadRegions(readAvailable, &dataPtr1, &size1,
+                    &dataPtr2, &size2);
+
+            process(dataPtr1, size1);
+            if (size2 > 0) {
+                process(dataPtr2, size2);
+            }
+
+            m_pOutputFifo->releaseReadRegions(readAvailable);
+        }
+    }
+    m_threadWaiting = false;
+    setFunctionCode(2);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThread>
+
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "encoder/encodersettings.h"
+#include "engine/sidechain/networkoutputstreamworker.h"
+#include "util/fifo.h"
+#include "util/types.h"
+
+class EngineNetworkStream;
+
+namespace mixxx {
+namespace audio {
+class SampleRate;
+} // namespace audio
+} // namespace mixxx
+
+/// An encoder that is shared by all broadcast connections with identical
+/// encoder settings, so the main mix is encoded only once.
+///
+/// The encoder is an output worker of EngineNetworkStream with its own
+/// sample FIFO and thread, just like a connection. The samples are encoded
+/// on this thread, independent of the network I/O of the connections. The
+/// encoded packets are queued separately for every subscribed connection
+/// and written to the server by the thread of the connection, so each
+/// connection keeps its own network queue and reconnects independently.
+/// A slow connection only delays its own packets.
+///
+/// Only formats that a listener can join at any frame, like MP3 and AAC
+/// with ADTS framing, must be shared. Ogg streams start with header
+/// packets that are written once by the encoder.
+class SharedBroadcastEncoder
+        : public QThread,
+          public NetworkOutputStreamWorker,
+          public EncoderCallback {
+    Q_OBJECT
+  public:
+    /// The maximum size of the encoded data that is queued for a
+    /// connection. The oldest packets are dropped if the connection
+    /// doesn't keep up, like the network cache of the connection would
+    /// overflow.
+    static constexpr int kMaxQueuedBytes = 1048576;
+
+    SharedBroadcastEncoder();
+    ~SharedBroadcastEncoder() override;
+
+    /// Returns the initialized and running encoder for the settings and
+    /// sample rate, which is shared with all other callers that have not
+    /// released it yet. Returns nullptr if the encoder could not be
+    /// initialized.
+    static QSharedPointer<SharedBroadcastEncoder> acquire(
+            const QSharedPointer<EngineNetworkStream>& pNetworkStream,
+            const EncoderSettingsPointer& pSettings,
+            mixxx::audio::SampleRate sampleRate,
+            QString* pUserErrorMessage);
+    /// Releases and resets an encoder that has been acquired. The encoder
+    /// is removed from the network stream and stopped by the last caller.
+    static void release(
+            const QSharedPointer<EngineNetworkStream>& pNetworkStream,
+            QSharedPointer<SharedBroadcastEncoder>* ppSharedEncoder);
+
+    /// Sets the encoder, which needs to write to this object.
+    void setEncoder(EncoderPointer pEncoder);
+
+    /// Starts queuing the encoded packets for the subscriber.
+    void subscribe(EncoderCallback* pSubscriber);
+    void unsubscribe(EncoderCallback* pSubscriber);
+
+    /// Encodes the samples. Invoked by the thread of the encoder with the
+    /// samples from its FIFO.
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override;
+    void shutdown() override {
+    }
+
+    /// Writes the packets that have been queued for the subscriber to it,
+    /// on the calling thread.
+    void writeEncodedData(EncoderCallback* pSubscriber);
+
+    void outputAvailable() override;
+    void setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) override;
+    QSharedPointer<FIFO<CSAMPLE>> getOutputFifo() override;
+    bool threadWaiting() override;
+    void run() override;
+    /// Stops the thread and waits until it has finished.
+    void stop();
+
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    int tell() override {
+        return -1;
+    }
+    void seek(int pos) override {
+        Q_UNUSED(pos);
+    }
+    int filelen() override {
+        return 0;
+    }
+
+  private:
+    struct PacketQueue {
+        QQueue<QByteArray> packets;
+        int numBytes = 0;
+    };
+
+    // Only accessed by acquire() and release() while holding their lock
+    QString m_key;
+    int m_numHolders;
+
+    QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
+    QSemaphore m_readSema;
+    QAtomicInt m_threadWaiting;
+    QAtomicInt m_stop;
+
+    QMutex m_subscribersMutex;
+    QHash<EncoderCallback*, PacketQueue> m_packetQueues;
+
+    // Only accessed by the thread of the encoder while running. Declared
+    // last, because the encoder might write while it is destroyed.
+    EncoderPointer m_pEncoder;
+};
@@ -43,7 +43,8 @@ const mixxx::Logger kLogger("ShoutConnection");
 } // namespace
 
 ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
-        UserSettingsPointer pConfig)
+        UserSettingsPointer pConfig,
+        const QSharedPointer<EngineNetworkStream>& pNetworkStream)
         : m_pTextCodec(nullptr),
           m_pMetaData(),
           m_pShout(nullptr),
@@ -54,6 +55,7 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_pConfig(pConfig),
           m_pProfile(profile),
           m_encoder(nullptr),
+          m_pNetworkStream(pNetworkStream),
           m_mainSamplerate(QStringLiteral("[App]"), QStringLiteral("samplerate")),
           m_broadcastEnabled(BROADCAST_PREF_KEY, "enabled"),
           m_custom_metadata(false),
@@ -123,6 +125,8 @@ ShoutConnection::~ShoutConnection() {
        qWarning() << "ShoutOutput::~ShoutOutput(): Thread didn't die.\
        Ignored but file a bug report if problems rise!";
     }
+
+    releaseEncoder();
 }
 
 bool ShoutConnection::isConnected() {
@@ -186,7 +190,7 @@ void ShoutConnection::updateFromPreferences() {
     // Delete m_encoder if it has been initialized (with maybe) different bitrate.
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -453,20 +457,33 @@ void ShoutConnection::updateFromPreferences() {
     // Initialize m_encoder
     EncoderSettingsPointer pBroadcastSettings =
             std::make_shared<EncoderBroadcastSettings>(m_pProfile);
-    m_encoder = EncoderFactory::getFactory().createEncoder(
-                    pBroadcastSettings, this);
 
     QString userErrorMsg;
     int ret = -1;
-    if (m_encoder) {
-        ret = m_encoder->initEncoder(mainSamplerate, &userErrorMsg);
+    if (m_format_is_mp3 || m_format_is_aac) {
+        // Listeners can join these streams at any frame, so the encoded
+        // data is shared with all connections with the same settings.
+        m_pSharedEncoder = SharedBroadcastEncoder::acquire(
+                m_pNetworkStream.toStrongRef(),
+                pBroadcastSettings,
+                mainSamplerate,
+                &userErrorMsg);
+        if (m_pSharedEncoder) {
+            ret = 0;
+        }
+    } else {
+        m_encoder = EncoderFactory::getFactory().createEncoder(
+                pBroadcastSettings, this);
+        if (m_encoder) {
+            ret = m_encoder->initEncoder(mainSamplerate, &userErrorMsg);
+        }
     }
 
     // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
     if (ret < 0) {
         // delete m_encoder calls write() make sure it will be exit early
         DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
+        releaseEncoder();
 
         setState(NETWORKSTREAMWORKER_STATE_ERROR);
 
@@ -499,7 +516,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_encoder && !m_pSharedEncoder) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -597,6 +614,10 @@ bool ShoutConnection::processConnect() {
             }
             m_threadWaiting = true;
 
+            if (m_pSharedEncoder) {
+                m_pSharedEncoder->subscribe(this);
+            }
+
             setStatus(BroadcastProfile::STATUS_CONNECTED);
             emit broadcastConnected();
 
@@ -625,7 +646,7 @@ bool ShoutConnection::processConnect() {
     shout_close(m_pShout);
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -650,10 +671,19 @@ bool ShoutConnection::processDisconnect() {
     }
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     return disconnected;
 }
 
+void ShoutConnection::releaseEncoder() {
+    m_encoder.reset();
+    if (m_pSharedEncoder) {
+        m_pSharedEncoder->unsubscribe(this);
+        SharedBroadcastEncoder::release(
+                m_pNetworkStream.toStrongRef(), &m_pSharedEncoder);
+    }
+}
+
 void ShoutConnection::write(const unsigned char* header, const unsigned char* body,
                             int headerLen, int bodyLen) {
     setFunctionCode(7);
@@ -742,12 +772,20 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     // to prevent race conditions when resetting the member
     // pointer while disconnecting in the worker thread!
     const EncoderPointer pEncoder = m_encoder;
+    const QSharedPointer<SharedBroadcastEncoder> pSharedEncoder = m_pSharedEncoder;
 
     // If we are connected, encode the samples.
     if (iBufferSize > 0 && pEncoder) {
         setFunctionCode(6);
         pEncoder->encodeBuffer(pBuffer, iBufferSize);
         // the encoded frames are received by the write() callback.
+    } else if (pSharedEncoder) {
+        setFunctionCode(6);
+        // The samples have already been encoded by the thread of the
+        // shared encoder, which receives them in its own FIFO. Only the
+        // packets that are queued for this connection are written, which
+        // might reconnect and release the encoder.
+        pSharedEncoder->writeEncodedData(this);
     }
 
     // Check if track metadata has changed and if so, update.
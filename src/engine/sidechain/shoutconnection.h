@@ -12,6 +12,7 @@
 #include "control/pollingcontrolproxy.h"
 #include "encoder/encoder.h"
 #include "encoder/encodercallback.h"
+#include "engine/sidechain/sharedbroadcastencoder.h"
 #include "preferences/broadcastprofile.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
@@ -22,13 +23,16 @@
 typedef struct shout shout_t;
 typedef struct _util_dict shout_metadata_t;
 
+class EngineNetworkStream;
 class QTextCodec;
 
 class ShoutConnection
         : public QThread, public EncoderCallback, public NetworkOutputStreamWorker {
     Q_OBJECT
   public:
-    ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig);
+    ShoutConnection(BroadcastProfilePtr profile,
+            UserSettingsPointer pConfig,
+            const QSharedPointer<EngineNetworkStream>& pNetworkStream);
     ~ShoutConnection() override;
 
     // This is called by the Engine implementation for each sample. Encode and
@@ -108,6 +112,7 @@ class ShoutConnection
     bool waitForRetry();
 
     void tryReconnect();
+    void releaseEncoder();
     void insertMetaData(const char *name, const char *value);
 
     QTextCodec* m_pTextCodec;
@@ -120,6 +125,11 @@ class ShoutConnection
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
     EncoderPointer m_encoder;
+    // Used instead of m_encoder for formats that can be shared with other
+    // connections, see SharedBroadcastEncoder
+    QSharedPointer<SharedBroadcastEncoder> m_pSharedEncoder;
+    // The shared encoders are output workers of the network stream
+    const QWeakPointer<EngineNetworkStream> m_pNetworkStream;
     PollingControlProxy m_mainSamplerate;
     PollingControlProxy m_broadcastEnabled;
     // static metadata according to prefereneces
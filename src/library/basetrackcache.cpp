@@ -1,7 +1,12 @@
 #include "library/basetrackcache.h"
 
+#include <QVarLengthArray>
+#include <algorithm>
+#include <bit>
+
 #include "library/queryutil.h"
 #include "library/searchquery.h"
+#include "library/searchquerycompiler.h"
 #include "library/searchqueryparser.h"
 #include "library/trackcollection.h"
 #include "moc_basetrackcache.cpp"
@@ -32,6 +37,12 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
           m_database(pTrackCollection->database()) {
+    std::vector<TrackColumnIndex::ColumnType> columnTypes;
+    columnTypes.reserve(m_columnCount);
+    for (int i = 0; i < m_columnCount; ++i) {
+        columnTypes.push_back(columnTypeForFieldIndex(i));
+    }
+    m_trackIndex.reset(std::move(columnTypes));
 }
 
 BaseTrackCache::~BaseTrackCache() {
@@ -78,7 +89,7 @@ void BaseTrackCache::slotTracksRemoved(const QSet<TrackId>& trackIds) {
         qDebug() << this << "slotTracksRemoved" << trackIds.size();
     }
     for (const auto& trackId : std::as_const(trackIds)) {
-        m_trackInfo.remove(trackId);
+        m_trackIndex.remove(trackId);
         m_dirtyTracks.remove(trackId);
     }
 }
@@ -100,7 +111,7 @@ void BaseTrackCache::slotTrackClean(TrackId trackId) {
 }
 
 bool BaseTrackCache::isCached(TrackId trackId) const {
-    return m_trackInfo.contains(trackId);
+    return m_trackIndex.contains(trackId);
 }
 
 void BaseTrackCache::ensureCached(TrackId trackId) {
@@ -201,13 +212,12 @@ bool BaseTrackCache::updateTrackInIndex(
 
     TrackId trackId = pTrack->getId();
     if (trackId.isValid()) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        // preallocate memory for all columns at once
-        record.resize(numColumns);
+        const int row = m_trackIndex.ensureRow(trackId);
         for (int i = 0; i < numColumns; ++i) {
-            getTrackValueForColumn(pTrack, i, record[i]);
+            // Columns that are not provided by the track keep their value
+            QVariant value = m_trackIndex.value(row, i);
+            getTrackValueForColumn(pTrack, i, value);
+            m_trackIndex.setValue(row, i, std::move(value));
         }
         if (m_bIsCaching) {
             replaceRecentTrack(std::move(trackId), pTrack);
@@ -249,19 +259,15 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     while (query.next()) {
         TrackId trackId(query.value(idColumn));
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        record.resize(numColumns);
-
+        const int row = m_trackIndex.ensureRow(trackId);
         for (int i = 0; i < numColumns; ++i) {
             if (fieldIndex(ColumnCache::COLUMN_TRACKLOCATIONSTABLE_LOCATION) == i) {
                 // Database stores all locations with Qt separators: "/"
                 // Here we want to cache the display string with native separators.
                 QString location = query.value(i).toString();
-                record[i] = QDir::toNativeSeparators(location);
+                m_trackIndex.setValue(row, i, QDir::toNativeSeparators(location));
             } else {
-                record[i] = query.value(i);
+                m_trackIndex.setValue(row, i, query.value(i));
             }
         }
     }
@@ -285,7 +291,7 @@ void BaseTrackCache::buildIndex() {
     // TODO(rryan) for very large tables, it probably makes more sense to NOT
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
-    m_trackInfo.clear();
+    m_trackIndex.clear();
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -428,11 +434,10 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     // TODO(rryan) this code is flawed for columns that contains row-specific
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
-    if (!result.isValid()) {
-        auto it = m_trackInfo.constFind(trackId);
-        if (it != m_trackInfo.constEnd()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+    if (!result.isValid() && column >= 0 && column < m_columnCount) {
+        const int row = m_trackIndex.row(trackId);
+        if (row != TrackColumnIndex::kInvalidRow) {
+            result = m_trackIndex.value(row, column);
         }
     }
     return result;
@@ -454,71 +459,106 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
     // TODO(rryan) consider making this the data passed in and a separate
     // QVector for output
     QSet<TrackId> dirtyTracks;
     for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
 
-    QStringList queryFragments;
-    if (!extraFilter.isNull() && extraFilter != "") {
-        queryFragments << QString("(%1)").arg(extraFilter);
-    }
-    if (idStrings.size() > 0) {
-        queryFragments << QString("%1 in (%2)")
-                .arg(m_idColumn, idStrings.join(","));
-    }
-
+    // The extra filter is added as an SQL node, which prevents filtering
+    // in memory.
     const std::unique_ptr<QueryNode> pQuery =
-            m_pQueryParser->parseQuery(
+            m_pQueryParser->parseQuery(searchQuery, extraFilter);
+
+    // Sorting by cached columns is done in memory using the precomputed
+    // sort ranks of the index instead of letting SQLite sort the results.
+    const bool sortInMemory = !orderByClause.isEmpty() &&
+            canSortInIndex(sortColumns, columnOffset);
+
+    m_trackOrder.resize(0); // keeps allocated memory
+    trackToIndex->clear();
+
+    if ((orderByClause.isEmpty() || sortInMemory) &&
+            filterInIndex(trackIds,
                     searchQuery,
-                    queryFragments.join(" AND "));
+                    *pQuery,
+                    sortInMemory ? sortColumns : QList<SortColumn>(),
+                    columnOffset)) {
+        if (sDebug) {
+            qDebug() << this << "filterAndSort() filtered in memory:"
+                     << m_trackOrder.size();
+        }
+    } else {
+        QStringList idStrings;
+        idStrings.reserve(trackIds.size());
+        for (const auto& trackId : trackIds) {
+            idStrings << trackId.toString();
+        }
 
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
-    }
+        QStringList queryFragments;
+        if (!extraFilter.isNull() && extraFilter != "") {
+            queryFragments << QString("(%1)").arg(extraFilter);
+        }
+        if (idStrings.size() > 0) {
+            queryFragments << QString("%1 in (%2)")
+                    .arg(m_idColumn, idStrings.join(","));
+        }
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
+        const std::unique_ptr<QueryNode> pSqlQuery =
+                m_pQueryParser->parseQuery(
+                        searchQuery,
+                        queryFragments.join(" AND "));
 
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
+        QString filter = pSqlQuery->toSql();
+        if (!filter.isEmpty()) {
+            filter.prepend("WHERE ");
+        }
 
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
+        QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+                                      .arg(m_idColumn,
+                                              m_tableName,
+                                              filter,
+                                              sortInMemory ? QString() : orderByClause);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+        if (sDebug) {
+            qDebug() << this << "select() executing:" << queryString;
+        }
 
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+        QSqlQuery query(m_database);
+        // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+        // won't allocate a giant in-memory table that we won't use at all.
+        query.setForwardOnly(true);
+        query.prepare(queryString);
 
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
-    }
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
 
-    m_trackOrder.resize(0); // keeps allocated memory
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
+        int idColumn = query.record().indexOf(m_idColumn);
+        int rows = query.size();
+
+        if (sDebug) {
+            qDebug() << "Rows returned:" << rows;
+        }
+
+        if (rows > 0) {
+            m_trackOrder.reserve(rows);
+        }
+
+        while (query.next()) {
+            m_trackOrder.append(TrackId(query.value(idColumn)));
+        }
+        if (sortInMemory) {
+            sortInIndex(&m_trackOrder, sortColumns, columnOffset);
+        }
     }
 
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -624,23 +664,37 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
         int mid = min + (max - min) / 2;
         TrackId otherTrackId(trackIds[mid]);
 
+        const int otherRow = m_trackIndex.row(otherTrackId);
         // This should not happen, but it's a recoverable error so we should
         // only log it.
-        if (!m_trackInfo.contains(otherTrackId)) {
+        if (otherRow == TrackColumnIndex::kInvalidRow) {
             qDebug() << "WARNING: track" << otherTrackId << "was not in index";
             //updateTrackInIndex(otherTrackId);
         }
+        // The index might be outdated for dirty tracks, their values need
+        // to be obtained from the track object.
+        const bool compareWithIndex = otherRow != TrackColumnIndex::kInvalidRow &&
+                !m_dirtyTracks.contains(otherTrackId);
 
         int compare = 0;
         for (int i = 0; i < sortColumns.count(); i++) {
-            QVariant tableValue =
-                    data(otherTrackId, sortColumns[i].m_column - columnOffset);
-
-            compare = compareColumnValues(
-                    sortColumns[i].m_column - columnOffset,
-                    sortColumns[i].m_order,
-                    trackValues[i],
-                    tableValue);
+            const int column = sortColumns[i].m_column - columnOffset;
+            if (compareWithIndex && column >= 0 && column < m_columnCount) {
+                compare = m_trackIndex.compareValueWithRow(column,
+                        trackValues[i],
+                        otherRow,
+                        m_columnCache.keyNotation());
+                if (sortColumns[i].m_order == Qt::DescendingOrder) {
+                    compare = -compare;
+                }
+            } else {
+                QVariant tableValue = data(otherTrackId, column);
+                compare = compareColumnValues(
+                        column,
+                        sortColumns[i].m_order,
+                        trackValues[i],
+                        tableValue);
+            }
 
             if (compare != 0) {
                 break;
@@ -667,18 +721,8 @@ int BaseTrackCache::compareColumnValues(int sortColumn,
         const QVariant& val2) const {
     int result = 0;
 
-    if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION)
-    ) {
+    const TrackColumnIndex::ColumnType columnType = columnTypeForFieldIndex(sortColumn);
+    if (columnType == TrackColumnIndex::ColumnType::Numeric) {
         // Sort as floats.
         double delta = val1.toDouble() - val2.toDouble();
 
@@ -689,7 +733,7 @@ int BaseTrackCache::compareColumnValues(int sortColumn,
         } else {
             result = -1;
         }
-    } else if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+    } else if (columnType == TrackColumnIndex::ColumnType::Key) {
         KeyUtils::KeyNotation keyNotation = m_columnCache.keyNotation();
 
         int key1 = KeyUtils::keyToCircleOfFifthsOrder(
@@ -714,3 +758,224 @@ int BaseTrackCache::compareColumnValues(int sortColumn,
 
     return result;
 }
+
+TrackColumnIndex::ColumnType BaseTrackCache::columnTypeForFieldIndex(int column) const {
+    if (column < 0) {
+        return TrackColumnIndex::ColumnType::Text;
+    }
+    if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_PLAYED) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM_LOCK) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COLOR) ||
+            column == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION)) {
+        return TrackColumnIndex::ColumnType::Numeric;
+    }
+    if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+        return TrackColumnIndex::ColumnType::Key;
+    }
+    return TrackColumnIndex::ColumnType::Text;
+}
+
+int BaseTrackCache::searchColumnIndex(const QString& sqlColumn,
+        TrackColumnIndex::ColumnType columnType) const {
+    const int column = fieldIndex(sqlColumn);
+    if (column < 0 || m_trackIndex.columnType(column) != columnType) {
+        return -1;
+    }
+    // These columns are stored as text in the database, but compared or
+    // formatted differently in the index.
+    if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DATETIMEADDED) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_LAST_PLAYED_AT)) {
+        return -1;
+    }
+    return column;
+}
+
+bool BaseTrackCache::filterInIndex(const QSet<TrackId>& trackIds,
+        const QString& searchQuery,
+        const QueryNode& query,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) {
+    // All tracks must be in the index to skip the database
+    for (const auto& trackId : trackIds) {
+        if (!m_trackIndex.contains(trackId)) {
+            return false;
+        }
+    }
+
+    SearchQueryCompiler compiler(m_trackIndex,
+            [this](const QString& sqlColumn, TrackColumnIndex::ColumnType columnType) {
+                return searchColumnIndex(sqlColumn, columnType);
+            });
+    const std::unique_ptr<CompiledSearchQuery> pCompiledQuery = compiler.compile(query);
+    if (!pCompiledQuery) {
+        return false;
+    }
+
+    SearchResult result;
+    result.searchQuery = searchQuery;
+    result.indexRevision = m_trackIndex.revision();
+    result.keyNotation = m_columnCache.keyNotation();
+    for (const auto& sc : sortColumns) {
+        result.sortKey.emplace_back(sc.m_column - columnOffset, sc.m_order);
+    }
+
+    // Look for the same or a less specific search in the recent results.
+    // If there are several ones, the smallest result set is refined.
+    auto baseResult = m_recentSearchResults.end();
+    for (auto it = m_recentSearchResults.begin(); it != m_recentSearchResults.end();) {
+        if (it->indexRevision != result.indexRevision ||
+                it->keyNotation != result.keyNotation) {
+            it = m_recentSearchResults.erase(it);
+            continue;
+        }
+        if (it->searchQuery == searchQuery && it->sortKey == result.sortKey) {
+            baseResult = it;
+            break;
+        }
+        if (m_pQueryParser->queryIsRefinement(it->searchQuery, searchQuery) &&
+                (baseResult == m_recentSearchResults.end() ||
+                        it->rows.size() < baseResult->rows.size())) {
+            baseResult = it;
+        }
+        ++it;
+    }
+
+    if (baseResult == m_recentSearchResults.end()) {
+        const CompiledSearchQuery::Selection selection = pCompiledQuery->evaluate();
+        for (std::size_t word = 0; word < selection.size(); ++word) {
+            std::uint64_t bits = selection[word];
+            while (bits != 0) {
+                result.rows.push_back(static_cast<int>(word) * 64 + std::countr_zero(bits));
+                bits &= bits - 1;
+            }
+        }
+        sortRows(&result.rows, result.sortKey);
+    } else if (baseResult->searchQuery == searchQuery) {
+        // Same search, e.g. after the selection of the sidebar changed
+        result.rows = std::move(baseResult->rows);
+        m_recentSearchResults.erase(baseResult);
+    } else {
+        if (sDebug) {
+            qDebug() << this << "Refining the results of" << baseResult->searchQuery
+                     << "with" << baseResult->rows.size() << "rows";
+        }
+        // Filtering keeps the order of the rows
+        result.rows = pCompiledQuery->filterRows(baseResult->rows);
+        if (baseResult->sortKey != result.sortKey) {
+            // Ties must end up in the same order as for a full evaluation
+            std::sort(result.rows.begin(), result.rows.end());
+            sortRows(&result.rows, result.sortKey);
+        }
+    }
+
+    m_trackOrder.reserve(static_cast<int>(std::min(
+            result.rows.size(), static_cast<std::size_t>(trackIds.size()))));
+    for (const int row : result.rows) {
+        const TrackId trackId = m_trackIndex.trackId(row);
+        if (trackIds.contains(trackId)) {
+            m_trackOrder.append(trackId);
+        }
+    }
+
+    m_recentSearchResults.push_front(std::move(result));
+    while (static_cast<int>(m_recentSearchResults.size()) > kMaxRecentSearchResults) {
+        m_recentSearchResults.pop_back();
+    }
+    return true;
+}
+
+void BaseTrackCache::slotCratesChanged() {
+    // The results of searches that include crates are outdated
+    m_recentSearchResults.clear();
+}
+
+bool BaseTrackCache::canSortInIndex(const QList<SortColumn>& sortColumns,
+        const int columnOffset) const {
+    if (sortColumns.isEmpty()) {
+        return false;
+    }
+    for (const auto& sc : sortColumns) {
+        const int column = sc.m_column - columnOffset;
+        // Column 0 is the id column, which is either sorted by SQL or
+        // stands for a virtual column of the table model.
+        if (column <= 0 || column >= m_columnCount) {
+            return false;
+        }
+        // These columns are stored as text in the database and sorted
+        // by SQL, i.e. the year case-insensitively as text and the track
+        // number with CAST semantics. Values like "2019-03-15" or "3/12"
+        // would not be ordered the same way by their numeric value.
+        if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
+                column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BaseTrackCache::sortInIndex(QVector<TrackId>* pTrackIds,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) const {
+    SortKey sortKey;
+    for (const auto& sc : sortColumns) {
+        sortKey.emplace_back(sc.m_column - columnOffset, sc.m_order);
+    }
+    std::vector<int> rows;
+    rows.reserve(pTrackIds->size());
+    QVector<TrackId> missingTrackIds;
+    for (const auto& trackId : std::as_const(*pTrackIds)) {
+        const int row = m_trackIndex.row(trackId);
+        if (row == TrackColumnIndex::kInvalidRow) {
+            missingTrackIds.append(trackId);
+        } else {
+            rows.push_back(row);
+        }
+    }
+    sortRows(&rows, sortKey);
+    int i = 0;
+    for (const int row : rows) {
+        (*pTrackIds)[i++] = m_trackIndex.trackId(row);
+    }
+    for (const auto& trackId : std::as_const(missingTrackIds)) {
+        (*pTrackIds)[i++] = trackId;
+    }
+}
+
+void BaseTrackCache::sortRows(std::vector<int>* pRows, const SortKey& sortKey) const {
+    if (sortKey.empty()) {
+        return;
+    }
+    const KeyUtils::KeyNotation keyNotation = m_columnCache.keyNotation();
+    // Resolve the sort ranks once upfront
+    QVarLengthArray<const std::vector<int>*, 4> sortRanks;
+    for (const auto& [column, order] : sortKey) {
+        sortRanks.append(&m_trackIndex.sortRanks(column, keyNotation));
+    }
+    std::stable_sort(pRows->begin(),
+            pRows->end(),
+            [&](int lhs, int rhs) {
+                for (int i = 0; i < sortRanks.size(); ++i) {
+                    const int rank1 = (*sortRanks[i])[lhs];
+                    const int rank2 = (*sortRanks[i])[rhs];
+                    if (rank1 != rank2) {
+                        return sortKey[i].second == Qt::AscendingOrder
+                                ? rank1 < rank2
+                                : rank1 > rank2;
+                    }
+                }
+                return false;
+            });
+}
@@ -8,14 +8,19 @@
 #include <QString>
 #include <QStringList>
 #include <QVector>
+#include <list>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "library/columncache.h"
+#include "library/trackcolumnindex.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/class.h"
 #include "util/string.h"
 
+class QueryNode;
 class SearchQueryParser;
 class TrackCollection;
 
@@ -85,6 +90,7 @@ class BaseTrackCache : public QObject {
     void slotTracksRemoved(const QSet<TrackId>& trackId);
     void slotTrackDirty(TrackId trackId);
     void slotTrackClean(TrackId trackId);
+    void slotCratesChanged();
 
   private:
     const TrackPointer& getRecentTrack(TrackId trackId) const;
@@ -107,6 +113,32 @@ class BaseTrackCache : public QObject {
             Qt::SortOrder sortOrder,
             const QVariant& val1,
             const QVariant& val2) const;
+    TrackColumnIndex::ColumnType columnTypeForFieldIndex(int column) const;
+    // Returns the column of the index that may be searched in memory
+    // instead of using SQL, or -1.
+    int searchColumnIndex(const QString& sqlColumn,
+            TrackColumnIndex::ColumnType columnType) const;
+    // Evaluates the query on the index and fills m_trackOrder with the
+    // matching tracks, sorted by the given columns. Returns false if the
+    // query needs to be evaluated with SQL instead.
+    bool filterInIndex(const QSet<TrackId>& trackIds,
+            const QString& searchQuery,
+            const QueryNode& query,
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset);
+    // Returns true if all sort columns are cached by this BaseTrackCache
+    // and can thus be sorted in memory.
+    bool canSortInIndex(const QList<SortColumn>& sortColumns,
+            const int columnOffset) const;
+    // Columns of the index and their sort order
+    typedef std::vector<std::pair<int, Qt::SortOrder>> SortKey;
+    // Stable sort of the track ids by the given sort columns. Tracks that
+    // are not in the index are moved to the end.
+    void sortInIndex(QVector<TrackId>* pTrackIds,
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset) const;
+    // Stable sort of rows of the index
+    void sortRows(std::vector<int>* pRows, const SortKey& sortKey) const;
     bool trackMatches(const TrackPointer& pTrack,
             const QRegularExpression& matcher) const;
     bool trackMatchesNumeric(const TrackPointer& pTrack,
@@ -130,6 +162,21 @@ class BaseTrackCache : public QObject {
 
     QVector<TrackId> m_trackOrder;
 
+    // The matching rows of the whole index for a recent search, which
+    // allows to only filter these rows again when the search is refined
+    // while typing.
+    struct SearchResult {
+        QString searchQuery;
+        quint64 indexRevision;
+        KeyUtils::KeyNotation keyNotation;
+        SortKey sortKey;
+        // Sorted by sortKey
+        std::vector<int> rows;
+    };
+    static constexpr int kMaxRecentSearchResults = 8;
+    // Most recent first
+    std::list<SearchResult> m_recentSearchResults;
+
     // Remember key and value of the most recent cache lookup to avoid querying
     // the global track cache again and again while populating the columns
     // of a single row. These members serve as a single-valued private cache.
@@ -144,7 +191,7 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<TrackId, QVector<QVariant>> m_trackInfo;
+    TrackColumnIndex m_trackIndex;
     QSqlDatabase m_database;
 
     DISALLOW_COPY_AND_ASSIGN(BaseTrackCache);
@@ -312,7 +312,7 @@ bool BrowseTableModel::isColumnHiddenByDefault(int column) {
     return false;
 }
 
-void BrowseTableModel::moveTrack(const QModelIndex&, const QModelIndex&) {
+void BrowseTableModel::moveTracks(const QModelIndexList&, const QModelIndex&) {
 }
 
 void BrowseTableModel::copyTracks(const QModelIndexList& indices) const {
@@ -70,7 +70,7 @@ class BrowseTableModel final : public QStandardItemModel, public virtual TrackMo
     QMimeData* mimeData(const QModelIndexList &indexes) const override;
     const QString currentSearch() const override;
     bool isColumnInternal(int) override;
-    void moveTrack(const QModelIndex&, const QModelIndex&) override;
+    void moveTracks(const QModelIndexList&, const QModelIndex&) override;
     void copyTracks(const QModelIndexList& indices) const override;
     bool isLocked() override { return false; }
     bool isColumnHiddenByDefault(int column) override;
@@ -2,14 +2,25 @@
 
 #include <QSqlQuery>
 #include <QtDebug>
+#include <algorithm>
 
 #include "library/queryutil.h"
 #include "preferences/waveformsettings.h"
+#include "util/compatibility/qmutex.h"
 #include "util/performancetimer.h"
 #include "waveform/waveform.h"
 
 const QString AnalysisDao::s_analysisTableName = "track_analysis";
 
+namespace {
+
+// Files that could not be deleted yet, because a Waveform still maps them.
+// Shared by all instances, e.g. those of the analyzer threads.
+QMutex s_undeletedFilesMutex;
+QStringList s_undeletedFiles;
+
+} // namespace
+
 // For a track that takes 1.2MB to store the big waveform, the default
 // compression level (-1) takes the size down to about 600KB. The difference
 // between the default and 9 (the max) was only about 1-2KB for a lot of extra
@@ -83,21 +94,23 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         int checksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
-        const QByteArray compressedData = loadDataFromFile(dataPath);
+        // Only the header is loaded and checked for flat files
+        const QByteArray storedData = loadDataFromFile(dataPath, &info.flat);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
         const int file_checksum = qChecksum(
-                compressedData);
+                storedData);
 #else
         const int file_checksum = qChecksum(
-                compressedData.constData(),
-                compressedData.length());
+                storedData.constData(),
+                storedData.length());
 #endif
         if (checksum != file_checksum) {
             qDebug() << "WARNING: Corrupt analysis loaded from" << dataPath
-                     << "length" << compressedData.length();
+                     << "length" << storedData.length();
             continue;
         }
-        info.data = qUncompress(compressedData);
+        info.dataPath = dataPath;
+        info.data = info.flat ? storedData : qUncompress(storedData);
         bytes += info.data.length();
         analyses.append(info);
     }
@@ -119,72 +132,93 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     PerformanceTimer time;
     time.start();
 
-    const QByteArray compressedData = qCompress(info->data, kCompressionLevel);
+    // Flat data is stored as is and only its header is checksummed. The
+    // header contains the checksum of the data, which is verified when
+    // mapping the file, see Waveform::mapFlatFile().
+    const QByteArray storedData = info->flat
+            ? info->data
+            : qCompress(info->data, kCompressionLevel);
+    const QByteArray checksummedData = info->flat
+            ? storedData.left(Waveform::kFlatHeaderSize)
+            : storedData;
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     const int checksum = qChecksum(
-            compressedData);
+            checksummedData);
 #else
     const int checksum = qChecksum(
-            compressedData.constData(),
-            compressedData.length());
+            checksummedData.constData(),
+            checksummedData.length());
 #endif
+    // The file of an existing analysis is never replaced, because it might
+    // be mapped by a Waveform. Mapped files can neither be replaced nor
+    // removed on Windows, and rewriting them would change the data of the
+    // mapping. The data is stored under a new id instead, which is never
+    // reused, and the previous analysis is deleted afterwards. Its file is
+    // only deleted by finishTransaction().
+    const int replacedAnalysisId = info->analysisId;
+    info->analysisId = -1;
+
     QSqlQuery query(m_database);
-    if (info->analysisId == -1) {
-        query.prepare(QString(
-            "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
-            "VALUES (:trackId,:type,:description,:version,:data_checksum)")
-                      .arg(s_analysisTableName));
-
-        query.bindValue(":trackId", info->trackId.toVariant());
-        query.bindValue(":type", info->type);
-        query.bindValue(":description", info->description);
-        query.bindValue(":version", info->version);
-        query.bindValue(":data_checksum", checksum);
-
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query) << "couldn't save new analysis";
-            return false;
-        }
-        info->analysisId = query.lastInsertId().toInt();
-    } else {
-        query.prepare(QString(
-            "UPDATE %1 SET "
-            "track_id = :trackId,"
-            "type = :type,"
-            "description = :description,"
-            "version = :version,"
-            "data_checksum = :data_checksum "
-            "WHERE id = :analysisId").arg(s_analysisTableName));
-
-        query.bindValue(":analysisId", info->analysisId);
-        query.bindValue(":trackId", info->trackId.toVariant());
-        query.bindValue(":type", info->type);
-        query.bindValue(":description", info->description);
-        query.bindValue(":version", info->version);
-        query.bindValue(":data_checksum", checksum);
-
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query) << "couldn't update existing analysis";
-            return false;
-        }
+    query.prepare(QString(
+        "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
+        "VALUES (:trackId,:type,:description,:version,:data_checksum)")
+                  .arg(s_analysisTableName));
+
+    query.bindValue(":trackId", info->trackId.toVariant());
+    query.bindValue(":type", info->type);
+    query.bindValue(":description", info->description);
+    query.bindValue(":version", info->version);
+    query.bindValue(":data_checksum", checksum);
+
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "couldn't save new analysis";
+        info->analysisId = replacedAnalysisId;
+        return false;
     }
+    info->analysisId = query.lastInsertId().toInt();
 
     QString dataPath = getAnalysisStoragePath().absoluteFilePath(
         QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
+    if (!saveDataToFile(dataPath, storedData, info->flat ? info->flatFileSize : 0)) {
         qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
+        deleteAnalysis(info->analysisId);
+        info->analysisId = replacedAnalysisId;
         return false;
     }
+    if (replacedAnalysisId != -1 && deleteAnalysisRecord(replacedAnalysisId)) {
+        m_replacedFiles.append(getAnalysisStoragePath().absoluteFilePath(
+                QString::number(replacedAnalysisId)));
+    }
 
     qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
+             << QString("%1 (%2 %3)").arg(QString::number(info->data.length()),
+                                        QString::number(storedData.length()),
+                                        info->flat ? "flat" : "compressed")
              << "bytes for track"
              << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
     return true;
 }
 
+void AnalysisDao::finishTransaction(bool committed) {
+    if (committed) {
+        for (const auto& fileName : std::as_const(m_replacedFiles)) {
+            deleteFile(fileName);
+        }
+    }
+    m_replacedFiles.clear();
+}
+
 bool AnalysisDao::deleteAnalysis(const int analysisId) {
+    if (!deleteAnalysisRecord(analysisId)) {
+        return false;
+    }
+    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
+        QString::number(analysisId));
+    deleteFile(dataPath);
+    return true;
+}
+
+bool AnalysisDao::deleteAnalysisRecord(const int analysisId) {
     if (analysisId == -1) {
         return false;
     }
@@ -197,10 +231,6 @@ bool AnalysisDao::deleteAnalysis(const int analysisId) {
         LOG_FAILED_QUERY(query) << "couldn't delete analysis";
         return false;
     }
-
-    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-        QString::number(analysisId));
-    deleteFile(dataPath);
     return true;
 }
 
@@ -261,7 +291,8 @@ QDir AnalysisDao::getAnalysisStoragePath() const {
     return dir.absolutePath().append("/");
 }
 
-QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
+QByteArray AnalysisDao::loadDataFromFile(const QString& filename, bool* pFlat) const {
+    *pFlat = false;
     QFile file(filename);
     if (!file.exists()) {
         return QByteArray();
@@ -269,40 +300,45 @@ QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
     if (!file.open(QIODevice::ReadOnly)) {
         return QByteArray();
     }
+    const QByteArray header = file.peek(Waveform::kFlatHeaderSize);
+    if (Waveform::isFlatHeader(header)) {
+        *pFlat = true;
+        return header;
+    }
     return file.readAll();
 }
 
 bool AnalysisDao::deleteFile(const QString& fileName) const {
-    QFile file(fileName);
-    return file.remove();
-}
+    const auto locker = lockMutex(&s_undeletedFilesMutex);
+    // Retry the files that have been unmapped in the meantime
+    s_undeletedFiles.erase(std::remove_if(s_undeletedFiles.begin(),
+                                   s_undeletedFiles.end(),
+                                   [](const QString& undeletedFileName) {
+                                       QFile undeletedFile(undeletedFileName);
+                                       return undeletedFile.remove() ||
+                                               !undeletedFile.exists();
+                                   }),
+            s_undeletedFiles.end());
 
-bool AnalysisDao::saveDataToFile(const QString& fileName, const QByteArray& data) const {
     QFile file(fileName);
-
-    // If the file exists, do the right thing. Write to a temp file, unlink the
-    // existing file, and then move the temp file to the real file's name.
-    if (file.exists()) {
-        QString tempFileName = fileName + ".tmp";
-        QFile tempFile(tempFileName);
-        if (!tempFile.open(QIODevice::WriteOnly)) {
-            return false;
-        }
-        int bytesWritten = tempFile.write(data);
-        if (bytesWritten == -1 || bytesWritten != data.length()) {
-            return false;
-        }
-        tempFile.close();
-        if (!file.remove()) {
-            return false;
-        }
-        if (!tempFile.rename(fileName)) {
-            return false;
-        }
+    if (file.remove()) {
         return true;
     }
+    if (file.exists() && !s_undeletedFiles.contains(fileName)) {
+        qDebug() << "Deferring deletion of analysis file" << fileName
+                 << file.errorString();
+        s_undeletedFiles.append(fileName);
+    }
+    return false;
+}
 
-    // If the file doesn't exist, just create a new file and write the data.
+bool AnalysisDao::saveDataToFile(const QString& fileName,
+        const QByteArray& data,
+        qint64 paddedSize) const {
+    // The file of an analysis is written only once, see saveAnalysis(). A
+    // file with the same name can only be left over from a transaction
+    // that has been rolled back, and is overwritten.
+    QFile file(fileName);
     if (!file.open(QIODevice::WriteOnly)) {
         return false;
     }
@@ -310,6 +346,9 @@ bool AnalysisDao::saveDataToFile(const QString& fileName, const QByteArray& data
     if (bytesWritten == -1 || bytesWritten != data.length()) {
         return false;
     }
+    if (paddedSize > data.length() && !file.resize(paddedSize)) {
+        return false;
+    }
     file.close();
     return true;
 }
@@ -331,6 +370,8 @@ void AnalysisDao::saveTrackAnalyses(
         return;
     }
 
+    const bool flat = waveformSettings.flatWaveformStorageEnabled();
+
     AnalysisDao::AnalysisInfo analysis;
     analysis.trackId = trackId;
     if (pWaveform->getId() != -1) {
@@ -339,9 +380,16 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
+    analysis.flat = flat;
+    if (flat) {
+        analysis.data = pWaveform->toFlatByteArray();
+        analysis.flatFileSize = pWaveform->flatFileSize();
+    } else {
+        analysis.data = pWaveform->toByteArray();
+    }
     bool success = saveAnalysis(&analysis);
     if (success) {
+        pWaveform->setId(analysis.analysisId);
         pWaveform->setSaveState(Waveform::SaveState::Saved);
     }
 
@@ -349,15 +397,22 @@ void AnalysisDao::saveTrackAnalyses(
                  << "waveform analysis for trackId" << trackId
                  << "analysisId" << analysis.analysisId;
 
-    // Clear analysisId since we are re-using the AnalysisInfo
-    analysis.analysisId = -1;
+    // Reset analysisId since we are re-using the AnalysisInfo, a summary
+    // that has been loaded from the database is replaced
+    analysis.analysisId = pWaveSummary->getId();
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
+    if (flat) {
+        analysis.data = pWaveSummary->toFlatByteArray();
+        analysis.flatFileSize = pWaveSummary->flatFileSize();
+    } else {
+        analysis.data = pWaveSummary->toByteArray();
+    }
 
     success = saveAnalysis(&analysis);
     if (success) {
+        pWaveSummary->setId(analysis.analysisId);
         pWaveSummary->setSaveState(Waveform::SaveState::Saved);
     }
     qDebug() << (success ? "Saved" : "Failed to save")
@@ -365,6 +420,29 @@ void AnalysisDao::saveTrackAnalyses(
              << "analysisId" << analysis.analysisId;
 }
 
+void AnalysisDao::migrateTrackAnalyses(
+        TrackId trackId,
+        ConstWaveformPointer pWaveform,
+        ConstWaveformPointer pWaveSummary) {
+    WaveformSettings waveformSettings(m_pConfig);
+    if (!waveformSettings.waveformCachingEnabled() ||
+            !waveformSettings.flatWaveformStorageEnabled()) {
+        return;
+    }
+    // Mapped waveforms have already been migrated, invalid waveforms are
+    // analyzed again.
+    if (!pWaveform || pWaveform->isMapped() || pWaveform->getDataSize() == 0 ||
+            !pWaveSummary || pWaveSummary->isMapped() ||
+            pWaveSummary->getDataSize() == 0) {
+        return;
+    }
+    qDebug() << "Migrating waveform analyses of track" << trackId
+             << "to the flat format";
+    pWaveform->setSaveState(Waveform::SaveState::SavePending);
+    pWaveSummary->setSaveState(Waveform::SaveState::SavePending);
+    saveTrackAnalyses(trackId, pWaveform, pWaveSummary);
+}
+
 size_t AnalysisDao::getDiskUsageInBytes(
         const QSqlDatabase& database,
         AnalysisType type) const {
@@ -22,7 +22,9 @@ class AnalysisDao : public DAO {
     struct AnalysisInfo {
         AnalysisInfo()
                 : analysisId(-1),
-                  type(TYPE_UNKNOWN) {
+                  type(TYPE_UNKNOWN),
+                  flat(false),
+                  flatFileSize(0) {
         }
         int analysisId;
         TrackId trackId;
@@ -30,6 +32,13 @@ class AnalysisDao : public DAO {
         QString description;
         QString version;
         QByteArray data;
+        // Analyses in the flat format of Waveform::toFlatByteArray() are
+        // stored uncompressed and padded with zeros up to flatFileSize.
+        // When loading them only the header is read into data, the file
+        // at dataPath is mapped into memory by the consumer.
+        bool flat;
+        qint64 flatFileSize;
+        QString dataPath;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -47,7 +56,15 @@ class AnalysisDao : public DAO {
 
     QList<AnalysisInfo> getAnalysesForTrackByType(TrackId trackId, AnalysisType type);
     QList<AnalysisInfo> getAnalysesForTrack(TrackId trackId);
+    // Stores the analysis under a new analysisId. An existing analysis
+    // with the previous analysisId is deleted, its file might still be
+    // mapped and is never overwritten.
     bool saveAnalysis(AnalysisInfo* analysis);
+    // The files of the analyses that have been replaced by saveAnalysis()
+    // are kept until the enclosing transaction has been finished, because
+    // a rollback restores the analyses. Must be called afterwards, with
+    // committed = true if no transaction was active.
+    void finishTransaction(bool committed);
     bool deleteAnalysis(const int analysisId);
     void deleteAnalyses(const QList<TrackId>& trackIds);
     bool deleteAnalysesForTrack(TrackId trackId);
@@ -56,13 +73,23 @@ class AnalysisDao : public DAO {
             TrackId trackId,
             ConstWaveformPointer pWaveform,
             ConstWaveformPointer pWaveSummary);
+    // Stores waveforms that have been loaded from the compressed format
+    // again in the flat format, if enabled.
+    void migrateTrackAnalyses(
+            TrackId trackId,
+            ConstWaveformPointer pWaveform,
+            ConstWaveformPointer pWaveSummary);
 
   private:
     QDir getAnalysisStoragePath() const;
-    QByteArray loadDataFromFile(const QString& fileName) const;
-    bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
+    QByteArray loadDataFromFile(const QString& fileName, bool* pFlat) const;
+    bool saveDataToFile(const QString& fileName,
+            const QByteArray& data,
+            qint64 paddedSize = 0) const;
     bool deleteFile(const QString& filename) const;
+    bool deleteAnalysisRecord(const int analysisId);
     QList<AnalysisInfo> loadAnalysesFromQuery(TrackId trackId, QSqlQuery* query);
 
     const UserSettingsPointer m_pConfig;
+    QStringList m_replacedFiles;
 };
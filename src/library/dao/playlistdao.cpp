@@ -2,6 +2,8 @@
 
 #include <QRandomGenerator>
 #include <QtDebug>
+#include <algorithm>
+#include <limits>
 
 #include "library/autodj/autodjprocessor.h"
 #include "library/queryutil.h"
@@ -11,6 +13,28 @@
 #include "util/make_const_iterator.h"
 #include "util/math.h"
 
+namespace {
+
+QString joinPositionList(const QList<int>& positions) {
+    QStringList positionList;
+    positionList.reserve(positions.size());
+    for (const auto position : positions) {
+        positionList.append(QString::number(position));
+    }
+    return positionList.join(QChar(','));
+}
+
+QString joinTrackIdList(const QSet<TrackId>& trackIds) {
+    QStringList trackIdList;
+    trackIdList.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        trackIdList.append(trackId.toString());
+    }
+    return trackIdList.join(QChar(','));
+}
+
+} // namespace
+
 PlaylistDAO::PlaylistDAO()
         : m_pAutoDJProcessor(nullptr) {
 }
@@ -576,10 +600,11 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-        int position = query.value(query.record().indexOf("position")).toInt();
-        removeTracksFromPlaylistInner(playlistId, position);
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 
     transaction.commit();
     emit playlistContentChanged(QSet<int>{playlistId});
@@ -588,19 +613,23 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
 
 void PlaylistDAO::removeTracksFromPlaylistById(int playlistId, TrackId trackId) {
     ScopedTransaction transaction(m_database);
-    removeTracksFromPlaylistByIdInner(playlistId, trackId);
+    removeTracksFromPlaylistByIdInner(playlistId, QSet<TrackId>{trackId});
     transaction.commit();
     emit playlistContentChanged(QSet<int>{playlistId});
     emit tracksRemoved(QSet<int>{playlistId});
 }
 
-void PlaylistDAO::removeTracksFromPlaylistByIdInner(int playlistId, TrackId trackId) {
+void PlaylistDAO::removeTracksFromPlaylistByIdInner(
+        int playlistId, const QSet<TrackId>& trackIds) {
+    if (trackIds.isEmpty()) {
+        return;
+    }
     QSqlQuery query(m_database);
     query.prepare(QStringLiteral(
             "SELECT position FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND track_id=:track_id"));
+            "WHERE playlist_id=:id AND track_id IN (%1)")
+                    .arg(joinTrackIdList(trackIds)));
     query.bindValue(":id", playlistId);
-    query.bindValue(":track_id", trackId.toVariant());
 
     query.setForwardOnly(true);
     if (!query.exec()) {
@@ -608,85 +637,110 @@ void PlaylistDAO::removeTracksFromPlaylistByIdInner(int playlistId, TrackId trac
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-        int position = query.value(query.record().indexOf("position")).toInt();
-        removeTracksFromPlaylistInner(playlistId, position);
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 }
 
 void PlaylistDAO::removeTrackFromPlaylist(int playlistId, int position) {
     // qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //          << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    removeTracksFromPlaylistInner(playlistId, position);
+    removeTracksFromPlaylistInner(playlistId, QList<int>{position});
     transaction.commit();
     emit playlistContentChanged(QSet<int>{playlistId});
     emit tracksRemoved(QSet<int>{playlistId});
 }
 
 void PlaylistDAO::removeTracksFromPlaylist(int playlistId, const QList<int>& positions) {
-    // get positions in reversed order
-    auto sortedPositons = positions;
-    std::sort(sortedPositons.begin(), sortedPositons.end(), std::greater<int>());
-
     //qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    for (const auto position : std::as_const(sortedPositons)) {
-        removeTracksFromPlaylistInner(playlistId, position);
-    }
+    removeTracksFromPlaylistInner(playlistId, positions);
     transaction.commit();
     emit playlistContentChanged(QSet<int>{playlistId});
     emit tracksRemoved(QSet<int>{playlistId});
 }
 
-void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
+void PlaylistDAO::removeTracksFromPlaylistInner(
+        int playlistId, const QList<int>& positions) {
+    if (positions.isEmpty()) {
+        return;
+    }
+    const QString positionList = joinPositionList(positions);
+
     QSqlQuery query(m_database);
     query.prepare(QStringLiteral(
-            "SELECT track_id FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND position=:position"));
+            "SELECT track_id, position FROM PlaylistTracks "
+            "WHERE playlist_id=:id AND position IN (%1) "
+            "ORDER BY position DESC")
+                    .arg(positionList));
     query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
 
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
         return;
     }
 
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
+    // In descending order, i.e. each position is still valid after the
+    // tracks that precede it in this list have been removed.
+    QList<std::pair<TrackId, int>> removedTracks;
+    const int trackIdColumn = query.record().indexOf("track_id");
+    const int positionColumn = query.record().indexOf("position");
+    while (query.next()) {
+        removedTracks.append(std::make_pair(
+                TrackId(query.value(trackIdColumn)),
+                query.value(positionColumn).toInt()));
+    }
+    if (removedTracks.isEmpty()) {
+        qDebug() << "removeTrackFromPlaylist no track exists at positions:"
+                 << positions << "in playlist:" << playlistId;
         return;
     }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
 
-    // Delete the track from the playlist.
+    // Delete the tracks from the playlist.
     query.prepare(QStringLiteral(
             "DELETE FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND position=:position"));
+            "WHERE playlist_id=:id AND position IN (%1)")
+                    .arg(positionList));
     query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
 
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
         return;
     }
 
+    // Close the gaps. The tracks between the n-th and the next removed
+    // position move up by n, so each following track is updated once
+    // instead of once per removed track.
     query.prepare(QStringLiteral(
-            "UPDATE PlaylistTracks SET position=position-1 "
-            "WHERE position>=:position AND playlist_id=:id"));
+            "UPDATE PlaylistTracks SET position=position-:shift "
+            "WHERE playlist_id=:id AND position>:position AND position<:next_position"));
     query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    int shift = 0;
+    for (auto it = removedTracks.crbegin(); it != removedTracks.crend(); ++it) {
+        const auto next = std::next(it);
+        query.bindValue(":shift", ++shift);
+        query.bindValue(":position", it->second);
+        query.bindValue(":next_position",
+                next != removedTracks.crend()
+                        ? next->second
+                        : std::numeric_limits<int>::max());
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
     }
 
-    m_playlistsTrackIsIn.remove(trackId, playlistId);
-
-    emit trackRemoved(playlistId, trackId, position);
+    QSet<TrackId> removedTrackIds;
+    for (const auto& [trackId, position] : std::as_const(removedTracks)) {
+        m_playlistsTrackIsIn.remove(trackId, playlistId);
+        removedTrackIds.insert(trackId);
+        emit trackRemoved(playlistId, trackId, position);
+    }
     if (getHiddenType(playlistId) == PLHT_SET_LOG) {
-        emit tracksRemovedFromPlayedHistory({trackId});
+        emit tracksRemovedFromPlayedHistory(removedTrackIds);
     }
 }
 
@@ -744,7 +798,6 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         return 0;
     }
 
-    int numTracksAdded = 0;
     ScopedTransaction transaction(m_database);
 
     int max_position = getMaxPosition(playlistId) + 1;
@@ -753,51 +806,69 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         position = max_position;
     }
 
+    QList<TrackId> validTrackIds;
+    validTrackIds.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        if (trackId.isValid()) {
+            validTrackIds.append(trackId);
+        }
+    }
+    if (validTrackIds.isEmpty()) {
+        return 0;
+    }
+
+    // Make room for all tracks at once
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "UPDATE PlaylistTracks SET position=position+:count "
+            "WHERE position>=:position AND "
+            "playlist_id=:id"));
+    query.bindValue(":count", validTrackIds.size());
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", position);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
+
     QSqlQuery insertQuery(m_database);
     insertQuery.prepare(QStringLiteral(
             "INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
             "VALUES (:playlist_id, :track_id, :position)"));
-    QSqlQuery query(m_database);
-    int insertPositon = position;
-    for (const auto& trackId : trackIds) {
-        if (!trackId.isValid()) {
+    QList<TrackId> addedTrackIds;
+    for (const auto& trackId : std::as_const(validTrackIds)) {
+        // Insert the track at the given position
+        insertQuery.bindValue(":playlist_id", playlistId);
+        insertQuery.bindValue(":track_id", trackId.toVariant());
+        insertQuery.bindValue(":position", position + addedTrackIds.size());
+        if (!insertQuery.exec()) {
+            LOG_FAILED_QUERY(insertQuery);
             continue;
         }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
+        addedTrackIds.append(trackId);
+    }
+    const int numTracksAdded = static_cast<int>(addedTrackIds.size());
+
+    if (numTracksAdded < validTrackIds.size()) {
+        // Close the gap that has been left by the tracks that failed to insert
         query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position+1 "
+                "UPDATE PlaylistTracks SET position=position-:count "
                 "WHERE position>=:position AND "
                 "playlist_id=:id"));
+        query.bindValue(":count", validTrackIds.size() - numTracksAdded);
         query.bindValue(":id", playlistId);
-        query.bindValue(":position", insertPositon);
-
+        query.bindValue(":position", position + validTrackIds.size());
         if (!query.exec()) {
             LOG_FAILED_QUERY(query);
-            continue;
         }
-
-        // Insert the track at the given position
-        insertQuery.bindValue(":playlist_id", playlistId);
-        insertQuery.bindValue(":track_id", trackId.toVariant());
-        insertQuery.bindValue(":position", insertPositon);
-        if (!insertQuery.exec()) {
-            LOG_FAILED_QUERY(insertQuery);
-            continue;
-        }
-
-        // Increment the insert position for the track.
-        ++insertPositon;
-        ++numTracksAdded;
     }
 
     transaction.commit();
 
-    insertPositon = position;
-    for (const auto& trackId : trackIds) {
+    int insertPosition = position;
+    for (const auto& trackId : std::as_const(addedTrackIds)) {
         m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
-        emit trackAdded(playlistId, trackId, insertPositon++);
+        emit trackAdded(playlistId, trackId, insertPosition++);
     }
     emit tracksAdded(QSet<int>{playlistId});
     return numTracksAdded;
@@ -961,23 +1032,26 @@ int PlaylistDAO::getMaxPosition(const int playlistId) const {
 void PlaylistDAO::removeTracksFromPlaylists(const QList<TrackId>& trackIds, bool purged) {
     // copy the hash, because there is no guarantee that "it" is valid after remove
     QMultiHash<TrackId, int> playlistsTrackIsInCopy = m_playlistsTrackIsIn;
-    QSet<int> playlistIds;
-
-    ScopedTransaction transaction(m_database);
+    // Remove the tracks of each playlist at once
+    QHash<int, QSet<TrackId>> trackIdsByPlaylist;
     for (const auto& trackId : trackIds) {
-        for (auto it = playlistsTrackIsInCopy.constBegin();
-                it != playlistsTrackIsInCopy.constEnd();
+        for (auto it = playlistsTrackIsInCopy.constFind(trackId);
+                it != playlistsTrackIsInCopy.constEnd() && it.key() == trackId;
                 ++it) {
-            if (it.key() == trackId) {
-                const auto playlistId = it.value();
-                // keep tracks in history playlists
-                if (getHiddenType(playlistId) == PlaylistDAO::PLHT_SET_LOG) {
-                    continue;
-                }
-                removeTracksFromPlaylistByIdInner(playlistId, trackId);
-                playlistIds.insert(playlistId);
-            }
+            trackIdsByPlaylist[it.value()].insert(trackId);
+        }
+    }
+
+    QSet<int> playlistIds;
+    ScopedTransaction transaction(m_database);
+    for (auto it = trackIdsByPlaylist.constBegin(); it != trackIdsByPlaylist.constEnd(); ++it) {
+        const auto playlistId = it.key();
+        // keep tracks in history playlists
+        if (getHiddenType(playlistId) == PlaylistDAO::PLHT_SET_LOG) {
+            continue;
         }
+        removeTracksFromPlaylistByIdInner(playlistId, it.value());
+        playlistIds.insert(playlistId);
     }
     transaction.commit();
 
@@ -1013,70 +1087,109 @@ int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
     return count;
 }
 
-void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const int newPosition) {
+void PlaylistDAO::moveTracks(const int playlistId,
+        const QList<int>& positions,
+        const int beforePosition) {
+    if (positions.isEmpty()) {
+        return;
+    }
+    QList<int> movedPositions = positions;
+    std::sort(movedPositions.begin(), movedPositions.end());
+    movedPositions.erase(std::unique(movedPositions.begin(), movedPositions.end()),
+            movedPositions.end());
+    const int movedCount = static_cast<int>(movedPositions.size());
+    // The tracks are inserted before the track at beforePosition, or
+    // appended if there is no such track.
+    const int maxPosition = getMaxPosition(playlistId);
+    const int insertPosition = beforePosition > 0 && beforePosition <= maxPosition
+            ? beforePosition
+            : maxPosition + 1;
+
     ScopedTransaction transaction(m_database);
     QSqlQuery query(m_database);
 
-    // Algorithm for code below
-    // Case 1: destination < source (newPositon < oldPosition)
-    //    1) Set position = -1 where pos=source -- Gives that track a dummy index to keep stuff simple.
-    //    2) Decrement position where pos >= dest AND pos < source
-    //    3) Set position = dest where pos=-1 -- Move track from dummy pos to final destination.
-
-    // Case 2: destination > source (newPos > oldPos)
-    //   1) Set position=-1 where pos=source -- Give track a dummy index again.
-    //   2) Decrement position where pos > source AND pos <= dest
-    //   3) Set position=dest where pos=-1 -- Move that track from dummy pos to final destination
-
-    // Move moved track to dummy position -1
+    // Negate the positions of the moved tracks to keep them apart from the
+    // others while the positions are updated.
     query.prepare(QStringLiteral(
-            "UPDATE PlaylistTracks SET position=-1 "
-            "WHERE position=:position AND "
-            "playlist_id=:id"));
-    query.bindValue(":position", oldPosition);
+            "UPDATE PlaylistTracks SET position=-position "
+            "WHERE playlist_id=:id AND position IN (%1)")
+                    .arg(joinPositionList(movedPositions)));
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
+        return;
     }
 
-    if (newPosition < oldPosition) {
-        query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position+1 "
-                "WHERE position >= :new_position AND position < :old_position AND "
-                "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
-    } else {
-        query.prepare(QStringLiteral(
-                "UPDATE PlaylistTracks SET position=position-1 "
-                "WHERE position > :old_position AND position <= :new_position AND "
-                "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
+    // The other tracks between the n-th and the next moved position move up
+    // by n, and the tracks after the insert position move down by the number
+    // of moved tracks. Both shifts are combined per range, so each track is
+    // updated at most once instead of once per moved track.
+    struct ShiftedRange {
+        int position;
+        int nextPosition;
+        int shift;
+    };
+    QList<ShiftedRange> shiftedRanges;
+    int position = 1;
+    for (int i = 0; i <= movedCount; ++i) {
+        const int nextPosition = i < movedCount
+                ? movedPositions[i]
+                : std::numeric_limits<int>::max();
+        const int splitPosition = std::clamp(insertPosition, position, nextPosition);
+        if (i > 0 && position < splitPosition) {
+            shiftedRanges.append(ShiftedRange{position, splitPosition, -i});
+        }
+        if (i < movedCount && splitPosition < nextPosition) {
+            shiftedRanges.append(ShiftedRange{splitPosition, nextPosition, movedCount - i});
+        }
+        position = nextPosition + 1;
     }
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    query.prepare(QStringLiteral(
+            "UPDATE PlaylistTracks SET position=position+:shift "
+            "WHERE playlist_id=:id AND position>=:position AND position<:next_position"));
+    query.bindValue(":id", playlistId);
+    const auto shiftRange = [&query](const ShiftedRange& range) {
+        query.bindValue(":shift", range.shift);
+        query.bindValue(":position", range.position);
+        query.bindValue(":next_position", range.nextPosition);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
+    };
+    // The ranges that move up are updated in ascending and those that move
+    // down in descending order, so no track is shifted into a range that
+    // has not been updated yet.
+    for (const auto& range : std::as_const(shiftedRanges)) {
+        if (range.shift < 0) {
+            shiftRange(range);
+        }
+    }
+    for (auto it = shiftedRanges.crbegin(); it != shiftedRanges.crend(); ++it) {
+        if (it->shift > 0) {
+            shiftRange(*it);
+        }
     }
 
+    // The moved tracks keep their order
+    const int movedBefore = static_cast<int>(std::distance(movedPositions.cbegin(),
+            std::lower_bound(movedPositions.cbegin(),
+                    movedPositions.cend(),
+                    insertPosition)));
+    int newPosition = insertPosition - movedBefore;
     query.prepare(QStringLiteral(
             "UPDATE PlaylistTracks SET position=:new_position "
-            "WHERE position=-1 AND "
-            "playlist_id=:id"));
-    query.bindValue(":new_position", newPosition);
+            "WHERE playlist_id=:id AND position=:old_position"));
     query.bindValue(":id", playlistId);
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    for (const int oldPosition : std::as_const(movedPositions)) {
+        query.bindValue(":new_position", newPosition++);
+        query.bindValue(":old_position", -oldPosition);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
     }
 
     transaction.commit();
 
-    // Print out any SQL error, if there was one.
-    if (query.lastError().isValid()) {
-        qDebug() << query.lastError();
-    }
-
     emit tracksMoved(QSet<int>{playlistId});
 }
 
@@ -123,9 +123,12 @@ class PlaylistDAO : public QObject, public virtual DAO {
     bool copyPlaylistTracks(const int sourcePlaylistID, const int targetPlaylistID);
     // Returns the number of tracks in the given playlist.
     int tracksInPlaylist(const int playlistId) const;
-    // moved Track to a new position
-    void moveTrack(const int playlistId,
-            const int oldPosition, const int newPosition);
+    // Moves the tracks at the positions before the track at beforePosition,
+    // or to the end if there is no such track. The moved tracks keep their
+    // order and the positions of all affected tracks are updated only once.
+    void moveTracks(const int playlistId,
+            const QList<int>& positions,
+            const int beforePosition);
     // shuffles all tracks in the position List
     void shuffleTracks(const int playlistId, const QList<int>& positions, const QHash<int,TrackId>& allIds);
     bool isTrackInPlaylist(TrackId trackId, const int playlistId) const;
@@ -151,8 +154,10 @@ class PlaylistDAO : public QObject, public virtual DAO {
 
   private:
     bool removeTracksFromPlaylist(int playlistId, int startIndex);
-    void removeTracksFromPlaylistInner(int playlistId, int position);
-    void removeTracksFromPlaylistByIdInner(int playlistId, TrackId trackId);
+    /// Removes the tracks at the positions and closes the gaps, renumbering
+    /// each of the following tracks only once.
+    void removeTracksFromPlaylistInner(int playlistId, const QList<int>& positions);
+    void removeTracksFromPlaylistByIdInner(int playlistId, const QSet<TrackId>& trackIds);
     void searchForDuplicateTrack(const int fromPosition,
                                  const int toPosition,
                                  TrackId trackID,
@@ -4,6 +4,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QtDebug>
+#include <algorithm>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -17,6 +18,7 @@
 #include "library/dao/playlistdao.h"
 #include "library/library_prefs.h"
 #include "library/queryutil.h"
+#include "library/scanner/parsedtrack.h"
 #include "moc_trackdao.cpp"
 #include "sources/soundsourceproxy.h"
 #include "track/beats.h"
@@ -65,6 +67,102 @@ QString joinTrackIdList(const QSet<TrackId>& trackIds) {
     return trackIdList.join(QChar(','));
 }
 
+// SQLite versions before 3.32.0 limit the number of host parameters
+// of a single statement to 999
+constexpr int kMaxBoundValuesPerStatement = 999;
+
+const QStringList kTrackLocationInsertColumns = {
+        QStringLiteral("location"),
+        QStringLiteral("directory"),
+        QStringLiteral("filename"),
+        QStringLiteral("filesize"),
+        QStringLiteral("fs_deleted"),
+        QStringLiteral("needs_verification"),
+};
+
+const QStringList kLibraryInsertColumns = {
+        QStringLiteral("artist"),
+        QStringLiteral("title"),
+        QStringLiteral("album"),
+        QStringLiteral("album_artist"),
+        QStringLiteral("year"),
+        QStringLiteral("genre"),
+        QStringLiteral("tracknumber"),
+        QStringLiteral("tracktotal"),
+        QStringLiteral("composer"),
+        QStringLiteral("grouping"),
+        QStringLiteral("filetype"),
+        QStringLiteral("location"),
+        QStringLiteral("color"),
+        QStringLiteral("comment"),
+        QStringLiteral("url"),
+        QStringLiteral("rating"),
+        QStringLiteral("key"),
+        QStringLiteral("key_id"),
+        QStringLiteral("cuepoint"),
+        QStringLiteral("bpm"),
+        QStringLiteral("replaygain"),
+        QStringLiteral("replaygain_peak"),
+        QStringLiteral("wavesummaryhex"),
+        QStringLiteral("timesplayed"),
+        QStringLiteral("last_played_at"),
+        QStringLiteral("played"),
+        QStringLiteral("mixxx_deleted"),
+        QStringLiteral("header_parsed"),
+        QStringLiteral("source_synchronized_ms"),
+        QStringLiteral("channels"),
+        QStringLiteral("samplerate"),
+        QStringLiteral("bitrate"),
+        QStringLiteral("duration"),
+        QStringLiteral("beats_version"),
+        QStringLiteral("beats_sub_version"),
+        QStringLiteral("beats"),
+        QStringLiteral("bpm_lock"),
+        QStringLiteral("keys_version"),
+        QStringLiteral("keys_sub_version"),
+        QStringLiteral("keys"),
+        QStringLiteral("coverart_source"),
+        QStringLiteral("coverart_type"),
+        QStringLiteral("coverart_location"),
+        QStringLiteral("coverart_color"),
+        QStringLiteral("coverart_digest"),
+        QStringLiteral("coverart_hash"),
+        QStringLiteral("datetime_added"),
+};
+
+// The placeholders of the first row are named like the columns, the
+// placeholders of all following rows are suffixed with the row index.
+QString placeholderSuffix(int row) {
+    if (row == 0) {
+        return QString();
+    }
+    return QStringLiteral("_%1").arg(row);
+}
+
+// Returns an insert statement for one or more rows with a named
+// placeholder for each column of each row.
+QString insertStatement(
+        const QString& tableName,
+        const QStringList& columns,
+        int numRows) {
+    DEBUG_ASSERT(numRows > 0);
+    QStringList rows;
+    rows.reserve(numRows);
+    for (int row = 0; row < numRows; ++row) {
+        const QString suffix = placeholderSuffix(row);
+        QStringList placeholders;
+        placeholders.reserve(columns.size());
+        for (const auto& column : columns) {
+            placeholders.append(QChar(':') + column + suffix);
+        }
+        rows.append(QChar('(') + placeholders.join(QChar(',')) + QChar(')'));
+    }
+    return QStringLiteral("INSERT INTO %1 (%2) VALUES %3")
+            .arg(tableName,
+                    columns.join(QChar(',')),
+                    rows.join(QChar(',')));
+}
+
 QString locationPathPrefixFromRootDir(const QDir& rootDir) {
     // Appending '/' is required to disambiguate files from parent
     // directories, e.g. "a/b.mp3" and "a/b/c.mp3" where "a/b" would
@@ -374,114 +472,13 @@ void TrackDAO::addTracksPrepare() {
     m_pQueryLibraryUpdate = std::make_unique<QSqlQuery>(m_database);
     m_pQueryLibrarySelect = std::make_unique<QSqlQuery>(m_database);
 
-    m_pQueryTrackLocationInsert->prepare("INSERT INTO track_locations "
-            "("
-            "location,directory,filename,filesize,fs_deleted,needs_verification"
-            ") VALUES ("
-            ":location,:directory,:filename,:filesize,:fs_deleted,:needs_verification"
-            ")");
+    m_pQueryTrackLocationInsert->prepare(insertStatement(
+            QStringLiteral("track_locations"), kTrackLocationInsertColumns, 1));
 
     m_pQueryTrackLocationSelect->prepare("SELECT id FROM track_locations WHERE location=:location");
 
-    m_pQueryLibraryInsert->prepare(
-            "INSERT INTO library "
-            "("
-            "artist,"
-            "title,"
-            "album,"
-            "album_artist,"
-            "year,"
-            "genre,"
-            "tracknumber,"
-            "tracktotal,"
-            "composer,"
-            "grouping,"
-            "filetype,"
-            "location,"
-            "color,"
-            "comment,"
-            "url,"
-            "rating,"
-            "key,"
-            "key_id,"
-            "cuepoint,"
-            "bpm,"
-            "replaygain,"
-            "replaygain_peak,"
-            "wavesummaryhex,"
-            "timesplayed,"
-            "last_played_at,"
-            "played,"
-            "mixxx_deleted,"
-            "header_parsed,"
-            "source_synchronized_ms,"
-            "channels,"
-            "samplerate,"
-            "bitrate,"
-            "duration,"
-            "beats_version,"
-            "beats_sub_version,"
-            "beats,"
-            "bpm_lock,"
-            "keys_version,"
-            "keys_sub_version,"
-            "keys,"
-            "coverart_source,"
-            "coverart_type,"
-            "coverart_location,"
-            "coverart_color,"
-            "coverart_digest,"
-            "coverart_hash,"
-            "datetime_added"
-            ") VALUES ("
-            ":artist,"
-            ":title,"
-            ":album,"
-            ":album_artist,"
-            ":year,"
-            ":genre,"
-            ":tracknumber,"
-            ":tracktotal,"
-            ":composer,"
-            ":grouping,"
-            ":filetype,"
-            ":location,"
-            ":color,"
-            ":comment,"
-            ":url,"
-            ":rating,"
-            ":key,"
-            ":key_id,"
-            ":cuepoint,"
-            ":bpm,"
-            ":replaygain,"
-            ":replaygain_peak,"
-            ":wavesummaryhex,"
-            ":timesplayed,"
-            ":last_played_at,"
-            ":played,"
-            ":mixxx_deleted,"
-            ":header_parsed,"
-            ":source_synchronized_ms,"
-            ":channels,"
-            ":samplerate,"
-            ":bitrate,"
-            ":duration,"
-            ":beats_version,"
-            ":beats_sub_version,"
-            ":beats,"
-            ":bpm_lock,"
-            ":keys_version,"
-            ":keys_sub_version,"
-            ":keys,"
-            ":coverart_source,"
-            ":coverart_type,"
-            ":coverart_location,"
-            ":coverart_color,"
-            ":coverart_digest,"
-            ":coverart_hash,"
-            ":datetime_added"
-            ")");
+    m_pQueryLibraryInsert->prepare(insertStatement(
+            QStringLiteral("library"), kLibraryInsertColumns, 1));
 
     m_pQueryLibraryUpdate->prepare("UPDATE library SET mixxx_deleted = 0 "
             "WHERE id=:id");
@@ -495,8 +492,10 @@ void TrackDAO::addTracksFinish(bool rollback) {
         if (rollback) {
             m_pTransaction->rollback();
             m_tracksAddedSet.clear();
+            m_analysisDao.finishTransaction(false);
         } else {
-            m_pTransaction->commit();
+            const bool committed = !*m_pTransaction || m_pTransaction->commit();
+            m_analysisDao.finishTransaction(committed);
         }
     }
     m_pQueryTrackLocationInsert.reset();
@@ -511,16 +510,29 @@ void TrackDAO::addTracksFinish(bool rollback) {
 
 namespace {
 
+// Binds the values of a single row by invoking
+// bindValue(placeholder, value) for each placeholder.
+template<typename BindValue>
+void bindTrackLocationValues(
+        BindValue&& bindValue,
+        const mixxx::FileInfo& fileInfo) {
+    bindValue(":location", fileInfo.location());
+    bindValue(":directory", fileInfo.locationPath());
+    bindValue(":filename", fileInfo.fileName());
+    bindValue(":filesize", fileInfo.sizeInBytes());
+    bindValue(":fs_deleted", 0);
+    bindValue(":needs_verification", 0);
+}
+
 bool insertTrackLocation(
         QSqlQuery* pTrackLocationInsert,
         const mixxx::FileInfo& fileInfo) {
     DEBUG_ASSERT(pTrackLocationInsert);
-    pTrackLocationInsert->bindValue(":location", fileInfo.location());
-    pTrackLocationInsert->bindValue(":directory", fileInfo.locationPath());
-    pTrackLocationInsert->bindValue(":filename", fileInfo.fileName());
-    pTrackLocationInsert->bindValue(":filesize", fileInfo.sizeInBytes());
-    pTrackLocationInsert->bindValue(":fs_deleted", 0);
-    pTrackLocationInsert->bindValue(":needs_verification", 0);
+    bindTrackLocationValues(
+            [pTrackLocationInsert](const QString& placeholder, const QVariant& value) {
+                pTrackLocationInsert->bindValue(placeholder, value);
+            },
+            fileInfo);
     if (pTrackLocationInsert->exec()) {
         return true;
     } else {
@@ -531,70 +543,71 @@ bool insertTrackLocation(
 }
 
 // Bind common values for insert/update
+template<typename BindValue>
 void bindTrackLibraryValues(
-        QSqlQuery* pTrackLibraryQuery,
+        BindValue&& bindValue,
         const mixxx::TrackRecord& track,
         const mixxx::BeatsPointer& pBeats) {
     const mixxx::TrackMetadata& trackMetadata = track.getMetadata();
     const mixxx::TrackInfo& trackInfo = trackMetadata.getTrackInfo();
     const mixxx::AlbumInfo& albumInfo = trackMetadata.getAlbumInfo();
 
-    pTrackLibraryQuery->bindValue(":artist", trackInfo.getArtist());
-    pTrackLibraryQuery->bindValue(":title", trackInfo.getTitle());
-    pTrackLibraryQuery->bindValue(":album", albumInfo.getTitle());
-    pTrackLibraryQuery->bindValue(":album_artist", albumInfo.getArtist());
-    pTrackLibraryQuery->bindValue(":year", trackInfo.getYear());
-    pTrackLibraryQuery->bindValue(":genre", trackInfo.getGenre());
-    pTrackLibraryQuery->bindValue(":composer", trackInfo.getComposer());
-    pTrackLibraryQuery->bindValue(":grouping", trackInfo.getGrouping());
-    pTrackLibraryQuery->bindValue(":tracknumber", trackInfo.getTrackNumber());
-    pTrackLibraryQuery->bindValue(":tracktotal", trackInfo.getTrackTotal());
-    pTrackLibraryQuery->bindValue(":filetype", track.getFileType());
-    pTrackLibraryQuery->bindValue(":color", mixxx::RgbColor::toQVariant(track.getColor()));
-    pTrackLibraryQuery->bindValue(":comment", trackInfo.getComment());
-    pTrackLibraryQuery->bindValue(":url", track.getUrl());
-    pTrackLibraryQuery->bindValue(":rating", track.getRating());
-    pTrackLibraryQuery->bindValue(":cuepoint",
+    bindValue(":artist", trackInfo.getArtist());
+    bindValue(":title", trackInfo.getTitle());
+    bindValue(":album", albumInfo.getTitle());
+    bindValue(":album_artist", albumInfo.getArtist());
+    bindValue(":year", trackInfo.getYear());
+    bindValue(":genre", trackInfo.getGenre());
+    bindValue(":composer", trackInfo.getComposer());
+    bindValue(":grouping", trackInfo.getGrouping());
+    bindValue(":tracknumber", trackInfo.getTrackNumber());
+    bindValue(":tracktotal", trackInfo.getTrackTotal());
+    bindValue(":filetype", track.getFileType());
+    bindValue(":color", mixxx::RgbColor::toQVariant(track.getColor()));
+    bindValue(":comment", trackInfo.getComment());
+    bindValue(":url", track.getUrl());
+    bindValue(":rating", track.getRating());
+    bindValue(":cuepoint",
             track.getMainCuePosition().toEngineSamplePosMaybeInvalid());
-    pTrackLibraryQuery->bindValue(":bpm_lock", track.getBpmLocked() ? 1 : 0);
-    pTrackLibraryQuery->bindValue(":replaygain", trackInfo.getReplayGain().getRatio());
-    pTrackLibraryQuery->bindValue(":replaygain_peak", trackInfo.getReplayGain().getPeak());
+    bindValue(":bpm_lock", track.getBpmLocked() ? 1 : 0);
+    bindValue(":replaygain", trackInfo.getReplayGain().getRatio());
+    bindValue(":replaygain_peak", trackInfo.getReplayGain().getPeak());
 
-    pTrackLibraryQuery->bindValue(":channels",
+    bindValue(":channels",
             static_cast<uint>(trackMetadata.getStreamInfo().getSignalInfo().getChannelCount()));
-    pTrackLibraryQuery->bindValue(":samplerate",
+    bindValue(":samplerate",
             static_cast<uint>(trackMetadata.getStreamInfo().getSignalInfo().getSampleRate()));
-    pTrackLibraryQuery->bindValue(":bitrate",
+    bindValue(":bitrate",
             static_cast<uint>(trackMetadata.getStreamInfo().getBitrate()));
-    pTrackLibraryQuery->bindValue(":duration",
+    bindValue(":duration",
             trackMetadata.getStreamInfo().getDuration().toDoubleSeconds());
 
-    pTrackLibraryQuery->bindValue(":header_parsed",
+    bindValue(":header_parsed",
             TrackDAO::getTrackHeaderParsedInternal(track) ? 1 : 0);
     const QDateTime sourceSynchronizedAt =
             track.getSourceSynchronizedAt();
     if (sourceSynchronizedAt.isValid()) {
         DEBUG_ASSERT(sourceSynchronizedAt.timeSpec() == Qt::UTC);
-        pTrackLibraryQuery->bindValue(":source_synchronized_ms",
+        bindValue(":source_synchronized_ms",
                 sourceSynchronizedAt.toMSecsSinceEpoch());
     } else {
-        pTrackLibraryQuery->bindValue(":source_synchronized_ms",
+        bindValue(":source_synchronized_ms",
                 QVariant());
     }
 
     const PlayCounter& playCounter = track.getPlayCounter();
-    pTrackLibraryQuery->bindValue(":timesplayed", playCounter.getTimesPlayed());
-    pTrackLibraryQuery->bindValue(":last_played_at",
+    bindValue(":timesplayed", playCounter.getTimesPlayed());
+    bindValue(":last_played_at",
             mixxx::sqlite::writeGeneratedTimestamp(playCounter.getLastPlayedAt()));
-    pTrackLibraryQuery->bindValue(":played", playCounter.isPlayed() ? 1 : 0);
+    bindValue(":played", playCounter.isPlayed() ? 1 : 0);
 
     const CoverInfoRelative& coverInfo = track.getCoverInfo();
-    pTrackLibraryQuery->bindValue(":coverart_source", coverInfo.source);
-    pTrackLibraryQuery->bindValue(":coverart_type", coverInfo.type);
-    pTrackLibraryQuery->bindValue(":coverart_location", coverInfo.coverLocation);
-    pTrackLibraryQuery->bindValue(":coverart_color", mixxx::RgbColor::toQVariant(coverInfo.color));
-    pTrackLibraryQuery->bindValue(":coverart_digest", coverInfo.imageDigest());
-    pTrackLibraryQuery->bindValue(":coverart_hash", coverInfo.legacyHash());
+    bindValue(":coverart_source", coverInfo.source);
+    bindValue(":coverart_type", coverInfo.type);
+    bindValue(":coverart_location", coverInfo.coverLocation);
+    bindValue(":coverart_color", mixxx::RgbColor::toQVariant(coverInfo.color));
+    bindValue(":coverart_digest", coverInfo.imageDigest());
+    bindValue(":coverart_hash", coverInfo.legacyHash());
 
     QByteArray beatsBlob;
     QString beatsVersion;
@@ -611,10 +624,10 @@ void bindTrackLibraryValues(
         bpm = pBeats->getBpmInRange(mixxx::audio::kStartFramePos, trackEndPosition);
     }
     const double bpmValue = bpm.isValid() ? bpm.value() : mixxx::Bpm::kValueUndefined;
-    pTrackLibraryQuery->bindValue(":bpm", bpmValue);
-    pTrackLibraryQuery->bindValue(":beats_version", beatsVersion);
-    pTrackLibraryQuery->bindValue(":beats_sub_version", beatsSubVersion);
-    pTrackLibraryQuery->bindValue(":beats", beatsBlob);
+    bindValue(":bpm", bpmValue);
+    bindValue(":beats_version", beatsVersion);
+    bindValue(":beats_sub_version", beatsSubVersion);
+    bindValue(":beats", beatsBlob);
 
     const Keys keys = track.getKeys();
     QByteArray keysBlob = keys.toByteArray();
@@ -622,21 +635,34 @@ void bindTrackLibraryValues(
     QString keysSubVersion = keys.getSubVersion();
     mixxx::track::io::key::ChromaticKey key = keys.getGlobalKey();
     QString keyText = KeyUtils::formatGlobalKey(keys);
-    pTrackLibraryQuery->bindValue(":keys", keysBlob);
-    pTrackLibraryQuery->bindValue(":keys_version", keysVersion);
-    pTrackLibraryQuery->bindValue(":keys_sub_version", keysSubVersion);
-    pTrackLibraryQuery->bindValue(":key_id", static_cast<int>(key));
-    pTrackLibraryQuery->bindValue(":key", keyText);
+    bindValue(":keys", keysBlob);
+    bindValue(":keys_version", keysVersion);
+    bindValue(":keys_sub_version", keysSubVersion);
+    bindValue(":key_id", static_cast<int>(key));
+    bindValue(":key", keyText);
 }
 
-bool insertTrackLibrary(
-        QSqlQuery* pTrackLibraryInsert,
+void bindTrackLibraryValues(
+        QSqlQuery* pTrackLibraryQuery,
+        const mixxx::TrackRecord& track,
+        const mixxx::BeatsPointer& pBeats) {
+    bindTrackLibraryValues(
+            [pTrackLibraryQuery](const QString& placeholder, const QVariant& value) {
+                pTrackLibraryQuery->bindValue(placeholder, value);
+            },
+            track,
+            pBeats);
+}
+
+template<typename BindValue>
+void bindTrackLibraryInsertValues(
+        BindValue&& bindValue,
         const mixxx::TrackRecord& trackRecord,
         const mixxx::BeatsPointer& pBeats,
         DbId trackLocationId,
         const mixxx::FileInfo& fileInfo,
         const QDateTime& trackDateAdded) {
-    bindTrackLibraryValues(pTrackLibraryInsert, trackRecord, pBeats);
+    bindTrackLibraryValues(bindValue, trackRecord, pBeats);
 
     if (!trackRecord.getDateAdded().isNull()) {
         qDebug() << "insertTrackLibrary: Track"
@@ -644,22 +670,40 @@ bool insertTrackLibrary(
                  << "was added"
                  << trackRecord.getDateAdded();
     }
-    pTrackLibraryInsert->bindValue(":datetime_added", trackDateAdded);
+    bindValue(":datetime_added", trackDateAdded);
 
     // Written only once upon insert
-    pTrackLibraryInsert->bindValue(":location", trackLocationId.toVariant());
+    bindValue(":location", trackLocationId.toVariant());
 
     // Column datetime_added is set implicitly
-    //pTrackLibraryInsert->bindValue(":datetime_added", track.getDateAdded());
+    //bindValue(":datetime_added", track.getDateAdded());
 
-    pTrackLibraryInsert->bindValue(":mixxx_deleted", 0);
+    bindValue(":mixxx_deleted", 0);
 
     // We no longer store the wavesummary in the library table.
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    pTrackLibraryInsert->bindValue(":wavesummaryhex", QVariant(QMetaType(QMetaType::QByteArray)));
+    bindValue(":wavesummaryhex", QVariant(QMetaType(QMetaType::QByteArray)));
 #else
-    pTrackLibraryInsert->bindValue(":wavesummaryhex", QVariant(QVariant::ByteArray));
+    bindValue(":wavesummaryhex", QVariant(QVariant::ByteArray));
 #endif
+}
+
+bool insertTrackLibrary(
+        QSqlQuery* pTrackLibraryInsert,
+        const mixxx::TrackRecord& trackRecord,
+        const mixxx::BeatsPointer& pBeats,
+        DbId trackLocationId,
+        const mixxx::FileInfo& fileInfo,
+        const QDateTime& trackDateAdded) {
+    bindTrackLibraryInsertValues(
+            [pTrackLibraryInsert](const QString& placeholder, const QVariant& value) {
+                pTrackLibraryInsert->bindValue(placeholder, value);
+            },
+            trackRecord,
+            pBeats,
+            trackLocationId,
+            fileInfo,
+            trackDateAdded);
 
     if (!pTrackLibraryInsert->exec()) {
         // We failed to insert the track. Maybe it is already in the library
@@ -896,6 +940,213 @@ TrackPointer TrackDAO::addTracksAddFile(
     return pTrack;
 }
 
+QList<TrackId> TrackDAO::addTracksAddParsedTracks(
+        const QList<ParsedTrack>& parsedTracks) {
+    VERIFY_OR_DEBUG_ASSERT(m_pTransaction) {
+        kLogger.warning()
+                << "Adding tracks requires a transaction."
+                << "Skipping" << parsedTracks.size() << "track(s)";
+        return {};
+    }
+    QList<TrackId> addedTrackIds;
+    addedTrackIds.reserve(parsedTracks.size());
+    const int maxRowsPerInsert =
+            kMaxBoundValuesPerStatement / static_cast<int>(kLibraryInsertColumns.size());
+    for (int first = 0; first < parsedTracks.size(); first += maxRowsPerInsert) {
+        const int last = std::min(first + maxRowsPerInsert, static_cast<int>(parsedTracks.size()));
+        // Tracks that are added one by one after the batch
+        QList<const ParsedTrack*> remainingTracks;
+        {
+            // Keep the cache locked while adding the tracks to prevent
+            // creating Track objects for the same files concurrently
+            GlobalTrackCacheLocker cacheLocker;
+
+            QStringList locations;
+            locations.reserve(last - first);
+            for (int i = first; i < last; ++i) {
+                locations.append(parsedTracks.at(i).fileAccess.info().location());
+            }
+            QSet<QString> existingLocations;
+            {
+                QSqlQuery query(m_database);
+                query.prepare(QStringLiteral(
+                        "SELECT location FROM track_locations WHERE location IN (%1)")
+                                      .arg(SqlStringFormatter::formatList(
+                                              m_database, locations)));
+                if (!query.exec()) {
+                    LOG_FAILED_QUERY(query);
+                    DEBUG_ASSERT(!"Failed query");
+                }
+                while (query.next()) {
+                    existingLocations.insert(query.value(0).toString());
+                }
+            }
+
+            QList<const ParsedTrack*> newTracks;
+            newTracks.reserve(last - first);
+            for (int i = first; i < last; ++i) {
+                const ParsedTrack& parsedTrack = parsedTracks.at(i);
+                const mixxx::FileInfo& fileInfo = parsedTrack.fileAccess.info();
+                // The location might already exist in the database, e.g. if the
+                // file has been added while scanning, or a Track object might
+                // exist for the file, e.g. if it has been loaded from a browsed
+                // directory. Both cases are handled like before by adding these
+                // tracks one by one.
+                if (existingLocations.contains(fileInfo.location()) ||
+                        cacheLocker.lookupTrackByRef(TrackRef::fromFileInfo(fileInfo))) {
+                    remainingTracks.append(&parsedTrack);
+                    continue;
+                }
+                // Duplicates are added one by one, too
+                existingLocations.insert(fileInfo.location());
+                newTracks.append(&parsedTrack);
+            }
+
+            if (!newTracks.isEmpty()) {
+                addedTrackIds += addTracksInsertRows(newTracks);
+            }
+        }
+
+        for (const auto* pParsedTrack : std::as_const(remainingTracks)) {
+            const auto numTracksAdded = m_tracksAddedSet.size();
+            const auto pTrack = addTracksAddFile(pParsedTrack->fileAccess, false);
+            if (pTrack && m_tracksAddedSet.size() > numTracksAdded) {
+                addedTrackIds.append(pTrack->getId());
+            }
+        }
+    }
+    return addedTrackIds;
+}
+
+QList<TrackId> TrackDAO::addTracksInsertRows(
+        const QList<const ParsedTrack*>& parsedTracks) {
+    DEBUG_ASSERT(!parsedTracks.isEmpty());
+    const int numRows = static_cast<int>(parsedTracks.size());
+
+    // Insert all track locations with a single statement
+    QStringList locations;
+    locations.reserve(numRows);
+    QSqlQuery trackLocationInsert(m_database);
+    trackLocationInsert.prepare(insertStatement(
+            QStringLiteral("track_locations"), kTrackLocationInsertColumns, numRows));
+    for (int row = 0; row < numRows; ++row) {
+        const QString suffix = placeholderSuffix(row);
+        bindTrackLocationValues(
+                [&trackLocationInsert, &suffix](
+                        const QString& placeholder, const QVariant& value) {
+                    trackLocationInsert.bindValue(placeholder + suffix, value);
+                },
+                parsedTracks.at(row)->fileAccess.info());
+        locations.append(parsedTracks.at(row)->fileAccess.info().location());
+    }
+    if (!trackLocationInsert.exec()) {
+        LOG_FAILED_QUERY(trackLocationInsert)
+                << "Failed to insert" << numRows << "track locations";
+        DEBUG_ASSERT(!"Failed query");
+        return {};
+    }
+    // Read back the ids by the inserted keys. Other connections might
+    // have inserted rows concurrently, i.e. the ids of the new rows are
+    // not necessarily consecutive.
+    QHash<QString, DbId> trackLocationIds;
+    {
+        QSqlQuery query(m_database);
+        query.prepare(QStringLiteral(
+                "SELECT id, location FROM track_locations WHERE location IN (%1)")
+                              .arg(SqlStringFormatter::formatList(m_database, locations)));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            DEBUG_ASSERT(!"Failed query");
+            return {};
+        }
+        while (query.next()) {
+            trackLocationIds.insert(query.value(1).toString(), DbId(query.value(0)));
+        }
+    }
+    VERIFY_OR_DEBUG_ASSERT(trackLocationIds.size() == numRows) {
+        return {};
+    }
+
+    // Insert all tracks with a single statement
+    // Time stamps are stored with timezone UTC in the database
+    const auto trackDateAdded = QDateTime::currentDateTimeUtc();
+    QSqlQuery trackLibraryInsert(m_database);
+    trackLibraryInsert.prepare(insertStatement(
+            QStringLiteral("library"), kLibraryInsertColumns, numRows));
+    for (int row = 0; row < numRows; ++row) {
+        const ParsedTrack& parsedTrack = *parsedTracks.at(row);
+        const mixxx::FileInfo& fileInfo = parsedTrack.fileAccess.info();
+        const QString suffix = placeholderSuffix(row);
+        bindTrackLibraryInsertValues(
+                [&trackLibraryInsert, &suffix](
+                        const QString& placeholder, const QVariant& value) {
+                    trackLibraryInsert.bindValue(placeholder + suffix, value);
+                },
+                parsedTrack.record,
+                parsedTrack.pBeats,
+                trackLocationIds.value(fileInfo.location()),
+                fileInfo,
+                trackDateAdded);
+    }
+    if (!trackLibraryInsert.exec()) {
+        LOG_FAILED_QUERY(trackLibraryInsert)
+                << "Failed to insert" << numRows << "tracks";
+        DEBUG_ASSERT(!"Failed query");
+        return {};
+    }
+    // The track locations have just been inserted, i.e. the new tracks
+    // are the only ones that refer to them
+    QStringList trackLocationIdStrings;
+    trackLocationIdStrings.reserve(numRows);
+    for (const auto& trackLocationId : std::as_const(trackLocationIds)) {
+        trackLocationIdStrings.append(trackLocationId.toString());
+    }
+    QHash<DbId, TrackId> trackIds;
+    {
+        QSqlQuery query(m_database);
+        query.prepare(QStringLiteral(
+                "SELECT id, location FROM library WHERE location IN (%1)")
+                              .arg(trackLocationIdStrings.join(QChar(','))));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            DEBUG_ASSERT(!"Failed query");
+            return {};
+        }
+        while (query.next()) {
+            trackIds.insert(DbId(query.value(1)), TrackId(query.value(0)));
+        }
+    }
+    VERIFY_OR_DEBUG_ASSERT(trackIds.size() == numRows) {
+        return {};
+    }
+
+    QList<TrackId> addedTrackIds;
+    addedTrackIds.reserve(numRows);
+    for (const auto* pParsedTrack : parsedTracks) {
+        const TrackId trackId = trackIds.value(
+                trackLocationIds.value(pParsedTrack->fileAccess.info().location()));
+        VERIFY_OR_DEBUG_ASSERT(trackId.isValid()) {
+            continue;
+        }
+        if (!pParsedTrack->cueInfos.isEmpty()) {
+            const auto sampleRate = pParsedTrack->record.getMetadata()
+                                            .getStreamInfo()
+                                            .getSignalInfo()
+                                            .getSampleRate();
+            QList<CuePointer> cuePoints;
+            cuePoints.reserve(pParsedTrack->cueInfos.size());
+            for (const auto& cueInfo : pParsedTrack->cueInfos) {
+                cuePoints.append(CuePointer(new Cue(cueInfo, sampleRate, true)));
+            }
+            m_cueDao.saveTrackCues(trackId, cuePoints);
+        }
+        DEBUG_ASSERT(!m_tracksAddedSet.contains(trackId));
+        m_tracksAddedSet.insert(trackId);
+        addedTrackIds.append(trackId);
+    }
+    return addedTrackIds;
+}
+
 bool TrackDAO::hideTracks(
         const QList<TrackId>& trackIds) const {
     QStringList idList;
@@ -1688,7 +1939,8 @@ bool TrackDAO::updateTrack(const Track& track) const {
             track.getWaveformSummary());
     m_cueDao.saveTrackCues(
             trackId, track.getCuePoints());
-    transaction.commit();
+    const bool committed = !transaction || transaction.commit();
+    m_analysisDao.finishTransaction(committed);
 
     //qDebug() << "Update track in database took: " << time.elapsed().formatMillisWithUnit();
     //time.start();
@@ -1711,6 +1963,23 @@ void TrackDAO::invalidateTrackLocationsInLibrary() const {
     }
 }
 
+// Mark the tracks in the given directories as invalid, i.e. only the
+// changed directories need to be verified by the library scanner.
+void TrackDAO::invalidateTrackLocationsInDirectories(const QStringList& directories) const {
+    QSqlQuery query(m_database);
+    query.prepare(
+            QString("UPDATE track_locations "
+                    "SET needs_verification=1 "
+                    "WHERE directory IN (%1)")
+                    .arg(SqlStringFormatter::formatList(m_database, directories)));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+        DEBUG_ASSERT(!"Failed query");
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) const {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
@@ -2058,6 +2327,9 @@ bool TrackDAO::verifyRemainingTracks(
     return true;
 }
 
+// The number of tracks with detected cover art that are updated at once
+constexpr int kCoverArtUpdateBatchSize = 100;
+
 struct TrackWithoutCover {
     TrackId trackId;
     QString trackLocation;
@@ -2134,9 +2406,45 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
             "coverart_hash=:coverart_hash "
             "WHERE id=:track_id");
 
+    // The updates are written in batches, each one in a single transaction.
+    // The database is not locked while reading the files.
+    QVector<QPair<TrackId, CoverInfo>> pendingUpdates;
+    pendingUpdates.reserve(kCoverArtUpdateBatchSize);
+    const auto writePendingUpdates = [&]() {
+        if (pendingUpdates.isEmpty()) {
+            return;
+        }
+        SqlTransaction transaction(m_database);
+        QSet<TrackId> updatedTrackIds;
+        for (const auto& [trackId, coverInfo] : std::as_const(pendingUpdates)) {
+            updateQuery.bindValue(":track_id", trackId.toVariant());
+            updateQuery.bindValue(":coverart_type",
+                    static_cast<int>(coverInfo.type));
+            updateQuery.bindValue(":coverart_source",
+                    static_cast<int>(coverInfo.source));
+            updateQuery.bindValue(":coverart_location", coverInfo.coverLocation);
+            updateQuery.bindValue(":coverart_color",
+                    mixxx::RgbColor::toQVariant(coverInfo.color));
+            updateQuery.bindValue(":coverart_digest", coverInfo.imageDigest());
+            updateQuery.bindValue(":coverart_hash", coverInfo.legacyHash());
+
+            if (!updateQuery.exec()) {
+                LOG_FAILED_QUERY(updateQuery) << "failed to write file or none cover";
+            } else {
+                updatedTrackIds.insert(trackId);
+            }
+        }
+        pendingUpdates.clear();
+        if (transaction && !transaction.commit()) {
+            return;
+        }
+        *pTracksChanged += updatedTrackIds;
+    };
+
     CoverInfoGuesser coverInfoGuesser;
     for (const auto& track: tracksWithoutCover) {
         if (*pCancel) {
+            writePendingUpdates();
             return;
         }
 
@@ -2159,22 +2467,12 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
                         embeddedCover);
         DEBUG_ASSERT(coverInfo.source != CoverInfo::UNKNOWN);
 
-        updateQuery.bindValue(":track_id", track.trackId.toVariant());
-        updateQuery.bindValue(":coverart_type",
-                              static_cast<int>(coverInfo.type));
-        updateQuery.bindValue(":coverart_source",
-                              static_cast<int>(coverInfo.source));
-        updateQuery.bindValue(":coverart_location", coverInfo.coverLocation);
-        updateQuery.bindValue(":coverart_color", mixxx::RgbColor::toQVariant(coverInfo.color));
-        updateQuery.bindValue(":coverart_digest", coverInfo.imageDigest());
-        updateQuery.bindValue(":coverart_hash", coverInfo.legacyHash());
-
-        if (!updateQuery.exec()) {
-            LOG_FAILED_QUERY(updateQuery) << "failed to write file or none cover";
-        } else {
-            pTracksChanged->insert(track.trackId);
+        pendingUpdates.append(qMakePair(track.trackId, coverInfo));
+        if (pendingUpdates.size() >= kCoverArtUpdateBatchSize) {
+            writePendingUpdates();
         }
     }
+    writePendingUpdates();
 }
 
 TrackPointer TrackDAO::getOrAddTrack(
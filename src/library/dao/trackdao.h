@@ -1,5 +1,7 @@
 #pragma once
 
+#include <gtest/gtest_prod.h>
+
 #include <QList>
 #include <QObject>
 #include <QSet>
@@ -17,6 +19,7 @@ class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
 class LibraryHashDAO;
+struct ParsedTrack;
 
 namespace mixxx {
 class FileInfo;
@@ -25,6 +28,7 @@ class TrackRecord;
 } // namespace mixxx
 
 class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackCacheRelocator {
+    FRIEND_TEST(TrackDAOTest, addParsedTracks);
     Q_OBJECT
   public:
 
@@ -157,6 +161,14 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
                 mixxx::FileAccess(mixxx::FileInfo(filePath)),
                 unremove);
     }
+    /// Adds the new tracks that have been parsed by the library scanner
+    /// with multi-row inserts into the transaction of addTracksPrepare().
+    /// No Track objects are created, unless a Track object for the same
+    /// file already exists. Returns the ids of the added tracks.
+    QList<TrackId> addTracksAddParsedTracks(
+            const QList<ParsedTrack>& parsedTracks);
+    QList<TrackId> addTracksInsertRows(
+            const QList<const ParsedTrack*>& parsedTracks);
     void addTracksFinish(bool rollback = false);
 
     bool updateTrack(const Track& track) const;
@@ -182,6 +194,7 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     void markTrackLocationsAsVerified(const QStringList& locations) const;
     void markTracksInDirectoriesAsVerified(const QStringList& directories) const;
     void invalidateTrackLocationsInLibrary() const;
+    void invalidateTrackLocationsInDirectories(const QStringList& directories) const;
     void markUnverifiedTracksAsDeleted();
 
     bool verifyRemainingTracks(
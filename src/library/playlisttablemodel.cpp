@@ -265,29 +265,25 @@ void PlaylistTableModel::removeTracks(const QModelIndexList& indices) {
             std::move(trackPositions));
 }
 
-void PlaylistTableModel::moveTrack(const QModelIndex& sourceIndex,
+void PlaylistTableModel::moveTracks(const QModelIndexList& sourceIndices,
         const QModelIndex& destIndex) {
-    int playlistPositionColumn = fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION);
-
-    int newPosition = destIndex.sibling(destIndex.row(), playlistPositionColumn).data().toInt();
-    int oldPosition = sourceIndex.sibling(sourceIndex.row(), playlistPositionColumn).data().toInt();
-
-    if (newPosition > oldPosition) {
-        // new position moves up due to closing the gap of the old position
-        --newPosition;
-    }
+    const int playlistPositionColumn =
+            fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION);
 
-    //qDebug() << "old pos" << oldPosition << "new pos" << newPosition;
-    if (newPosition < 0 || newPosition == oldPosition) {
-        // Invalid for the position to be 0 or less.
-        // or no move at all
-        return;
-    } else if (newPosition == 0) {
-        // Dragged out of bounds, which is past the end of the rows...
-        newPosition = m_pTrackCollectionManager->internalCollection()->getPlaylistDAO().getMaxPosition(m_iPlaylistId);
+    QList<int> oldPositions;
+    oldPositions.reserve(sourceIndices.size());
+    for (const QModelIndex& sourceIndex : sourceIndices) {
+        oldPositions.append(sourceIndex.sibling(sourceIndex.row(), playlistPositionColumn)
+                                    .data()
+                                    .toInt());
     }
+    // An invalid destination yields 0, which appends the tracks
+    const int beforePosition =
+            destIndex.sibling(destIndex.row(), playlistPositionColumn).data().toInt();
 
-    m_pTrackCollectionManager->internalCollection()->getPlaylistDAO().moveTrack(m_iPlaylistId, oldPosition, newPosition);
+    //qDebug() << "old pos" << oldPositions << "before pos" << beforePosition;
+    m_pTrackCollectionManager->internalCollection()->getPlaylistDAO().moveTracks(
+            m_iPlaylistId, oldPositions, beforePosition);
 }
 
 bool PlaylistTableModel::isLocked() {
@@ -19,7 +19,7 @@ class PlaylistTableModel final : public TrackSetTableModel {
     }
 
     bool appendTrack(TrackId trackId);
-    void moveTrack(const QModelIndex& sourceIndex, const QModelIndex& destIndex) override;
+    void moveTracks(const QModelIndexList& sourceIndices, const QModelIndex& destIndex) override;
     void removeTrack(const QModelIndex& index);
     void shuffleTracks(const QModelIndexList& shuffle, const QModelIndex& exclude);
 
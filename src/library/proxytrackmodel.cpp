@@ -124,12 +124,16 @@ void ProxyTrackModel::copyTracks(const QModelIndexList& indices) const {
     }
 }
 
-void ProxyTrackModel::moveTrack(const QModelIndex& sourceIndex,
+void ProxyTrackModel::moveTracks(const QModelIndexList& sourceIndices,
         const QModelIndex& destIndex) {
-    QModelIndex sourceIndexSource = mapToSource(sourceIndex);
+    QModelIndexList sourceIndicesSource;
+    sourceIndicesSource.reserve(sourceIndices.size());
+    for (const QModelIndex& sourceIndex : sourceIndices) {
+        sourceIndicesSource.append(mapToSource(sourceIndex));
+    }
     QModelIndex destIndexSource = mapToSource(destIndex);
     if (m_pTrackModel) {
-        m_pTrackModel->moveTrack(sourceIndexSource, destIndexSource);
+        m_pTrackModel->moveTracks(sourceIndicesSource, destIndexSource);
     }
 }
 
@@ -37,7 +37,7 @@ class ProxyTrackModel : public QSortFilterProxyModel, public TrackModel {
     bool isColumnHiddenByDefault(int column) final;
     void removeTracks(const QModelIndexList& indices) final;
     void copyTracks(const QModelIndexList& indices) const final;
-    void moveTrack(const QModelIndex& sourceIndex, const QModelIndex& destIndex) final;
+    void moveTracks(const QModelIndexList& sourceIndices, const QModelIndex& destIndex) final;
     QAbstractItemDelegate* delegateForColumn(const int i, QObject* pParent) final;
     QString getModelSetting(const QString& name) final;
     bool setModelSetting(const QString& name, const QVariant& value) final;
@@ -22,6 +22,9 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
 
 void ImportFilesTask::run() {
     ScopedTimer timer(QStringLiteral("ImportFilesTask::run"));
+    // The metadata of new tracks is parsed in parallel by the worker
+    // threads and the tracks are added to the database in batches.
+    QList<ParsedTrack> parsedTracks;
     for (const QFileInfo& fileInfo: m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -49,9 +52,17 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit addNewTrack(trackLocation);
+            auto parsedTrack = ParsedTrack::parseFromFile(
+                    mixxx::FileAccess(mixxx::FileInfo(fileInfo), m_pToken),
+                    m_scannerGlobal->syncTrackMetadataParams());
+            if (parsedTrack) {
+                parsedTracks.append(std::move(*parsedTrack));
+            }
         }
     }
+    if (!parsedTracks.isEmpty()) {
+        emit addNewTracks(parsedTracks);
+    }
     // Insert or update the hash in the database.
     emit directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash);
     setSuccess(true);
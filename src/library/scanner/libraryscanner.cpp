@@ -1,8 +1,12 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <algorithm>
+
 #include "library/coverartutils.h"
+#include "library/library_prefs.h"
 #include "library/queryutil.h"
 #include "library/scanner/libraryscannerdlg.h"
+#include "library/scanner/librarywatcher.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/scannertask.h"
 #include "library/scanner/scannerutil.h"
@@ -19,8 +23,8 @@
 
 namespace {
 
-// TODO(rryan) make configurable
-constexpr int kScannerThreadPoolSize = 1;
+// The number of parsed tracks that are added to the database at once
+constexpr int kAddParsedTracksBatchSize = 500;
 
 mixxx::Logger kLogger("LibraryScanner");
 
@@ -98,12 +102,15 @@ LibraryScanner::LibraryScanner(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pConfig(pConfig),
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_watchDirectories(pConfig->getValue(
+                  mixxx::library::prefs::kWatchDirectoriesConfigKey, false)) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     moveToThread(this);
@@ -112,7 +119,11 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    // The worker threads parse the metadata of new tracks in parallel,
+    // one thread per core.
+    // TODO(rryan) make configurable
+    m_pool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 1));
+    qRegisterMetaType<QList<ParsedTrack>>();
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
@@ -174,10 +185,24 @@ void LibraryScanner::run() {
         m_analysisDao.initialize(dbConnection);
         m_directoryDao.initialize(dbConnection);
 
+        if (m_watchDirectories) {
+            // Changes while Mixxx was not running are only detected
+            // by a full scan, using the directory hashes
+            m_pWatcher = std::make_unique<LibraryWatcher>();
+            connect(m_pWatcher.get(),
+                    &LibraryWatcher::directoriesChanged,
+                    this,
+                    &LibraryScanner::slotDirectoriesChanged);
+            m_libraryRootDirs = m_directoryDao.loadAllDirectories();
+            updateWatchedDirectories();
+        }
+
         // Start the event loop.
         kLogger.debug() << "Event loop starting";
         exec();
         kLogger.debug() << "Event loop stopped";
+
+        m_pWatcher.reset();
     }
     kLogger.debug() << "Exiting thread";
 }
@@ -186,13 +211,16 @@ void LibraryScanner::slotStartScan() {
     kLogger.debug() << "slotStartScan()";
     DEBUG_ASSERT(m_state == STARTING);
 
-    cleanUpDatabase(m_libraryHashDao.database());
+    if (m_changedDirectories.isEmpty()) {
+        cleanUpDatabase(m_libraryHashDao.database());
+    }
 
     // Recursively scan each directory in the directories table.
     m_libraryRootDirs = m_directoryDao.loadAllDirectories();
     // If there are no directories then we have nothing to do. Cleanup and
     // finish the scan immediately.
     if (m_libraryRootDirs.isEmpty()) {
+        m_changedDirectories.clear();
         changeScannerState(IDLE);
         return;
     }
@@ -207,23 +235,31 @@ void LibraryScanner::slotStartScan() {
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
+            new ScannerGlobal(trackLocations,
+                    directoryHashes,
+                    extensionFilter,
+                    coverExtensionFilter,
+                    directoryBlacklist,
+                    SyncTrackMetadataParams::readFromUserSettings(*m_pConfig)));
 
     m_scannerGlobal->startTimer();
 
     emit scanStarted();
 
-    // First, we're going to mark all the directories that we've previously
-    // hashed as needing verification. As we search through the directory tree
-    // when we rescan, we'll mark any directory that does still exist as
-    // verified.
-    m_libraryHashDao.invalidateAllDirectories();
-
-    // Mark all the tracks in the library as needing verification of their
-    // existence. (ie. we want to check they're still on your hard drive where
-    // we think they are)
-    m_trackDao.invalidateTrackLocationsInLibrary();
+    if (m_changedDirectories.isEmpty()) {
+        // First, we're going to mark all the directories that we've previously
+        // hashed as needing verification. As we search through the directory tree
+        // when we rescan, we'll mark any directory that does still exist as
+        // verified.
+        m_libraryHashDao.invalidateAllDirectories();
+
+        // Mark all the tracks in the library as needing verification of their
+        // existence. (ie. we want to check they're still on your hard drive where
+        // we think they are)
+        m_trackDao.invalidateTrackLocationsInLibrary();
+    } else {
+        invalidateChangedDirectories();
+    }
 
     kLogger.debug() << "Recursively scanning library.";
 
@@ -245,6 +281,38 @@ void LibraryScanner::slotStartScan() {
             this,
             &LibraryScanner::slotFinishHashedScan);
 
+    if (!m_changedDirectories.isEmpty()) {
+        kLogger.info()
+                << "Scanning" << m_changedDirectories.size()
+                << "changed directories";
+        // Scan only the entries of the changed directories, new
+        // subdirectories are scanned recursively
+        for (const auto& directory : std::as_const(m_changedDirectories)) {
+            const mixxx::FileInfo dirInfo(directory);
+            if (!dirInfo.isDir()) {
+                // Deleted
+                continue;
+            }
+            for (const mixxx::FileInfo& rootDir : std::as_const(m_libraryRootDirs)) {
+                const QString rootLocation = rootDir.location();
+                if (directory != rootLocation &&
+                        !directory.startsWith(rootLocation + QChar('/'))) {
+                    continue;
+                }
+                if (!m_scannerGlobal->testAndMarkDirectoryScanned(dirInfo.toQDir())) {
+                    queueTask(new RecursiveScanDirectoryTask(this,
+                            m_scannerGlobal,
+                            mixxx::FileAccess(dirInfo, mixxx::FileAccess(rootDir).token()),
+                            true,
+                            false));
+                }
+                break;
+            }
+        }
+        pWatcher->taskDone();
+        return;
+    }
+
     for (const mixxx::FileInfo& rootDir : std::as_const(m_libraryRootDirs)) {
         // Acquire a security bookmark for this directory if we are in a
         // sandbox. For speed we avoid opening security bookmarks when recursive
@@ -257,7 +325,7 @@ void LibraryScanner::slotStartScan() {
         auto dirAccess = mixxx::FileAccess(rootDir);
         if (!m_scannerGlobal->testAndMarkDirectoryScanned(rootDir.toQDir())) {
             queueTask(new RecursiveScanDirectoryTask(
-                    this, m_scannerGlobal, std::move(dirAccess), false));
+                    this, m_scannerGlobal, std::move(dirAccess), false, true));
         }
     }
     pWatcher->taskDone();
@@ -296,7 +364,7 @@ void LibraryScanner::slotFinishHashedScan() {
         // no testAndMarkDirectoryScanned() here, because all unhashedDirs()
         // are already tracked
         queueTask(new RecursiveScanDirectoryTask(
-                this, m_scannerGlobal, std::move(dirAccess), true));
+                this, m_scannerGlobal, std::move(dirAccess), true, true));
     }
     pWatcher->taskDone();
 }
@@ -402,6 +470,8 @@ void LibraryScanner::slotFinishUnhashedScan() {
         kLogger.debug() << "Recursive scanning interrupted by the user";
     }
 
+    addParsedTracks();
+
     // Finish adding the tracks -- rollback the transaction if the scan did not
     // finish cleanly and the user did not cancel the transaction.
     m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
@@ -411,7 +481,8 @@ void LibraryScanner::slotFinishUnhashedScan() {
         cleanUpScan();
     }
 
-    if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
+    if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly &&
+            m_changedDirectories.isEmpty()) {
         const auto dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
         updateQueryPlannerStatisticsForDatabase(dbConnection);
     }
@@ -434,11 +505,73 @@ void LibraryScanner::slotFinishUnhashedScan() {
             static_cast<int>(m_scannerGlobal->verifiedTracks().size()),
             static_cast<int>(m_scannerGlobal->addedTracks().size()));
 
+    const bool finishedCleanly = !m_scannerGlobal->shouldCancel() && bScanFinishedCleanly;
     m_scannerGlobal.clear();
+    m_changedDirectories.clear();
     changeScannerState(FINISHED);
     // now we may accept new scan commands
 
     emit scanFinished();
+
+    if (m_pWatcher) {
+        if (finishedCleanly) {
+            updateWatchedDirectories();
+        }
+        if (!m_pendingChangedDirectories.isEmpty()) {
+            const QStringList directories = m_pendingChangedDirectories.values();
+            m_pendingChangedDirectories.clear();
+            slotDirectoriesChanged(directories);
+        }
+    }
+}
+
+void LibraryScanner::slotDirectoriesChanged(const QStringList& directories) {
+    if (!changeScannerState(STARTING)) {
+        // Rescanned after the current scan has finished
+        for (const auto& directory : directories) {
+            m_pendingChangedDirectories.insert(directory);
+        }
+        return;
+    }
+    DEBUG_ASSERT(m_changedDirectories.isEmpty());
+    m_changedDirectories = directories;
+    slotStartScan();
+}
+
+void LibraryScanner::invalidateChangedDirectories() {
+    QStringList invalidatedDirectories = m_changedDirectories;
+    // Only the parent of a deleted or renamed directory is reported as
+    // changed. Its subdirectories are gone, too.
+    const QStringList knownDirectories = m_libraryHashDao.getDirectoryHashes().keys();
+    QStringList deletedDirectories;
+    for (const auto& directory : std::as_const(m_changedDirectories)) {
+        const QString prefix = directory + QChar('/');
+        for (const auto& knownDirectory : knownDirectories) {
+            if (knownDirectory.startsWith(prefix) &&
+                    knownDirectory.indexOf(QChar('/'), prefix.size()) < 0 &&
+                    !QFileInfo::exists(knownDirectory)) {
+                deletedDirectories.append(knownDirectory);
+            }
+        }
+    }
+    for (const auto& deletedDirectory : std::as_const(deletedDirectories)) {
+        invalidatedDirectories.append(deletedDirectory);
+        const QString prefix = deletedDirectory + QChar('/');
+        for (const auto& knownDirectory : knownDirectories) {
+            if (knownDirectory.startsWith(prefix)) {
+                invalidatedDirectories.append(knownDirectory);
+            }
+        }
+    }
+    invalidatedDirectories.removeDuplicates();
+    m_libraryHashDao.updateDirectoryStatuses(invalidatedDirectories, false, false);
+    m_trackDao.invalidateTrackLocationsInDirectories(invalidatedDirectories);
+}
+
+void LibraryScanner::updateWatchedDirectories() {
+    DEBUG_ASSERT(m_pWatcher);
+    m_pWatcher->setDirectories(m_libraryRootDirs,
+            m_libraryHashDao.getDirectoryHashes().keys());
 }
 
 void LibraryScanner::scan() {
@@ -511,9 +644,9 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             this,
             &LibraryScanner::slotTrackExists);
     connect(pTask,
-            &ScannerTask::addNewTrack,
+            &ScannerTask::addNewTracks,
             this,
-            &LibraryScanner::slotAddNewTrack);
+            &LibraryScanner::slotAddNewTracks);
 
     // Progress signals.
     // Pass directly to the main thread
@@ -566,36 +699,51 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
-    //kLogger.debug() << "slotAddNewTrack" << trackPath;
-    ScopedTimer timer(QStringLiteral("LibraryScanner::addNewTrack"));
+void LibraryScanner::slotAddNewTracks(const QList<ParsedTrack>& parsedTracks) {
+    //kLogger.debug() << "slotAddNewTracks" << parsedTracks.size();
+    if (!m_scannerGlobal) {
+        // The scan has already been finished or canceled
+        return;
+    }
+    m_parsedTracks += parsedTracks;
+    if (m_parsedTracks.size() >= kAddParsedTracksBatchSize) {
+        addParsedTracks();
+    }
+}
+
+void LibraryScanner::addParsedTracks() {
+    if (m_parsedTracks.isEmpty()) {
+        return;
+    }
+    ScopedTimer timer(QStringLiteral("LibraryScanner::addParsedTracks"));
+    const QList<TrackId> addedTrackIds =
+            m_trackDao.addTracksAddParsedTracks(m_parsedTracks);
+    if (addedTrackIds.size() < m_parsedTracks.size()) {
+        kLogger.warning()
+                << "Failed to add"
+                << m_parsedTracks.size() - addedTrackIds.size()
+                << "of" << m_parsedTracks.size()
+                << "track(s) to library";
+    }
     // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack = m_trackDao.addTracksAddFile(
-            trackPath,
-            false);
-    if (pTrack) {
-        DEBUG_ASSERT(!pTrack->isDirty());
-        // The track's actual location might differ from the
-        // given trackPath
-        const QString trackLocation(pTrack->getLocation());
-        // Acknowledge successful track addition
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackLocation);
+    if (m_scannerGlobal) {
+        for (const auto& parsedTrack : std::as_const(m_parsedTracks)) {
+            // TODO(XXX): Is it really intended to acknowledge a failed
+            // track addition like a successful one??
+            m_scannerGlobal->trackAdded(parsedTrack.fileAccess.info().location());
         }
-        // Signal the main instance of TrackDAO, that there is
-        // a new track in the database.
-        emit trackAdded(pTrack);
-        emit progressLoading(trackLocation);
-    } else {
-        // Acknowledge failed track addition
-        // TODO(XXX): Is it really intended to acknowledge a failed
-        // track addition with a trackAdded() signal??
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackPath);
+    }
+    emit progressLoading(m_parsedTracks.last().fileAccess.info().location());
+    m_parsedTracks.clear();
+    if (!addedTrackIds.isEmpty()) {
+        // Signal the main instance of TrackDAO, that there are
+        // new tracks in the database.
+        QSet<TrackId> trackIds;
+        trackIds.reserve(addedTrackIds.size());
+        for (const auto& trackId : addedTrackIds) {
+            trackIds.insert(trackId);
         }
-        kLogger.warning()
-                << "Failed to add track to library:"
-                << trackPath;
+        emit tracksAdded(trackIds);
     }
 }
 
@@ -7,6 +7,7 @@
 #include <QSemaphore>
 #include <QThread>
 #include <QThreadPool>
+#include <memory>
 
 #include "library/dao/analysisdao.h"
 #include "library/dao/cuedao.h"
@@ -14,12 +15,14 @@
 #include "library/dao/libraryhashdao.h"
 #include "library/dao/playlistdao.h"
 #include "library/dao/trackdao.h"
+#include "library/scanner/parsedtrack.h"
 #include "library/scanner/scannerglobal.h"
 #include "track/track_decl.h"
 #include "util/db/dbconnectionpool.h"
 
 class ScannerTask;
 class LibraryScannerDlg;
+class LibraryWatcher;
 class QString;
 
 class LibraryScanner : public QThread {
@@ -45,7 +48,7 @@ class LibraryScanner : public QThread {
     void progressHashing(const QString&);
     void progressLoading(const QString& path);
     void progressCoverArt(const QString& file);
-    void trackAdded(TrackPointer pTrack);
+    void tracksAdded(const QSet<TrackId>& addedTrackIds);
     void tracksChanged(const QSet<TrackId>& changedTrackIds);
     void tracksRelocated(const QList<RelocatedTrack>& relocatedTracks);
 
@@ -64,12 +67,16 @@ class LibraryScanner : public QThread {
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
 
+    // Rescans only the changed directories, after the current scan if
+    // a scan is in progress.
+    void slotDirectoriesChanged(const QStringList& directories);
+
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
                                    bool newDirectory, mixxx::cache_key_t hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotAddNewTracks(const QList<ParsedTrack>& parsedTracks);
 
   private:
     enum ScannerState {
@@ -95,8 +102,18 @@ class LibraryScanner : public QThread {
 
     void cleanUpScan();
 
+    // Adds the buffered new tracks to the database
+    void addParsedTracks();
+
+    // Marks the tracks and hashes of the changed directories and of their
+    // deleted subdirectories as needing verification.
+    void invalidateChangedDirectories();
+    void updateWatchedDirectories();
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
+    const UserSettingsPointer m_pConfig;
+
     // The pool of threads used for worker tasks.
     QThreadPool m_pool;
 
@@ -111,6 +128,10 @@ class LibraryScanner : public QThread {
     // Global scanner state for scan currently in progress.
     ScannerGlobalPointer m_scannerGlobal;
 
+    // The new tracks that have been parsed by the worker threads
+    // and are added to the database in batches.
+    QList<ParsedTrack> m_parsedTracks;
+
     // The Semaphore guards the state transitions queued to the
     // Qt even Queue in the way, that you cannot start a
     // new scan while the old one is canceled
@@ -120,4 +141,13 @@ class LibraryScanner : public QThread {
 
     QList<mixxx::FileInfo> m_libraryRootDirs;
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
+
+    // Only accessed from the LibraryScanner thread
+    const bool m_watchDirectories;
+    std::unique_ptr<LibraryWatcher> m_pWatcher;
+    // The directories of the incremental scan in progress. The whole
+    // library is scanned if empty.
+    QStringList m_changedDirectories;
+    // The directories that have changed during a scan
+    QSet<QString> m_pendingChangedDirectories;
 };
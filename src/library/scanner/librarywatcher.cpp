@@ -0,0 +1,178 @@
+#include "library/scanner/librarywatcher.h"
+
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <algorithm>
+
+#include "moc_librarywatcher.cpp"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryWatcher");
+
+bool isNetworkFileSystem(const QString& path) {
+    const QByteArray type = QStorageInfo(path).fileSystemType();
+    return type.startsWith("nfs") ||
+            type.startsWith("smb") ||
+            type.startsWith("fuse.") ||
+            type == "cifs" ||
+            type == "9p" ||
+            type == "afpfs" ||
+            type == "webdav";
+}
+
+bool isSameOrSubdirectory(const QString& directory, const QString& rootDirectory) {
+    return directory.startsWith(rootDirectory) &&
+            (directory.size() == rootDirectory.size() ||
+                    directory.at(rootDirectory.size()) == QChar('/'));
+}
+
+} // anonymous namespace
+
+LibraryWatcher::LibraryWatcher(QObject* pParent)
+        : QObject(pParent),
+          m_fileSystemWatcher(this),
+          m_pollTimer(this),
+          m_settleTimer(this) {
+    connect(&m_fileSystemWatcher,
+            &QFileSystemWatcher::directoryChanged,
+            this,
+            &LibraryWatcher::slotDirectoryChanged);
+
+    m_pollTimer.setInterval(kPollInterval.toIntegerMillis());
+    connect(&m_pollTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::pollDirectories);
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(kSettleDelay.toIntegerMillis());
+    connect(&m_settleTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::reportChangedDirectories);
+}
+
+void LibraryWatcher::setDirectories(
+        const QList<mixxx::FileInfo>& rootDirs,
+        const QStringList& directories) {
+    QStringList polledRootDirs;
+    for (const auto& rootDir : rootDirs) {
+        if (isNetworkFileSystem(rootDir.location())) {
+            polledRootDirs.append(rootDir.location());
+        }
+    }
+
+    QSet<QString> directoriesToWatch;
+    QHash<QString, DirectoryState> polledDirectories;
+    for (const auto& directory : directories) {
+        const bool polled = std::any_of(polledRootDirs.cbegin(),
+                polledRootDirs.cend(),
+                [&directory](const QString& rootDir) {
+                    return isSameOrSubdirectory(directory, rootDir);
+                });
+        if (polled) {
+            // Keep the previous state to not miss any changes in between
+            const auto it = m_polledDirectories.constFind(directory);
+            polledDirectories.insert(directory,
+                    it != m_polledDirectories.constEnd()
+                            ? it.value()
+                            : readDirectoryState(directory));
+        } else {
+            directoriesToWatch.insert(directory);
+        }
+    }
+
+    const QStringList watchedDirectories = m_fileSystemWatcher.directories();
+    QSet<QString> watchedDirectorySet;
+    QStringList pathsToRemove;
+    for (const auto& directory : watchedDirectories) {
+        watchedDirectorySet.insert(directory);
+        if (!directoriesToWatch.contains(directory)) {
+            pathsToRemove.append(directory);
+        }
+    }
+    QStringList pathsToAdd;
+    for (const auto& directory : std::as_const(directoriesToWatch)) {
+        if (!watchedDirectorySet.contains(directory)) {
+            pathsToAdd.append(directory);
+        }
+    }
+    if (!pathsToRemove.isEmpty()) {
+        m_fileSystemWatcher.removePaths(pathsToRemove);
+    }
+    if (!pathsToAdd.isEmpty()) {
+        const QStringList failedPaths = m_fileSystemWatcher.addPaths(pathsToAdd);
+        for (const auto& directory : failedPaths) {
+            polledDirectories.insert(directory, readDirectoryState(directory));
+        }
+    }
+
+    m_polledDirectories = std::move(polledDirectories);
+    if (m_polledDirectories.isEmpty()) {
+        m_pollTimer.stop();
+    } else if (!m_pollTimer.isActive()) {
+        m_pollTimer.start();
+    }
+    kLogger.info()
+            << "Watching" << numWatchedDirectories() << "and polling"
+            << numPolledDirectories() << "directories";
+}
+
+// static
+LibraryWatcher::DirectoryState LibraryWatcher::readDirectoryState(
+        const QString& directory) {
+    const QFileInfo fileInfo(directory);
+    if (!fileInfo.isDir()) {
+        return DirectoryState{false, QDateTime(), 0};
+    }
+    return DirectoryState{true, fileInfo.lastModified(), fileInfo.size()};
+}
+
+void LibraryWatcher::pollDirectories() {
+    for (auto it = m_polledDirectories.begin(); it != m_polledDirectories.end();) {
+        const DirectoryState state = readDirectoryState(it.key());
+        if (state == it.value()) {
+            ++it;
+            continue;
+        }
+        journalChange(it.key());
+        if (!state.exists) {
+            it = m_polledDirectories.erase(it);
+            continue;
+        }
+        it.value() = state;
+        ++it;
+    }
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& directory) {
+    journalChange(directory);
+}
+
+void LibraryWatcher::journalChange(const QString& directory) {
+    if (m_changedDirectories.isEmpty()) {
+        m_firstChangeTimer.start();
+    }
+    m_changedDirectories.insert(directory);
+    if (m_firstChangeTimer.elapsed() >= kMaxDelay) {
+        reportChangedDirectories();
+        return;
+    }
+    // Restarted by every change until the changes have settled
+    m_settleTimer.start();
+}
+
+void LibraryWatcher::reportChangedDirectories() {
+    m_settleTimer.stop();
+    if (m_changedDirectories.isEmpty()) {
+        return;
+    }
+    const QStringList changedDirectories = m_changedDirectories.values();
+    m_changedDirectories.clear();
+    kLogger.debug()
+            << "Changed directories:"
+            << changedDirectories;
+    emit directoriesChanged(changedDirectories);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include "util/duration.h"
+#include "util/fileinfo.h"
+#include "util/performancetimer.h"
+
+/// Watches the directories of the library for changes, so only the changed
+/// directories need to be rescanned instead of walking the whole library.
+///
+/// Directories on local file systems are watched by the operating system,
+/// i.e. inotify on Linux. Network file systems don't report the changes of
+/// other clients, so the directories below a root directory on a network
+/// file system are polled by comparing their modification time and size.
+///
+/// The changed directories are journaled and reported after the changes
+/// have settled, e.g. after all files of an album have been copied.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    static constexpr mixxx::Duration kSettleDelay = mixxx::Duration::fromSeconds(2);
+    /// Continuous changes are reported at least this often
+    static constexpr mixxx::Duration kMaxDelay = mixxx::Duration::fromSeconds(30);
+    static constexpr mixxx::Duration kPollInterval = mixxx::Duration::fromSeconds(60);
+
+    explicit LibraryWatcher(QObject* pParent = nullptr);
+    ~LibraryWatcher() override = default;
+
+    /// Replaces the watched directories, which are the locations of all
+    /// directories below the root directories of the library.
+    void setDirectories(
+            const QList<mixxx::FileInfo>& rootDirs,
+            const QStringList& directories);
+
+    int numWatchedDirectories() const {
+        return static_cast<int>(m_fileSystemWatcher.directories().size());
+    }
+    int numPolledDirectories() const {
+        return static_cast<int>(m_polledDirectories.size());
+    }
+
+    /// Checks the polled directories for changes. Called by the poll timer.
+    void pollDirectories();
+
+    /// Reports the journaled changes immediately. Called by the settle
+    /// timer.
+    void reportChangedDirectories();
+
+  signals:
+    /// The locations of the directories whose entries have changed or
+    /// that have been deleted.
+    void directoriesChanged(const QStringList& directories);
+
+  private:
+    struct DirectoryState {
+        bool exists;
+        QDateTime lastModified;
+        qint64 size;
+
+        bool operator==(const DirectoryState& other) const {
+            return exists == other.exists &&
+                    lastModified == other.lastModified &&
+                    size == other.size;
+        }
+        bool operator!=(const DirectoryState& other) const {
+            return !(*this == other);
+        }
+    };
+    static DirectoryState readDirectoryState(const QString& directory);
+
+    void slotDirectoryChanged(const QString& directory);
+    void journalChange(const QString& directory);
+
+    QFileSystemWatcher m_fileSystemWatcher;
+
+    QHash<QString, DirectoryState> m_polledDirectories;
+    QTimer m_pollTimer;
+
+    // The journal of changed directories since they have been reported
+    QSet<QString> m_changedDirectories;
+    PerformanceTimer m_firstChangeTimer;
+    QTimer m_settleTimer;
+};
@@ -0,0 +1,50 @@
+#include "library/scanner/parsedtrack.h"
+
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ParsedTrack");
+
+} // anonymous namespace
+
+// static
+std::optional<ParsedTrack> ParsedTrack::parseFromFile(
+        mixxx::FileAccess fileAccess,
+        const SyncTrackMetadataParams& syncParams) {
+    if (!SoundSourceProxy::isFileSupported(fileAccess.info())) {
+        kLogger.warning()
+                << "Unsupported file type"
+                << fileAccess.info().location();
+        return std::nullopt;
+    }
+
+    // The temporary track object is neither added to GlobalTrackCache
+    // nor shared with other threads. It only applies the rules for
+    // importing the metadata of new tracks from the file.
+    const auto pTrack = Track::newTemporary(fileAccess);
+    SoundSourceProxy(pTrack).updateTrackFromSource(
+            SoundSourceProxy::UpdateTrackFromSourceMode::Once,
+            syncParams);
+    if (!pTrack->checkSourceSynchronized()) {
+        kLogger.warning()
+                << "Failed to parse track metadata from file"
+                << fileAccess.info().location();
+        // Continue with adding the track to the library, no matter
+        // if parsing the metadata from file succeeded or failed.
+    }
+
+    ParsedTrack parsedTrack;
+    parsedTrack.fileAccess = std::move(fileAccess);
+    parsedTrack.record = pTrack->getRecord();
+    parsedTrack.pBeats = pTrack->getBeats();
+    const auto sampleRate = pTrack->getSampleRate();
+    const QList<CuePointer> cuePoints = pTrack->getCuePoints();
+    parsedTrack.cueInfos.reserve(cuePoints.size());
+    for (const auto& pCue : cuePoints) {
+        parsedTrack.cueInfos.append(pCue->getCueInfo(sampleRate));
+    }
+    return parsedTrack;
+}
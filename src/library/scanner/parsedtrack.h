@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QList>
+#include <QMetaType>
+#include <optional>
+
+#include "track/beats.h"
+#include "track/cueinfo.h"
+#include "track/track_decl.h"
+#include "track/trackrecord.h"
+#include "util/fileaccess.h"
+
+/// The properties of a new track that have been parsed from its file
+/// by a worker thread of the library scanner.
+///
+/// Unlike a Track object it is a plain value that is neither managed
+/// by GlobalTrackCache nor bound to a thread. The rows are written into
+/// the database in batches and the Track object is only created when
+/// the track is loaded from the database.
+struct ParsedTrack {
+    /// Parses the metadata, cover art, beats and cues from the file
+    /// with the same rules as for new tracks that are added one by one.
+    ///
+    /// This function is thread-safe and can be invoked from any thread.
+    /// Returns std::nullopt if the file type is not supported.
+    static std::optional<ParsedTrack> parseFromFile(
+            mixxx::FileAccess fileAccess,
+            const SyncTrackMetadataParams& syncParams);
+
+    mixxx::FileAccess fileAccess;
+    mixxx::TrackRecord record;
+    mixxx::BeatsPointer pBeats;
+    QList<mixxx::CueInfo> cueInfos;
+};
+
+Q_DECLARE_METATYPE(ParsedTrack);
@@ -13,10 +13,12 @@ RecursiveScanDirectoryTask::RecursiveScanDirectoryTask(
         LibraryScanner* pScanner,
         const ScannerGlobalPointer& scannerGlobal,
         const mixxx::FileAccess&& dirAccess,
-        bool scanUnhashed)
+        bool scanUnhashed,
+        bool recursive)
         : ScannerTask(pScanner, scannerGlobal),
           m_dirAccess(std::move(dirAccess)),
-          m_scanUnhashed(scanUnhashed) {
+          m_scanUnhashed(scanUnhashed),
+          m_recursive(recursive) {
 }
 
 void RecursiveScanDirectoryTask::run() {
@@ -117,6 +119,12 @@ void RecursiveScanDirectoryTask::run() {
 
     // Process all of the sub-directories.
     for (const mixxx::FileInfo& dirInfo : dirsToScan) {
+        if (!m_recursive &&
+                mixxx::isValidCacheKey(m_scannerGlobal->directoryHashInDatabase(
+                        dirInfo.location()))) {
+            // Unchanged subdirectory
+            continue;
+        }
         // Atomically test and mark the directory as scanned to avoid
         // that the same directory is scanned multiple times by different
         // tasks.
@@ -126,7 +134,10 @@ void RecursiveScanDirectoryTask::run() {
                             m_pScanner,
                             m_scannerGlobal,
                             mixxx::FileAccess(dirInfo, m_dirAccess.token()),
-                            m_scanUnhashed));
+                            m_scanUnhashed,
+                            // New subdirectories of a changed directory
+                            // are scanned entirely
+                            true));
         }
     }
     setSuccess(true);
@@ -8,13 +8,17 @@
 /// performing a hash of the directory's file list, and those hashes are stored
 /// in the database. Successful if the scan completed without being
 /// cancelled. False if the scan was cancelled part-way through.
+///
+/// If not recursive, only the subdirectories without a hash are scanned,
+/// i.e. the new ones.
 class RecursiveScanDirectoryTask : public ScannerTask {
     Q_OBJECT
   public:
     RecursiveScanDirectoryTask(LibraryScanner* pScanner,
             const ScannerGlobalPointer& scannerGlobal,
             const mixxx::FileAccess&& dirAccess,
-            bool scanUnhashed);
+            bool scanUnhashed,
+            bool recursive);
     ~RecursiveScanDirectoryTask() override = default;
 
     void run() override;
@@ -22,4 +26,5 @@ class RecursiveScanDirectoryTask : public ScannerTask {
   private:
     const mixxx::FileAccess m_dirAccess;
     const bool m_scanUnhashed;
+    const bool m_recursive;
 };
@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QRunnable>
 
+#include "library/scanner/parsedtrack.h"
 #include "library/scanner/scannerglobal.h"
 
 class LibraryScanner;
@@ -23,7 +24,7 @@ class ScannerTask : public QObject, public QRunnable {
                                    bool newDirectory, mixxx::cache_key_t hash);
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    void addNewTracks(const QList<ParsedTrack>& parsedTracks);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
@@ -1,9 +1,11 @@
 #include "library/searchquery.h"
 
 #include <QRegularExpression>
+#include <limits>
 
 #include "library/dao/trackschema.h"
 #include "library/queryutil.h"
+#include "library/searchquerycompiler.h"
 #include "library/trackset/crate/crateschema.h"
 #include "library/trackset/crate/cratestorage.h" // for CrateTrackSelectResult
 #include "track/keyutils.h"
@@ -15,6 +17,8 @@ namespace {
 
 constexpr double kLibraryRoundRange = 0.05;
 
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
 const QRegularExpression kDurationRegex(QStringLiteral("^(\\d+)(m|:)?([0-5]?\\d)?s?$"));
 
 // The ordering of operator alternatives separated by '|' is crucial to avoid incomplete
@@ -100,6 +104,86 @@ QString concatSqlClauses(
     }
 }
 
+// Compiles all nodes that don't evaluate to an empty SQL clause
+CompileResult compileNodes(const std::vector<std::unique_ptr<QueryNode>>& nodes,
+        SearchQueryCompiler* pCompiler,
+        bool negated,
+        int* pNumEmitted) {
+    *pNumEmitted = 0;
+    for (const auto& pNode : nodes) {
+        const CompileResult result = negated
+                ? pNode->compileNegated(pCompiler)
+                : pNode->compile(pCompiler);
+        switch (result) {
+        case CompileResult::Unsupported:
+            return CompileResult::Unsupported;
+        case CompileResult::Empty:
+            break;
+        case CompileResult::Emitted:
+            ++*pNumEmitted;
+            break;
+        }
+    }
+    return *pNumEmitted > 0 ? CompileResult::Emitted : CompileResult::Empty;
+}
+
+// Negates the result of a node whose SQL expression never evaluates to
+// NULL, e.g. IS NULL or IN.
+CompileResult negateNullSafe(SearchQueryCompiler* pCompiler, CompileResult result) {
+    if (result == CompileResult::Emitted) {
+        pCompiler->emitNot();
+    }
+    return result;
+}
+
+// The comparisons of a column that is NULL evaluate to NULL. Their negation
+// must not select the row either, so it is added to the selection of the
+// comparisons on top of the stack before the result is inverted.
+void emitNumericNullGuard(SearchQueryCompiler* pCompiler, int column, bool negated) {
+    if (negated) {
+        pCompiler->emitNumericNull(column);
+        pCompiler->emitOr(2);
+    }
+}
+
+// Emits the comparison of all columns with the same numeric operator,
+// combined with OR like in the corresponding SQL clause.
+CompileResult compileNumericOperator(SearchQueryCompiler* pCompiler,
+        const QStringList& sqlColumns,
+        const QString& sqlOperator,
+        double argument,
+        bool negated) {
+    if (sqlColumns.isEmpty()) {
+        return CompileResult::Empty;
+    }
+    for (const auto& sqlColumn : sqlColumns) {
+        const int column = pCompiler->numericColumn(sqlColumn);
+        if (column < 0) {
+            return CompileResult::Unsupported;
+        }
+        if (sqlOperator == "=") {
+            pCompiler->emitNumericRange(column, argument, true, argument, true);
+        } else if (sqlOperator == "<") {
+            pCompiler->emitNumericRange(column, -kInfinity, true, argument, false);
+        } else if (sqlOperator == ">") {
+            pCompiler->emitNumericRange(column, argument, false, kInfinity, true);
+        } else if (sqlOperator == "<=") {
+            pCompiler->emitNumericRange(column, -kInfinity, true, argument, true);
+        } else if (sqlOperator == ">=") {
+            pCompiler->emitNumericRange(column, argument, true, kInfinity, true);
+        } else {
+            DEBUG_ASSERT(!"unsupported operator");
+            return CompileResult::Unsupported;
+        }
+        emitNumericNullGuard(pCompiler, column, negated);
+    }
+    pCompiler->emitOr(static_cast<int>(sqlColumns.size()));
+    if (negated) {
+        pCompiler->emitNot();
+    }
+    return CompileResult::Emitted;
+}
+
 } // namespace
 
 bool AndNode::match(const TrackPointer& pTrack) const {
@@ -125,6 +209,25 @@ QString AndNode::toSql() const {
     return concatSqlClauses(queryFragments, "AND");
 }
 
+CompileResult AndNode::compile(SearchQueryCompiler* pCompiler) const {
+    int numEmitted;
+    const CompileResult result = compileNodes(m_nodes, pCompiler, false, &numEmitted);
+    if (result == CompileResult::Emitted) {
+        pCompiler->emitAnd(numEmitted);
+    }
+    return result;
+}
+
+CompileResult AndNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    // NOT (a AND b) = (NOT a) OR (NOT b), which also holds for NULL
+    int numEmitted;
+    const CompileResult result = compileNodes(m_nodes, pCompiler, true, &numEmitted);
+    if (result == CompileResult::Emitted) {
+        pCompiler->emitOr(numEmitted);
+    }
+    return result;
+}
+
 bool OrNode::match(const TrackPointer& pTrack) const {
     for (const auto& pNode : m_nodes) {
         if (pNode->match(pTrack)) {
@@ -149,6 +252,34 @@ QString OrNode::toSql() const {
     return concatSqlClauses(queryFragments, "OR");
 }
 
+CompileResult OrNode::compile(SearchQueryCompiler* pCompiler) const {
+    if (m_nodes.empty()) {
+        pCompiler->emitNone();
+        return CompileResult::Emitted;
+    }
+    int numEmitted;
+    const CompileResult result = compileNodes(m_nodes, pCompiler, false, &numEmitted);
+    if (result == CompileResult::Emitted) {
+        pCompiler->emitOr(numEmitted);
+    }
+    return result;
+}
+
+CompileResult OrNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    if (m_nodes.empty()) {
+        // NOT (FALSE)
+        pCompiler->emitAll();
+        return CompileResult::Emitted;
+    }
+    // NOT (a OR b) = (NOT a) AND (NOT b), which also holds for NULL
+    int numEmitted;
+    const CompileResult result = compileNodes(m_nodes, pCompiler, true, &numEmitted);
+    if (result == CompileResult::Emitted) {
+        pCompiler->emitAnd(numEmitted);
+    }
+    return result;
+}
+
 bool NotNode::match(const TrackPointer& pTrack) const {
     return !m_pNode->match(pTrack);
 }
@@ -165,6 +296,14 @@ QString NotNode::toSql() const {
     }
 }
 
+CompileResult NotNode::compile(SearchQueryCompiler* pCompiler) const {
+    return m_pNode->compileNegated(pCompiler);
+}
+
+CompileResult NotNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return m_pNode->compile(pCompiler);
+}
+
 TextFilterNode::TextFilterNode(const QSqlDatabase& database,
         const QStringList& sqlColumns,
         const QString& argument,
@@ -226,6 +365,46 @@ QString TextFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+CompileResult TextFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, false);
+}
+
+CompileResult TextFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, true);
+}
+
+CompileResult TextFilterNode::compileFilter(
+        SearchQueryCompiler* pCompiler, bool negated) const {
+    if (m_sqlColumns.isEmpty()) {
+        return CompileResult::Empty;
+    }
+    // The same LIKE pattern as in toSql(), but without SQL escaping
+    QString pattern = m_argument;
+    if (pattern.size() > 0 && pattern[pattern.size() - 1].isSpace()) {
+        pattern.append(kSqlLikeMatchOne);
+    }
+    if (m_matchMode == StringMatch::Contains) {
+        pattern = kSqlLikeMatchAll + pattern + kSqlLikeMatchAll;
+    }
+    for (const auto& sqlColumn : m_sqlColumns) {
+        const int column = pCompiler->textColumn(sqlColumn);
+        if (column < 0) {
+            return CompileResult::Unsupported;
+        }
+        pCompiler->emitTextLike(column, pattern);
+        if (negated) {
+            // NULL LIKE pattern is NULL, see emitNumericNullGuard()
+            pCompiler->emitTextNull(column);
+            pCompiler->emitOr(2);
+        }
+    }
+    pCompiler->emitOr(static_cast<int>(m_sqlColumns.size()));
+    if (negated) {
+        pCompiler->emitNot();
+    }
+    return CompileResult::Emitted;
+}
+
 bool NullOrEmptyTextFilterNode::match(const TrackPointer& pTrack) const {
     if (!m_sqlColumns.isEmpty()) {
         // only use the major column
@@ -246,6 +425,23 @@ QString NullOrEmptyTextFilterNode::toSql() const {
     return QString();
 }
 
+CompileResult NullOrEmptyTextFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    if (m_sqlColumns.isEmpty()) {
+        return CompileResult::Empty;
+    }
+    // only use the major column
+    const int column = pCompiler->textColumn(m_sqlColumns.first());
+    if (column < 0) {
+        return CompileResult::Unsupported;
+    }
+    pCompiler->emitTextEmpty(column);
+    return CompileResult::Emitted;
+}
+
+CompileResult NullOrEmptyTextFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return negateNullSafe(pCompiler, compile(pCompiler));
+}
+
 CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
         const QString& crateNameLike)
         : m_pCrateStorage(pCrateStorage),
@@ -253,7 +449,7 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
           m_matchInitialized(false) {
 }
 
-bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+const std::vector<TrackId>& CrateFilterNode::matchingTrackIds() const {
     if (!m_matchInitialized) {
         CrateTrackSelectResult crateTracks(
                 m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
@@ -264,8 +460,12 @@ bool CrateFilterNode::match(const TrackPointer& pTrack) const {
 
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+    const std::vector<TrackId>& trackIds = matchingTrackIds();
+    return std::binary_search(trackIds.begin(), trackIds.end(), pTrack->getId());
 }
 
 QString CrateFilterNode::toSql() const {
@@ -274,12 +474,21 @@ QString CrateFilterNode::toSql() const {
                     m_crateNameLike));
 }
 
+CompileResult CrateFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    pCompiler->emitTrackIds(matchingTrackIds());
+    return CompileResult::Emitted;
+}
+
+CompileResult CrateFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return negateNullSafe(pCompiler, compile(pCompiler));
+}
+
 NoCrateFilterNode::NoCrateFilterNode(const CrateStorage* pCrateStorage)
         : m_pCrateStorage(pCrateStorage),
           m_matchInitialized(false) {
 }
 
-bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
+const std::vector<TrackId>& NoCrateFilterNode::matchingTrackIds() const {
     if (!m_matchInitialized) {
         TrackSelectResult tracks(
                 m_pCrateStorage->selectAllTracksSorted());
@@ -290,8 +499,12 @@ bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
 
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return !std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
+    const std::vector<TrackId>& trackIds = matchingTrackIds();
+    return !std::binary_search(trackIds.begin(), trackIds.end(), pTrack->getId());
 }
 
 QString NoCrateFilterNode::toSql() const {
@@ -300,6 +513,19 @@ QString NoCrateFilterNode::toSql() const {
                     CrateStorage::formatQueryForTrackIdsWithCrate());
 }
 
+CompileResult NoCrateFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    // The ids of all tracks in any crate
+    pCompiler->emitTrackIds(matchingTrackIds());
+    pCompiler->emitNot();
+    return CompileResult::Emitted;
+}
+
+CompileResult NoCrateFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    // The ids of all tracks in any crate
+    pCompiler->emitTrackIds(matchingTrackIds());
+    return CompileResult::Emitted;
+}
+
 NumericFilterNode::NumericFilterNode(const QStringList& sqlColumns)
         : m_sqlColumns(sqlColumns),
           m_bOperatorQuery(false),
@@ -415,6 +641,59 @@ QString NumericFilterNode::toSql() const {
     return QString();
 }
 
+CompileResult NumericFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, false);
+}
+
+CompileResult NumericFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, true);
+}
+
+CompileResult NumericFilterNode::compileFilter(
+        SearchQueryCompiler* pCompiler, bool negated) const {
+    if (m_bNullQuery) {
+        if (m_sqlColumns.isEmpty()) {
+            return CompileResult::Empty;
+        }
+        // only use the major column
+        const int column = pCompiler->numericColumn(m_sqlColumns.first());
+        if (column < 0) {
+            return CompileResult::Unsupported;
+        }
+        pCompiler->emitNumericNull(column);
+        if (negated) {
+            pCompiler->emitNot();
+        }
+        return CompileResult::Emitted;
+    }
+
+    if (m_bOperatorQuery) {
+        return compileNumericOperator(
+                pCompiler, m_sqlColumns, m_operator, m_dOperatorArgument, negated);
+    }
+
+    if (m_bRangeQuery) {
+        if (m_sqlColumns.isEmpty()) {
+            return CompileResult::Empty;
+        }
+        for (const auto& sqlColumn : m_sqlColumns) {
+            const int column = pCompiler->numericColumn(sqlColumn);
+            if (column < 0) {
+                return CompileResult::Unsupported;
+            }
+            pCompiler->emitNumericRange(column, m_dRangeLow, true, m_dRangeHigh, true);
+            emitNumericNullGuard(pCompiler, column, negated);
+        }
+        pCompiler->emitOr(static_cast<int>(m_sqlColumns.size()));
+        if (negated) {
+            pCompiler->emitNot();
+        }
+        return CompileResult::Emitted;
+    }
+
+    return CompileResult::Empty;
+}
+
 NullNumericFilterNode::NullNumericFilterNode(const QStringList& sqlColumns)
         : m_sqlColumns(sqlColumns) {
 }
@@ -438,6 +717,23 @@ QString NullNumericFilterNode::toSql() const {
     return QString();
 }
 
+CompileResult NullNumericFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    if (m_sqlColumns.isEmpty()) {
+        return CompileResult::Empty;
+    }
+    // only use the major column
+    const int column = pCompiler->numericColumn(m_sqlColumns.first());
+    if (column < 0) {
+        return CompileResult::Unsupported;
+    }
+    pCompiler->emitNumericNull(column);
+    return CompileResult::Emitted;
+}
+
+CompileResult NullNumericFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return negateNullSafe(pCompiler, compile(pCompiler));
+}
+
 DurationFilterNode::DurationFilterNode(
         const QStringList& sqlColumns, const QString& argument)
         : NumericFilterNode(sqlColumns) {
@@ -761,6 +1057,72 @@ QString BpmFilterNode::toSql() const {
     }
 }
 
+CompileResult BpmFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, false);
+}
+
+CompileResult BpmFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    return compileFilter(pCompiler, true);
+}
+
+CompileResult BpmFilterNode::compileFilter(
+        SearchQueryCompiler* pCompiler, bool negated) const {
+    const int column = pCompiler->numericColumn(QStringLiteral("bpm"));
+    if (column < 0) {
+        return CompileResult::Unsupported;
+    }
+    switch (m_matchMode) {
+    case MatchMode::Null: {
+        // bpm IS 0, which is never NULL
+        pCompiler->emitNumericRange(column, 0.0, true, 0.0, true);
+        if (negated) {
+            pCompiler->emitNot();
+        }
+        return CompileResult::Emitted;
+    }
+    case MatchMode::Explicit: {
+        pCompiler->emitNumericRange(column, m_rangeLower, true, m_rangeUpper, false);
+        break;
+    }
+    case MatchMode::ExplicitStrict:
+    case MatchMode::Fuzzy:
+    case MatchMode::Range: {
+        pCompiler->emitNumericRange(column, m_rangeLower, true, m_rangeUpper, true);
+        break;
+    }
+    case MatchMode::HalveDouble: {
+        pCompiler->emitNumericRange(column, m_rangeLower, true, m_rangeUpper, false);
+        pCompiler->emitNumericRange(column, m_bpmHalfLower, true, m_bpmHalfUpper, false);
+        pCompiler->emitNumericRange(column, m_bpmDoubleLower, true, m_bpmDoubleUpper, false);
+        pCompiler->emitOr(3);
+        break;
+    }
+    case MatchMode::HalveDoubleStrict: {
+        pCompiler->emitNumericRange(column, m_rangeLower, true, m_rangeUpper, true);
+        pCompiler->emitNumericRange(column, m_bpmHalfLower, true, m_bpmHalfUpper, true);
+        pCompiler->emitNumericRange(column, m_bpmDoubleLower, true, m_bpmDoubleUpper, true);
+        pCompiler->emitOr(3);
+        break;
+    }
+    case MatchMode::Operator: {
+        return compileNumericOperator(
+                pCompiler, QStringList{QStringLiteral("bpm")}, m_operator, m_bpm, negated);
+    }
+    default: // MatchMode::Invalid
+        // bpm IS NULL
+        pCompiler->emitNumericNull(column);
+        if (negated) {
+            pCompiler->emitNot();
+        }
+        return CompileResult::Emitted;
+    }
+    emitNumericNullGuard(pCompiler, column, negated);
+    if (negated) {
+        pCompiler->emitNot();
+    }
+    return CompileResult::Emitted;
+}
+
 KeyFilterNode::KeyFilterNode(mixxx::track::io::key::ChromaticKey key,
         bool fuzzy) {
     if (fuzzy) {
@@ -782,6 +1144,26 @@ QString KeyFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+CompileResult KeyFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    if (m_matchKeys.isEmpty()) {
+        return CompileResult::Empty;
+    }
+    const int column = pCompiler->numericColumn(QStringLiteral("key_id"));
+    if (column < 0) {
+        return CompileResult::Unsupported;
+    }
+    for (const auto& matchKey : m_matchKeys) {
+        pCompiler->emitNumericRange(column, matchKey, true, matchKey, true);
+    }
+    pCompiler->emitOr(static_cast<int>(m_matchKeys.size()));
+    return CompileResult::Emitted;
+}
+
+CompileResult KeyFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    // key_id IS key
+    return negateNullSafe(pCompiler, compile(pCompiler));
+}
+
 YearFilterNode::YearFilterNode(
         const QStringList& sqlColumns, const QString& argument)
         : NumericFilterNode(sqlColumns, argument) {
@@ -807,3 +1189,15 @@ QString YearFilterNode::toSql() const {
 
     return QString();
 }
+
+CompileResult YearFilterNode::compile(SearchQueryCompiler* pCompiler) const {
+    // The year is stored as text and only its first four characters
+    // are compared, which is left to SQL.
+    Q_UNUSED(pCompiler);
+    return CompileResult::Unsupported;
+}
+
+CompileResult YearFilterNode::compileNegated(SearchQueryCompiler* pCompiler) const {
+    Q_UNUSED(pCompiler);
+    return CompileResult::Unsupported;
+}
@@ -14,6 +14,7 @@
 #include "util/assert.h"
 
 class CrateStorage;
+class SearchQueryCompiler;
 class TrackId;
 
 const QString kMissingFieldSearchTerm = "\"\""; // "" searches for an empty string
@@ -23,6 +24,15 @@ enum class StringMatch {
     Equals,
 };
 
+enum class CompileResult {
+    // The node can only be evaluated with SQL
+    Unsupported,
+    // The node does not restrict the results, i.e. toSql() is empty
+    Empty,
+    // The instructions of the node have been emitted
+    Emitted,
+};
+
 class QueryNode {
   public:
     QueryNode(const QueryNode&) = delete; // prevent copying
@@ -31,6 +41,20 @@ class QueryNode {
     virtual bool match(const TrackPointer& pTrack) const = 0;
     virtual QString toSql() const = 0;
 
+    /// Emits the instructions for evaluating the node on the in-memory
+    /// track index with the same result as toSql().
+    virtual CompileResult compile(SearchQueryCompiler* pCompiler) const {
+        Q_UNUSED(pCompiler);
+        return CompileResult::Unsupported;
+    }
+    /// Emits the instructions for NOT (toSql()). A comparison with a NULL
+    /// column evaluates to NULL in SQL and NOT (NULL) is still NULL, i.e.
+    /// the negation must not select those rows either.
+    virtual CompileResult compileNegated(SearchQueryCompiler* pCompiler) const {
+        Q_UNUSED(pCompiler);
+        return CompileResult::Unsupported;
+    }
+
   protected:
     QueryNode() = default;
 };
@@ -53,12 +77,16 @@ class OrNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 };
 
 class AndNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 };
 
 class NotNode : public QueryNode {
@@ -70,6 +98,8 @@ class NotNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
     std::unique_ptr<QueryNode> m_pNode;
@@ -84,8 +114,12 @@ class TextFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
+    CompileResult compileFilter(SearchQueryCompiler* pCompiler, bool negated) const;
+
     QSqlDatabase m_database;
     QStringList m_sqlColumns;
     QString m_argument;
@@ -102,6 +136,8 @@ class NullOrEmptyTextFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
     QSqlDatabase m_database;
@@ -115,8 +151,12 @@ class CrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
+    const std::vector<TrackId>& matchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
@@ -129,8 +169,12 @@ class NoCrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
+    const std::vector<TrackId>& matchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
@@ -143,6 +187,8 @@ class NumericFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   protected:
     // Single argument constructor for that does not call init()
@@ -156,6 +202,8 @@ class NumericFilterNode : public QueryNode {
 
     virtual double parse(const QString& arg, bool* ok);
 
+    CompileResult compileFilter(SearchQueryCompiler* pCompiler, bool negated) const;
+
     QStringList m_sqlColumns;
     bool m_bOperatorQuery;
     bool m_bNullQuery;
@@ -172,6 +220,8 @@ class NullNumericFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
     QStringList m_sqlColumns;
 };
@@ -213,9 +263,12 @@ class BpmFilterNode : public QueryNode {
     }
 
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
     bool match(const TrackPointer& pTrack) const override;
+    CompileResult compileFilter(SearchQueryCompiler* pCompiler, bool negated) const;
 
     MatchMode m_matchMode;
 
@@ -238,6 +291,8 @@ class KeyFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 
   private:
     QList<mixxx::track::io::key::ChromaticKey> m_matchKeys;
@@ -271,6 +326,8 @@ class YearFilterNode : public NumericFilterNode {
   public:
     YearFilterNode(const QStringList& sqlColumns, const QString& argument);
     QString toSql() const override;
+    CompileResult compile(SearchQueryCompiler* pCompiler) const override;
+    CompileResult compileNegated(SearchQueryCompiler* pCompiler) const override;
 };
 
 #endif /* SEARCHQUERY_H */
@@ -0,0 +1,466 @@
+#include "library/searchquerycompiler.h"
+
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <algorithm>
+
+#include "library/searchquery.h"
+#include "util/assert.h"
+#include "util/db/dbconnection.h"
+#include "util/db/sqllikewildcards.h"
+
+namespace {
+
+// Below these sizes the overhead of dispatching work to the thread
+// pool outweighs the gain.
+constexpr int kMinStringsPerTask = 16384;
+constexpr int kMinBlocksPerTask = 32;
+
+// Invokes function(begin, end) for consecutive ranges that cover [0, count).
+// If count is large enough the ranges are processed concurrently on the
+// global thread pool, with the calling thread taking the first range.
+template<typename Function>
+void forEachRange(int count, int minRangeSize, const Function& function) {
+    QThreadPool* pThreadPool = QThreadPool::globalInstance();
+    const int numRanges = std::min(pThreadPool->maxThreadCount(), count / minRangeSize);
+    if (numRanges <= 1) {
+        function(0, count);
+        return;
+    }
+    const int rangeSize = (count + numRanges - 1) / numRanges;
+    std::vector<QFuture<void>> futures;
+    futures.reserve(numRanges - 1);
+    for (int begin = rangeSize; begin < count; begin += rangeSize) {
+        const int end = std::min(begin + rangeSize, count);
+        futures.push_back(QtConcurrent::run(pThreadPool, [&function, begin, end]() {
+            function(begin, end);
+        }));
+    }
+    function(0, rangeSize);
+    for (auto& future : futures) {
+        future.waitForFinished();
+    }
+}
+
+bool containsWildcards(const QString& pattern, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        const QChar c = pattern[i];
+        // '\0' is the default escape character of our LIKE function
+        if (c == kSqlLikeMatchAll || c == kSqlLikeMatchOne || c.isNull()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Maps the positions of a block onto consecutive rows
+class AllRows {
+  public:
+    int operator()(int position) const {
+        return position;
+    }
+};
+
+// Maps the positions of a block onto a list of rows
+class SelectedRows {
+  public:
+    explicit SelectedRows(const std::vector<int>& rows)
+            : m_rows(rows) {
+    }
+    int operator()(int position) const {
+        return m_rows[position];
+    }
+
+  private:
+    const std::vector<int>& m_rows;
+};
+
+template<typename Block, typename RowMapper, typename Predicate>
+inline void fillBlock(Block* pBlock,
+        const RowMapper& rowMapper,
+        int positionBegin,
+        int positionEnd,
+        Predicate predicate) {
+    pBlock->fill(0);
+    for (int position = positionBegin; position < positionEnd; ++position) {
+        const int bit = position - positionBegin;
+        (*pBlock)[bit / 64] |= static_cast<std::uint64_t>(
+                                       predicate(rowMapper(position)))
+                << (bit % 64);
+    }
+}
+
+// Clears the bits that are not backed by a row
+template<typename Block>
+inline void maskBlock(Block* pBlock, int numRows) {
+    const int numWords = static_cast<int>(pBlock->size());
+    for (int word = numRows / 64; word < numWords; ++word) {
+        const int bits = numRows - word * 64;
+        (*pBlock)[word] &= bits > 0 ? (std::uint64_t(1) << bits) - 1 : 0;
+    }
+}
+
+} // namespace
+
+CompiledSearchQuery::CompiledSearchQuery(const TrackColumnIndex& index)
+        : m_index(index),
+          m_maxStackSize(0) {
+}
+
+CompiledSearchQuery::Selection CompiledSearchQuery::evaluate() {
+    // Resolve the text matchers for all strings of the index at once
+    forEachRange(m_index.stringCount(), kMinStringsPerTask, [this](int begin, int end) {
+        resolveTextMatchers(begin, end);
+    });
+
+    const int numRows = m_index.rowCount();
+    Selection selection((numRows + 63) / 64);
+    const int numBlocks = (numRows + kBlockRows - 1) / kBlockRows;
+    forEachRange(numBlocks, kMinBlocksPerTask, [this, numRows, &selection](int begin, int end) {
+        evaluateBlocks(AllRows(), numRows, begin, end, &selection);
+    });
+    return selection;
+}
+
+std::vector<int> CompiledSearchQuery::filterRows(const std::vector<int>& rows) {
+    resolveTextMatchers(rows);
+
+    const int numPositions = static_cast<int>(rows.size());
+    Selection selection((numPositions + 63) / 64);
+    const int numBlocks = (numPositions + kBlockRows - 1) / kBlockRows;
+    const SelectedRows rowMapper(rows);
+    forEachRange(numBlocks,
+            kMinBlocksPerTask,
+            [this, &rowMapper, numPositions, &selection](int begin, int end) {
+                evaluateBlocks(rowMapper, numPositions, begin, end, &selection);
+            });
+
+    std::vector<int> filteredRows;
+    for (int position = 0; position < numPositions; ++position) {
+        if (isSelected(selection, position)) {
+            filteredRows.push_back(rows[position]);
+        }
+    }
+    return filteredRows;
+}
+
+bool CompiledSearchQuery::matchText(const TextMatcher& matcher, int stringId) const {
+    const QString& string = m_index.foldedString(stringId);
+    switch (matcher.mode) {
+    case TextMatcher::Mode::Contains:
+        return string.contains(matcher.argument);
+    case TextMatcher::Mode::Equals:
+        return string == matcher.argument;
+    case TextMatcher::Mode::Like: {
+        QString likePattern = matcher.pattern;
+        QString likeString = string;
+        return mixxx::DbConnection::likeCompareLatinLow(
+                &likePattern, &likeString, QChar());
+    }
+    }
+    return false;
+}
+
+void CompiledSearchQuery::resolveTextMatchers(int beginStringId, int endStringId) {
+    // Only called for disjunct ranges concurrently, the vectors have
+    // already been sized on construction.
+    for (auto& matcher : m_textMatchers) {
+        for (int stringId = beginStringId; stringId < endStringId; ++stringId) {
+            if (!matcher.resolved[stringId]) {
+                matcher.matches[stringId] = matchText(matcher, stringId);
+                matcher.resolved[stringId] = 1;
+            }
+        }
+    }
+}
+
+void CompiledSearchQuery::resolveTextMatchers(const std::vector<int>& rows) {
+    for (const auto& instruction : m_program) {
+        if (instruction.opCode != OpCode::TextMatch) {
+            continue;
+        }
+        TextMatcher& matcher = m_textMatchers[instruction.operand];
+        for (const int row : rows) {
+            const int stringId = m_index.stringId(row, instruction.column);
+            if (!matcher.resolved[stringId]) {
+                matcher.matches[stringId] = matchText(matcher, stringId);
+                matcher.resolved[stringId] = 1;
+            }
+        }
+    }
+}
+
+template<typename RowMapper>
+void CompiledSearchQuery::evaluateBlocks(const RowMapper& rowMapper,
+        int numPositions,
+        int firstBlock,
+        int lastBlock,
+        Selection* pSelection) const {
+    std::vector<Block> stack(m_maxStackSize);
+    for (int block = firstBlock; block < lastBlock; ++block) {
+        const int positionBegin = block * kBlockRows;
+        const int positionEnd = std::min(positionBegin + kBlockRows, numPositions);
+        int stackSize = 0;
+        for (const auto& instruction : m_program) {
+            evaluateInstruction(instruction,
+                    rowMapper,
+                    positionBegin,
+                    positionEnd,
+                    stack.data(),
+                    &stackSize);
+        }
+        DEBUG_ASSERT(stackSize == 1);
+        // Blocks are word-aligned, i.e. concurrent tasks never write
+        // the same word.
+        const int numWords = (positionEnd - positionBegin + 63) / 64;
+        std::copy_n(stack[0].cbegin(), numWords, pSelection->begin() + block * kBlockWords);
+    }
+}
+
+template<typename RowMapper>
+void CompiledSearchQuery::evaluateInstruction(const Instruction& instruction,
+        const RowMapper& rowMapper,
+        int positionBegin,
+        int positionEnd,
+        Block* pStack,
+        int* pStackSize) const {
+    const int column = instruction.column;
+    switch (instruction.opCode) {
+    case OpCode::All: {
+        Block* pBlock = &pStack[(*pStackSize)++];
+        pBlock->fill(~std::uint64_t(0));
+        maskBlock(pBlock, positionEnd - positionBegin);
+        return;
+    }
+    case OpCode::None: {
+        pStack[(*pStackSize)++].fill(0);
+        return;
+    }
+    case OpCode::TextMatch: {
+        const std::vector<char>& matches = m_textMatchers[instruction.operand].matches;
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            return matches[m_index.stringId(row, column)] != 0;
+        });
+        return;
+    }
+    case OpCode::TextEmpty: {
+        // The empty string has always id 0, null values are stored as
+        // empty strings.
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            return m_index.stringId(row, column) == 0;
+        });
+        return;
+    }
+    case OpCode::TextNull: {
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            return m_index.isTextNull(row, column);
+        });
+        return;
+    }
+    case OpCode::NumericRange: {
+        const double lower = instruction.lower;
+        const double upper = instruction.upper;
+        const bool lowerInclusive = instruction.lowerInclusive;
+        const bool upperInclusive = instruction.upperInclusive;
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            const double value = m_index.numericValue(row, column);
+            return !m_index.isNumericNull(row, column) &&
+                    (lowerInclusive ? value >= lower : value > lower) &&
+                    (upperInclusive ? value <= upper : value < upper);
+        });
+        return;
+    }
+    case OpCode::NumericNull: {
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            return m_index.isNumericNull(row, column);
+        });
+        return;
+    }
+    case OpCode::TrackIds: {
+        const std::vector<TrackId>& trackIds = m_trackIdSets[instruction.operand];
+        fillBlock(&pStack[(*pStackSize)++], rowMapper, positionBegin, positionEnd, [&](int row) {
+            return std::binary_search(trackIds.begin(), trackIds.end(), m_index.trackId(row));
+        });
+        return;
+    }
+    case OpCode::And: {
+        *pStackSize -= instruction.operand - 1;
+        Block* pResult = &pStack[*pStackSize - 1];
+        for (int i = 1; i < instruction.operand; ++i) {
+            const Block& operand = pStack[*pStackSize - 1 + i];
+            for (int word = 0; word < kBlockWords; ++word) {
+                (*pResult)[word] &= operand[word];
+            }
+        }
+        return;
+    }
+    case OpCode::Or: {
+        *pStackSize -= instruction.operand - 1;
+        Block* pResult = &pStack[*pStackSize - 1];
+        for (int i = 1; i < instruction.operand; ++i) {
+            const Block& operand = pStack[*pStackSize - 1 + i];
+            for (int word = 0; word < kBlockWords; ++word) {
+                (*pResult)[word] |= operand[word];
+            }
+        }
+        return;
+    }
+    case OpCode::Not: {
+        Block* pResult = &pStack[*pStackSize - 1];
+        for (int word = 0; word < kBlockWords; ++word) {
+            (*pResult)[word] = ~(*pResult)[word];
+        }
+        maskBlock(pResult, positionEnd - positionBegin);
+        return;
+    }
+    }
+    DEBUG_ASSERT(!"unreachable");
+}
+
+SearchQueryCompiler::SearchQueryCompiler(
+        const TrackColumnIndex& index, ColumnResolver columnResolver)
+        : m_index(index),
+          m_columnResolver(std::move(columnResolver)),
+          m_stackSize(0) {
+}
+
+std::unique_ptr<CompiledSearchQuery> SearchQueryCompiler::compile(const QueryNode& query) {
+    // CompiledSearchQuery has a private constructor
+    m_pQuery.reset(new CompiledSearchQuery(m_index));
+    m_stackSize = 0;
+
+    switch (query.compile(this)) {
+    case CompileResult::Unsupported:
+        m_pQuery.reset();
+        return nullptr;
+    case CompileResult::Empty:
+        // Matches all tracks, like an empty WHERE clause
+        emitAll();
+        break;
+    case CompileResult::Emitted:
+        break;
+    }
+    DEBUG_ASSERT(m_stackSize == 1);
+    return std::move(m_pQuery);
+}
+
+void SearchQueryCompiler::addInstruction(
+        const CompiledSearchQuery::Instruction& instruction, int numOperands) {
+    DEBUG_ASSERT(m_stackSize >= numOperands);
+    m_pQuery->m_program.push_back(instruction);
+    m_stackSize += 1 - numOperands;
+    m_pQuery->m_maxStackSize = std::max(m_pQuery->m_maxStackSize, m_stackSize);
+}
+
+int SearchQueryCompiler::textMatcher(const QString& likePattern) {
+    // Columns that are searched for the same argument share the matcher
+    auto& textMatchers = m_pQuery->m_textMatchers;
+    for (std::size_t i = 0; i < textMatchers.size(); ++i) {
+        if (textMatchers[i].pattern == likePattern) {
+            return static_cast<int>(i);
+        }
+    }
+    CompiledSearchQuery::TextMatcher matcher;
+    matcher.pattern = likePattern;
+    const int size = likePattern.size();
+    if (size >= 2 &&
+            likePattern.startsWith(kSqlLikeMatchAll) &&
+            likePattern.endsWith(kSqlLikeMatchAll) &&
+            !containsWildcards(likePattern, 1, size - 1)) {
+        // Most common case
+        matcher.mode = CompiledSearchQuery::TextMatcher::Mode::Contains;
+        matcher.argument = likePattern.mid(1, size - 2);
+    } else if (!containsWildcards(likePattern, 0, size)) {
+        matcher.mode = CompiledSearchQuery::TextMatcher::Mode::Equals;
+        matcher.argument = likePattern;
+    } else {
+        matcher.mode = CompiledSearchQuery::TextMatcher::Mode::Like;
+    }
+    // Strings are resolved lazily on evaluation
+    const int numStrings = m_index.stringCount();
+    matcher.matches.resize(numStrings);
+    matcher.resolved.resize(numStrings);
+    textMatchers.push_back(std::move(matcher));
+    return static_cast<int>(textMatchers.size()) - 1;
+}
+
+void SearchQueryCompiler::emitAll() {
+    addInstruction({CompiledSearchQuery::OpCode::All, -1, 0, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitNone() {
+    addInstruction({CompiledSearchQuery::OpCode::None, -1, 0, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitTextLike(int column, const QString& likePattern) {
+    DEBUG_ASSERT(m_index.columnType(column) == TrackColumnIndex::ColumnType::Text);
+    addInstruction({CompiledSearchQuery::OpCode::TextMatch,
+                 column,
+                 textMatcher(likePattern),
+                 0.0,
+                 0.0,
+                 false,
+                 false},
+            0);
+}
+
+void SearchQueryCompiler::emitTextEmpty(int column) {
+    DEBUG_ASSERT(m_index.columnType(column) == TrackColumnIndex::ColumnType::Text);
+    addInstruction({CompiledSearchQuery::OpCode::TextEmpty, column, 0, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitTextNull(int column) {
+    DEBUG_ASSERT(m_index.columnType(column) == TrackColumnIndex::ColumnType::Text);
+    addInstruction({CompiledSearchQuery::OpCode::TextNull, column, 0, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitNumericRange(int column,
+        double lower,
+        bool lowerInclusive,
+        double upper,
+        bool upperInclusive) {
+    DEBUG_ASSERT(m_index.columnType(column) == TrackColumnIndex::ColumnType::Numeric);
+    addInstruction({CompiledSearchQuery::OpCode::NumericRange,
+                 column,
+                 0,
+                 lower,
+                 upper,
+                 lowerInclusive,
+                 upperInclusive},
+            0);
+}
+
+void SearchQueryCompiler::emitNumericNull(int column) {
+    DEBUG_ASSERT(m_index.columnType(column) == TrackColumnIndex::ColumnType::Numeric);
+    addInstruction({CompiledSearchQuery::OpCode::NumericNull, column, 0, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitTrackIds(std::vector<TrackId> sortedTrackIds) {
+    DEBUG_ASSERT(std::is_sorted(sortedTrackIds.begin(), sortedTrackIds.end()));
+    m_pQuery->m_trackIdSets.push_back(std::move(sortedTrackIds));
+    const int trackIdSet = static_cast<int>(m_pQuery->m_trackIdSets.size()) - 1;
+    addInstruction({CompiledSearchQuery::OpCode::TrackIds, -1, trackIdSet, 0.0, 0.0, false, false}, 0);
+}
+
+void SearchQueryCompiler::emitAnd(int numOperands) {
+    DEBUG_ASSERT(numOperands > 0);
+    if (numOperands == 1) {
+        return;
+    }
+    addInstruction({CompiledSearchQuery::OpCode::And, -1, numOperands, 0.0, 0.0, false, false},
+            numOperands);
+}
+
+void SearchQueryCompiler::emitOr(int numOperands) {
+    DEBUG_ASSERT(numOperands > 0);
+    if (numOperands == 1) {
+        return;
+    }
+    addInstruction({CompiledSearchQuery::OpCode::Or, -1, numOperands, 0.0, 0.0, false, false},
+            numOperands);
+}
+
+void SearchQueryCompiler::emitNot() {
+    addInstruction({CompiledSearchQuery::OpCode::Not, -1, 1, 0.0, 0.0, false, false}, 1);
+}
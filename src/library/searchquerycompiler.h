@@ -0,0 +1,192 @@
+#pragma once
+
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "library/trackcolumnindex.h"
+#include "track/trackid.h"
+#include "util/class.h"
+
+class QueryNode;
+
+/// A search query that has been lowered into a flat program, which is run
+/// over the typed columns of a TrackColumnIndex instead of being translated
+/// into an SQL WHERE clause.
+///
+/// The program is a sequence of stack instructions that is evaluated for one
+/// block of rows at a time. Leaf instructions push the selection bitmap of a
+/// predicate for the current block, the other instructions combine the
+/// topmost bitmaps. Text predicates are resolved once per distinct interned
+/// string of the index, so for each row only its string id needs to be
+/// looked up.
+class CompiledSearchQuery {
+  public:
+    /// One bit per row of the index, row i is bit (i % 64) of word (i / 64).
+    typedef std::vector<std::uint64_t> Selection;
+
+    /// Number of rows that are evaluated at once.
+    static constexpr int kBlockRows = 1024;
+
+    static bool isSelected(const Selection& selection, int row) {
+        return (selection[row / 64] >> (row % 64)) & 1;
+    }
+
+    /// Evaluates the query for all rows of the index. Large indexes are split
+    /// into chunks that are evaluated concurrently. The index must not be
+    /// modified after the query has been compiled.
+    Selection evaluate();
+
+    /// Returns the given rows of the index that match the query, preserving
+    /// their order. Only the strings referenced by these rows are matched,
+    /// i.e. the costs scale with the number of rows instead of the size of
+    /// the index.
+    std::vector<int> filterRows(const std::vector<int>& rows);
+
+  private:
+    friend class SearchQueryCompiler;
+
+    enum class OpCode {
+        All,
+        None,
+        TextMatch,
+        TextEmpty,
+        TextNull,
+        NumericRange,
+        NumericNull,
+        TrackIds,
+        And,
+        Or,
+        Not,
+    };
+
+    struct TextMatcher {
+        enum class Mode {
+            // '%argument%' without wildcards in between
+            Contains,
+            // Pattern without wildcards
+            Equals,
+            Like,
+        };
+
+        // Folded LIKE pattern
+        QString pattern;
+        Mode mode;
+        QString argument;
+        // Indexed by string id
+        std::vector<char> matches;
+        std::vector<char> resolved;
+    };
+
+    struct Instruction {
+        OpCode opCode;
+        int column;
+        // Number of operands for And/Or, the text matcher for TextMatch and
+        // the track id set for TrackIds
+        int operand;
+        double lower;
+        double upper;
+        bool lowerInclusive;
+        bool upperInclusive;
+    };
+
+    static constexpr int kBlockWords = kBlockRows / 64;
+    typedef std::array<std::uint64_t, kBlockWords> Block;
+
+    explicit CompiledSearchQuery(const TrackColumnIndex& index);
+
+    /// Resolves the text matchers for the strings in [begin, end)
+    void resolveTextMatchers(int beginStringId, int endStringId);
+    /// Resolves the text matchers for the strings referenced by the rows
+    void resolveTextMatchers(const std::vector<int>& rows);
+    bool matchText(const TextMatcher& matcher, int stringId) const;
+
+    /// Evaluates the blocks of the positions [0, numPositions) with either
+    /// rows[position] or the position itself as the row.
+    template<typename RowMapper>
+    void evaluateBlocks(const RowMapper& rowMapper,
+            int numPositions,
+            int firstBlock,
+            int lastBlock,
+            Selection* pSelection) const;
+    template<typename RowMapper>
+    void evaluateInstruction(const Instruction& instruction,
+            const RowMapper& rowMapper,
+            int positionBegin,
+            int positionEnd,
+            Block* pStack,
+            int* pStackSize) const;
+
+    const TrackColumnIndex& m_index;
+    std::vector<Instruction> m_program;
+    int m_maxStackSize;
+    std::vector<TextMatcher> m_textMatchers;
+    // Sorted
+    std::vector<std::vector<TrackId>> m_trackIdSets;
+
+    DISALLOW_COPY_AND_ASSIGN(CompiledSearchQuery);
+};
+
+/// Translates a tree of QueryNodes into a CompiledSearchQuery. Each node
+/// emits its own instructions through QueryNode::compile() or, if it is
+/// negated, QueryNode::compileNegated().
+class SearchQueryCompiler {
+  public:
+    /// Returns the column of the index that may be searched in memory for
+    /// the given SQL column, or -1 if it must be searched with SQL. A column
+    /// must only be returned if the search yields the same result as the SQL
+    /// expression created by QueryNode::toSql().
+    typedef std::function<int(const QString& sqlColumn,
+            TrackColumnIndex::ColumnType columnType)>
+            ColumnResolver;
+
+    SearchQueryCompiler(const TrackColumnIndex& index, ColumnResolver columnResolver);
+
+    /// Returns nullptr if at least one node of the query can not be
+    /// evaluated in memory.
+    std::unique_ptr<CompiledSearchQuery> compile(const QueryNode& query);
+
+    int textColumn(const QString& sqlColumn) const {
+        return m_columnResolver(sqlColumn, TrackColumnIndex::ColumnType::Text);
+    }
+    int numericColumn(const QString& sqlColumn) const {
+        return m_columnResolver(sqlColumn, TrackColumnIndex::ColumnType::Numeric);
+    }
+
+    void emitAll();
+    void emitNone();
+    /// Selects the rows with a text that matches the SQL LIKE pattern, which
+    /// must already be folded with DbConnection::makeStringLatinLow().
+    void emitTextLike(int column, const QString& likePattern);
+    /// Selects the rows with a null or empty text.
+    void emitTextEmpty(int column);
+    void emitTextNull(int column);
+    /// Selects the rows with a non-null value within the given bounds.
+    void emitNumericRange(int column,
+            double lower,
+            bool lowerInclusive,
+            double upper,
+            bool upperInclusive);
+    void emitNumericNull(int column);
+    void emitTrackIds(std::vector<TrackId> sortedTrackIds);
+    /// Replaces the topmost numOperands selections with their intersection.
+    void emitAnd(int numOperands);
+    /// Replaces the topmost numOperands selections with their union.
+    void emitOr(int numOperands);
+    void emitNot();
+
+  private:
+    void addInstruction(const CompiledSearchQuery::Instruction& instruction, int numOperands);
+    int textMatcher(const QString& likePattern);
+
+    const TrackColumnIndex& m_index;
+    const ColumnResolver m_columnResolver;
+
+    std::unique_ptr<CompiledSearchQuery> m_pQuery;
+    int m_stackSize;
+
+    DISALLOW_COPY_AND_ASSIGN(SearchQueryCompiler);
+};
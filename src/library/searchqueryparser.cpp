@@ -8,6 +8,7 @@
 #include "library/trackcollection.h"
 #include "track/keyutils.h"
 #include "util/assert.h"
+#include "util/db/dbconnection.h"
 
 namespace {
 
@@ -53,6 +54,22 @@ std::pair<QString, Quoted> consumeQuotedArgument(QString argument,
     return {argument, Quoted::Complete};
 }
 
+// Checks if every text that contains the refined argument also contains
+// the previous argument
+bool argumentIsRefinement(QString previousArgument, QString refinedArgument) {
+    if (previousArgument.isEmpty() ||
+            previousArgument.startsWith('=') ||
+            refinedArgument.startsWith('=')) {
+        // An empty argument consumes the next term and '=' requests
+        // an exact match
+        return false;
+    }
+    // Same folding as for the LIKE patterns
+    mixxx::DbConnection::makeStringLatinLow(&previousArgument);
+    mixxx::DbConnection::makeStringLatinLow(&refinedArgument);
+    return refinedArgument.contains(previousArgument);
+}
+
 } // anonymous namespace
 
 constexpr char kNegatePrefix[] = "-";
@@ -383,3 +400,74 @@ bool SearchQueryParser::queryIsLessSpecific(const QString& original, const QStri
     }
     return false;
 }
+
+bool SearchQueryParser::queryIsRefinement(
+        const QString& previous, const QString& refined) const {
+    // Alternatives and quoted arguments are not analyzed
+    if (previous.contains(kSplitOnOrOperatorRegexp) ||
+            refined.contains(kSplitOnOrOperatorRegexp) ||
+            previous.contains('"') ||
+            refined.contains('"')) {
+        return false;
+    }
+    const QStringList previousTerms = splitQueryIntoWords(previous);
+    const QStringList refinedTerms = splitQueryIntoWords(refined);
+    for (const QString& refinedTerm : refinedTerms) {
+        if (refinedTerm.endsWith(':')) {
+            // A filter without argument consumes the next term, which
+            // may change the meaning of the query
+            return false;
+        }
+    }
+    // Every term of the previous query must be implied by a term of the
+    // refined query, additional terms only restrict the results further
+    for (const QString& previousTerm : previousTerms) {
+        if (previousTerm.endsWith(':')) {
+            return false;
+        }
+        bool implied = false;
+        for (const QString& refinedTerm : refinedTerms) {
+            if (refinedTerm == previousTerm ||
+                    termIsRefinement(previousTerm, refinedTerm)) {
+                implied = true;
+                break;
+            }
+        }
+        if (!implied) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SearchQueryParser::termIsRefinement(
+        const QString& previousTerm, const QString& refinedTerm) const {
+    // Negated and fuzzy terms are only implied by identical terms
+    if (previousTerm.startsWith(kNegatePrefix) ||
+            previousTerm.startsWith(kFuzzyPrefix) ||
+            refinedTerm.startsWith(kNegatePrefix) ||
+            refinedTerm.startsWith(kFuzzyPrefix)) {
+        return false;
+    }
+    const QRegularExpressionMatch previousTextFilterMatch =
+            m_textFilterMatcher.match(previousTerm);
+    const QRegularExpressionMatch refinedTextFilterMatch =
+            m_textFilterMatcher.match(refinedTerm);
+    if (previousTextFilterMatch.hasMatch()) {
+        // Text filters on the same field
+        return refinedTextFilterMatch.hasMatch() &&
+                refinedTextFilterMatch.captured(1) == previousTextFilterMatch.captured(1) &&
+                argumentIsRefinement(previousTextFilterMatch.captured(2),
+                        refinedTextFilterMatch.captured(2));
+    }
+    // Numeric and special filters are only implied by identical terms
+    if (refinedTextFilterMatch.hasMatch() ||
+            m_numericFilterMatcher.match(previousTerm).hasMatch() ||
+            m_numericFilterMatcher.match(refinedTerm).hasMatch() ||
+            m_specialFilterMatcher.match(previousTerm).hasMatch() ||
+            m_specialFilterMatcher.match(refinedTerm).hasMatch()) {
+        return false;
+    }
+    // Plain search terms
+    return argumentIsRefinement(previousTerm, refinedTerm);
+}
@@ -25,6 +25,11 @@ class SearchQueryParser {
     static QStringList splitQueryIntoWords(const QString& query);
     /// checks if the changed search query is less specific then the original term
     static bool queryIsLessSpecific(const QString& original, const QString& changed);
+    /// Checks if the refined query can only match a subset of the tracks
+    /// that are matched by the previous query, e.g. because characters have
+    /// been appended to a search term or terms have been added. This is a
+    /// conservative check, i.e. it may return false for some refinements.
+    bool queryIsRefinement(const QString& previous, const QString& refined) const;
 
   private:
     void parseTokens(QStringList tokens,
@@ -38,6 +43,8 @@ class SearchQueryParser {
         StringMatch mode;
     };
 
+    bool termIsRefinement(const QString& previousTerm, const QString& refinedTerm) const;
+
     TextArgumentResult getTextArgument(QString argument,
             QStringList* tokens,
             bool removeLeadingEqualsSign = true) const;
@@ -127,6 +127,19 @@ void TrackCollection::connectTrackSource(QSharedPointer<BaseTrackCache> pTrackSo
             &TrackDAO::tracksRemoved,
             m_pTrackSource.data(),
             &BaseTrackCache::slotTracksRemoved);
+    // Searches also match crate names
+    connect(this,
+            &TrackCollection::crateUpdated,
+            m_pTrackSource.data(),
+            &BaseTrackCache::slotCratesChanged);
+    connect(this,
+            &TrackCollection::crateDeleted,
+            m_pTrackSource.data(),
+            &BaseTrackCache::slotCratesChanged);
+    connect(this,
+            &TrackCollection::crateTracksChanged,
+            m_pTrackSource.data(),
+            &BaseTrackCache::slotCratesChanged);
 }
 
 QWeakPointer<BaseTrackCache> TrackCollection::disconnectTrackSource() {
@@ -136,6 +149,7 @@ QWeakPointer<BaseTrackCache> TrackCollection::disconnectTrackSource() {
     if (m_pTrackSource) {
         kLogger.info() << "Disconnecting track source";
         m_trackDao.disconnect(m_pTrackSource.data());
+        disconnect(m_pTrackSource.data());
         m_pTrackSource.reset();
     }
     return pWeakPtr;
@@ -91,10 +91,10 @@ TrackCollectionManager::TrackCollectionManager(
         // signals are handled within the receiver's and NOT the sender's
         // event loop thread!!!
         connect(m_pScanner.get(),
-                &LibraryScanner::trackAdded,
+                &LibraryScanner::tracksAdded,
                 /*receiver thread context*/ this,
-                [this](const TrackPointer& pTrack) {
-                    afterTrackAdded(pTrack);
+                [this](const QSet<TrackId>& addedTrackIds) {
+                    afterTracksAdded(addedTrackIds);
                 });
         connect(m_pScanner.get(),
                 &LibraryScanner::tracksChanged,
@@ -508,6 +508,23 @@ void TrackCollectionManager::afterTrackAdded(const TrackPointer& pTrack) const {
     }
 }
 
+void TrackCollectionManager::afterTracksAdded(const QSet<TrackId>& addedTrackIds) const {
+    DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
+
+    // Already added to m_pInternalCollection
+    if (m_externalCollections.isEmpty()) {
+        return;
+    }
+    // The library scanner doesn't create Track objects for new tracks.
+    // They are only loaded if needed for the external collections.
+    for (const auto& trackId : addedTrackIds) {
+        const auto pTrack = m_pInternalCollection->getTrackById(trackId);
+        if (pTrack) {
+            afterTrackAdded(pTrack);
+        }
+    }
+}
+
 void TrackCollectionManager::afterTracksUpdated(const QSet<TrackId>& updatedTrackIds) const {
     DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
 
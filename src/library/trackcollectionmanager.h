@@ -102,6 +102,7 @@ class TrackCollectionManager: public QObject,
 
   private:
     void afterTrackAdded(const TrackPointer& pTrack) const;
+    void afterTracksAdded(const QSet<TrackId>& addedTrackIds) const;
     void afterTracksUpdated(const QSet<TrackId>& updatedTrackIds) const;
     void afterTracksRelocated(const QList<RelocatedTrack>& relocatedTracks) const;
 
@@ -0,0 +1,272 @@
+#include "library/trackcolumnindex.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "util/db/dbconnection.h"
+
+namespace {
+
+inline int compareInts(int val1, int val2) {
+    return (val1 > val2) - (val1 < val2);
+}
+
+// Numbers are compared exactly. Unlike the epsilon comparison of
+// BaseTrackCache::compareColumnValues() this is a strict weak ordering
+// as required by std::sort(). Like in SQLite NULL values are ordered
+// before all numbers.
+inline int compareNumbers(bool isNull1, double val1, bool isNull2, double val2) {
+    if (isNull1 || isNull2) {
+        return compareInts(isNull2 ? 1 : 0, isNull1 ? 1 : 0);
+    }
+    return (val1 > val2) - (val1 < val2);
+}
+
+inline int keyOrder(int key, KeyUtils::KeyNotation keyNotation) {
+    return KeyUtils::keyToCircleOfFifthsOrder(
+            static_cast<mixxx::track::io::key::ChromaticKey>(key), keyNotation);
+}
+
+} // namespace
+
+TrackColumnIndex::TrackColumnIndex()
+        : m_revision(0),
+          m_collationRanksValid(false) {
+    clear();
+}
+
+void TrackColumnIndex::reset(std::vector<ColumnType> columnTypes) {
+    m_columns.clear();
+    m_columns.resize(columnTypes.size());
+    for (std::size_t i = 0; i < columnTypes.size(); ++i) {
+        m_columns[i].type = columnTypes[i];
+    }
+    clear();
+}
+
+void TrackColumnIndex::clear() {
+    for (auto& column : m_columns) {
+        column.values.clear();
+        column.numbers.clear();
+        column.nulls.clear();
+        column.ids.clear();
+        column.sortRanks.clear();
+        column.sortRanksValid = false;
+    }
+    ++m_revision;
+    m_trackIds.clear();
+    m_rowsByTrackId.clear();
+    m_strings.clear();
+    m_foldedStrings.clear();
+    m_stringIds.clear();
+    m_collationRanks.clear();
+    m_collationRanksValid = false;
+    // The empty string always has id 0. Null values are treated like empty
+    // strings when comparing, just like QVariant::toString() does.
+    internString(QString());
+}
+
+int TrackColumnIndex::internString(const QString& str) {
+    const auto it = m_stringIds.constFind(str);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+    const int stringId = static_cast<int>(m_strings.size());
+    m_strings.push_back(str);
+    QString foldedStr = str;
+    mixxx::DbConnection::makeStringLatinLow(&foldedStr);
+    m_foldedStrings.push_back(std::move(foldedStr));
+    m_stringIds.insert(str, stringId);
+    m_collationRanksValid = false;
+    return stringId;
+}
+
+int TrackColumnIndex::ensureRow(TrackId trackId) {
+    const auto it = m_rowsByTrackId.constFind(trackId);
+    if (it != m_rowsByTrackId.constEnd()) {
+        return it.value();
+    }
+    ++m_revision;
+    const int row = rowCount();
+    m_trackIds.push_back(trackId);
+    m_rowsByTrackId.insert(trackId, row);
+    for (auto& column : m_columns) {
+        column.values.emplace_back();
+        switch (column.type) {
+        case ColumnType::Numeric:
+            column.numbers.push_back(0.0);
+            column.nulls.push_back(1);
+            break;
+        case ColumnType::Key:
+            column.ids.push_back(mixxx::track::io::key::INVALID);
+            break;
+        case ColumnType::Text:
+            column.ids.push_back(0);
+            column.nulls.push_back(1);
+            break;
+        }
+        column.sortRanksValid = false;
+    }
+    return row;
+}
+
+void TrackColumnIndex::remove(TrackId trackId) {
+    const auto it = m_rowsByTrackId.find(trackId);
+    if (it == m_rowsByTrackId.end()) {
+        return;
+    }
+    ++m_revision;
+    const int row = it.value();
+    m_rowsByTrackId.erase(it);
+    const int lastRow = rowCount() - 1;
+    if (row != lastRow) {
+        // Move the last row into the gap
+        m_trackIds[row] = m_trackIds[lastRow];
+        m_rowsByTrackId[m_trackIds[row]] = row;
+        for (auto& column : m_columns) {
+            column.values[row] = std::move(column.values[lastRow]);
+            if (column.type == ColumnType::Numeric) {
+                column.numbers[row] = column.numbers[lastRow];
+            } else {
+                column.ids[row] = column.ids[lastRow];
+            }
+            if (column.type != ColumnType::Key) {
+                column.nulls[row] = column.nulls[lastRow];
+            }
+        }
+    }
+    m_trackIds.pop_back();
+    for (auto& column : m_columns) {
+        column.values.pop_back();
+        if (column.type == ColumnType::Numeric) {
+            column.numbers.pop_back();
+        } else {
+            column.ids.pop_back();
+        }
+        if (column.type != ColumnType::Key) {
+            column.nulls.pop_back();
+        }
+        column.sortRanksValid = false;
+    }
+}
+
+void TrackColumnIndex::setValue(int row, int column, QVariant value) {
+    ++m_revision;
+    Column& col = m_columns[column];
+    switch (col.type) {
+    case ColumnType::Numeric:
+        col.numbers[row] = value.toDouble();
+        col.nulls[row] = value.isNull() ? 1 : 0;
+        break;
+    case ColumnType::Key:
+        col.ids[row] = KeyUtils::guessKeyFromText(value.toString());
+        break;
+    case ColumnType::Text: {
+        const int stringId = internString(value.toString());
+        col.ids[row] = stringId;
+        col.nulls[row] = value.isNull() ? 1 : 0;
+        if (value.userType() == QMetaType::QString) {
+            // Share the string data with the pool
+            value = m_strings[stringId];
+        }
+        break;
+    }
+    }
+    col.values[row] = std::move(value);
+    col.sortRanksValid = false;
+}
+
+const std::vector<int>& TrackColumnIndex::collationRanks() const {
+    if (m_collationRanksValid) {
+        return m_collationRanks;
+    }
+    const int numStrings = stringCount();
+    std::vector<int> stringIds(numStrings);
+    std::iota(stringIds.begin(), stringIds.end(), 0);
+    std::sort(stringIds.begin(), stringIds.end(), [this](int lhs, int rhs) {
+        return m_collator.compare(m_strings[lhs], m_strings[rhs]) < 0;
+    });
+    m_collationRanks.resize(numStrings);
+    int rank = 0;
+    for (int i = 0; i < numStrings; ++i) {
+        if (i > 0 &&
+                m_collator.compare(m_strings[stringIds[i - 1]], m_strings[stringIds[i]]) != 0) {
+            ++rank;
+        }
+        m_collationRanks[stringIds[i]] = rank;
+    }
+    m_collationRanksValid = true;
+    return m_collationRanks;
+}
+
+int TrackColumnIndex::compareRows(int column,
+        int row1,
+        int row2,
+        KeyUtils::KeyNotation keyNotation) const {
+    const Column& col = m_columns[column];
+    switch (col.type) {
+    case ColumnType::Numeric:
+        return compareNumbers(col.nulls[row1] != 0,
+                col.numbers[row1],
+                col.nulls[row2] != 0,
+                col.numbers[row2]);
+    case ColumnType::Key:
+        return compareInts(
+                keyOrder(col.ids[row1], keyNotation),
+                keyOrder(col.ids[row2], keyNotation));
+    case ColumnType::Text: {
+        const std::vector<int>& ranks = collationRanks();
+        return compareInts(ranks[col.ids[row1]], ranks[col.ids[row2]]);
+    }
+    }
+    return 0;
+}
+
+int TrackColumnIndex::compareValueWithRow(int column,
+        const QVariant& value,
+        int row,
+        KeyUtils::KeyNotation keyNotation) const {
+    const Column& col = m_columns[column];
+    switch (col.type) {
+    case ColumnType::Numeric:
+        return compareNumbers(value.isNull(),
+                value.toDouble(),
+                col.nulls[row] != 0,
+                col.numbers[row]);
+    case ColumnType::Key:
+        return compareInts(
+                keyOrder(KeyUtils::guessKeyFromText(value.toString()), keyNotation),
+                keyOrder(col.ids[row], keyNotation));
+    case ColumnType::Text: {
+        const int result = m_collator.compare(value.toString(), m_strings[col.ids[row]]);
+        return compareInts(result, 0);
+    }
+    }
+    return 0;
+}
+
+const std::vector<int>& TrackColumnIndex::sortRanks(
+        int column, KeyUtils::KeyNotation keyNotation) const {
+    const Column& col = m_columns[column];
+    if (col.sortRanksValid &&
+            (col.type != ColumnType::Key || col.sortRanksKeyNotation == keyNotation)) {
+        return col.sortRanks;
+    }
+    const int numRows = rowCount();
+    std::vector<int> rows(numRows);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::sort(rows.begin(), rows.end(), [&](int lhs, int rhs) {
+        return compareRows(column, lhs, rhs, keyNotation) < 0;
+    });
+    col.sortRanks.resize(numRows);
+    int rank = 0;
+    for (int i = 0; i < numRows; ++i) {
+        if (i > 0 && compareRows(column, rows[i - 1], rows[i], keyNotation) != 0) {
+            ++rank;
+        }
+        col.sortRanks[rows[i]] = rank;
+    }
+    col.sortRanksValid = true;
+    col.sortRanksKeyNotation = keyNotation;
+    return col.sortRanks;
+}
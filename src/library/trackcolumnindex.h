@@ -0,0 +1,164 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <vector>
+
+#include "track/keyutils.h"
+#include "track/trackid.h"
+#include "util/assert.h"
+#include "util/string.h"
+
+/// Column-oriented in-memory storage for the rows of a BaseTrackCache.
+///
+/// Rows are stored densely and track ids are mapped onto row indices. Besides
+/// the plain value that is only needed for displaying it, each column stores
+/// a typed key in a contiguous array that is used for comparing, sorting and
+/// filtering without unboxing QVariants:
+///  - Numeric columns store a double
+///  - Key columns store the musical key parsed once from its text
+///  - Text columns store an id into a pool of interned strings, which also
+///    provides the folded variant (see DbConnection::makeStringLatinLow())
+///    and the collation order of each string
+///
+/// Sort ranks are computed lazily per column and cached until the column is
+/// modified, so sorting a set of rows only needs integer comparisons.
+class TrackColumnIndex {
+  public:
+    enum class ColumnType {
+        Numeric,
+        Key,
+        Text,
+    };
+
+    static constexpr int kInvalidRow = -1;
+
+    TrackColumnIndex();
+
+    /// Removes all rows and (re-)defines the columns.
+    void reset(std::vector<ColumnType> columnTypes);
+    /// Removes all rows but keeps the columns.
+    void clear();
+
+    int columnCount() const {
+        return static_cast<int>(m_columns.size());
+    }
+    int rowCount() const {
+        return static_cast<int>(m_trackIds.size());
+    }
+    ColumnType columnType(int column) const {
+        return m_columns[column].type;
+    }
+    /// Changes on every modification. Data that has been derived from the
+    /// index is outdated if the revision has changed since.
+    quint64 revision() const {
+        return m_revision;
+    }
+
+    bool contains(TrackId trackId) const {
+        return m_rowsByTrackId.contains(trackId);
+    }
+    int row(TrackId trackId) const {
+        return m_rowsByTrackId.value(trackId, kInvalidRow);
+    }
+    TrackId trackId(int row) const {
+        return m_trackIds[row];
+    }
+
+    /// Returns the row of the track, appending an empty row if needed.
+    int ensureRow(TrackId trackId);
+    /// Removes the row of the track. The last row is moved into the gap,
+    /// i.e. row indices are not stable across removals.
+    void remove(TrackId trackId);
+
+    void setValue(int row, int column, QVariant value);
+    const QVariant& value(int row, int column) const {
+        return m_columns[column].values[row];
+    }
+
+    /// Typed accessors for the hot paths.
+    double numericValue(int row, int column) const {
+        DEBUG_ASSERT(m_columns[column].type == ColumnType::Numeric);
+        return m_columns[column].numbers[row];
+    }
+    /// Null values are stored as 0.0, use this to distinguish them.
+    bool isNumericNull(int row, int column) const {
+        DEBUG_ASSERT(m_columns[column].type == ColumnType::Numeric);
+        return m_columns[column].nulls[row] != 0;
+    }
+    mixxx::track::io::key::ChromaticKey keyValue(int row, int column) const {
+        DEBUG_ASSERT(m_columns[column].type == ColumnType::Key);
+        return static_cast<mixxx::track::io::key::ChromaticKey>(
+                m_columns[column].ids[row]);
+    }
+    int stringId(int row, int column) const {
+        DEBUG_ASSERT(m_columns[column].type == ColumnType::Text);
+        return m_columns[column].ids[row];
+    }
+    /// Null values are stored as the empty string, use this to distinguish them.
+    bool isTextNull(int row, int column) const {
+        DEBUG_ASSERT(m_columns[column].type == ColumnType::Text);
+        return m_columns[column].nulls[row] != 0;
+    }
+    const QString& string(int stringId) const {
+        return m_strings[stringId];
+    }
+    const QString& foldedString(int stringId) const {
+        return m_foldedStrings[stringId];
+    }
+    int stringCount() const {
+        return static_cast<int>(m_strings.size());
+    }
+
+    /// Compares two rows in ascending order of the given column, with the
+    /// same semantics as BaseTrackCache::compareColumnValues(). Except that
+    /// numbers are compared exactly and NULL values are ordered first, just
+    /// like SQLite does.
+    int compareRows(int column,
+            int row1,
+            int row2,
+            KeyUtils::KeyNotation keyNotation) const;
+    /// Compares a value that is not (yet) stored in the index with a row.
+    int compareValueWithRow(int column,
+            const QVariant& value,
+            int row,
+            KeyUtils::KeyNotation keyNotation) const;
+
+    /// Returns the rank of each row in ascending order of the column. Equal
+    /// values share the same rank.
+    const std::vector<int>& sortRanks(int column, KeyUtils::KeyNotation keyNotation) const;
+
+  private:
+    struct Column {
+        ColumnType type = ColumnType::Text;
+        std::vector<QVariant> values;
+        // ColumnType::Numeric
+        std::vector<double> numbers;
+        // ColumnType::Numeric and ColumnType::Text
+        std::vector<char> nulls;
+        // ColumnType::Key: ChromaticKey, ColumnType::Text: string id
+        std::vector<int> ids;
+
+        mutable std::vector<int> sortRanks;
+        mutable bool sortRanksValid = false;
+        mutable KeyUtils::KeyNotation sortRanksKeyNotation = KeyUtils::KeyNotation::Invalid;
+    };
+
+    int internString(const QString& str);
+    const std::vector<int>& collationRanks() const;
+
+    const mixxx::StringCollator m_collator;
+
+    quint64 m_revision;
+    std::vector<Column> m_columns;
+    std::vector<TrackId> m_trackIds;
+    QHash<TrackId, int> m_rowsByTrackId;
+
+    // Interned strings are never removed before the next clear().
+    std::vector<QString> m_strings;
+    std::vector<QString> m_foldedStrings;
+    QHash<QString, int> m_stringIds;
+    mutable std::vector<int> m_collationRanks;
+    mutable bool m_collationRanksValid;
+};
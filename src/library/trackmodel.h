@@ -172,9 +172,11 @@ class TrackModel {
         Q_UNUSED(pOutInsertionPos);
         return 0;
     }
-    virtual void moveTrack(const QModelIndex& sourceIndex,
-                           const QModelIndex& destIndex) {
-        Q_UNUSED(sourceIndex);
+    /// Moves the tracks before the track at destIndex, or to the end if
+    /// destIndex is invalid. The moved tracks keep their order.
+    virtual void moveTracks(const QModelIndexList& sourceIndices,
+            const QModelIndex& destIndex) {
+        Q_UNUSED(sourceIndices);
         Q_UNUSED(destIndex);
     }
     virtual bool isLocked() {
@@ -16,6 +16,18 @@ class WaveformSettings {
                 ConfigKey("[Library]", "EnableWaveformCaching"), enabled);
     }
 
+    // Store waveforms uncompressed, so they can be mapped into memory when
+    // loading a track. Waveforms in either format can always be loaded.
+    bool flatWaveformStorageEnabled() const {
+        return m_pConfig->getValue<bool>(
+                ConfigKey("[Library]", "EnableFlatWaveformStorage"), false);
+    }
+
+    void setFlatWaveformStorageEnabled(bool enabled) {
+        m_pConfig->setValue<bool>(
+                ConfigKey("[Library]", "EnableFlatWaveformStorage"), enabled);
+    }
+
     bool waveformGenerationWithAnalysisEnabled() const {
         return m_pConfig->getValue<bool>(
                 ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"), true);
@@ -0,0 +1,200 @@
+#include "sources/seekindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("SeekIndex");
+
+constexpr quint32 kMagic = 0x4d585349; // "MXSI"
+constexpr quint32 kFormatVersion = 1;
+constexpr QDataStream::Version kDataStreamVersion = QDataStream::Qt_5_12;
+
+// Large enough to include ID3v2/APE tags at the start and ID3v1/APE tags
+// at the end of a file, i.e. the regions that are modified when editing
+// the metadata of a file.
+constexpr qint64 kFingerprintBlockSize = 64 * 1024;
+
+const QString kFileSuffix = QStringLiteral(".seekindex");
+
+QMutex s_storageDirMutex;
+QString s_storageDirPath;
+
+} // anonymous namespace
+
+// static
+void SeekIndex::setStorageDirectory(const QString& dirPath) {
+    const auto locker = lockMutex(&s_storageDirMutex);
+    s_storageDirPath = dirPath;
+}
+
+// static
+QString SeekIndex::storageFilePath(const QString& audioFilePath) {
+    QString storageDirPath;
+    {
+        const auto locker = lockMutex(&s_storageDirMutex);
+        storageDirPath = s_storageDirPath;
+    }
+    if (storageDirPath.isEmpty()) {
+        return QString();
+    }
+    const QByteArray locationHash = QCryptographicHash::hash(
+            QFileInfo(audioFilePath).absoluteFilePath().toUtf8(),
+            QCryptographicHash::Sha1);
+    return QDir(storageDirPath).filePath(
+            QString::fromLatin1(locationHash.toHex()) + kFileSuffix);
+}
+
+// static
+QByteArray SeekIndex::fileFingerprint(const uchar* pFileData, qint64 fileSize) {
+    if (!pFileData || fileSize <= 0) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(fileSize));
+    const qint64 headSize = std::min(fileSize, kFingerprintBlockSize);
+    hash.addData(QByteArray::fromRawData(
+            reinterpret_cast<const char*>(pFileData), static_cast<int>(headSize)));
+    const qint64 tailSize = std::min(fileSize - headSize, kFingerprintBlockSize);
+    if (tailSize > 0) {
+        hash.addData(QByteArray::fromRawData(
+                reinterpret_cast<const char*>(pFileData + fileSize - tailSize),
+                static_cast<int>(tailSize)));
+    }
+    return hash.result();
+}
+
+// static
+std::optional<SeekIndex> SeekIndex::load(
+        const QString& filePath,
+        const QByteArray& fileFingerprint,
+        qint64 fileSize) {
+    if (filePath.isEmpty() || fileFingerprint.isEmpty()) {
+        return std::nullopt;
+    }
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Not an error, the file has not been scanned yet
+        return std::nullopt;
+    }
+    QDataStream in(&file);
+    in.setVersion(kDataStreamVersion);
+
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+    if (magic != kMagic || formatVersion != kFormatVersion) {
+        kLogger.info() << "Ignoring unsupported seek index" << filePath;
+        return std::nullopt;
+    }
+    SeekIndex seekIndex;
+    in >> seekIndex.fingerprint;
+    if (in.status() != QDataStream::Ok ||
+            seekIndex.fingerprint != fileFingerprint) {
+        // The file has been modified since it has been scanned
+        kLogger.debug() << "Ignoring outdated seek index" << filePath;
+        return std::nullopt;
+    }
+    quint8 channelCount = 0;
+    quint32 sampleRate = 0;
+    quint32 bitrate = 0;
+    qint64 frameCount = 0;
+    quint32 entryCount = 0;
+    in >> channelCount >> sampleRate >> bitrate >> frameCount >> entryCount;
+    seekIndex.channelCount = audio::ChannelCount(channelCount);
+    seekIndex.sampleRate = audio::SampleRate(sampleRate);
+    seekIndex.bitrate = audio::Bitrate(bitrate);
+    seekIndex.frameCount = static_cast<SINT>(frameCount);
+    // Each entry occupies 8 bytes, which rejects corrupt counts before
+    // allocating any memory
+    if (in.status() != QDataStream::Ok ||
+            !seekIndex.channelCount.isValid() ||
+            !seekIndex.sampleRate.isValid() ||
+            entryCount == 0 ||
+            static_cast<qint64>(entryCount) > (file.size() - file.pos()) / 8) {
+        kLogger.warning() << "Invalid seek index" << filePath;
+        return std::nullopt;
+    }
+
+    // Entries are stored as differences to their predecessor
+    seekIndex.entries.reserve(entryCount);
+    Entry entry{0, 0};
+    for (quint32 i = 0; i < entryCount; ++i) {
+        quint32 frameDelta = 0;
+        quint32 byteDelta = 0;
+        in >> frameDelta >> byteDelta;
+        if (i > 0 && (frameDelta == 0 || byteDelta == 0)) {
+            break;
+        }
+        entry.frameIndex += frameDelta;
+        entry.byteOffset += byteDelta;
+        if (entry.frameIndex >= seekIndex.frameCount ||
+                entry.byteOffset >= fileSize) {
+            break;
+        }
+        seekIndex.entries.push_back(entry);
+    }
+    if (in.status() != QDataStream::Ok ||
+            seekIndex.entries.size() != entryCount ||
+            seekIndex.entries.front().frameIndex != 0) {
+        kLogger.warning() << "Invalid seek index" << filePath;
+        return std::nullopt;
+    }
+    return seekIndex;
+}
+
+bool SeekIndex::save(const QString& filePath) const {
+    DEBUG_ASSERT(!fingerprint.isEmpty());
+    DEBUG_ASSERT(!entries.empty());
+    if (filePath.isEmpty()) {
+        return false;
+    }
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath())) {
+        kLogger.warning() << "Failed to create directory for seek index" << filePath;
+        return false;
+    }
+    // Decks and the analysis might open the same file concurrently. The
+    // file is replaced atomically, so readers never see a partial index.
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to create seek index" << filePath
+                          << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(kDataStreamVersion);
+    out << kMagic << kFormatVersion << fingerprint
+        << static_cast<quint8>(channelCount.value())
+        << static_cast<quint32>(sampleRate.value())
+        << static_cast<quint32>(bitrate.value())
+        << static_cast<qint64>(frameCount)
+        << static_cast<quint32>(entries.size());
+    Entry prevEntry{0, 0};
+    for (const auto& entry : entries) {
+        DEBUG_ASSERT(entry.frameIndex >= prevEntry.frameIndex);
+        DEBUG_ASSERT(entry.byteOffset >= prevEntry.byteOffset);
+        out << static_cast<quint32>(entry.frameIndex - prevEntry.frameIndex)
+            << static_cast<quint32>(entry.byteOffset - prevEntry.byteOffset);
+        prevEntry = entry;
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        kLogger.warning() << "Failed to write seek index" << filePath
+                          << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace mixxx
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <optional>
+#include <vector>
+
+#include "audio/types.h"
+#include "util/types.h"
+
+namespace mixxx {
+
+/// The seek positions of a compressed audio stream that has been scanned
+/// once, i.e. the byte offsets of the frames that decoding can start from.
+///
+/// Scanning all frame headers of a large VBR file takes a noticeable amount
+/// of time and reads the whole file. The index is stored per file in the
+/// storage directory after the first scan, which is usually done by the
+/// analysis, and replaces the scan when the file is opened again.
+///
+/// The index is only valid for the exact file content that it has been
+/// created from, which is identified by a fingerprint.
+class SeekIndex final {
+  public:
+    struct Entry {
+        SINT frameIndex;
+        SINT byteOffset;
+    };
+
+    /// The directory where seek indexes are stored. Seek indexes are
+    /// neither loaded nor stored while no directory has been set.
+    static void setStorageDirectory(const QString& dirPath);
+    /// Returns the file path of the seek index for the given audio file
+    /// or an empty string if no storage directory has been set.
+    static QString storageFilePath(const QString& audioFilePath);
+
+    /// Identifies the content of a file by its size and a hash of its
+    /// first and last bytes, where the tags and the headers of the audio
+    /// stream are located. This is cheap enough to be computed on every
+    /// open, even for files that are mapped into memory.
+    static QByteArray fileFingerprint(const uchar* pFileData, qint64 fileSize);
+
+    /// Returns the stored index if it has been created from a file with
+    /// the given fingerprint and is consistent with the file size.
+    static std::optional<SeekIndex> load(
+            const QString& filePath,
+            const QByteArray& fileFingerprint,
+            qint64 fileSize);
+    bool save(const QString& filePath) const;
+
+    QByteArray fingerprint;
+    audio::ChannelCount channelCount;
+    audio::SampleRate sampleRate;
+    audio::Bitrate bitrate;
+    SINT frameCount = 0;
+    /// Ordered by both frame index and byte offset, starting at frame 0
+    std::vector<Entry> entries;
+};
+
+} // namespace mixxx
@@ -1,5 +1,6 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
+#include "sources/seekindex.h"
 
 #include "util/logger.h"
 #include "util/math.h"
@@ -239,14 +240,27 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     // described in the following bug report:
     // https://github.com/mixxxdj/mixxx/issues/8011
 
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    m_avgSeekFrameCount = 0;
+    m_curFrameIndex = 0;
+
+    // Skip scanning all frame headers if the file has been scanned before
+    const QString seekIndexFilePath = SeekIndex::storageFilePath(m_file.fileName());
+    QByteArray fileFingerprint;
+    if (!seekIndexFilePath.isEmpty()) {
+        fileFingerprint = SeekIndex::fileFingerprint(m_pFileData, m_fileSize);
+        const auto seekIndex = SeekIndex::load(
+                seekIndexFilePath, fileFingerprint, m_fileSize);
+        if (seekIndex && initFromSeekIndex(*seekIndex)) {
+            return OpenResult::Succeeded;
+        }
+    }
+
     // Transfer it to the mad stream-buffer:
     mad_stream_options(&m_madStream, MAD_OPTION_IGNORECRC);
     mad_stream_buffer(&m_madStream, m_pFileData, m_fileSize);
     DEBUG_ASSERT(m_pFileData == m_madStream.this_frame);
 
-    DEBUG_ASSERT(m_seekFrameList.empty());
-    m_avgSeekFrameCount = 0;
-    m_curFrameIndex = 0;
     int headerPerSampleRate[kSampleRateCount];
     for (int i = 0; i < kSampleRateCount; ++i) {
         headerPerSampleRate[i] = 0;
@@ -475,6 +489,10 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     addSeekFrame(m_curFrameIndex, nullptr);
     DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
 
+    if (!seekIndexFilePath.isEmpty()) {
+        saveSeekIndex(seekIndexFilePath, fileFingerprint);
+    }
+
     // Restart decoding at the beginning of the audio stream
     restartDecoding(m_seekFrameList.front());
 
@@ -487,6 +505,67 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     return OpenResult::Succeeded;
 }
 
+bool SoundSourceMp3::initFromSeekIndex(const SeekIndex& seekIndex) {
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    // Validate the properties before initializing the AudioSource, which
+    // can only be done once
+    if (seekIndex.channelCount > kChannelCountMax ||
+            getIndexBySampleRate(seekIndex.sampleRate) >= kSampleRateCount ||
+            seekIndex.frameCount <= 0) {
+        kLogger.warning() << "Ignoring invalid seek index for" << m_file.fileName();
+        return false;
+    }
+    initChannelCountOnce(seekIndex.channelCount);
+    initSampleRateOnce(seekIndex.sampleRate);
+    initFrameIndexRangeOnce(IndexRange::forward(0, seekIndex.frameCount));
+    if (seekIndex.bitrate.isValid()) {
+        initBitrateOnce(seekIndex.bitrate);
+    }
+
+    for (const auto& entry : seekIndex.entries) {
+        addSeekFrame(entry.frameIndex, m_pFileData + entry.byteOffset);
+    }
+    m_avgSeekFrameCount = frameLength() / static_cast<SINT>(m_seekFrameList.size());
+    DEBUG_ASSERT(m_avgSeekFrameCount > 0);
+    addSeekFrame(seekIndex.frameCount, nullptr);
+
+    // The decoder does not need any state from preceding frames, because
+    // seeking restarts decoding kMp3SeekFramePrefetchCount frames before
+    // the target position anyway.
+    restartDecoding(m_seekFrameList.front());
+    DEBUG_ASSERT(m_curFrameIndex == frameIndexMin());
+    return true;
+}
+
+void SoundSourceMp3::saveSeekIndex(
+        const QString& seekIndexFilePath,
+        const QByteArray& fileFingerprint) const {
+    SeekIndex seekIndex;
+    seekIndex.fingerprint = fileFingerprint;
+    seekIndex.channelCount = getSignalInfo().getChannelCount();
+    seekIndex.sampleRate = getSignalInfo().getSampleRate();
+    seekIndex.bitrate = getBitrate();
+    seekIndex.frameCount = frameIndexMax();
+    seekIndex.entries.reserve(m_seekFrameList.size());
+    for (const auto& seekFrame : m_seekFrameList) {
+        // Skip the terminator and the last frame if it has been decoded
+        // from a copy in m_leftoverBuffer. Seeking to the last frame will
+        // then start decoding at the preceding frame.
+        if (!seekFrame.pInputData ||
+                seekFrame.pInputData < m_pFileData ||
+                seekFrame.pInputData >= m_pFileData + m_fileSize) {
+            continue;
+        }
+        seekIndex.entries.push_back(SeekIndex::Entry{
+                seekFrame.frameIndex,
+                static_cast<SINT>(seekFrame.pInputData - m_pFileData)});
+    }
+    if (seekIndex.entries.empty()) {
+        return;
+    }
+    seekIndex.save(seekIndexFilePath);
+}
+
 void SoundSourceMp3::close() {
     finishDecoding();
 
@@ -16,6 +16,8 @@
 
 namespace mixxx {
 
+class SeekIndex;
+
 class SoundSourceMp3 final : public SoundSource {
   public:
     explicit SoundSourceMp3(const QUrl& url);
@@ -53,6 +55,13 @@ class SoundSourceMp3 final : public SoundSource {
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
+    /** Initializes the AudioSource and m_seekFrameList from a stored
+     * seek index instead of scanning the whole file. */
+    bool initFromSeekIndex(const SeekIndex& seekIndex);
+    void saveSeekIndex(
+            const QString& seekIndexFilePath,
+            const QByteArray& fileFingerprint) const;
+
     /** Returns the position in m_seekFrameList of the requested frame index. */
     SINT findSeekFrameIndex(SINT frameIndex) const;
 
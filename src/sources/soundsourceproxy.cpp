@@ -686,6 +686,13 @@ SoundSourceProxy::UpdateTrackFromSourceResult SoundSourceProxy::updateTrackFromS
 
     const bool updateMetadataFromSource =
             shouldUpdateTrackMetadataFromSource(sourceSyncStatus, mode);
+    if (!updateMetadataFromSource &&
+            !m_pTrack->needsExtraMetadataFromSource()) {
+        // Skip parsing the file tags for a partial import that would
+        // not merge anything. This happens whenever a track that is
+        // synchronized with its file is loaded from the library.
+        return UpdateTrackFromSourceResult::NotUpdated;
+    }
 
     // Decide if cover art needs to be re-imported
     if (updateMetadataFromSource) {
@@ -1,5 +1,12 @@
 #include "sources/soundsourcestem.h"
 
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtConcurrentRun>
+#include <algorithm>
+
 #include "sources/readaheadframebuffer.h"
 
 extern "C" {
@@ -29,6 +36,41 @@ constexpr int kRequiredStreamCount = kNumStreams - 1; // Stem count doesn't incl
 
 const Logger kLogger("SoundSourceSTEM");
 
+// Each stem is decoded by its own FFmpeg decoder, which allows to decode
+// the stems of a file concurrently instead of one after another.
+class StemDecodingThreadPool : public QThreadPool {
+  public:
+    StemDecodingThreadPool() {
+        // The thread that reads from the SoundSourceSTEM decodes one
+        // stem itself
+        setMaxThreadCount(std::max(QThread::idealThreadCount(), kRequiredStreamCount - 1));
+    }
+};
+
+Q_GLOBAL_STATIC(StemDecodingThreadPool, s_stemDecodingThreadPool)
+
+/// Invokes the function for the indices [0, count) concurrently and
+/// returns the results in order. The calling thread invokes the function
+/// for index 0 itself and then waits until all others have finished.
+template<typename Result, typename Function>
+QVarLengthArray<Result, kNumStreams> invokeConcurrently(int count, Function function) {
+    QVarLengthArray<QFuture<Result>, kNumStreams> futures;
+    for (int index = 1; index < count; ++index) {
+        futures.append(QtConcurrent::run(s_stemDecodingThreadPool(), [function, index] {
+            return function(index);
+        }));
+    }
+    QVarLengthArray<Result, kNumStreams> results;
+    if (count > 0) {
+        results.append(function(0));
+    }
+    for (auto& future : futures) {
+        // Blocks until the result is available
+        results.append(future.result());
+    }
+    return results;
+}
+
 } // anonymous namespace
 
 const QString SoundSourceProviderSTEM::kDisplayName = QStringLiteral("STEM with FFmpeg");
@@ -374,10 +416,6 @@ SoundSource::OpenResult SoundSourceSTEM::tryOpen(
         }
 
         m_pStereoStreams.emplace_back(std::make_unique<SoundSourceSingleSTEM>(getUrl(), streamIdx));
-        if (m_pStereoStreams.back()->open(OpenMode::Strict /*Unused*/,
-                    stemParam) != OpenResult::Succeeded) {
-            return OpenResult::Failed;
-        }
     }
 
     if (stemCount != kRequiredStreamCount) {
@@ -388,6 +426,21 @@ SoundSource::OpenResult SoundSourceSTEM::tryOpen(
         return OpenResult::Failed;
     }
 
+    // Each stream opens and probes the file on its own
+    const auto openResults = invokeConcurrently<OpenResult>(
+            static_cast<int>(m_pStereoStreams.size()),
+            [this, &stemParam](int streamIdx) {
+                return m_pStereoStreams[streamIdx]->open(
+                        OpenMode::Strict /*Unused*/, stemParam);
+            });
+    for (const auto openResult : openResults) {
+        if (openResult != OpenResult::Succeeded) {
+            close();
+            return OpenResult::Failed;
+        }
+    }
+    m_stemBuffers.resize(m_pStereoStreams.size());
+
     if (openInStereo) {
         DEBUG_ASSERT(m_pStereoStreams.size() == 1);
         // Requesting a stereo stream (used for analysis)
@@ -419,7 +472,8 @@ ReadableSampleFrames SoundSourceSTEM::readSampleFramesClamped(
         return m_pStereoStreams.front()->readSampleFrames(globalSampleFrames);
     }
 
-    int stemCount = m_pStereoStreams.size();
+    const int stemCount = static_cast<int>(m_pStereoStreams.size());
+    DEBUG_ASSERT(static_cast<int>(m_stemBuffers.size()) == stemCount);
 
     VERIFY_OR_DEBUG_ASSERT(globalSampleFrames.writableLength() %
                     (stemCount * mixxx::audio::ChannelCount::stereo()) ==
@@ -427,42 +481,77 @@ ReadableSampleFrames SoundSourceSTEM::readSampleFramesClamped(
         return ReadableSampleFrames();
     };
 
-    SINT stemSampleLength = m_pStereoStreams.front()->getSignalInfo().frames2samples(
-            globalSampleFrames.frameLength());
-
-    // The same buffer is reused between requests tp prevent reallocation, but
-    // it will be reallocated if a larger chunk is requested and will keep the
+    // Frames are skipped without writing any samples
+    const bool writeSamples = globalSampleFrames.writableData() != nullptr;
+    const SINT stemSampleLength = writeSamples
+            ? m_pStereoStreams.front()->getSignalInfo().frames2samples(
+                      globalSampleFrames.frameLength())
+            : 0;
+    DEBUG_ASSERT(!writeSamples ||
+            stemSampleLength * stemCount == globalSampleFrames.writableLength());
+
+    // The same buffers are reused between requests to prevent reallocation, but
+    // they will be reallocated if a larger chunk is requested and will keep the
     // new maximum size
-    if (stemSampleLength > m_buffer.size()) {
-        m_buffer = SampleBuffer(stemSampleLength);
+    for (auto& stemBuffer : m_stemBuffers) {
+        if (stemSampleLength > stemBuffer.size()) {
+            stemBuffer = SampleBuffer(stemSampleLength);
+        }
     }
 
-    ReadableSampleFrames read(globalSampleFrames.frameIndexRange(),
-            SampleBuffer::ReadableSlice(
-                    globalSampleFrames.writableData(),
-                    globalSampleFrames.writableLength()));
-    DEBUG_ASSERT(stemSampleLength * stemCount == globalSampleFrames.writableLength());
-    CSAMPLE* pBuffer = globalSampleFrames.writableData();
+    // Decode all stems concurrently. All streams are read from the same
+    // position, i.e. they also seek to the same position.
+    const auto stemSampleFrames = invokeConcurrently<ReadableSampleFrames>(
+            stemCount,
+            [this, &globalSampleFrames, writeSamples, stemSampleLength](int streamIdx) {
+                return m_pStereoStreams[streamIdx]->readSampleFrames(
+                        WritableSampleFrames(
+                                globalSampleFrames.frameIndexRange(),
+                                writeSamples
+                                        ? SampleBuffer::WritableSlice(
+                                                  m_stemBuffers[streamIdx].data(),
+                                                  stemSampleLength)
+                                        : SampleBuffer::WritableSlice()));
+            });
+
+    // A stream might fail to decode some of the requested frames. Only the
+    // frames that have been decoded for all stems are returned to keep the
+    // stems aligned.
+    const SINT firstFrameIndex = globalSampleFrames.frameIndexRange().start();
+    std::optional<IndexRange> frameIndexRange = globalSampleFrames.frameIndexRange();
+    for (const auto& sampleFrames : stemSampleFrames) {
+        frameIndexRange = intersect2(*frameIndexRange, sampleFrames.frameIndexRange());
+        if (!frameIndexRange || frameIndexRange->empty()) {
+            return ReadableSampleFrames(IndexRange::between(firstFrameIndex, firstFrameIndex));
+        }
+    }
+    if (!writeSamples) {
+        return ReadableSampleFrames(*frameIndexRange);
+    }
+
+    CSAMPLE* pBuffer = globalSampleFrames.writableData(
+            getSignalInfo().frames2samples(frameIndexRange->start() - firstFrameIndex));
     for (int streamIdx = 0; streamIdx < stemCount; streamIdx++) {
-        WritableSampleFrames currentStemFrame = WritableSampleFrames(
-                globalSampleFrames.frameIndexRange(),
-                SampleBuffer::WritableSlice(
-                        m_buffer.data(),
-                        stemSampleLength));
-        m_pStereoStreams[streamIdx]->readSampleFrames(currentStemFrame);
+        const auto& sampleFrames = stemSampleFrames[streamIdx];
+        const CSAMPLE* pStemBuffer = sampleFrames.readableData(
+                m_pStereoStreams[streamIdx]->getSignalInfo().frames2samples(
+                        frameIndexRange->start() - sampleFrames.frameIndexRange().start()));
         // TODO(XXX): currently, stem samples are interleaved and packed next to each other as such:
         //    1L1R1L1R1L1R...2L2R2L2R2L2R2L2R......3L3R3L3R3L3R3L3R......4L4R4L4R4L4R4L4R....
         //    Can FFmpeg decode as without having to use a decoder per channel?
         //    1LLLLLLLLLLLLLL....1RRRRRRRRR...2LLLLLLL...?
 
         // Change the sample layout to interleave all channels together
-        for (SINT i = 0; i < stemSampleLength / 2; i++) {
-            pBuffer[2 * stemCount * i + 2 * streamIdx] = m_buffer[2 * i];
-            pBuffer[2 * stemCount * i + 2 * streamIdx + 1] = m_buffer[2 * i + 1];
+        for (SINT i = 0; i < frameIndexRange->length(); i++) {
+            pBuffer[2 * stemCount * i + 2 * streamIdx] = pStemBuffer[2 * i];
+            pBuffer[2 * stemCount * i + 2 * streamIdx + 1] = pStemBuffer[2 * i + 1];
         }
     }
 
-    return read;
+    return ReadableSampleFrames(*frameIndexRange,
+            SampleBuffer::ReadableSlice(
+                    pBuffer,
+                    getSignalInfo().frames2samples(frameIndexRange->length())));
 }
 
 } // namespace mixxx
@@ -35,7 +35,8 @@ class SoundSourceSTEM : public SoundSource {
   private:
     // Contains each stem source, or the main mix if opened in stereo mode
     std::vector<std::unique_ptr<SoundSourceSingleSTEM>> m_pStereoStreams;
-    SampleBuffer m_buffer;
+    // The decoding buffer of each stem, which are decoded concurrently
+    std::vector<SampleBuffer> m_stemBuffers;
 
   protected:
     OpenResult tryOpen(
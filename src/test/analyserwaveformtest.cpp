@@ -9,6 +9,7 @@
 #include "library/dao/analysisdao.h"
 #include "test/mixxxtest.h"
 #include "track/track.h"
+#include "waveform/waveformfactory.h"
 
 namespace {
 
@@ -129,4 +130,29 @@ TEST_F(AnalyzerWaveformTest, canary) {
     EXPECT_DOUBLE_EQ(pWaveformSummary->getAudioVisualRatio(), 1.0);
 }
 
+// The waveforms are shared with the track before they are complete
+TEST_F(AnalyzerWaveformTest, publishCompletion) {
+    m_aw.initialize(AnalyzerTrack(m_pTrack),
+            m_pTrack->getSampleRate(),
+            kBigBufSize / kChannelCount);
+    ConstWaveformPointer pWaveform = m_pTrack->getWaveform();
+    ASSERT_NE(pWaveform, nullptr);
+    EXPECT_EQ(0, pWaveform->getCompletion());
+    EXPECT_EQ(Waveform::SaveState::NotSaved, pWaveform->saveState());
+    EXPECT_EQ(WaveformFactory::currentWaveformVersion(), pWaveform->getVersion());
+
+    m_aw.processSamples(&m_canaryBigBuf[kCanarySize], kBigBufSize / 2);
+    const int completion = pWaveform->getCompletion();
+    EXPECT_LT(0, completion);
+    EXPECT_GT(pWaveform->getDataSize(), completion);
+    EXPECT_EQ(Waveform::SaveState::NotSaved, pWaveform->saveState());
+
+    m_aw.processSamples(&m_canaryBigBuf[kCanarySize + kBigBufSize / 2], kBigBufSize / 2);
+    EXPECT_LT(completion, pWaveform->getCompletion());
+    m_aw.storeResults(m_pTrack);
+    m_aw.cleanup();
+    EXPECT_EQ(pWaveform->getDataSize(), pWaveform->getCompletion());
+    EXPECT_EQ(Waveform::SaveState::SavePending, pWaveform->saveState());
+}
+
 } // namespace
@@ -0,0 +1,83 @@
+#include "analyzer/analyzerthread.h"
+
+#include <gtest/gtest.h>
+
+#include <QSemaphore>
+
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/cue.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr int kTimeoutMillis = 60000;
+
+const ConfigKey kPipelinedAnalysisConfigKey =
+        ConfigKey{QStringLiteral("[Library]"), QStringLiteral("AnalyzerPipelining")};
+
+class AnalyzerThreadTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    TrackPointer createTestTrack() const {
+        return Track::newTemporary(getTestDir().filePath(QStringLiteral("sine-30.wav")));
+    }
+
+    /// Analyzes the track with a new AnalyzerThread and waits until the
+    /// analysis is done.
+    void analyzeTrack(const TrackPointer& pTrack) {
+        // The waveform analyzer is omitted, it would need a database
+        AnalyzerThread::Pointer pThread = AnalyzerThread::createInstance(
+                0, mixxx::DbConnectionPoolPtr(), config(), AnalyzerModeFlags::WithBeats);
+        QSemaphore idle;
+        QSemaphore done;
+        QObject::connect(pThread.get(),
+                &AnalyzerThread::progress,
+                [&idle, &done](int threadId,
+                        AnalyzerThreadState threadState,
+                        TrackId trackId,
+                        AnalyzerProgress trackProgress) {
+                    Q_UNUSED(threadId);
+                    Q_UNUSED(trackId);
+                    if (threadState == AnalyzerThreadState::Idle) {
+                        idle.release();
+                    } else if (threadState == AnalyzerThreadState::Done) {
+                        EXPECT_EQ(kAnalyzerProgressDone, trackProgress);
+                        done.release();
+                    }
+                });
+        pThread->start();
+        ASSERT_TRUE(idle.tryAcquire(1, kTimeoutMillis));
+        ASSERT_TRUE(pThread->submitNextTrack(AnalyzerTrack(pTrack)));
+        EXPECT_TRUE(done.tryAcquire(1, kTimeoutMillis));
+        pThread->stop();
+        pThread->wait();
+        pThread.reset();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+};
+
+TEST_F(AnalyzerThreadTest, PipelinedAnalysisMatchesSequentialAnalysis) {
+    config()->setValue(kPipelinedAnalysisConfigKey, false);
+    const TrackPointer pSequentialTrack = createTestTrack();
+    analyzeTrack(pSequentialTrack);
+
+    // Decodes the next chunk while the analyzers process the current one
+    // concurrently in the shared pool
+    config()->setValue(kPipelinedAnalysisConfigKey, true);
+    const TrackPointer pPipelinedTrack = createTestTrack();
+    analyzeTrack(pPipelinedTrack);
+
+    EXPECT_EQ(pSequentialTrack->getBpm(), pPipelinedTrack->getBpm());
+    EXPECT_EQ(pSequentialTrack->getKey(), pPipelinedTrack->getKey());
+    EXPECT_EQ(pSequentialTrack->getReplayGain(), pPipelinedTrack->getReplayGain());
+    const CuePointer pSequentialCue =
+            pSequentialTrack->findCueByType(mixxx::CueType::N60dBSound);
+    const CuePointer pPipelinedCue =
+            pPipelinedTrack->findCueByType(mixxx::CueType::N60dBSound);
+    ASSERT_TRUE(pSequentialCue);
+    ASSERT_TRUE(pPipelinedCue);
+    EXPECT_EQ(pSequentialCue->getPosition(), pPipelinedCue->getPosition());
+    EXPECT_EQ(pSequentialCue->getEndPosition(), pPipelinedCue->getEndPosition());
+}
+
+} // namespace
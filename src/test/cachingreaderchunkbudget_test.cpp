@@ -0,0 +1,77 @@
+#include "engine/cachingreader/cachingreaderchunkbudget.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr qint64 kChunkBytes = 65536;
+
+class CachingReaderChunkBudgetTest : public testing::Test {
+};
+
+TEST_F(CachingReaderChunkBudgetTest, ReserveWithinLimit) {
+    CachingReaderChunkBudget budget(4 * kChunkBytes);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(budget.tryReserve(kChunkBytes));
+    }
+    EXPECT_FALSE(budget.tryReserve(kChunkBytes));
+    EXPECT_EQ(4 * kChunkBytes, budget.used());
+
+    budget.release(kChunkBytes);
+    EXPECT_TRUE(budget.tryReserve(kChunkBytes));
+}
+
+TEST_F(CachingReaderChunkBudgetTest, ForceReserveExceedsLimit) {
+    CachingReaderChunkBudget budget(kChunkBytes);
+    budget.forceReserve(2 * kChunkBytes);
+    EXPECT_EQ(2 * kChunkBytes, budget.used());
+    EXPECT_FALSE(budget.tryReserve(kChunkBytes));
+    EXPECT_TRUE(budget.isUnderPressure());
+
+    budget.release(2 * kChunkBytes);
+    EXPECT_EQ(0, budget.used());
+    EXPECT_FALSE(budget.isUnderPressure());
+}
+
+TEST_F(CachingReaderChunkBudgetTest, Pressure) {
+    CachingReaderChunkBudget budget(8 * kChunkBytes);
+    for (int i = 0; i < 7; ++i) {
+        EXPECT_TRUE(budget.tryReserve(kChunkBytes));
+    }
+    EXPECT_FALSE(budget.isUnderPressure());
+    EXPECT_TRUE(budget.tryReserve(kChunkBytes));
+    EXPECT_TRUE(budget.isUnderPressure());
+
+    // Lowering the limit does not release any memory
+    budget.setLimit(2 * kChunkBytes);
+    EXPECT_EQ(8 * kChunkBytes, budget.used());
+    EXPECT_TRUE(budget.isUnderPressure());
+}
+
+TEST_F(CachingReaderChunkBudgetTest, ConcurrentReserve) {
+    constexpr int kThreads = 4;
+    constexpr int kLimitChunks = 1000;
+    CachingReaderChunkBudget budget(kLimitChunks * kChunkBytes);
+    std::vector<int> reservedChunks(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&budget, &reservedChunks, i] {
+            while (budget.tryReserve(kChunkBytes)) {
+                ++reservedChunks[i];
+            }
+        });
+    }
+    int totalChunks = 0;
+    for (int i = 0; i < kThreads; ++i) {
+        threads[i].join();
+        totalChunks += reservedChunks[i];
+    }
+    // The limit is never exceeded
+    EXPECT_EQ(kLimitChunks, totalChunks);
+    EXPECT_EQ(kLimitChunks * kChunkBytes, budget.used());
+}
+
+} // namespace
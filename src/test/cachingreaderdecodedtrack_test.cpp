@@ -0,0 +1,70 @@
+#include "engine/cachingreader/cachingreaderdecodedtrack.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+constexpr auto kChannelCount = mixxx::audio::ChannelCount::stereo();
+
+class CachingReaderDecodedTrackTest : public testing::Test {
+  protected:
+    // A track with 8 frames from 2 to 10, whose samples contain the
+    // frame index and the channel in the fraction
+    CachingReaderDecodedTrackTest()
+            : m_decodedTrack(createSampleBuffer(),
+                      kChannelCount,
+                      mixxx::IndexRange::forward(2, 8)) {
+    }
+
+    static mixxx::SampleBuffer createSampleBuffer() {
+        mixxx::SampleBuffer sampleBuffer(8 * kChannelCount);
+        for (SINT i = 0; i < sampleBuffer.size(); ++i) {
+            sampleBuffer.data()[i] = (i / kChannelCount + 2) + (i % kChannelCount) * 0.5f;
+        }
+        return sampleBuffer;
+    }
+
+    const CachingReaderDecodedTrack m_decodedTrack;
+};
+
+TEST_F(CachingReaderDecodedTrackTest, ReadSampleFrames) {
+    std::vector<CSAMPLE> buffer(4 * kChannelCount, -1.0f);
+    // The first frame is before the track
+    const auto readFrames = m_decodedTrack.readSampleFrames(
+            buffer.data(), kChannelCount, mixxx::IndexRange::forward(1, 4));
+    EXPECT_EQ(mixxx::IndexRange::forward(2, 3), readFrames);
+    EXPECT_EQ(-1.0f, buffer[0]);
+    EXPECT_EQ(-1.0f, buffer[1]);
+    EXPECT_EQ(2.0f, buffer[2]);
+    EXPECT_EQ(2.5f, buffer[3]);
+    EXPECT_EQ(4.0f, buffer[6]);
+    EXPECT_EQ(4.5f, buffer[7]);
+}
+
+TEST_F(CachingReaderDecodedTrackTest, ReadSampleFramesReverse) {
+    std::vector<CSAMPLE> buffer(4 * kChannelCount, -1.0f);
+    // The last frame is after the track
+    const auto readFrames = m_decodedTrack.readSampleFramesReverse(
+            buffer.data() + buffer.size(), kChannelCount, mixxx::IndexRange::forward(7, 4));
+    EXPECT_EQ(mixxx::IndexRange::forward(7, 3), readFrames);
+    EXPECT_EQ(-1.0f, buffer[0]);
+    EXPECT_EQ(-1.0f, buffer[1]);
+    EXPECT_EQ(9.0f, buffer[2]);
+    EXPECT_EQ(9.5f, buffer[3]);
+    EXPECT_EQ(7.0f, buffer[6]);
+    EXPECT_EQ(7.5f, buffer[7]);
+}
+
+TEST_F(CachingReaderDecodedTrackTest, ReadOutsideOfTrack) {
+    std::vector<CSAMPLE> buffer(4 * kChannelCount, -1.0f);
+    EXPECT_TRUE(m_decodedTrack
+                        .readSampleFrames(buffer.data(),
+                                kChannelCount,
+                                mixxx::IndexRange::forward(10, 4))
+                        .empty());
+    EXPECT_EQ(-1.0f, buffer[0]);
+}
+
+} // namespace
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "engine/channelprocessingpool.h"
+
+namespace {
+
+struct TaskCounters {
+    std::vector<std::atomic<int>> counts;
+
+    explicit TaskCounters(int numTasks)
+            : counts(numTasks) {
+    }
+
+    static void count(void* pContext, int taskIndex) {
+        static_cast<TaskCounters*>(pContext)->counts[taskIndex].fetch_add(1);
+    }
+};
+
+TEST(ChannelProcessingPoolTest, EachTaskRunsExactlyOnce) {
+    ChannelProcessingPool pool(3, false);
+    EXPECT_EQ(3, pool.numHelpers());
+
+    constexpr int kNumTasks = 16;
+    constexpr int kNumRuns = 1000;
+    TaskCounters counters(kNumTasks);
+    for (int run = 0; run < kNumRuns; ++run) {
+        pool.run(&TaskCounters::count, &counters, kNumTasks);
+    }
+    for (int i = 0; i < kNumTasks; ++i) {
+        EXPECT_EQ(kNumRuns, counters.counts[i].load());
+    }
+}
+
+TEST(ChannelProcessingPoolTest, VaryingTaskCounts) {
+    ChannelProcessingPool pool(2, false);
+
+    constexpr int kMaxTasks = 8;
+    TaskCounters counters(kMaxTasks);
+    int expected[kMaxTasks] = {};
+    for (int run = 0; run < 500; ++run) {
+        const int numTasks = run % (kMaxTasks + 1);
+        pool.run(&TaskCounters::count, &counters, numTasks);
+        for (int i = 0; i < numTasks; ++i) {
+            ++expected[i];
+        }
+    }
+    for (int i = 0; i < kMaxTasks; ++i) {
+        EXPECT_EQ(expected[i], counters.counts[i].load());
+    }
+}
+
+TEST(ChannelProcessingPoolTest, NoHelpersRunsOnCallingThread) {
+    ChannelProcessingPool pool(0, false);
+    EXPECT_EQ(0, pool.numHelpers());
+
+    TaskCounters counters(4);
+    pool.run(&TaskCounters::count, &counters, 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(1, counters.counts[i].load());
+    }
+}
+
+} // namespace
@@ -49,3 +49,21 @@ TEST_F(ControllerRenderingEngineTest, createValidRendererWithSupportedTypes) {
         EXPECT_TRUE(screenTest.stop());
     }
 }
+
+TEST_F(ControllerRenderingEngineTest, changedAreaOfFrames) {
+    QImage previous(QSize(40, 20), QImage::Format_RGB16);
+    previous.fill(Qt::black);
+    QImage current = previous.copy();
+
+    // Without a previous frame, the whole frame has changed
+    EXPECT_EQ(current.rect(), ControllerRenderingEngine::changedArea(QImage(), current));
+    EXPECT_TRUE(ControllerRenderingEngine::changedArea(previous, current).isEmpty());
+
+    current.setPixelColor(5, 7, Qt::white);
+    EXPECT_EQ(QRect(5, 7, 1, 1), ControllerRenderingEngine::changedArea(previous, current));
+
+    current.setPixelColor(39, 2, Qt::white);
+    current.setPixelColor(12, 19, Qt::white);
+    EXPECT_EQ(QRect(QPoint(5, 2), QPoint(39, 19)),
+            ControllerRenderingEngine::changedArea(previous, current));
+}
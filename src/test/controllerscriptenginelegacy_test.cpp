@@ -96,12 +96,12 @@ class ControllerScriptEngineLegacyTest : public ControllerScriptEngineLegacy, pu
             const LegacyControllerMapping::ScreenInfo& screeninfo,
             const QImage& frame,
             const QDateTime& timestamp) {
-        handleScreenFrame(screeninfo, frame, timestamp);
+        handleScreenFrame(screeninfo, frame, frame.rect(), timestamp);
     }
 
     TransformScreenFrameFunction newTransformScreenFrameFunction(
             QMetaMethod method, bool typed) const {
-        return TransformScreenFrameFunction{method, typed};
+        return TransformScreenFrameFunction{method, typed, false};
     }
 #endif
 };
@@ -275,6 +275,89 @@ TEST_F(ControllerScriptEngineLegacyTest, softTakeover_ignoreNextValue) {
     EXPECT_DOUBLE_EQ(0.0, co->get());
 }
 
+TEST_F(ControllerScriptEngineLegacyTest, controlHandle_getSetValue) {
+    auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
+            -10.0,
+            10.0);
+    EXPECT_TRUE(evaluateAndAssert(
+            "var handle = engine.getControlHandle('[Test]', 'co');"
+            "handle.setValue(2.0);"));
+    EXPECT_DOUBLE_EQ(2.0, co->get());
+    EXPECT_DOUBLE_EQ(2.0, evaluate("handle.getValue();").toNumber());
+    EXPECT_TRUE(evaluateAndAssert("handle.setParameter(1.0);"));
+    EXPECT_DOUBLE_EQ(10.0, co->get());
+    EXPECT_DOUBLE_EQ(1.0, evaluate("handle.getParameter();").toNumber());
+    EXPECT_TRUE(evaluateAndAssert("handle.setValue(NaN);"));
+    EXPECT_DOUBLE_EQ(10.0, co->get());
+    EXPECT_TRUE(evaluateAndAssert("handle.reset();"));
+    EXPECT_DOUBLE_EQ(0.0, co->get());
+    EXPECT_EQ(QStringLiteral("[Test]"), evaluate("handle.group;").toString());
+    EXPECT_EQ(QStringLiteral("co"), evaluate("handle.name;").toString());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, controlHandle_InvalidControl) {
+    EXPECT_TRUE(evaluate("engine.getControlHandle('[Nothing]', 'nothing');").isUndefined());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, controlHandle_getSetValues) {
+    auto co1 = std::make_unique<ControlObject>(ConfigKey("[Test]", "co1"));
+    auto co2 = std::make_unique<ControlObject>(ConfigKey("[Test]", "co2"));
+    co1->set(1.0);
+    co2->set(2.0);
+    EXPECT_TRUE(evaluateAndAssert(
+            "var handles = [engine.getControlHandle('[Test]', 'co1'),"
+            "  engine.getControlHandle('[Test]', 'co2')];"
+            "var values = engine.getValues(handles);"));
+    EXPECT_DOUBLE_EQ(1.0, evaluate("values[0];").toNumber());
+    EXPECT_DOUBLE_EQ(2.0, evaluate("values[1];").toNumber());
+
+    EXPECT_TRUE(evaluateAndAssert("engine.setValues(handles, [3.0, 4.0]);"));
+    EXPECT_DOUBLE_EQ(3.0, co1->get());
+    EXPECT_DOUBLE_EQ(4.0, co2->get());
+
+    // Mismatching arrays are rejected as a whole
+    EXPECT_TRUE(evaluateAndAssert("engine.setValues(handles, [5.0]);"));
+    EXPECT_DOUBLE_EQ(3.0, co1->get());
+    EXPECT_DOUBLE_EQ(4.0, co2->get());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, controlHandle_softTakeover) {
+    auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
+            -10.0,
+            10.0);
+    co->setParameter(0.0);
+    EXPECT_TRUE(evaluateAndAssert(
+            "engine.softTakeover('[Test]', 'co', true);"
+            "var handle = engine.getControlHandle('[Test]', 'co');"
+            "handle.setValue(0.0);"));
+    // The first set after enabling is always ignored.
+    EXPECT_DOUBLE_EQ(-10.0, co->get());
+
+    // Advance time to 2x the threshold.
+    mixxx::Time::setTestElapsedTime(SoftTakeover::TestAccess::getTimeThreshold() * 2);
+
+    // Change the control internally (putting it out of sync with the
+    // ControllerEngine).
+    co->setParameter(0.5);
+
+    // Ignore the change since it occurred after the threshold and is too large.
+    EXPECT_TRUE(evaluateAndAssert("engine.setValues([handle], [-10.0]);"));
+    EXPECT_DOUBLE_EQ(0.0, co->get());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, controlHandle_makeConnection) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    auto pass = std::make_unique<ControlObject>(ConfigKey("[Test]", "passed"));
+
+    EXPECT_TRUE(evaluateAndAssert(
+            "var passed = engine.getControlHandle('[Test]', 'passed');"
+            "var connection = engine.getControlHandle('[Test]', 'co')"
+            "  .makeConnection(function(value) { passed.setValue(value); });"));
+    co->set(3.0);
+    processEvents();
+    EXPECT_DOUBLE_EQ(3.0, pass->get());
+}
+
 TEST_F(ControllerScriptEngineLegacyTest, reset) {
     // Test that NaNs are ignored.
     auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <QSqlQuery>
+#include <thread>
+
 #include "library/dao/settingsdao.h"
 #include "test/mixxxdbtest.h"
+#include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
 
 class DbConnectionPoolTest : public MixxxTest {};
@@ -20,3 +24,51 @@ TEST_F(DbConnectionPoolTest, MoveSemantics) {
     EXPECT_TRUE(p1.isPooling());
     EXPECT_FALSE(p2.isPooling());
 }
+
+TEST_F(DbConnectionPoolTest, WriteAheadLogDoesNotBlockWriters) {
+    config()->setValue(MixxxDb::kWriteAheadLogConfigKey, true);
+    const auto pDbConnectionPool = MixxxDb(config()).connectionPool();
+    mixxx::DbConnectionPooler readerPooler(pDbConnectionPool);
+    ASSERT_TRUE(readerPooler.isPooling());
+    QSqlDatabase reader = mixxx::DbConnectionPooled(pDbConnectionPool);
+
+    QSqlQuery query(reader);
+    ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(QStringLiteral("wal"), query.value(0).toString());
+    ASSERT_TRUE(query.exec("CREATE TABLE IF NOT EXISTS wal_test (value INTEGER)"));
+    ASSERT_TRUE(query.exec("DELETE FROM wal_test"));
+    ASSERT_TRUE(query.exec("INSERT INTO wal_test VALUES (1)"));
+
+    // A reader in the middle of a query, like a library view...
+    ASSERT_TRUE(reader.transaction());
+    ASSERT_TRUE(query.exec("SELECT value FROM wal_test"));
+    ASSERT_TRUE(query.next());
+
+    // ...doesn't block the commit of a writer on another thread, like
+    // the library scanner. With a rollback journal the writer would wait
+    // for the busy timeout and fail.
+    bool committed = false;
+    std::thread writerThread([&pDbConnectionPool, &committed] {
+        mixxx::DbConnectionPooler writerPooler(pDbConnectionPool);
+        QSqlDatabase writer = mixxx::DbConnectionPooled(pDbConnectionPool);
+        QSqlQuery writerQuery(writer);
+        if (writer.transaction() &&
+                writerQuery.exec("INSERT INTO wal_test VALUES (2)")) {
+            committed = writer.commit();
+        }
+    });
+    writerThread.join();
+    EXPECT_TRUE(committed);
+
+    // The reader still sees its snapshot until it ends the transaction
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM wal_test"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(1, query.value(0).toInt());
+    query.finish();
+    ASSERT_TRUE(reader.commit());
+
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM wal_test"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(2, query.value(0).toInt());
+}
@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "engine/filters/enginefilterbessel4.h"
+#include "engine/filters/enginefilterbessel8.h"
+#include "engine/filters/enginefilterlinkwitzriley8.h"
+
+namespace {
+
+constexpr auto kSampleRate = mixxx::audio::SampleRate(44100);
+constexpr int kBufferSize = 1024;
+
+std::vector<CSAMPLE> createInput(int bufferSize) {
+    std::vector<CSAMPLE> input(bufferSize);
+    for (int i = 0; i < bufferSize; i += 2) {
+        // Different signals on the left and the right channel
+        input[i] = static_cast<CSAMPLE>(0.5 * std::sin(i * 0.01) + 0.25 * std::sin(i * 0.37));
+        input[i + 1] = static_cast<CSAMPLE>(0.5 * std::cos(i * 0.003) - 0.2 * std::sin(i * 1.1));
+    }
+    return input;
+}
+
+// Processes each channel with the scalar kernel of the filter, like
+// EngineFilterIIR did before both channels were processed together.
+template<typename Filter, unsigned int SIZE>
+class ReferenceFilter : public Filter {
+  public:
+    using Filter::Filter;
+
+    void processReference(const CSAMPLE* pIn,
+            CSAMPLE* pOutput,
+            int bufferSize,
+            const double* coef,
+            double (*buf)[SIZE]) {
+        for (int i = 0; i < bufferSize; i += 2) {
+            pOutput[i] = static_cast<CSAMPLE>(
+                    Filter::template processSample<double>(coef, buf[0], pIn[i]));
+            pOutput[i + 1] = static_cast<CSAMPLE>(
+                    Filter::template processSample<double>(coef, buf[1], pIn[i + 1]));
+        }
+    }
+
+    const double* coef() const {
+        return this->m_coef;
+    }
+};
+
+template<typename Filter, unsigned int SIZE>
+void expectMatchesReference(double freq1, double freq2) {
+    ReferenceFilter<Filter, SIZE> filter(kSampleRate, freq1);
+    filter.assumeSettled();
+    const std::vector<CSAMPLE> input = createInput(kBufferSize);
+    std::vector<CSAMPLE> output(kBufferSize);
+    std::vector<CSAMPLE> expected(kBufferSize);
+    double buf[2][SIZE] = {};
+    for (int block = 0; block < 4; ++block) {
+        filter.process(input.data(), output.data(), kBufferSize);
+        filter.processReference(input.data(), expected.data(), kBufferSize, filter.coef(), buf);
+        for (int i = 0; i < kBufferSize; ++i) {
+            ASSERT_NEAR(expected[i], output[i], 1e-6) << block << " " << i;
+        }
+    }
+
+    // Changing the coefficients cross fades from the old filter to a new
+    // filter that starts from silence
+    std::vector<double> oldCoef(filter.coef(), filter.coef() + SIZE + 1);
+    filter.setFrequencyCorners(kSampleRate, freq2);
+    double newBuf[2][SIZE] = {};
+    std::vector<CSAMPLE> oldOutput(kBufferSize);
+    std::vector<CSAMPLE> newOutput(kBufferSize);
+    filter.process(input.data(), output.data(), kBufferSize);
+    filter.processReference(input.data(), oldOutput.data(), kBufferSize, oldCoef.data(), buf);
+    filter.processReference(input.data(), newOutput.data(), kBufferSize, filter.coef(), newBuf);
+    double crossMix = 0.0;
+    const double crossInc = 4.0 / kBufferSize;
+    for (int i = 0; i < kBufferSize; i += 2) {
+        for (int channel = 0; channel < 2; ++channel) {
+            double sample = oldOutput[i + channel];
+            if (i >= kBufferSize / 2) {
+                sample = newOutput[i + channel] * crossMix + sample * (1.0 - crossMix);
+            }
+            ASSERT_NEAR(sample, output[i + channel], 1e-6) << i + channel;
+        }
+        if (i >= kBufferSize / 2) {
+            crossMix += crossInc;
+        }
+    }
+
+    filter.process(input.data(), output.data(), kBufferSize);
+    filter.processReference(input.data(), expected.data(), kBufferSize, filter.coef(), newBuf);
+    for (int i = 0; i < kBufferSize; ++i) {
+        ASSERT_NEAR(expected[i], output[i], 1e-6) << i;
+    }
+}
+
+class EngineFilterIIRTest : public testing::Test {
+};
+
+TEST_F(EngineFilterIIRTest, Bessel4LowMatchesReference) {
+    expectMatchesReference<EngineFilterBessel4Low, 4>(246, 1000);
+}
+
+TEST_F(EngineFilterIIRTest, Bessel4HighMatchesReference) {
+    expectMatchesReference<EngineFilterBessel4High, 4>(2484, 800);
+}
+
+TEST_F(EngineFilterIIRTest, Bessel8LowMatchesReference) {
+    expectMatchesReference<EngineFilterBessel8Low, 8>(246, 60);
+}
+
+TEST_F(EngineFilterIIRTest, LinkwitzRiley8HighMatchesReference) {
+    expectMatchesReference<EngineFilterLinkwitzRiley8High, 8>(2484, 5000);
+}
+
+template<typename Filter>
+void processFilter(benchmark::State& state, Filter* pFilter) {
+    const int bufferSize = static_cast<int>(state.range(0));
+    const std::vector<CSAMPLE> input = createInput(bufferSize);
+    std::vector<CSAMPLE> output(bufferSize);
+    pFilter->assumeSettled();
+    for (auto _ : state) {
+        pFilter->process(input.data(), output.data(), bufferSize);
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+static void BM_EngineFilterBessel4Low(benchmark::State& state) {
+    EngineFilterBessel4Low filter(kSampleRate, 246);
+    processFilter(state, &filter);
+}
+BENCHMARK(BM_EngineFilterBessel4Low)->Range(64, 4 << 10);
+
+static void BM_EngineFilterBessel4Band(benchmark::State& state) {
+    EngineFilterBessel4Band filter(kSampleRate, 246, 2484);
+    processFilter(state, &filter);
+}
+BENCHMARK(BM_EngineFilterBessel4Band)->Range(64, 4 << 10);
+
+static void BM_EngineFilterBessel8Band(benchmark::State& state) {
+    EngineFilterBessel8Band filter(kSampleRate, 246, 2484);
+    processFilter(state, &filter);
+}
+BENCHMARK(BM_EngineFilterBessel8Band)->Range(64, 4 << 10);
+
+static void BM_EngineFilterLinkwitzRiley8High(benchmark::State& state) {
+    EngineFilterLinkwitzRiley8High filter(kSampleRate, 2484);
+    processFilter(state, &filter);
+}
+BENCHMARK(BM_EngineFilterLinkwitzRiley8High)->Range(64, 4 << 10);
+
+} // namespace
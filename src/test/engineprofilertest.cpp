@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include "engine/engineprofiler.h"
+#include "test/mixxxtest.h"
+#include "util/loglinearhistogram.h"
+
+namespace {
+
+constexpr auto kBudget = mixxx::Duration::fromMillis(1);
+
+class EngineProfilerTest : public MixxxTest {
+  protected:
+    EngineProfilerTest()
+            : m_stage(EngineProfiler::registerStage(QStringLiteral("[Test] stage"))) {
+        m_profiler.setEnabled(true);
+    }
+
+    void processCallback(mixxx::Duration stageDuration,
+            mixxx::Duration callbackDuration = mixxx::Duration::fromMicros(50)) {
+        EngineProfiler::beginCallback();
+        EngineProfiler::record(m_stage, stageDuration);
+        // Stages that are processed more than once are added up
+        EngineProfiler::record(m_stage, mixxx::Duration::fromMicros(15));
+        EngineProfiler::endCallback(callbackDuration, kBudget);
+    }
+
+    // Samples are aggregated once a later callback has been collected, so
+    // this processes another callback that is not aggregated itself
+    void collectAll() {
+        EngineProfiler::beginCallback();
+        EngineProfiler::endCallback(mixxx::Duration::fromMicros(1), kBudget);
+        m_profiler.collect();
+        m_profiler.collect();
+    }
+
+    EngineProfiler::StageReport stageReport(const QString& name) {
+        const auto reports = m_profiler.stageReports();
+        for (const auto& report : reports) {
+            if (report.name == name) {
+                return report;
+            }
+        }
+        return EngineProfiler::StageReport();
+    }
+
+    EngineProfiler m_profiler;
+    const EngineProfiler::StageId m_stage;
+};
+
+TEST_F(EngineProfilerTest, HistogramPercentiles) {
+    mixxx::LogLinearHistogram histogram;
+    EXPECT_EQ(0u, histogram.percentile(0.5));
+    for (quint64 value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(100000u, histogram.count());
+    EXPECT_EQ(1u, histogram.min());
+    EXPECT_EQ(100000u, histogram.max());
+    EXPECT_DOUBLE_EQ(50000.5, histogram.mean());
+    // The relative error is bounded by the bucket size
+    EXPECT_NEAR(50000.0, histogram.percentile(0.5), 50000.0 / 32);
+    EXPECT_NEAR(99000.0, histogram.percentile(0.99), 99000.0 / 32);
+    EXPECT_NEAR(99900.0, histogram.percentile(0.999), 99900.0 / 32);
+    EXPECT_EQ(100000u, histogram.percentile(1.0));
+
+    // Small values are exact
+    for (quint64 value = 0; value < 2 * mixxx::LogLinearHistogram::kSubBuckets; ++value) {
+        EXPECT_EQ(value,
+                mixxx::LogLinearHistogram::bucketUpperBound(
+                        mixxx::LogLinearHistogram::bucketIndex(value)));
+    }
+    // Each value is within the bounds of its bucket
+    for (quint64 value = 1; value < mixxx::LogLinearHistogram::kMaxValue; value = value * 3 + 1) {
+        const int index = mixxx::LogLinearHistogram::bucketIndex(value);
+        EXPECT_LE(value, mixxx::LogLinearHistogram::bucketUpperBound(index));
+        EXPECT_GT(value, mixxx::LogLinearHistogram::bucketUpperBound(index - 1));
+    }
+}
+
+TEST_F(EngineProfilerTest, AggregatesPerCallback) {
+    for (int i = 0; i < 100; ++i) {
+        if (i == 50) {
+            processCallback(mixxx::Duration::fromMicros(110));
+            // Accounted to this callback, when the next callback starts
+            EngineProfiler::reportXrun();
+        } else if (i == 70) {
+            processCallback(mixxx::Duration::fromMicros(10), mixxx::Duration::fromMillis(2));
+        } else {
+            processCallback(mixxx::Duration::fromMicros(10));
+        }
+    }
+    collectAll();
+
+    const auto report = stageReport(QStringLiteral("[Test] stage"));
+    EXPECT_EQ(100u, report.callbacks);
+    // Percentiles are as precise as the buckets of the histogram
+    EXPECT_NEAR(25.0, report.p50.toDoubleMicros(), 25.0 / 32);
+    EXPECT_NEAR(25.0, report.p99.toDoubleMicros(), 25.0 / 32);
+    EXPECT_EQ(mixxx::Duration::fromMicros(125), report.p999);
+    EXPECT_EQ(mixxx::Duration::fromMicros(125), report.max);
+    EXPECT_EQ(mixxx::Duration::fromMicros(26), report.mean);
+    // The xrun and the overrun
+    EXPECT_EQ(2u, report.lateCallbacks);
+    EXPECT_EQ(mixxx::Duration::fromMicros(75), report.lateMean);
+    EXPECT_EQ(mixxx::Duration::fromMicros(125), report.lateMax);
+
+    const auto callbackReport = stageReport(QStringLiteral("EngineMixer::process"));
+    EXPECT_EQ(100u, callbackReport.callbacks);
+    EXPECT_NEAR(50.0, callbackReport.p50.toDoubleMicros(), 50.0 / 32);
+    EXPECT_EQ(mixxx::Duration::fromMillis(2), callbackReport.max);
+    EXPECT_EQ(2u, callbackReport.lateCallbacks);
+
+    m_profiler.reset();
+    EXPECT_TRUE(m_profiler.stageReports().isEmpty());
+}
+
+TEST_F(EngineProfilerTest, Disabled) {
+    m_profiler.setEnabled(false);
+    EXPECT_FALSE(EngineProfiler::isActive());
+    processCallback(mixxx::Duration::fromMicros(10));
+    collectAll();
+    EXPECT_TRUE(m_profiler.stageReports().isEmpty());
+}
+
+static void BM_ScopedEngineStage(benchmark::State& state) {
+    EngineProfiler profiler;
+    profiler.setEnabled(state.range(0) != 0);
+    const auto stage = EngineProfiler::registerStage(QStringLiteral("[Benchmark] stage"));
+    for (auto _ : state) {
+        EngineProfiler::beginCallback();
+        {
+            ScopedEngineStage scopedStage(stage);
+            benchmark::ClobberMemory();
+        }
+        EngineProfiler::endCallback(mixxx::Duration::fromMicros(1), kBudget);
+        // Do not measure dropped samples
+        state.PauseTiming();
+        profiler.collect();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_ScopedEngineStage)->Arg(0)->Arg(1);
+
+} // namespace
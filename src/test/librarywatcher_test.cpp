@@ -0,0 +1,89 @@
+#include "library/scanner/librarywatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+// Less than the settle delay of the watcher
+constexpr auto kEventDelay = mixxx::Duration::fromMillis(500);
+
+class LibraryWatcherTest : public MixxxTest {
+  protected:
+    LibraryWatcherTest()
+            : m_rootDir(m_tempDir.path()),
+              m_albumDir(QDir(m_tempDir.path()).filePath(QStringLiteral("album"))) {
+        QDir(m_rootDir).mkdir(QStringLiteral("album"));
+        QObject::connect(&m_watcher,
+                &LibraryWatcher::directoriesChanged,
+                [this](const QStringList& directories) {
+                    m_reportedDirectories.append(directories);
+                });
+        m_watcher.setDirectories({mixxx::FileInfo(m_rootDir)},
+                {m_rootDir, m_albumDir});
+    }
+
+    void createFile(const QString& directory, const QString& fileName) {
+        QFile file(QDir(directory).filePath(fileName));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("data");
+    }
+
+    /// Processes the events of the file system watcher and reports the
+    /// journaled changes without waiting for them to settle
+    void reportChanges() {
+        PerformanceTimer timer;
+        timer.start();
+        while (timer.elapsed() < kEventDelay) {
+            application()->processEvents(QEventLoop::AllEvents, 50);
+        }
+        m_watcher.reportChangedDirectories();
+    }
+
+    QTemporaryDir m_tempDir;
+    const QString m_rootDir;
+    const QString m_albumDir;
+    LibraryWatcher m_watcher;
+    QList<QStringList> m_reportedDirectories;
+};
+
+TEST_F(LibraryWatcherTest, ReportsChangedDirectoriesOnce) {
+    ASSERT_EQ(2, m_watcher.numWatchedDirectories() + m_watcher.numPolledDirectories());
+
+    createFile(m_albumDir, QStringLiteral("track1.mp3"));
+    createFile(m_albumDir, QStringLiteral("track2.mp3"));
+    if (m_watcher.numPolledDirectories() > 0) {
+        m_watcher.pollDirectories();
+    }
+    reportChanges();
+
+    ASSERT_EQ(1, m_reportedDirectories.size());
+    EXPECT_EQ(QStringList{m_albumDir}, m_reportedDirectories.first());
+
+    // Nothing left to report
+    m_watcher.reportChangedDirectories();
+    EXPECT_EQ(1, m_reportedDirectories.size());
+}
+
+TEST_F(LibraryWatcherTest, ReportsDeletedDirectory) {
+    ASSERT_TRUE(QDir(m_albumDir).removeRecursively());
+    if (m_watcher.numPolledDirectories() > 0) {
+        m_watcher.pollDirectories();
+    }
+    reportChanges();
+
+    ASSERT_FALSE(m_reportedDirectories.isEmpty());
+    QStringList reportedDirectories;
+    for (const auto& directories : std::as_const(m_reportedDirectories)) {
+        reportedDirectories.append(directories);
+    }
+    EXPECT_TRUE(reportedDirectories.contains(m_rootDir));
+}
+
+} // namespace
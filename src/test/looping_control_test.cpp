@@ -92,6 +92,12 @@ class LoopingControlTest : public MockedEngineBackendTest {
         return m_pChannel1->getEngineBuffer()->m_pLoopingControl->frameInfo().currentPosition;
     }
 
+    HintVector hintReader() {
+        HintVector hints;
+        m_pChannel1->getEngineBuffer()->m_pLoopingControl->hintReader(&hints);
+        return hints;
+    }
+
     bool isLoopEnabled() {
         return m_pLoopEnabled->get() > 0.0;
     }
@@ -1329,3 +1335,43 @@ TEST_F(LoopingControlTest, LoopBeatloopReverse) {
         EXPECT_EQ(0.0, m_pSlipEnabled->get());
     }
 }
+
+TEST_F(LoopingControlTest, HintReader_PrefetchesBeatJumpTargetsAndLoopStart) {
+    m_pTrack1->trySetBpm(mixxx::Bpm{60});
+    m_pQuantizeEnabled->set(0);
+    m_pBeatJumpSize->set(4);
+    m_pBeatLoopSize->set(2);
+    setCurrentPosition(mixxx::audio::FramePos{44100 * 8});
+
+    QList<SINT> beatJumpFrames;
+    QList<SINT> loopStartFrames;
+    for (const Hint& hint : hintReader()) {
+        if (hint.type == Hint::Type::BeatJump) {
+            beatJumpFrames.append(hint.frame);
+        } else if (hint.type == Hint::Type::LoopStart) {
+            loopStartFrames.append(hint.frame);
+        } else {
+            continue;
+        }
+        // Only read when no chunks for the play position are requested
+        EXPECT_TRUE(hint.isPrefetch());
+    }
+    EXPECT_EQ(QList<SINT>({44100 * 12, 44100 * 4}), beatJumpFrames);
+    // The start of a beatloop that would end at the play position
+    EXPECT_EQ(QList<SINT>({44100 * 6}), loopStartFrames);
+
+    // The boundaries of an enabled loop are requested with normal priority
+    m_pButtonBeatLoopActivate->set(1);
+    m_pButtonBeatLoopActivate->set(0);
+    ProcessBuffer();
+    ASSERT_TRUE(isLoopEnabled());
+    int loopBoundaryHintCount = 0;
+    for (const Hint& hint : hintReader()) {
+        if (hint.type == Hint::Type::LoopStartEnabled ||
+                hint.type == Hint::Type::LoopEndEnabled) {
+            EXPECT_FALSE(hint.isPrefetch());
+            ++loopBoundaryHintCount;
+        }
+    }
+    EXPECT_EQ(2, loopBoundaryHintCount);
+}
@@ -27,7 +27,6 @@ class MockMidiController : public MidiController {
                     unsigned char byte1,
                     unsigned char byte2));
     MOCK_METHOD1(sendBytes, void(const QByteArray& data));
-    MOCK_CONST_METHOD0(isPolling, bool());
 };
 
 class MidiControllerTest : public MixxxTest {
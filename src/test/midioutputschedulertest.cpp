@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <QVector>
+
+#include "controllers/midi/midioutputscheduler.h"
+#include "test/mixxxtest.h"
+#include "util/time.h"
+
+namespace {
+
+struct Message {
+    unsigned char status;
+    unsigned char byte1;
+    unsigned char byte2;
+
+    bool operator==(const Message& other) const {
+        return status == other.status && byte1 == other.byte1 && byte2 == other.byte2;
+    }
+};
+
+void PrintTo(const Message& message, std::ostream* os) {
+    *os << std::hex << static_cast<int>(message.status) << " "
+        << static_cast<int>(message.byte1) << " "
+        << static_cast<int>(message.byte2);
+}
+
+class MidiOutputSchedulerTest : public MixxxTest {
+  protected:
+    MidiOutputSchedulerTest()
+            : m_scheduler([this](unsigned char status,
+                                  unsigned char byte1,
+                                  unsigned char byte2) {
+                  m_sentMessages.append(Message{status, byte1, byte2});
+              }) {
+        mixxx::Time::setTestMode(true);
+        setFrame(1);
+    }
+
+    ~MidiOutputSchedulerTest() override {
+        mixxx::Time::setTestMode(false);
+    }
+
+    void setFrame(int frame) {
+        mixxx::Time::setTestElapsedTime(MidiOutputScheduler::kFrameDuration * frame);
+    }
+
+    QVector<Message> takeSentMessages() {
+        QVector<Message> messages;
+        messages.swap(m_sentMessages);
+        return messages;
+    }
+
+    QVector<Message> m_sentMessages;
+    MidiOutputScheduler m_scheduler;
+};
+
+TEST_F(MidiOutputSchedulerTest, DropsUnchangedState) {
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F);
+    EXPECT_EQ(QVector<Message>({{0x90, 0x10, 0x7F}}), takeSentMessages());
+
+    setFrame(2);
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F);
+    EXPECT_TRUE(takeSentMessages().isEmpty());
+
+    // Note off sets the same output as note on
+    m_scheduler.sendShortMsg(0x80, 0x10, 0x00);
+    EXPECT_EQ(QVector<Message>({{0x80, 0x10, 0x00}}), takeSentMessages());
+
+    // Received input invalidates the state of the output
+    setFrame(3);
+    m_scheduler.invalidate(0x90, 0x10);
+    m_scheduler.sendShortMsg(0x80, 0x10, 0x00);
+    EXPECT_EQ(QVector<Message>({{0x80, 0x10, 0x00}}), takeSentMessages());
+}
+
+TEST_F(MidiOutputSchedulerTest, SendsForcedAndInvalidatedState) {
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x01);
+    EXPECT_EQ(QVector<Message>({{0x90, 0x10, 0x7F}, {0xB0, 0x20, 0x01}}),
+            takeSentMessages());
+
+    setFrame(2);
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F, true);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x01);
+    EXPECT_EQ(QVector<Message>({{0x90, 0x10, 0x7F}}), takeSentMessages());
+
+    // A forced message within the same frame is still rate-limited
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F, true);
+    EXPECT_TRUE(takeSentMessages().isEmpty());
+    setFrame(3);
+    m_scheduler.sendPendingMessages();
+    EXPECT_EQ(QVector<Message>({{0x90, 0x10, 0x7F}}), takeSentMessages());
+
+    setFrame(4);
+    m_scheduler.invalidateAll();
+    m_scheduler.sendShortMsg(0x90, 0x10, 0x7F);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x01);
+    EXPECT_EQ(QVector<Message>({{0x90, 0x10, 0x7F}, {0xB0, 0x20, 0x01}}),
+            takeSentMessages());
+}
+
+TEST_F(MidiOutputSchedulerTest, CoalescesChangesWithinFrame) {
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x01);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x02);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x03);
+    // Other outputs are not delayed
+    m_scheduler.sendShortMsg(0xB1, 0x20, 0x04);
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x20, 0x01}, {0xB1, 0x20, 0x04}}),
+            takeSentMessages());
+
+    setFrame(2);
+    m_scheduler.sendPendingMessages();
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x20, 0x03}}), takeSentMessages());
+
+    // A pending message that restores the sent state is dropped
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x05);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x03);
+    setFrame(3);
+    m_scheduler.sendPendingMessages();
+    EXPECT_TRUE(takeSentMessages().isEmpty());
+}
+
+TEST_F(MidiOutputSchedulerTest, Sends14BitControllersInOrder) {
+    m_scheduler.sendShortMsg(0xB0, 0x01, 0x10);
+    m_scheduler.sendShortMsg(0xB0, 0x21, 0x20);
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x01, 0x10}, {0xB0, 0x21, 0x20}}),
+            takeSentMessages());
+
+    // Only the MSB has been sent in this frame, the LSB must not overtake
+    // the pending MSB
+    setFrame(2);
+    m_scheduler.sendShortMsg(0xB0, 0x01, 0x11);
+    m_scheduler.sendShortMsg(0xB0, 0x01, 0x12);
+    m_scheduler.sendShortMsg(0xB0, 0x21, 0x22);
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x01, 0x11}}), takeSentMessages());
+    setFrame(3);
+    m_scheduler.sendPendingMessages();
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x01, 0x12}, {0xB0, 0x21, 0x22}}),
+            takeSentMessages());
+
+    // The MSB is sent first, even if the LSB has been pending first
+    m_scheduler.sendShortMsg(0xB0, 0x21, 0x23);
+    m_scheduler.sendShortMsg(0xB0, 0x01, 0x13);
+    setFrame(4);
+    m_scheduler.sendPendingMessages();
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x01, 0x13}, {0xB0, 0x21, 0x23}}),
+            takeSentMessages());
+
+    // Unchanged parts are not sent again
+    setFrame(5);
+    m_scheduler.sendShortMsg(0xB0, 0x01, 0x13);
+    m_scheduler.sendShortMsg(0xB0, 0x21, 0x24);
+    EXPECT_EQ(QVector<Message>({{0xB0, 0x21, 0x24}}), takeSentMessages());
+}
+
+TEST_F(MidiOutputSchedulerTest, LimitsMessagesPerFrame) {
+    for (int i = 0; i < MidiOutputScheduler::kMaxMessagesPerFrame + 2; ++i) {
+        m_scheduler.sendShortMsg(0x90, static_cast<unsigned char>(i), 0x7F);
+    }
+    EXPECT_EQ(MidiOutputScheduler::kMaxMessagesPerFrame, takeSentMessages().size());
+
+    setFrame(2);
+    m_scheduler.sendPendingMessages();
+    EXPECT_EQ(QVector<Message>({
+                      {0x90, MidiOutputScheduler::kMaxMessagesPerFrame, 0x7F},
+                      {0x90, MidiOutputScheduler::kMaxMessagesPerFrame + 1, 0x7F},
+              }),
+            takeSentMessages());
+}
+
+TEST_F(MidiOutputSchedulerTest, SendsEventsInOrder) {
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x01);
+    m_scheduler.sendShortMsg(0xB0, 0x20, 0x02);
+    // Program changes are sent immediately after the pending messages
+    m_scheduler.sendShortMsg(0xC0, 0x05, 0x00);
+    // NRPN messages are never coalesced
+    m_scheduler.sendShortMsg(0xB0, 99, 0x01);
+    m_scheduler.sendShortMsg(0xB0, 6, 0x10);
+    m_scheduler.sendShortMsg(0xB0, 99, 0x02);
+    m_scheduler.sendShortMsg(0xB0, 6, 0x10);
+    EXPECT_EQ(QVector<Message>({
+                      {0xB0, 0x20, 0x01},
+                      {0xB0, 0x20, 0x02},
+                      {0xC0, 0x05, 0x00},
+                      {0xB0, 99, 0x01},
+                      {0xB0, 6, 0x10},
+                      {0xB0, 99, 0x02},
+                      {0xB0, 6, 0x10},
+              }),
+            takeSentMessages());
+}
+
+TEST_F(MidiOutputSchedulerTest, FlushSendsAllPendingMessages) {
+    for (int i = 0; i < MidiOutputScheduler::kMaxMessagesPerFrame + 2; ++i) {
+        m_scheduler.sendShortMsg(0x90, static_cast<unsigned char>(i), 0x7F);
+    }
+    m_scheduler.sendShortMsg(0x90, 0x00, 0x00);
+    m_scheduler.flush();
+    const auto messages = takeSentMessages();
+    ASSERT_EQ(MidiOutputScheduler::kMaxMessagesPerFrame + 3, messages.size());
+    EXPECT_EQ((Message{0x90, 0x00, 0x00}), messages.last());
+
+    m_scheduler.reset();
+    setFrame(2);
+    m_scheduler.sendShortMsg(0x90, 0x00, 0x00);
+    EXPECT_EQ(QVector<Message>({{0x90, 0x00, 0x00}}), takeSentMessages());
+}
+
+} // namespace
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "library/dao/playlistdao.h"
+#include "test/librarytest.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr int kTrackCount = 6;
+
+class PlaylistDAOTest : public LibraryTest {
+  protected:
+    PlaylistDAOTest() {
+        for (int i = 0; i < kTrackCount; ++i) {
+            mixxx::FileInfo fileInfo(QDir(QDir::tempPath()),
+                    QStringLiteral("playlisttrack%1.mp3").arg(i));
+            m_trackIds.append(internalCollection()->addTrack(
+                    Track::newTemporary(mixxx::FileAccess(fileInfo)), false));
+        }
+    }
+
+    PlaylistDAO& playlistDAO() {
+        return internalCollection()->getPlaylistDAO();
+    }
+
+    int createPlaylistWithAllTracks(const QString& name) {
+        const int playlistId = playlistDAO().createPlaylist(name);
+        EXPECT_TRUE(playlistDAO().appendTracksToPlaylist(m_trackIds, playlistId));
+        return playlistId;
+    }
+
+    /// Returns the tracks of the playlist in the order of their positions,
+    /// which must start at 1 without any gaps.
+    QList<TrackId> tracksInPositionOrder(int playlistId) {
+        QList<TrackId> trackIds;
+        QSqlQuery query(dbConnection());
+        query.prepare(QStringLiteral(
+                "SELECT track_id, position FROM PlaylistTracks "
+                "WHERE playlist_id=:id ORDER BY position"));
+        query.bindValue(":id", playlistId);
+        EXPECT_TRUE(query.exec());
+        while (query.next()) {
+            EXPECT_EQ(trackIds.size() + 1, query.value(1).toInt());
+            trackIds.append(TrackId(query.value(0)));
+        }
+        return trackIds;
+    }
+
+    QList<TrackId> m_trackIds;
+};
+
+TEST_F(PlaylistDAOTest, removeTracksKeepsPositionsDense) {
+    const int playlistId = createPlaylistWithAllTracks(QStringLiteral("remove"));
+
+    playlistDAO().removeTracksFromPlaylist(playlistId, QList<int>{5, 2, 4});
+    EXPECT_EQ(QList<TrackId>({m_trackIds[0], m_trackIds[2], m_trackIds[5]}),
+            tracksInPositionOrder(playlistId));
+
+    playlistDAO().removeTrackFromPlaylist(playlistId, 1);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[2], m_trackIds[5]}),
+            tracksInPositionOrder(playlistId));
+}
+
+TEST_F(PlaylistDAOTest, insertTracksKeepsPositionsDense) {
+    const int playlistId = playlistDAO().createPlaylist(QStringLiteral("insert"));
+    ASSERT_TRUE(playlistDAO().appendTracksToPlaylist(
+            QList<TrackId>{m_trackIds[0], m_trackIds[1]}, playlistId));
+
+    EXPECT_EQ(3,
+            playlistDAO().insertTracksIntoPlaylist(
+                    QList<TrackId>{m_trackIds[2], TrackId(), m_trackIds[3], m_trackIds[4]},
+                    playlistId,
+                    2));
+    EXPECT_EQ(QList<TrackId>({m_trackIds[0],
+                      m_trackIds[2],
+                      m_trackIds[3],
+                      m_trackIds[4],
+                      m_trackIds[1]}),
+            tracksInPositionOrder(playlistId));
+}
+
+TEST_F(PlaylistDAOTest, moveTracksKeepsPositionsDense) {
+    const int playlistId = createPlaylistWithAllTracks(QStringLiteral("move"));
+
+    // Non-contiguous tracks into the range between them
+    playlistDAO().moveTracks(playlistId, QList<int>{5, 2}, 4);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[0],
+                      m_trackIds[2],
+                      m_trackIds[1],
+                      m_trackIds[4],
+                      m_trackIds[3],
+                      m_trackIds[5]}),
+            tracksInPositionOrder(playlistId));
+
+    // Down
+    playlistDAO().moveTracks(playlistId, QList<int>{1, 2}, 6);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[1],
+                      m_trackIds[4],
+                      m_trackIds[3],
+                      m_trackIds[0],
+                      m_trackIds[2],
+                      m_trackIds[5]}),
+            tracksInPositionOrder(playlistId));
+
+    // To the end
+    playlistDAO().moveTracks(playlistId, QList<int>{1}, 0);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[4],
+                      m_trackIds[3],
+                      m_trackIds[0],
+                      m_trackIds[2],
+                      m_trackIds[5],
+                      m_trackIds[1]}),
+            tracksInPositionOrder(playlistId));
+
+    // Up to the start
+    playlistDAO().moveTracks(playlistId, QList<int>{5, 6}, 1);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[5],
+                      m_trackIds[1],
+                      m_trackIds[4],
+                      m_trackIds[3],
+                      m_trackIds[0],
+                      m_trackIds[2]}),
+            tracksInPositionOrder(playlistId));
+
+    // Before a moved track, which doesn't change anything
+    playlistDAO().moveTracks(playlistId, QList<int>{2, 3}, 2);
+    EXPECT_EQ(QList<TrackId>({m_trackIds[5],
+                      m_trackIds[1],
+                      m_trackIds[4],
+                      m_trackIds[3],
+                      m_trackIds[0],
+                      m_trackIds[2]}),
+            tracksInPositionOrder(playlistId));
+}
+
+TEST_F(PlaylistDAOTest, removeTracksFromAllPlaylists) {
+    const int playlistId1 = createPlaylistWithAllTracks(QStringLiteral("first"));
+    const int playlistId2 = createPlaylistWithAllTracks(QStringLiteral("second"));
+    // Duplicates are removed, too
+    ASSERT_TRUE(playlistDAO().appendTrackToPlaylist(m_trackIds[1], playlistId2));
+
+    playlistDAO().removeTracksFromPlaylists(QList<TrackId>{m_trackIds[1], m_trackIds[3]});
+    const QList<TrackId> remainingTrackIds{
+            m_trackIds[0], m_trackIds[2], m_trackIds[4], m_trackIds[5]};
+    EXPECT_EQ(remainingTrackIds, tracksInPositionOrder(playlistId1));
+    EXPECT_EQ(remainingTrackIds, tracksInPositionOrder(playlistId2));
+}
+
+} // namespace
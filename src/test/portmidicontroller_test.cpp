@@ -98,7 +98,10 @@ class PortMidiControllerTest : public MixxxTest {
     }
 
     void pollDevice() {
-        m_pController->poll();
+        // Read the events synchronously instead of on the input thread
+        PortMidiInputThread inputThread(m_mockInput, m_pController->getName());
+        inputThread.readEvents();
+        m_pController->processInputEvents(inputThread.takeEvents());
     }
 
     PmDeviceInfo m_inputDeviceInfo;
@@ -138,6 +141,9 @@ TEST_F(PortMidiControllerTest, OpenClose) {
     EXPECT_CALL(*m_mockInput, close())
             .InSequence(input)
             .WillOnce(Return(pmNoError));
+    // Called by the input thread while the device is open
+    EXPECT_CALL(*m_mockInput, read(NotNull(), MIXXX_PORTMIDI_BUFFER_LEN))
+            .WillRepeatedly(Return(0));
 
     Sequence output;
     ON_CALL(*m_mockOutput, isOpen())
@@ -443,3 +449,49 @@ TEST_F(PortMidiControllerTest, Poll_Read_SysEx_BufferOverflow) {
     pollDevice();
     pollDevice();
 };
+
+TEST_F(PortMidiControllerTest, InputThread_QueuesEvents) {
+    std::vector<PmEvent> messages1;
+    messages1.push_back(MakeEvent(0x403C90, 0x0));
+    messages1.push_back(MakeEvent(0x403C80, 0x1));
+
+    std::vector<PmEvent> messages2;
+    messages2.push_back(MakeEvent(0x7F01B0, 0x2));
+
+    Sequence read;
+    EXPECT_CALL(*m_mockInput, read(NotNull(), MIXXX_PORTMIDI_BUFFER_LEN))
+            .InSequence(read)
+            .WillOnce(DoAll(SetArrayArgument<0>(messages1.begin(), messages1.end()),
+                    Return(static_cast<int>(messages1.size()))));
+    EXPECT_CALL(*m_mockInput, read(NotNull(), MIXXX_PORTMIDI_BUFFER_LEN))
+            .InSequence(read)
+            .WillOnce(Return(0));
+    EXPECT_CALL(*m_mockInput, read(NotNull(), MIXXX_PORTMIDI_BUFFER_LEN))
+            .Times(2)
+            .InSequence(read)
+            .WillRepeatedly(DoAll(SetArrayArgument<0>(messages2.begin(), messages2.end()),
+                    Return(static_cast<int>(messages2.size()))));
+
+    PortMidiInputThread inputThread(m_mockInput, m_pController->getName());
+    int eventsAvailableCount = 0;
+    QObject::connect(&inputThread,
+            &PortMidiInputThread::eventsAvailable,
+            [&eventsAvailableCount] { ++eventsAvailableCount; });
+
+    EXPECT_EQ(2, inputThread.readEvents());
+    EXPECT_EQ(0, inputThread.readEvents());
+    EXPECT_EQ(1, inputThread.readEvents());
+    // The consumer is notified once until it takes the queued events
+    EXPECT_EQ(1, eventsAvailableCount);
+
+    const auto events = inputThread.takeEvents();
+    ASSERT_EQ(3, events.size());
+    EXPECT_EQ(0x403C90, events[0].event.message);
+    EXPECT_EQ(0x403C80, events[1].event.message);
+    EXPECT_EQ(0x7F01B0, events[2].event.message);
+    EXPECT_TRUE(inputThread.takeEvents().isEmpty());
+
+    // Notified again for new events after the queue has been emptied
+    EXPECT_EQ(1, inputThread.readEvents());
+    EXPECT_EQ(2, eventsAvailableCount);
+};
@@ -254,6 +254,52 @@ TEST_F(SampleUtilTest, copy3WithGain) {
     }
 }
 
+TEST_F(SampleUtilTest, copyMultipleWithRampingGain) {
+    constexpr int kMaxSources = 40;
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        const int j = evenBuffers[i];
+        CSAMPLE* buffer = buffers[j];
+        const int size = sizes[j];
+        std::vector<CSAMPLE> expected(size);
+        std::vector<CSAMPLE> temp(size);
+        std::vector<std::vector<CSAMPLE>> sources(kMaxSources, std::vector<CSAMPLE>(size));
+        std::vector<const CSAMPLE*> pSources;
+        std::vector<CSAMPLE_GAIN> oldGains;
+        std::vector<CSAMPLE_GAIN> newGains;
+        for (int source = 0; source < kMaxSources; ++source) {
+            for (int k = 0; k < size; ++k) {
+                sources[source][k] = static_cast<CSAMPLE>((source + 1) * (k % 17)) / 100.0f;
+            }
+            pSources.push_back(sources[source].data());
+            // Mix constant, ramping and silent gains
+            oldGains.push_back(source % 4 == 3 ? 0.0f : 0.1f * (source % 5));
+            newGains.push_back(source % 2 == 0 ? oldGains.back() : 0.05f * (source % 7));
+        }
+        // Covers the unrolled chunks, the single source and several passes
+        for (int numSources : {0, 1, 2, 3, 7, 8, 16, 31, 33, kMaxSources}) {
+            SampleUtil::clear(expected.data(), size);
+            for (int source = 0; source < numSources; ++source) {
+                SampleUtil::copyWithRampingGain(temp.data(),
+                        pSources[source],
+                        oldGains[source],
+                        newGains[source],
+                        size);
+                SampleUtil::add(expected.data(), temp.data(), size);
+            }
+            FillBuffer(buffer, 1.0f, size);
+            SampleUtil::copyMultipleWithRampingGain(buffer,
+                    pSources.data(),
+                    oldGains.data(),
+                    newGains.data(),
+                    numSources,
+                    size);
+            for (int k = 0; k < size; ++k) {
+                ASSERT_NEAR(expected[k], buffer[k], 1e-4) << numSources << " " << k;
+            }
+        }
+    }
+}
+
 TEST_F(SampleUtilTest, convertS16ToFloat32) {
     // Shorts are asymmetric, so SAMPLE_MAX is less than -SAMPLE_MIN.
     const float expectedMax = static_cast<float>(SAMPLE_MAXIMUM) /
@@ -612,4 +658,63 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Mixes the channels like ChannelMixer did before, one after another
+static void BM_MixChannelsSeparately(benchmark::State& state) {
+    const int numChannels = static_cast<int>(state.range(0));
+    const SINT size = static_cast<SINT>(state.range(1));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    CSAMPLE* temp = SampleUtil::alloc(size);
+    std::vector<CSAMPLE*> channels;
+    for (int i = 0; i < numChannels; ++i) {
+        channels.push_back(SampleUtil::alloc(size));
+        SampleUtil::fill(channels.back(), 0.1f, size);
+    }
+
+    for (auto _ : state) {
+        SampleUtil::clear(buffer, size);
+        for (CSAMPLE* channel : channels) {
+            SampleUtil::copyWithRampingGain(temp, channel, 0.9f, 1.0f, size);
+            SampleUtil::add(buffer, temp, size);
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    for (CSAMPLE* channel : channels) {
+        SampleUtil::free(channel);
+    }
+    SampleUtil::free(temp);
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_MixChannelsSeparately)->RangeMultiplier(2)->Ranges({{2, 16}, {64, 4096}});
+
+static void BM_CopyMultipleWithRampingGain(benchmark::State& state) {
+    const int numChannels = static_cast<int>(state.range(0));
+    const SINT size = static_cast<SINT>(state.range(1));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    std::vector<CSAMPLE*> channels;
+    for (int i = 0; i < numChannels; ++i) {
+        channels.push_back(SampleUtil::alloc(size));
+        SampleUtil::fill(channels.back(), 0.1f, size);
+    }
+    const std::vector<const CSAMPLE*> sources(channels.begin(), channels.end());
+    const std::vector<CSAMPLE_GAIN> oldGains(numChannels, 0.9f);
+    const std::vector<CSAMPLE_GAIN> newGains(numChannels, 1.0f);
+
+    for (auto _ : state) {
+        SampleUtil::copyMultipleWithRampingGain(buffer,
+                sources.data(),
+                oldGains.data(),
+                newGains.data(),
+                numChannels,
+                size);
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    for (CSAMPLE* channel : channels) {
+        SampleUtil::free(channel);
+    }
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_CopyMultipleWithRampingGain)->RangeMultiplier(2)->Ranges({{2, 16}, {64, 4096}});
+
 }  // namespace
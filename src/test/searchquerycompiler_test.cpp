@@ -0,0 +1,298 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "library/searchquery.h"
+#include "library/searchquerycompiler.h"
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+constexpr int kArtistColumn = 0;
+constexpr int kTitleColumn = 1;
+constexpr int kBpmColumn = 2;
+constexpr int kRatingColumn = 3;
+
+class SearchQueryCompilerTest : public MixxxDbTest {
+  protected:
+    SearchQueryCompilerTest()
+            : MixxxDbTest(true),
+              m_compiler(m_index,
+                      [](const QString& sqlColumn,
+                              TrackColumnIndex::ColumnType columnType) {
+                          if (columnType == TrackColumnIndex::ColumnType::Text) {
+                              if (sqlColumn == "artist") {
+                                  return kArtistColumn;
+                              }
+                              if (sqlColumn == "title") {
+                                  return kTitleColumn;
+                              }
+                          } else if (columnType == TrackColumnIndex::ColumnType::Numeric) {
+                              if (sqlColumn == "bpm") {
+                                  return kBpmColumn;
+                              }
+                              if (sqlColumn == "rating") {
+                                  return kRatingColumn;
+                              }
+                          }
+                          return -1;
+                      }) {
+        m_index.reset({TrackColumnIndex::ColumnType::Text,
+                TrackColumnIndex::ColumnType::Text,
+                TrackColumnIndex::ColumnType::Numeric,
+                TrackColumnIndex::ColumnType::Numeric});
+        // The same tracks are stored in the database for comparing the
+        // results with those of QueryNode::toSql()
+        QSqlQuery query(dbConnection());
+        EXPECT_TRUE(query.exec(QStringLiteral(
+                "CREATE TEMPORARY TABLE search_tracks (id INTEGER PRIMARY KEY, "
+                "artist TEXT, title TEXT, bpm REAL, rating INTEGER)")));
+    }
+
+    /// A null string is stored as NULL
+    void addTrack(int id,
+            const QString& artist,
+            const QString& title,
+            const QVariant& bpm,
+            const QVariant& rating) {
+        const QVariant artistValue = artist.isNull() ? QVariant() : QVariant(artist);
+        const QVariant titleValue = title.isNull() ? QVariant() : QVariant(title);
+        const int row = m_index.ensureRow(TrackId(id));
+        m_index.setValue(row, kArtistColumn, artistValue);
+        m_index.setValue(row, kTitleColumn, titleValue);
+        m_index.setValue(row, kBpmColumn, bpm);
+        m_index.setValue(row, kRatingColumn, rating);
+
+        QSqlQuery query(dbConnection());
+        query.prepare(QStringLiteral(
+                "INSERT INTO search_tracks (id, artist, title, bpm, rating) "
+                "VALUES (:id, :artist, :title, :bpm, :rating)"));
+        query.bindValue(":id", id);
+        query.bindValue(":artist", artistValue);
+        query.bindValue(":title", titleValue);
+        query.bindValue(":bpm", bpm);
+        query.bindValue(":rating", rating);
+        EXPECT_TRUE(query.exec());
+    }
+
+    QList<int> matchingTracks(const QueryNode& query) {
+        const auto pCompiledQuery = m_compiler.compile(query);
+        EXPECT_TRUE(pCompiledQuery != nullptr);
+        QList<int> trackIds;
+        if (!pCompiledQuery) {
+            return trackIds;
+        }
+        const auto selection = pCompiledQuery->evaluate();
+        for (int row = 0; row < m_index.rowCount(); ++row) {
+            if (CompiledSearchQuery::isSelected(selection, row)) {
+                trackIds.append(m_index.trackId(row).toVariant().toInt());
+            }
+        }
+        std::sort(trackIds.begin(), trackIds.end());
+        return trackIds;
+    }
+
+    QList<int> sqlMatchingTracks(const QueryNode& query) {
+        QString sql = QStringLiteral("SELECT id FROM search_tracks");
+        const QString filter = query.toSql();
+        if (!filter.isEmpty()) {
+            sql += QStringLiteral(" WHERE ") + filter;
+        }
+        QSqlQuery sqlQuery(dbConnection());
+        EXPECT_TRUE(sqlQuery.exec(sql));
+        QList<int> trackIds;
+        while (sqlQuery.next()) {
+            trackIds.append(sqlQuery.value(0).toInt());
+        }
+        std::sort(trackIds.begin(), trackIds.end());
+        return trackIds;
+    }
+
+    std::unique_ptr<QueryNode> textFilter(const QStringList& sqlColumns,
+            const QString& argument,
+            StringMatch matchMode = StringMatch::Contains) {
+        return std::make_unique<TextFilterNode>(
+                dbConnection(), sqlColumns, argument, matchMode);
+    }
+
+    TrackColumnIndex m_index;
+    SearchQueryCompiler m_compiler;
+};
+
+TEST_F(SearchQueryCompilerTest, TextFilter) {
+    addTrack(1, "Ádele", "Hello", 120.0, 3);
+    addTrack(2, "Moby", "Porcelain", 95.0, 5);
+    addTrack(3, "Hello Seahorse", "Bestia", 128.0, QVariant());
+
+    EXPECT_EQ(QList<int>({1, 3}), matchingTracks(*textFilter({"artist", "title"}, "hello")));
+    // Decorations and case are ignored like by our SQL LIKE function
+    EXPECT_EQ(QList<int>({1}), matchingTracks(*textFilter({"artist"}, "ADELE")));
+    EXPECT_EQ(QList<int>({2}),
+            matchingTracks(*textFilter({"title"}, "porcelain", StringMatch::Equals)));
+    EXPECT_EQ(QList<int>(),
+            matchingTracks(*textFilter({"title"}, "porcel", StringMatch::Equals)));
+    // Wildcards are evaluated like LIKE does
+    EXPECT_EQ(QList<int>({1}), matchingTracks(*textFilter({"artist"}, "e_e")));
+}
+
+TEST_F(SearchQueryCompilerTest, NumericFilter) {
+    addTrack(1, "A", "A", 120.0, 3);
+    addTrack(2, "B", "B", 95.0, 5);
+    addTrack(3, "C", "C", 128.0, QVariant());
+
+    EXPECT_EQ(QList<int>({1, 2}), matchingTracks(NumericFilterNode({"rating"}, "<=5")));
+    EXPECT_EQ(QList<int>({2}), matchingTracks(NumericFilterNode({"rating"}, ">3")));
+    EXPECT_EQ(QList<int>({1, 2}), matchingTracks(NumericFilterNode({"rating"}, "1-5")));
+    EXPECT_EQ(QList<int>({3}), matchingTracks(NullNumericFilterNode({"rating"})));
+
+    QString argument = "120";
+    EXPECT_EQ(QList<int>({1}), matchingTracks(BpmFilterNode(argument, false)));
+    argument = "90-130";
+    EXPECT_EQ(QList<int>({1, 2, 3}), matchingTracks(BpmFilterNode(argument, false)));
+}
+
+TEST_F(SearchQueryCompilerTest, Composition) {
+    addTrack(1, "Artist", "Song A", 120.0, 3);
+    addTrack(2, "Artist", "Song B", 95.0, 5);
+    addTrack(3, "Other", "Song C", 128.0, 1);
+
+    AndNode query;
+    query.addNode(textFilter({"artist"}, "artist"));
+    query.addNode(std::make_unique<NotNode>(textFilter({"title"}, "b")));
+    EXPECT_EQ(QList<int>({1}), matchingTracks(query));
+
+    OrNode orQuery;
+    orQuery.addNode(textFilter({"title"}, "song a"));
+    orQuery.addNode(std::make_unique<NumericFilterNode>(QStringList{"rating"}, "1"));
+    EXPECT_EQ(QList<int>({1, 3}), matchingTracks(orQuery));
+
+    // An empty AND matches everything, an empty OR nothing
+    EXPECT_EQ(QList<int>({1, 2, 3}), matchingTracks(AndNode()));
+    EXPECT_EQ(QList<int>(), matchingTracks(OrNode()));
+}
+
+TEST_F(SearchQueryCompilerTest, UnsupportedNodes) {
+    addTrack(1, "Artist", "Song", 120.0, 3);
+
+    // Unknown columns and SQL are left to the database
+    EXPECT_TRUE(m_compiler.compile(*textFilter({"comment"}, "x")) == nullptr);
+    AndNode query;
+    query.addNode(textFilter({"artist"}, "artist"));
+    query.addNode(std::make_unique<SqlNode>("mixxx_deleted=0"));
+    EXPECT_TRUE(m_compiler.compile(query) == nullptr);
+}
+
+TEST_F(SearchQueryCompilerTest, FilterRows) {
+    addTrack(1, "Artist", "Song A", 120.0, 3);
+    addTrack(2, "Other", "Song B", 95.0, 5);
+    addTrack(3, "Artist", "Song C", 128.0, 1);
+    addTrack(4, "Artist", "Song D", 128.0, QVariant());
+
+    AndNode query;
+    query.addNode(textFilter({"artist"}, "art"));
+    query.addNode(std::make_unique<NotNode>(
+            std::make_unique<NullNumericFilterNode>(QStringList{"rating"})));
+    const auto pCompiledQuery = m_compiler.compile(query);
+    ASSERT_TRUE(pCompiledQuery != nullptr);
+    // The order of the rows is preserved
+    EXPECT_EQ(std::vector<int>({2, 0}), pCompiledQuery->filterRows({3, 2, 1, 0}));
+    EXPECT_EQ(std::vector<int>({0}), pCompiledQuery->filterRows({1, 0}));
+    EXPECT_EQ(std::vector<int>(), pCompiledQuery->filterRows({}));
+}
+
+TEST_F(SearchQueryCompilerTest, ManyBlocks) {
+    // Spans enough blocks to be evaluated concurrently, including a
+    // partial last block
+    const int numTracks = 100 * CompiledSearchQuery::kBlockRows + 17;
+    for (int i = 1; i <= numTracks; ++i) {
+        addTrack(i, QString::number(i % 7), QString(), i, i % 3);
+    }
+    NotNode query(std::make_unique<NumericFilterNode>(QStringList{"rating"}, "0"));
+    const QList<int> trackIds = matchingTracks(query);
+    int expectedCount = 0;
+    for (int i = 1; i <= numTracks; ++i) {
+        if (i % 3 != 0) {
+            ++expectedCount;
+        }
+    }
+    EXPECT_EQ(expectedCount, trackIds.size());
+    for (int trackId : trackIds) {
+        EXPECT_NE(0, trackId % 3);
+    }
+}
+
+TEST_F(SearchQueryCompilerTest, NegationOfNullColumns) {
+    addTrack(1, "Artist", "Song", 120.0, 3);
+    addTrack(2, QString(), "Song", QVariant(), QVariant());
+    addTrack(3, "", QString(), 95.0, 5);
+
+    // Comparisons with NULL are neither true nor false in SQL
+    const NotNode textQuery(textFilter({"artist", "title"}, "art"));
+    EXPECT_EQ(QList<int>(), matchingTracks(textQuery));
+    EXPECT_EQ(sqlMatchingTracks(textQuery), matchingTracks(textQuery));
+    const NotNode artistQuery(textFilter({"artist"}, "art"));
+    EXPECT_EQ(QList<int>({3}), matchingTracks(artistQuery));
+    EXPECT_EQ(sqlMatchingTracks(artistQuery), matchingTracks(artistQuery));
+    const NotNode ratingQuery(std::make_unique<NumericFilterNode>(QStringList{"rating"}, ">4"));
+    EXPECT_EQ(QList<int>({1}), matchingTracks(ratingQuery));
+    EXPECT_EQ(sqlMatchingTracks(ratingQuery), matchingTracks(ratingQuery));
+
+    std::vector<std::unique_ptr<QueryNode>> queries;
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<NumericFilterNode>(QStringList{"rating"}, "3-4")));
+    QString argument = "100-130";
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<BpmFilterNode>(argument, false)));
+    argument = "120";
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<BpmFilterNode>(argument, false)));
+    argument = "<100";
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<BpmFilterNode>(argument, false)));
+    // IS NULL is never NULL
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<NullNumericFilterNode>(QStringList{"rating"})));
+    queries.push_back(std::make_unique<NotNode>(
+            std::make_unique<NullOrEmptyTextFilterNode>(
+                    dbConnection(), QStringList{"artist"})));
+    queries.push_back(std::make_unique<NotNode>(std::make_unique<NotNode>(
+            textFilter({"title"}, "song"))));
+    auto pOrNode = std::make_unique<OrNode>();
+    pOrNode->addNode(textFilter({"artist"}, "x"));
+    pOrNode->addNode(std::make_unique<NumericFilterNode>(QStringList{"rating"}, "<4"));
+    queries.push_back(std::make_unique<NotNode>(std::move(pOrNode)));
+    auto pAndNode = std::make_unique<AndNode>();
+    pAndNode->addNode(textFilter({"title"}, "song"));
+    pAndNode->addNode(std::make_unique<NumericFilterNode>(QStringList{"rating"}, "<4"));
+    queries.push_back(std::make_unique<NotNode>(std::move(pAndNode)));
+    queries.push_back(std::make_unique<NotNode>(std::make_unique<OrNode>()));
+    for (const auto& pQuery : queries) {
+        EXPECT_EQ(sqlMatchingTracks(*pQuery), matchingTracks(*pQuery))
+                << pQuery->toSql().toStdString();
+    }
+}
+
+static void BM_CompiledTextSearch(benchmark::State& state) {
+    TrackColumnIndex index;
+    index.reset({TrackColumnIndex::ColumnType::Text,
+            TrackColumnIndex::ColumnType::Text});
+    const int numTracks = static_cast<int>(state.range(0));
+    for (int i = 0; i < numTracks; ++i) {
+        const int row = index.ensureRow(TrackId(i + 1));
+        index.setValue(row, 0, QStringLiteral("Artist %1").arg(i % 5000));
+        index.setValue(row, 1, QStringLiteral("Title %1").arg(i));
+    }
+    SearchQueryCompiler compiler(index,
+            [](const QString& sqlColumn, TrackColumnIndex::ColumnType) {
+                return sqlColumn == "artist" ? 0 : (sqlColumn == "title" ? 1 : -1);
+            });
+    const TextFilterNode query(QSqlDatabase(), {"artist", "title"}, "123");
+    for (auto _ : state) {
+        const auto pCompiledQuery = compiler.compile(query);
+        benchmark::DoNotOptimize(pCompiledQuery->evaluate());
+    }
+}
+BENCHMARK(BM_CompiledTextSearch)->Range(1024, 256 * 1024)->Unit(benchmark::kMillisecond);
+
+} // namespace
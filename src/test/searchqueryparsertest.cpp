@@ -1188,6 +1188,60 @@ TEST_F(SearchQueryParserTest, QueryIsLessSpecific) {
             QStringLiteral("crate:\"a b c\"")));
 }
 
+TEST_F(SearchQueryParserTest, QueryIsRefinement) {
+    // Characters appended while typing
+    EXPECT_TRUE(m_parser.queryIsRefinement(
+            QStringLiteral("tech"),
+            QStringLiteral("techno")));
+    EXPECT_TRUE(m_parser.queryIsRefinement(
+            QString(),
+            QStringLiteral("t")));
+    // Additional terms
+    EXPECT_TRUE(m_parser.queryIsRefinement(
+            QStringLiteral("techno"),
+            QStringLiteral("techno bpm:120")));
+    EXPECT_TRUE(m_parser.queryIsRefinement(
+            QStringLiteral("artist:abb bpm:120"),
+            QStringLiteral("bpm:120 artist:Abba")));
+    // Case and decorations are folded like for LIKE
+    EXPECT_TRUE(m_parser.queryIsRefinement(
+            QStringLiteral("BJO"),
+            QStringLiteral("björk")));
+
+    // Broader searches
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("techno"),
+            QStringLiteral("tech")));
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("techno house"),
+            QStringLiteral("techno")));
+    // Negated terms exclude more tracks when appending characters
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("-tech"),
+            QStringLiteral("-techno")));
+    // Numeric arguments are not refined by appending digits
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("bpm:12"),
+            QStringLiteral("bpm:120")));
+    // Different fields
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("artist:abb"),
+            QStringLiteral("album:abba")));
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("abb"),
+            QStringLiteral("comment:abba")));
+    // Exact matches, alternatives and filters that consume the next term
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("artist:=abb"),
+            QStringLiteral("artist:=abba")));
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("abb | tech"),
+            QStringLiteral("abba | tech")));
+    EXPECT_FALSE(m_parser.queryIsRefinement(
+            QStringLiteral("abba"),
+            QStringLiteral("comment: abba")));
+}
+
 TEST_F(SearchQueryParserTest, EmptyOrOperator) {
     auto pQuery = m_parser.parseQuery("|", QString());
 
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "sources/seekindex.h"
+
+namespace {
+
+constexpr qint64 kFileSize = 200000;
+
+class SeekIndexTest : public testing::Test {
+  protected:
+    SeekIndexTest()
+            : m_fileData(kFileSize, '\0') {
+        for (int i = 0; i < m_fileData.size(); ++i) {
+            m_fileData[i] = static_cast<char>(i * 7);
+        }
+    }
+
+    QByteArray fingerprint() const {
+        return mixxx::SeekIndex::fileFingerprint(
+                reinterpret_cast<const uchar*>(m_fileData.constData()),
+                m_fileData.size());
+    }
+
+    mixxx::SeekIndex createSeekIndex() const {
+        mixxx::SeekIndex seekIndex;
+        seekIndex.fingerprint = fingerprint();
+        seekIndex.channelCount = mixxx::audio::ChannelCount::stereo();
+        seekIndex.sampleRate = mixxx::audio::SampleRate(44100);
+        seekIndex.bitrate = mixxx::audio::Bitrate(192);
+        // VBR frames of different sizes
+        SINT byteOffset = 1000;
+        for (SINT i = 0; i < 100; ++i) {
+            seekIndex.entries.push_back(mixxx::SeekIndex::Entry{i * 1152, byteOffset});
+            byteOffset += 300 + (i % 5) * 100;
+        }
+        seekIndex.frameCount = 100 * 1152;
+        return seekIndex;
+    }
+
+    QString filePath() const {
+        return m_tempDir.filePath(QStringLiteral("test.seekindex"));
+    }
+
+    QTemporaryDir m_tempDir;
+    QByteArray m_fileData;
+};
+
+TEST_F(SeekIndexTest, SaveAndLoad) {
+    const auto seekIndex = createSeekIndex();
+    ASSERT_TRUE(seekIndex.save(filePath()));
+
+    const auto loadedSeekIndex = mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize);
+    ASSERT_TRUE(loadedSeekIndex);
+    EXPECT_EQ(seekIndex.fingerprint, loadedSeekIndex->fingerprint);
+    EXPECT_EQ(seekIndex.channelCount, loadedSeekIndex->channelCount);
+    EXPECT_EQ(seekIndex.sampleRate, loadedSeekIndex->sampleRate);
+    EXPECT_EQ(seekIndex.bitrate, loadedSeekIndex->bitrate);
+    EXPECT_EQ(seekIndex.frameCount, loadedSeekIndex->frameCount);
+    ASSERT_EQ(seekIndex.entries.size(), loadedSeekIndex->entries.size());
+    for (std::size_t i = 0; i < seekIndex.entries.size(); ++i) {
+        EXPECT_EQ(seekIndex.entries[i].frameIndex, loadedSeekIndex->entries[i].frameIndex);
+        EXPECT_EQ(seekIndex.entries[i].byteOffset, loadedSeekIndex->entries[i].byteOffset);
+    }
+}
+
+TEST_F(SeekIndexTest, ModifiedFile) {
+    ASSERT_TRUE(createSeekIndex().save(filePath()));
+
+    // Editing the tags at the start or the end of the file changes the
+    // fingerprint, even if the size remains the same
+    const QByteArray originalFileData = m_fileData;
+    m_fileData[10] = 'x';
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+    m_fileData = originalFileData;
+    m_fileData[kFileSize - 10] = 'x';
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+    m_fileData = originalFileData;
+    m_fileData.append('x');
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize + 1));
+
+    m_fileData = originalFileData;
+    EXPECT_TRUE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+    // Offsets beyond the end of the file are rejected
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), 10000));
+}
+
+TEST_F(SeekIndexTest, InvalidFile) {
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+
+    ASSERT_TRUE(createSeekIndex().save(filePath()));
+    QFile file(filePath());
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.resize(file.size() - 4));
+    file.close();
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("not a seek index");
+    file.close();
+    EXPECT_FALSE(mixxx::SeekIndex::load(filePath(), fingerprint(), kFileSize));
+}
+
+TEST_F(SeekIndexTest, StorageFilePath) {
+    mixxx::SeekIndex::setStorageDirectory(QString());
+    EXPECT_TRUE(mixxx::SeekIndex::storageFilePath(QStringLiteral("/music/a.mp3")).isEmpty());
+
+    mixxx::SeekIndex::setStorageDirectory(m_tempDir.path());
+    const QString storageFilePath =
+            mixxx::SeekIndex::storageFilePath(QStringLiteral("/music/a.mp3"));
+    EXPECT_TRUE(storageFilePath.startsWith(m_tempDir.path()));
+    EXPECT_EQ(storageFilePath,
+            mixxx::SeekIndex::storageFilePath(QStringLiteral("/music/a.mp3")));
+    EXPECT_NE(storageFilePath,
+            mixxx::SeekIndex::storageFilePath(QStringLiteral("/music/b.mp3")));
+    mixxx::SeekIndex::setStorageDirectory(QString());
+}
+
+} // namespace
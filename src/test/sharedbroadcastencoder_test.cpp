@@ -0,0 +1,148 @@
+#include "engine/sidechain/sharedbroadcastencoder.h"
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QVector>
+
+#include "encoder/encodercallback.h"
+
+namespace {
+
+/// Writes one byte per sample, which is the value of the sample
+class FakeEncoder : public Encoder {
+  public:
+    explicit FakeEncoder(EncoderCallback* pCallback)
+            : m_pCallback(pCallback) {
+    }
+
+    int initEncoder(mixxx::audio::SampleRate sampleRate, QString* pUserErrorMessage) override {
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(pUserErrorMessage);
+        return 0;
+    }
+    void encodeBuffer(const CSAMPLE* samples, const int size) override {
+        QByteArray data;
+        for (int i = 0; i < size; ++i) {
+            data.append(static_cast<char>(samples[i]));
+        }
+        m_pCallback->write(nullptr,
+                reinterpret_cast<const unsigned char*>(data.constData()),
+                0,
+                static_cast<int>(data.size()));
+    }
+    void updateMetaData(const QString& artist,
+            const QString& title,
+            const QString& album) override {
+        Q_UNUSED(artist);
+        Q_UNUSED(title);
+        Q_UNUSED(album);
+    }
+    void flush() override {
+    }
+    void setEncoderSettings(const EncoderSettings& settings) override {
+        Q_UNUSED(settings);
+    }
+
+  private:
+    EncoderCallback* const m_pCallback;
+};
+
+class Connection : public EncoderCallback {
+  public:
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override {
+        m_data.append(reinterpret_cast<const char*>(header), headerLen);
+        m_data.append(reinterpret_cast<const char*>(body), bodyLen);
+    }
+    int tell() override {
+        return -1;
+    }
+    void seek(int pos) override {
+        Q_UNUSED(pos);
+    }
+    int filelen() override {
+        return 0;
+    }
+
+    QByteArray m_data;
+};
+
+class SharedBroadcastEncoderTest : public testing::Test {
+  protected:
+    SharedBroadcastEncoderTest() {
+        m_sharedEncoder.setEncoder(std::make_shared<FakeEncoder>(&m_sharedEncoder));
+    }
+
+    void encode(std::initializer_list<CSAMPLE> samples) {
+        const QVector<CSAMPLE> buffer(samples);
+        m_sharedEncoder.process(buffer.constData(), buffer.size());
+    }
+
+    SharedBroadcastEncoder m_sharedEncoder;
+};
+
+TEST_F(SharedBroadcastEncoderTest, EncodesOnceForAllConnections) {
+    Connection first;
+    Connection second;
+    m_sharedEncoder.subscribe(&first);
+    m_sharedEncoder.subscribe(&second);
+
+    encode({1, 2});
+    m_sharedEncoder.writeEncodedData(&first);
+    encode({3});
+    m_sharedEncoder.writeEncodedData(&first);
+    // The second connection writes less often
+    m_sharedEncoder.writeEncodedData(&second);
+
+    EXPECT_EQ(QByteArray("\x01\x02\x03"), first.m_data);
+    EXPECT_EQ(QByteArray("\x01\x02\x03"), second.m_data);
+}
+
+TEST_F(SharedBroadcastEncoderTest, UnsubscribedConnectionMissesPackets) {
+    Connection first;
+    Connection second;
+    m_sharedEncoder.subscribe(&first);
+    m_sharedEncoder.subscribe(&second);
+
+    encode({1});
+
+    // E.g. the first connection reconnects
+    m_sharedEncoder.writeEncodedData(&first);
+    m_sharedEncoder.unsubscribe(&first);
+    encode({2});
+    m_sharedEncoder.writeEncodedData(&first);
+
+    m_sharedEncoder.subscribe(&first);
+    encode({3});
+    m_sharedEncoder.writeEncodedData(&first);
+    m_sharedEncoder.writeEncodedData(&second);
+
+    EXPECT_EQ(QByteArray("\x01\x03"), first.m_data);
+    EXPECT_EQ(QByteArray("\x01\x02\x03"), second.m_data);
+}
+
+TEST_F(SharedBroadcastEncoderTest, DropsOldestPacketsOfSlowConnection) {
+    Connection first;
+    Connection second;
+    m_sharedEncoder.subscribe(&first);
+    m_sharedEncoder.subscribe(&second);
+
+    const int packetSize = SharedBroadcastEncoder::kMaxQueuedBytes / 2 + 1;
+    for (CSAMPLE sample = 1; sample <= 3; ++sample) {
+        const QVector<CSAMPLE> buffer(packetSize, sample);
+        m_sharedEncoder.process(buffer.constData(), buffer.size());
+        m_sharedEncoder.writeEncodedData(&first);
+    }
+
+    // The second connection didn't write the first packets in time and
+    // only receives the most recent one
+    m_sharedEncoder.writeEncodedData(&second);
+    EXPECT_EQ(3 * packetSize, first.m_data.size());
+    ASSERT_EQ(packetSize, second.m_data.size());
+    EXPECT_EQ(3, second.m_data.at(0));
+}
+
+} // namespace
@@ -4,6 +4,7 @@
 
 #include "analyzer/analyzersilence.h"
 #include "sources/audiosourcestereoproxy.h"
+#include "sources/seekindex.h"
 #include "sources/soundsourceproxy.h"
 #include "test/mixxxtest.h"
 #include "test/soundsourceproviderregistration.h"
@@ -695,6 +696,76 @@ TEST_F(SoundSourceProxyTest, readBeyondEnd) {
     }
 }
 
+TEST_F(SoundSourceProxyTest, reopenFromSeekIndex) {
+    constexpr SINT kReadFrameCount = 1000;
+    QTemporaryDir seekIndexDir;
+    ASSERT_TRUE(seekIndexDir.isValid());
+    mixxx::SeekIndex::setStorageDirectory(seekIndexDir.path());
+
+    const QStringList filePaths = getFilePaths();
+    for (const auto& filePath : filePaths) {
+        if (!filePath.endsWith(QStringLiteral(".mp3"))) {
+            continue;
+        }
+        qDebug() << "Reopen from seek index test:" << filePath;
+
+        const auto fileUrl = QUrl::fromLocalFile(filePath);
+        const auto providerRegistrations =
+                SoundSourceProxy::allProviderRegistrationsForUrl(fileUrl);
+        for (const auto& providerRegistration : providerRegistrations) {
+            // Scans the file and stores the seek index, if supported
+            mixxx::AudioSourcePointer pScannedSource = openAudioSource(
+                    filePath,
+                    providerRegistration.getProvider());
+            if (!pScannedSource) {
+                // skip test file
+                continue;
+            }
+            // Uses the stored seek index, if available
+            mixxx::AudioSourcePointer pIndexedSource = openAudioSource(
+                    filePath,
+                    providerRegistration.getProvider());
+            ASSERT_FALSE(!pIndexedSource);
+            ASSERT_EQ(pScannedSource->getSignalInfo(), pIndexedSource->getSignalInfo());
+            ASSERT_EQ(pScannedSource->getBitrate(), pIndexedSource->getBitrate());
+            ASSERT_EQ(pScannedSource->frameIndexRange(), pIndexedSource->frameIndexRange());
+
+            mixxx::SampleBuffer scannedReadData(
+                    pScannedSource->getSignalInfo().frames2samples(kReadFrameCount));
+            mixxx::SampleBuffer indexedReadData(
+                    pIndexedSource->getSignalInfo().frames2samples(kReadFrameCount));
+            // Seek backward through the whole file and near the end
+            const SINT frameIndexStep = pScannedSource->frameLength() / 5;
+            for (SINT frameIndex = pScannedSource->frameIndexMax() - kReadFrameCount / 2;
+                    frameIndex >= pScannedSource->frameIndexMin();
+                    frameIndex -= frameIndexStep) {
+                const auto readFrameIndexRange =
+                        mixxx::IndexRange::forward(frameIndex, kReadFrameCount);
+                const auto scannedSampleFrames =
+                        pScannedSource->readSampleFrames(
+                                mixxx::WritableSampleFrames(
+                                        readFrameIndexRange,
+                                        mixxx::SampleBuffer::WritableSlice(scannedReadData)));
+                const auto indexedSampleFrames =
+                        pIndexedSource->readSampleFrames(
+                                mixxx::WritableSampleFrames(
+                                        readFrameIndexRange,
+                                        mixxx::SampleBuffer::WritableSlice(indexedReadData)));
+                ASSERT_EQ(scannedSampleFrames.frameIndexRange(),
+                        indexedSampleFrames.frameIndexRange());
+                expectDecodedSamplesEqual(
+                        pScannedSource->getSignalInfo().frames2samples(
+                                scannedSampleFrames.frameLength()),
+                        &scannedReadData[0],
+                        &indexedReadData[0],
+                        "Decoding mismatch after reopening from seek index");
+            }
+        }
+    }
+
+    mixxx::SeekIndex::setStorageDirectory(QString());
+}
+
 TEST_F(SoundSourceProxyTest, regressionTestCachingReaderChunkJumpForward) {
     // NOTE(uklotzde, 2017-12-10): Potential regression test for an infinite
     // seek/read loop in SoundSourceMediaFoundation. Unfortunately this
@@ -152,4 +152,59 @@ TEST_F(StemTest, OpenStem) {
             sourceStem.getSignalInfo());
 }
 
+TEST_F(StemTest, ReadInterleavedStems) {
+    constexpr SINT kFrameCount = 1024;
+    // Decoding after seeking may differ slightly from continuous decoding
+    constexpr CSAMPLE kMaxDecodingError = 0.01f;
+    SoundSourceSTEM sourceStem(QUrl::fromLocalFile(getTestDir().filePath("stems/test.stem.mp4")));
+
+    mixxx::AudioSource::OpenParams config;
+    config.setChannelCount(mixxx::audio::ChannelCount(8));
+    ASSERT_EQ(sourceStem.open(AudioSource::OpenMode::Strict, config),
+            AudioSource::OpenResult::Succeeded);
+    const int stemCount = sourceStem.getSignalInfo().getChannelCount() / 2;
+
+    // The stems are decoded concurrently, both after seeking forward
+    // and backward they must be aligned with the individual streams
+    const SINT middleFrameIndex = sourceStem.frameIndexRange().start() +
+            sourceStem.frameIndexRange().length() / 2;
+    for (const auto frameIndexRange : {
+                 IndexRange::forward(middleFrameIndex, kFrameCount),
+                 IndexRange::forward(0, kFrameCount)}) {
+        SampleBuffer stemBuffer(sourceStem.getSignalInfo().frames2samples(kFrameCount));
+        ASSERT_EQ(sourceStem.readSampleFrames(WritableSampleFrames(
+                                                      frameIndexRange,
+                                                      SampleBuffer::WritableSlice(stemBuffer)))
+                          .frameIndexRange(),
+                frameIndexRange);
+
+        for (int stemIdx = 0; stemIdx < stemCount; ++stemIdx) {
+            // The first stream contains the main mix
+            SoundSourceSingleSTEM sourceSingleStem(
+                    QUrl::fromLocalFile(getTestDir().filePath("stems/test.stem.mp4")),
+                    stemIdx + 1);
+            mixxx::AudioSource::OpenParams stereoConfig;
+            stereoConfig.setChannelCount(mixxx::audio::ChannelCount::stereo());
+            ASSERT_EQ(sourceSingleStem.open(AudioSource::OpenMode::Strict, stereoConfig),
+                    AudioSource::OpenResult::Succeeded);
+            SampleBuffer singleStemBuffer(
+                    sourceSingleStem.getSignalInfo().frames2samples(kFrameCount));
+            ASSERT_EQ(sourceSingleStem
+                              .readSampleFrames(WritableSampleFrames(
+                                      frameIndexRange,
+                                      SampleBuffer::WritableSlice(singleStemBuffer)))
+                              .frameIndexRange(),
+                    frameIndexRange);
+            for (SINT i = 0; i < kFrameCount; ++i) {
+                EXPECT_NEAR(singleStemBuffer[2 * i],
+                        stemBuffer[2 * stemCount * i + 2 * stemIdx],
+                        kMaxDecodingError);
+                EXPECT_NEAR(singleStemBuffer[2 * i + 1],
+                        stemBuffer[2 * stemCount * i + 2 * stemIdx + 1],
+                        kMaxDecodingError);
+            }
+        }
+    }
+}
+
 } // namespace
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "library/trackcolumnindex.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+constexpr int kTextColumn = 0;
+constexpr int kNumericColumn = 1;
+constexpr int kKeyColumn = 2;
+
+class TrackColumnIndexTest : public MixxxTest {
+  protected:
+    TrackColumnIndexTest() {
+        m_index.reset({TrackColumnIndex::ColumnType::Text,
+                TrackColumnIndex::ColumnType::Numeric,
+                TrackColumnIndex::ColumnType::Key});
+    }
+
+    int addRow(int id, const QString& text, double number, const QString& key) {
+        const int row = m_index.ensureRow(TrackId(id));
+        m_index.setValue(row, kTextColumn, text);
+        m_index.setValue(row, kNumericColumn, number);
+        m_index.setValue(row, kKeyColumn, key);
+        return row;
+    }
+
+    TrackColumnIndex m_index;
+};
+
+TEST_F(TrackColumnIndexTest, InsertAndRemove) {
+    addRow(1, "Artist A", 120.0, "Am");
+    addRow(2, "Artist B", 125.0, "C");
+    addRow(3, "Artist C", 128.0, "G");
+    EXPECT_EQ(3, m_index.rowCount());
+
+    m_index.remove(TrackId(1));
+    EXPECT_EQ(2, m_index.rowCount());
+    EXPECT_FALSE(m_index.contains(TrackId(1)));
+
+    // The last row has been moved into the gap
+    const int row = m_index.row(TrackId(3));
+    ASSERT_NE(TrackColumnIndex::kInvalidRow, row);
+    EXPECT_EQ(TrackId(3), m_index.trackId(row));
+    EXPECT_EQ(QVariant("Artist C"), m_index.value(row, kTextColumn));
+    EXPECT_DOUBLE_EQ(128.0, m_index.numericValue(row, kNumericColumn));
+}
+
+TEST_F(TrackColumnIndexTest, InternedStrings) {
+    const int row1 = addRow(1, "Same", 0.0, QString());
+    const int row2 = addRow(2, "Same", 0.0, QString());
+    const int row3 = addRow(3, "Other", 0.0, QString());
+    EXPECT_EQ(m_index.stringId(row1, kTextColumn), m_index.stringId(row2, kTextColumn));
+    EXPECT_NE(m_index.stringId(row1, kTextColumn), m_index.stringId(row3, kTextColumn));
+    EXPECT_EQ(QStringLiteral("same"),
+            m_index.foldedString(m_index.stringId(row1, kTextColumn)));
+}
+
+TEST_F(TrackColumnIndexTest, SortRanks) {
+    const int rowB = addRow(1, "b", 3.0, QString());
+    const int rowA = addRow(2, "A", 2.0, QString());
+    const int rowC = addRow(3, "c", 2.0, QString());
+
+    const auto& textRanks = m_index.sortRanks(kTextColumn, KeyUtils::KeyNotation::OpenKey);
+    EXPECT_LT(textRanks[rowA], textRanks[rowB]);
+    EXPECT_LT(textRanks[rowB], textRanks[rowC]);
+
+    const auto& numericRanks = m_index.sortRanks(kNumericColumn, KeyUtils::KeyNotation::OpenKey);
+    EXPECT_EQ(numericRanks[rowA], numericRanks[rowC]);
+    EXPECT_LT(numericRanks[rowC], numericRanks[rowB]);
+
+    // Modifying a column invalidates its ranks
+    m_index.setValue(rowA, kNumericColumn, 4.0);
+    const auto& updatedRanks = m_index.sortRanks(kNumericColumn, KeyUtils::KeyNotation::OpenKey);
+    EXPECT_LT(updatedRanks[rowB], updatedRanks[rowA]);
+}
+
+TEST_F(TrackColumnIndexTest, SortRanksNumericNullsFirst) {
+    const int rowZero = addRow(1, QString(), 0.0, QString());
+    const int rowNull = m_index.ensureRow(TrackId(2));
+    m_index.setValue(rowNull, kNumericColumn, QVariant());
+    const int rowNegative = addRow(3, QString(), -1.0, QString());
+    // Numbers that only differ by less than the epsilon of
+    // BaseTrackCache::compareColumnValues() are still ordered
+    const int rowTiny = addRow(4, QString(), 0.000001, QString());
+
+    const auto& ranks = m_index.sortRanks(kNumericColumn, KeyUtils::KeyNotation::OpenKey);
+    EXPECT_LT(ranks[rowNull], ranks[rowNegative]);
+    EXPECT_LT(ranks[rowNegative], ranks[rowZero]);
+    EXPECT_LT(ranks[rowZero], ranks[rowTiny]);
+
+    const auto notation = KeyUtils::KeyNotation::OpenKey;
+    EXPECT_GT(0, m_index.compareValueWithRow(kNumericColumn, QVariant(), rowZero, notation));
+    EXPECT_EQ(0, m_index.compareValueWithRow(kNumericColumn, QVariant(), rowNull, notation));
+}
+
+TEST_F(TrackColumnIndexTest, CompareValueWithRow) {
+    const int row = addRow(1, "Middle", 5.0, QString());
+    const auto notation = KeyUtils::KeyNotation::OpenKey;
+    EXPECT_GT(0, m_index.compareValueWithRow(kTextColumn, QVariant("aaa"), row, notation));
+    EXPECT_EQ(0, m_index.compareValueWithRow(kTextColumn, QVariant("middle"), row, notation));
+    EXPECT_LT(0, m_index.compareValueWithRow(kNumericColumn, QVariant(6), row, notation));
+    EXPECT_EQ(0, m_index.compareValueWithRow(kNumericColumn, QVariant(5.0), row, notation));
+}
+
+} // namespace
@@ -1,6 +1,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "library/scanner/parsedtrack.h"
 #include "test/librarytest.h"
 #include "track/track.h"
 
@@ -56,3 +57,82 @@ TEST_F(TrackDAOTest, detectMovedTracks) {
     QSet<QString> trackLocations = trackDAO.getAllTrackLocations();
     EXPECT_THAT(trackLocations, UnorderedElementsAre(newFile.location(), otherFile.location()));
 }
+
+TEST_F(TrackDAOTest, addParsedTracks) {
+    TrackDAO& trackDAO = internalCollection()->getTrackDAO();
+
+    const QString newFile = getTestDir().filePath(QStringLiteral("id3-test-data/artist.mp3"));
+    const QString existingFile =
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover-test-png.mp3"));
+    const TrackId existingId = internalCollection()->addTrack(
+            Track::newTemporary(mixxx::FileAccess(mixxx::FileInfo(existingFile))), false);
+    ASSERT_TRUE(existingId.isValid());
+
+    const auto parsedNewTrack = ParsedTrack::parseFromFile(
+            mixxx::FileAccess(mixxx::FileInfo(newFile)), SyncTrackMetadataParams());
+    const auto parsedExistingTrack = ParsedTrack::parseFromFile(
+            mixxx::FileAccess(mixxx::FileInfo(existingFile)), SyncTrackMetadataParams());
+    ASSERT_TRUE(parsedNewTrack);
+    ASSERT_TRUE(parsedExistingTrack);
+    EXPECT_EQ(QStringLiteral("Test Artist"),
+            parsedNewTrack->record.getMetadata().getTrackInfo().getArtist());
+
+    trackDAO.addTracksPrepare();
+    const QList<TrackId> addedIds = trackDAO.addTracksAddParsedTracks(
+            QList<ParsedTrack>{*parsedNewTrack, *parsedExistingTrack});
+    trackDAO.addTracksFinish();
+
+    // Only the new track has been added, without creating a Track object
+    ASSERT_EQ(1, addedIds.size());
+    EXPECT_FALSE(GlobalTrackCacheLocker().lookupTrackById(addedIds.first()));
+    EXPECT_EQ(addedIds.first(), trackDAO.getTrackIdByRef(TrackRef::fromFilePath(newFile)));
+    EXPECT_EQ(existingId, trackDAO.getTrackIdByRef(TrackRef::fromFilePath(existingFile)));
+
+    // The Track object is loaded from the database when needed
+    const TrackPointer pTrack = trackDAO.getTrackByRef(TrackRef::fromFilePath(newFile));
+    ASSERT_TRUE(pTrack);
+    EXPECT_EQ(QStringLiteral("Test Artist"), pTrack->getArtist());
+    EXPECT_TRUE(pTrack->getDateAdded().isValid());
+}
+
+TEST_F(TrackDAOTest, addParsedTracksInMultipleStatements) {
+    TrackDAO& trackDAO = internalCollection()->getTrackDAO();
+
+    const auto parsedTrack = ParsedTrack::parseFromFile(
+            mixxx::FileAccess(mixxx::FileInfo(
+                    getTestDir().filePath(QStringLiteral("id3-test-data/artist.mp3")))),
+            SyncTrackMetadataParams());
+    ASSERT_TRUE(parsedTrack);
+
+    // More tracks than fit into a single insert statement
+    constexpr int kNumTracks = 50;
+    const QDir dir(QDir::tempPath() + QStringLiteral("/batch"));
+    QList<ParsedTrack> parsedTracks;
+    for (int i = 0; i < kNumTracks; ++i) {
+        ParsedTrack batchTrack = *parsedTrack;
+        batchTrack.fileAccess = mixxx::FileAccess(
+                mixxx::FileInfo(dir, QStringLiteral("track%1.mp3").arg(i)));
+        parsedTracks.append(batchTrack);
+    }
+    // A track of a later statement that already exists is added one by one
+    const TrackId existingId = internalCollection()->addTrack(
+            Track::newTemporary(parsedTracks.at(30).fileAccess), false);
+    ASSERT_TRUE(existingId.isValid());
+
+    trackDAO.addTracksPrepare();
+    const QList<TrackId> addedIds = trackDAO.addTracksAddParsedTracks(parsedTracks);
+    trackDAO.addTracksFinish();
+
+    ASSERT_EQ(kNumTracks - 1, addedIds.size());
+    QSet<TrackId> trackIds;
+    for (const auto& batchTrack : std::as_const(parsedTracks)) {
+        const TrackId trackId = trackDAO.getTrackIdByRef(
+                TrackRef::fromFileInfo(batchTrack.fileAccess.info()));
+        ASSERT_TRUE(trackId.isValid());
+        trackIds.insert(trackId);
+        if (trackId != existingId) {
+            EXPECT_TRUE(addedIds.contains(trackId));
+        }
+    }
+    EXPECT_EQ(kNumTracks, trackIds.size());
+}
@@ -234,8 +234,12 @@ TEST_F(TrackMetadataTest, mergeExtraMetadataFromSource) {
     // Check that the placeholder for track total is replaced with the actual property
     ASSERT_NE(mixxx::TrackRecord::kTrackTotalPlaceholder, pNewTrackInfo->getTrackTotal());
     pMergedTrackInfo->setTrackTotal(mixxx::TrackRecord::kTrackTotalPlaceholder);
+    EXPECT_TRUE(mergedTrackRecord.needsExtraMetadataFromSource());
     mergedTrackRecord.mergeExtraMetadataFromSource(newTrackMetadata);
     EXPECT_EQ(pNewTrackInfo->getTrackTotal(), pMergedTrackInfo->getTrackTotal());
+#if !defined(__EXTRA_METADATA__)
+    EXPECT_FALSE(mergedTrackRecord.needsExtraMetadataFromSource());
+#endif // __EXTRA_METADATA__
     // ...but if track total is missing entirely it should be preserved
     ASSERT_NE(QString(), pNewTrackInfo->getTrackTotal());
     pMergedTrackInfo->setTrackTotal(QString());
@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <memory>
+
+#include "waveform/waveform.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kVisualSampleRate = 441;
+
+std::unique_ptr<Waveform> createWaveform(SINT frameLength) {
+    auto pWaveform = std::make_unique<Waveform>(
+            kSampleRate, frameLength, kVisualSampleRate, -1);
+    WaveformData* pData = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        pData[i].filtered.low = static_cast<unsigned char>(i);
+        pData[i].filtered.mid = static_cast<unsigned char>(i / 3);
+        pData[i].filtered.high = static_cast<unsigned char>(i / 7);
+        pData[i].filtered.all = static_cast<unsigned char>(i % 251);
+    }
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    return pWaveform;
+}
+
+// Writes the file like AnalysisDao does
+bool writeFile(const QString& fileName, const QByteArray& data, qint64 paddedSize = 0) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        return false;
+    }
+    return paddedSize <= data.size() || file.resize(paddedSize);
+}
+
+class WaveformFlatFileTest : public testing::Test {
+  protected:
+    QString filePath(const QString& fileName) const {
+        return m_tempDir.filePath(fileName);
+    }
+
+    QTemporaryDir m_tempDir;
+};
+
+TEST_F(WaveformFlatFileTest, RoundTrip) {
+    ASSERT_TRUE(m_tempDir.isValid());
+    const auto pWaveform = createWaveform(kSampleRate * 60);
+    ASSERT_LT(0, pWaveform->getDataSize());
+
+    const QByteArray flatData = pWaveform->toFlatByteArray();
+    EXPECT_TRUE(Waveform::isFlatHeader(flatData.left(Waveform::kFlatHeaderSize)));
+    const QString fileName = filePath("waveform");
+    ASSERT_TRUE(writeFile(fileName, flatData, pWaveform->flatFileSize()));
+
+    const std::unique_ptr<Waveform> pMapped(Waveform::mapFlatFile(fileName));
+    ASSERT_TRUE(pMapped->isMapped());
+    EXPECT_EQ(Waveform::SaveState::Saved, pMapped->saveState());
+    EXPECT_EQ(pWaveform->getDataSize(), pMapped->getDataSize());
+    EXPECT_EQ(pWaveform->getDataSize(), pMapped->getCompletion());
+    EXPECT_EQ(pWaveform->getTextureStride(), pMapped->getTextureStride());
+    EXPECT_EQ(pWaveform->getTextureSize(), pMapped->getTextureSize());
+    EXPECT_DOUBLE_EQ(pWaveform->getAudioVisualRatio(), pMapped->getAudioVisualRatio());
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        ASSERT_EQ(pWaveform->get(i).m_i, pMapped->get(i).m_i) << i;
+    }
+    // The texture padding is zero
+    for (int i = pMapped->getDataSize(); i < pMapped->getTextureSize(); ++i) {
+        ASSERT_EQ(0, pMapped->get(i).m_i) << i;
+    }
+}
+
+TEST_F(WaveformFlatFileTest, InvalidFiles) {
+    ASSERT_TRUE(m_tempDir.isValid());
+    const auto pWaveform = createWaveform(kSampleRate * 10);
+
+    // The protobuf serialization is not a flat file
+    const QString protobufFileName = filePath("protobuf");
+    ASSERT_TRUE(writeFile(protobufFileName, pWaveform->toByteArray()));
+    std::unique_ptr<Waveform> pMapped(Waveform::mapFlatFile(protobufFileName));
+    EXPECT_FALSE(pMapped->isMapped());
+    EXPECT_EQ(0, pMapped->getDataSize());
+
+    // Missing padding
+    const QString truncatedFileName = filePath("truncated");
+    ASSERT_TRUE(writeFile(truncatedFileName, pWaveform->toFlatByteArray()));
+    pMapped.reset(Waveform::mapFlatFile(truncatedFileName));
+    EXPECT_FALSE(pMapped->isMapped());
+    EXPECT_EQ(0, pMapped->getDataSize());
+
+    // Corrupt data that is not covered by the checksum of the header in
+    // the database
+    QByteArray corruptData = pWaveform->toFlatByteArray();
+    corruptData[corruptData.size() - 1] = static_cast<char>(corruptData.back() + 1);
+    const QString corruptFileName = filePath("corrupt");
+    ASSERT_TRUE(writeFile(corruptFileName, corruptData, pWaveform->flatFileSize()));
+    pMapped.reset(Waveform::mapFlatFile(corruptFileName));
+    EXPECT_FALSE(pMapped->isMapped());
+    EXPECT_EQ(0, pMapped->getDataSize());
+
+    pMapped.reset(Waveform::mapFlatFile(filePath("missing")));
+    EXPECT_FALSE(pMapped->isMapped());
+}
+
+int sumAll(const Waveform& waveform) {
+    int sum = 0;
+    for (int i = 0; i < waveform.getDataSize(); ++i) {
+        sum += waveform.getAll(i);
+    }
+    return sum;
+}
+
+// Loading a 5 minute track from the compressed protobuf format like
+// AnalysisDao did before
+static void BM_LoadWaveformCompressed(benchmark::State& state) {
+    QTemporaryDir tempDir;
+    const QString fileName = tempDir.filePath("waveform");
+    const auto pWaveform = createWaveform(kSampleRate * 300);
+    writeFile(fileName, qCompress(pWaveform->toByteArray()));
+    for (auto _ : state) {
+        QFile file(fileName);
+        file.open(QIODevice::ReadOnly);
+        const Waveform waveform(qUncompress(file.readAll()));
+        benchmark::DoNotOptimize(sumAll(waveform));
+    }
+}
+BENCHMARK(BM_LoadWaveformCompressed)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadWaveformFlat(benchmark::State& state) {
+    QTemporaryDir tempDir;
+    const QString fileName = tempDir.filePath("waveform");
+    const auto pWaveform = createWaveform(kSampleRate * 300);
+    writeFile(fileName, pWaveform->toFlatByteArray(), pWaveform->flatFileSize());
+    for (auto _ : state) {
+        const std::unique_ptr<Waveform> pMapped(Waveform::mapFlatFile(fileName));
+        benchmark::DoNotOptimize(sumAll(*pMapped));
+    }
+}
+BENCHMARK(BM_LoadWaveformFlat)->Unit(benchmark::kMillisecond);
+
+} // namespace
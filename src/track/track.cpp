@@ -274,6 +274,11 @@ bool Track::mergeExtraMetadataFromSource(
     return true;
 }
 
+bool Track::needsExtraMetadataFromSource() const {
+    const auto locked = lockMutex(&m_qMutex);
+    return m_record.needsExtraMetadataFromSource();
+}
+
 mixxx::TrackMetadata Track::getMetadata(
         mixxx::TrackRecord::SourceSyncStatus* pSourceSyncStatus) const {
     const auto locked = lockMutex(&m_qMutex);
@@ -556,6 +556,7 @@ class Track : public QObject {
     /// Returns true if the track has been modified and false otherwise.
     bool mergeExtraMetadataFromSource(
             const mixxx::TrackMetadata& importedMetadata);
+    bool needsExtraMetadataFromSource() const;
 
     bool exportSeratoMetadata();
 
@@ -212,6 +212,16 @@ bool TrackRecord::replaceMetadataFromSource(
     return modified;
 }
 
+bool TrackRecord::needsExtraMetadataFromSource() const {
+#if defined(__EXTRA_METADATA__)
+    // The extra properties are not stored in the library and
+    // need to be imported from the file every time.
+    return true;
+#else
+    return m_metadata.getTrackInfo().getTrackTotal() == kTrackTotalPlaceholder;
+#endif // __EXTRA_METADATA__
+}
+
 bool TrackRecord::mergeExtraMetadataFromSource(
         const TrackMetadata& importedMetadata) {
     bool modified = false;
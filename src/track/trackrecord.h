@@ -145,6 +145,12 @@ class TrackRecord final {
     bool mergeExtraMetadataFromSource(
             const TrackMetadata& importedMetadata);
 
+    // Checks if mergeExtraMetadataFromSource() could modify any
+    // property. Otherwise the file tags don't need to be parsed
+    // for merging, because all properties are already stored in
+    // the library.
+    bool needsExtraMetadataFromSource() const;
+
     /// Update the stream info after opening the audio stream during
     /// a session.
     /// Returns true if the corresponding metadata properties have been
@@ -1,5 +1,6 @@
 #include <QSqlDriver>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -316,13 +317,15 @@ bool initDatabase(const QSqlDatabase& database, mixxx::StringCollator* pCollator
 DbConnection::DbConnection(
         const Params& params,
         const QString& connectionName)
-    : m_sqlDatabase(createDatabase(params, connectionName)) {
+    : m_sqlDatabase(createDatabase(params, connectionName)),
+      m_initStatements(params.initStatements) {
 }
 
 DbConnection::DbConnection(
         const DbConnection& prototype,
         const QString& connectionName)
-    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
+    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)),
+      m_initStatements(prototype.m_initStatements) {
 }
 
 DbConnection::~DbConnection() {
@@ -350,6 +353,17 @@ bool DbConnection::open() {
         m_sqlDatabase.close();
         return false; // abort
     }
+    for (const auto& statement : m_initStatements) {
+        QSqlQuery query(m_sqlDatabase);
+        if (!query.exec(statement)) {
+            // Only affects the performance, the connection is still usable
+            kLogger.warning()
+                    << "Failed to initialize database connection"
+                    << *this
+                    << statement
+                    << query.lastError();
+        }
+    }
     return true;
 }
 
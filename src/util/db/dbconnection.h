@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QSqlDatabase>
+#include <QStringList>
 #include <QtDebug>
 
 #include "util/string.h"
@@ -29,6 +30,9 @@ class DbConnection final {
         QString filePath;
         QString userName;
         QString password;
+        // Statements that are executed on every connection after it has
+        // been opened, e.g. PRAGMA statements for tuning SQLite
+        QStringList initStatements;
     };
 
     // All constructors are reserved for DbConnectionPool!!
@@ -62,6 +66,7 @@ class DbConnection final {
     DbConnection(const DbConnection&&) = delete;
 
     QSqlDatabase m_sqlDatabase;
+    const QStringList m_initStatements;
     mixxx::StringCollator m_collator;
 };
 
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+namespace mixxx {
+
+/// Histogram of non-negative integer values with a bounded relative error,
+/// like the HdrHistogram.
+///
+/// Values below 2 * kSubBuckets are counted exactly. Above, each power of 2
+/// is split into kSubBuckets linear buckets, so that a bucket never spans
+/// more than 1 / kSubBuckets (~3%) of its values. Recording a value is a
+/// shift and an increment, which allows to keep one histogram per measured
+/// quantity without a noticeable cost.
+class LogLinearHistogram {
+  public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    /// Larger values are clamped
+    static constexpr quint64 kMaxValue = (quint64(1) << 40) - 1;
+
+    LogLinearHistogram()
+            : m_counts(bucketIndex(kMaxValue) + 1) {
+        reset();
+    }
+
+    void reset() {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+        m_sum = 0;
+        m_min = kMaxValue;
+        m_max = 0;
+    }
+
+    void record(quint64 value) {
+        value = std::min(value, kMaxValue);
+        ++m_counts[bucketIndex(value)];
+        ++m_count;
+        m_sum += value;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    quint64 count() const {
+        return m_count;
+    }
+    quint64 min() const {
+        return m_count > 0 ? m_min : 0;
+    }
+    quint64 max() const {
+        return m_max;
+    }
+    double mean() const {
+        return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0;
+    }
+
+    /// Returns the smallest recorded value that is greater or equal than the
+    /// given fraction of all values, e.g. 0.99 for the 99th percentile. The
+    /// result is the upper bound of its bucket, but never exceeds max().
+    quint64 percentile(double fraction) const {
+        if (m_count == 0) {
+            return 0;
+        }
+        const auto rank = std::max(quint64(1),
+                static_cast<quint64>(std::ceil(fraction * m_count)));
+        quint64 cumulated = 0;
+        for (int i = 0; i < static_cast<int>(m_counts.size()); ++i) {
+            cumulated += m_counts[i];
+            if (cumulated >= rank) {
+                return std::min(bucketUpperBound(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    static int bucketIndex(quint64 value) {
+        const int shift = std::max(0, static_cast<int>(std::bit_width(value)) - 1 - kSubBucketBits);
+        return (shift << kSubBucketBits) + static_cast<int>(value >> shift);
+    }
+
+    static quint64 bucketUpperBound(int index) {
+        // The first 2 * kSubBuckets buckets hold a single value each
+        const int shift = std::max(0, (index >> kSubBucketBits) - 1);
+        const quint64 subBucket = index - (shift << kSubBucketBits);
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+  private:
+    std::vector<quint64> m_counts;
+    quint64 m_count;
+    quint64 m_sum;
+    quint64 m_min;
+    quint64 m_max;
+};
+
+} // namespace mixxx
@@ -383,6 +383,168 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
     // applyRampingGain(pDest, gain);
 }
 
+namespace {
+
+// The number of samples that are mixed at once by
+// SampleUtil::copyMultipleWithRampingGain(). The block is small enough to stay
+// in the L1 cache while all sources are added.
+constexpr int kMixBlockSamples = 64;
+// The number of sources that are mixed in the same pass
+constexpr int kMaxMixSources = 32;
+
+struct MixSource {
+    const CSAMPLE* pSrc;
+    // The gain of the first frame
+    CSAMPLE_GAIN gain;
+    CSAMPLE_GAIN gainDelta;
+};
+
+// Adds N sources to the block. N and the block size are known at compile
+// time, so the inner loop is unrolled and the sum stays in a register.
+template<int N, int blockSamples, bool ramping>
+inline void accumulateSources(CSAMPLE* M_RESTRICT pBlock,
+        const CSAMPLE_GAIN* M_RESTRICT pFrames,
+        const MixSource* pSources,
+        SINT offset) {
+    const CSAMPLE* pSrc[N];
+    CSAMPLE_GAIN gain[N];
+    CSAMPLE_GAIN gainDelta[N];
+    for (int j = 0; j < N; ++j) {
+        pSrc[j] = pSources[j].pSrc + offset;
+        gain[j] = pSources[j].gain;
+        gainDelta[j] = pSources[j].gainDelta;
+    }
+    // note: LOOP VECTORIZED.
+    for (int k = 0; k < blockSamples; ++k) {
+        CSAMPLE sum = pBlock[k];
+        for (int j = 0; j < N; ++j) {
+            if (ramping) {
+                sum += pSrc[j][k] * (gain[j] + gainDelta[j] * pFrames[k]);
+            } else {
+                sum += pSrc[j][k] * gain[j];
+            }
+        }
+        pBlock[k] = sum;
+    }
+}
+
+// Adds the sources in chunks of 16, 8, 4, 2 and 1
+template<int blockSamples, bool ramping>
+void accumulateSources(CSAMPLE* M_RESTRICT pBlock,
+        const CSAMPLE_GAIN* M_RESTRICT pFrames,
+        const MixSource* pSources,
+        int numSources,
+        SINT offset) {
+    int j = 0;
+    for (; numSources - j >= 16; j += 16) {
+        accumulateSources<16, blockSamples, ramping>(pBlock, pFrames, pSources + j, offset);
+    }
+    if (numSources - j >= 8) {
+        accumulateSources<8, blockSamples, ramping>(pBlock, pFrames, pSources + j, offset);
+        j += 8;
+    }
+    if (numSources - j >= 4) {
+        accumulateSources<4, blockSamples, ramping>(pBlock, pFrames, pSources + j, offset);
+        j += 4;
+    }
+    if (numSources - j >= 2) {
+        accumulateSources<2, blockSamples, ramping>(pBlock, pFrames, pSources + j, offset);
+        j += 2;
+    }
+    if (numSources - j >= 1) {
+        accumulateSources<1, blockSamples, ramping>(pBlock, pFrames, pSources + j, offset);
+    }
+}
+
+// Mixes the constant sources followed by the ramping sources into one block
+// of pDest.
+template<int blockSamples>
+void mixBlock(CSAMPLE* M_RESTRICT pDest,
+        const MixSource* pSources,
+        int numConstantSources,
+        int numSources,
+        bool add,
+        SINT offset) {
+    CSAMPLE block[blockSamples];
+    CSAMPLE_GAIN frames[blockSamples];
+    for (int k = 0; k < blockSamples; ++k) {
+        block[k] = add ? pDest[offset + k] : CSAMPLE_ZERO;
+        frames[k] = static_cast<CSAMPLE_GAIN>(static_cast<int>(offset + k) / 2);
+    }
+    accumulateSources<blockSamples, false>(
+            block, frames, pSources, numConstantSources, offset);
+    accumulateSources<blockSamples, true>(block,
+            frames,
+            pSources + numConstantSources,
+            numSources - numConstantSources,
+            offset);
+    for (int k = 0; k < blockSamples; ++k) {
+        pDest[offset + k] = block[k];
+    }
+}
+
+} // anonymous namespace
+
+// static
+void SampleUtil::copyMultipleWithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* const* pSrc,
+        const CSAMPLE_GAIN* pOldGains,
+        const CSAMPLE_GAIN* pNewGains,
+        int numSources,
+        SINT numSamples) {
+    MixSource sources[kMaxMixSources];
+    for (int first = 0; first == 0 || first < numSources; first += kMaxMixSources) {
+        const int last = std::min(numSources, first + kMaxMixSources);
+        // Silent sources are skipped, sources with a constant gain are
+        // sorted in front of the ramping ones
+        int numConstantSources = 0;
+        int numMixSources = 0;
+        int lastMixSource = first;
+        for (int i = first; i < last; ++i) {
+            const CSAMPLE_GAIN oldGain = pOldGains[i];
+            const CSAMPLE_GAIN newGain = pNewGains[i];
+            if (oldGain == CSAMPLE_GAIN_ZERO && newGain == CSAMPLE_GAIN_ZERO) {
+                continue;
+            }
+            lastMixSource = i;
+            const CSAMPLE_GAIN gainDelta = (newGain - oldGain) / CSAMPLE_GAIN(numSamples / 2);
+            if (gainDelta == 0) {
+                sources[numMixSources++] = sources[numConstantSources];
+                sources[numConstantSources++] = MixSource{pSrc[i], oldGain, 0};
+            } else {
+                sources[numMixSources++] = MixSource{pSrc[i], oldGain + gainDelta, gainDelta};
+            }
+        }
+
+        const bool add = first > 0;
+        if (!add && numMixSources <= 1) {
+            // Nothing to fuse
+            if (numMixSources == 0) {
+                clear(pDest, numSamples);
+            } else {
+                copyWithRampingGain(pDest,
+                        pSrc[lastMixSource],
+                        pOldGains[lastMixSource],
+                        pNewGains[lastMixSource],
+                        numSamples);
+            }
+            continue;
+        }
+        if (numMixSources == 0) {
+            continue;
+        }
+        SINT offset = 0;
+        for (; offset + kMixBlockSamples <= numSamples; offset += kMixBlockSamples) {
+            mixBlock<kMixBlockSamples>(
+                    pDest, sources, numConstantSources, numMixSources, add, offset);
+        }
+        // Engine buffers are usually a multiple of the block size
+        for (; offset < numSamples; offset += 2) {
+            mixBlock<2>(pDest, sources, numConstantSources, numMixSources, add, offset);
+        }
+    }
+}
+
 // static
 void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
         const SAMPLE* M_RESTRICT pSrc, SINT numSamples) {
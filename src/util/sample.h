@@ -181,6 +181,17 @@ class SampleUtil {
             CSAMPLE_GAIN old_gain, CSAMPLE_GAIN new_gain,
             SINT numSamples);
 
+    // Copy the sum of the stereo buffers pSrc[0] ... pSrc[numSources - 1] to
+    // pDest, each multiplied by a gain ramping from pOldGains[i] to
+    // pNewGains[i] like in copyWithRampingGain(). The sources are mixed in
+    // a single pass over pDest, which must not overlap any of them.
+    static void copyMultipleWithRampingGain(CSAMPLE* pDest,
+            const CSAMPLE* const* pSrc,
+            const CSAMPLE_GAIN* pOldGains,
+            const CSAMPLE_GAIN* pNewGains,
+            int numSources,
+            SINT numSamples);
+
     // Add pSrc to pDest
     static void add(CSAMPLE* pDest, const CSAMPLE* pSrc, SINT numSamples);
 
@@ -1,6 +1,8 @@
 #include "waveform/waveform.h"
 
+#include <QFile>
 #include <QtDebug>
+#include <cstring>
 
 #include "analyzer/constants.h"
 #include "engine/engine.h"
@@ -8,6 +10,50 @@
 
 using namespace mixxx::track;
 
+namespace {
+
+constexpr char kFlatMagic[4] = {'M', 'X', 'W', 'F'};
+constexpr quint32 kFlatFormatVersion = 2;
+// The header and the data are stored in native byte order. Files that have
+// been copied from a machine with a different byte order are rejected.
+constexpr quint32 kFlatByteOrderMark = 0x01020304;
+// Rejects corrupt headers before computing the texture size
+constexpr qint32 kFlatMaxDataSize = 16384 * 16384;
+
+struct FlatHeader {
+    char magic[4];
+    quint32 formatVersion;
+    quint32 byteOrderMark;
+    qint32 dataSize;
+    qint32 textureStride;
+    // qChecksum() of the data without the padding. The database only
+    // stores the checksum of the header, see AnalysisDao::saveAnalysis().
+    quint32 dataChecksum;
+    double visualSampleRate;
+    double audioVisualRatio;
+};
+
+static_assert(sizeof(FlatHeader) <= Waveform::kFlatHeaderSize);
+static_assert(sizeof(WaveformData) == 4);
+
+qint64 flatFileSizeForStride(int textureStride) {
+    return Waveform::kFlatHeaderSize +
+            static_cast<qint64>(textureStride) * textureStride *
+            static_cast<qint64>(sizeof(WaveformData));
+}
+
+quint32 flatDataChecksum(const WaveformData* pData, int dataSize) {
+    const int dataBytes = dataSize * static_cast<int>(sizeof(WaveformData));
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(
+            reinterpret_cast<const char*>(pData), dataBytes));
+#else
+    return qChecksum(reinterpret_cast<const char*>(pData), dataBytes);
+#endif
+}
+
+} // anonymous namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -22,6 +68,8 @@ Waveform::Waveform(const QByteArray& data)
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
+          m_textureSize(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
@@ -37,6 +85,8 @@ Waveform::Waveform(
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
+          m_textureSize(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
@@ -114,7 +164,7 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
@@ -132,6 +182,104 @@ QByteArray Waveform::toByteArray() const {
     return QByteArray(output.data(), static_cast<int>(output.length()));
 }
 
+QByteArray Waveform::toFlatByteArray() const {
+    FlatHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kFlatMagic, sizeof(kFlatMagic));
+    header.formatVersion = kFlatFormatVersion;
+    header.byteOrderMark = kFlatByteOrderMark;
+    header.dataSize = m_dataSize;
+    header.textureStride = m_textureStride;
+    header.dataChecksum = flatDataChecksum(m_pData, m_dataSize);
+    header.visualSampleRate = m_visualSampleRate;
+    header.audioVisualRatio = m_audioVisualRatio;
+
+    const int dataBytes = m_dataSize * static_cast<int>(sizeof(WaveformData));
+    QByteArray bytes(kFlatHeaderSize + dataBytes, '\0');
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (dataBytes > 0) {
+        std::memcpy(bytes.data() + kFlatHeaderSize, m_pData, dataBytes);
+    }
+    return bytes;
+}
+
+qint64 Waveform::flatFileSize() const {
+    return flatFileSizeForStride(m_textureStride);
+}
+
+// static
+bool Waveform::isFlatHeader(const QByteArray& header) {
+    if (header.size() < kFlatHeaderSize) {
+        return false;
+    }
+    FlatHeader flatHeader;
+    std::memcpy(&flatHeader, header.constData(), sizeof(flatHeader));
+    return std::memcmp(flatHeader.magic, kFlatMagic, sizeof(kFlatMagic)) == 0 &&
+            flatHeader.formatVersion == kFlatFormatVersion &&
+            flatHeader.byteOrderMark == kFlatByteOrderMark;
+}
+
+// static
+Waveform* Waveform::mapFlatFile(const QString& fileName) {
+    auto pWaveform = std::make_unique<Waveform>();
+    auto pFile = std::make_unique<QFile>(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        qDebug() << "ERROR: Could not open waveform file" << fileName;
+        return pWaveform.release();
+    }
+    const qint64 fileSize = pFile->size();
+    if (fileSize < kFlatHeaderSize) {
+        qDebug() << "ERROR: Waveform file" << fileName << "is truncated";
+        return pWaveform.release();
+    }
+    // The mapping is copy-on-write, not read-only: a write would modify a
+    // private copy of the page, never the file or the mappings of other
+    // Waveforms. The pages are shared as long as nothing writes to them.
+    uchar* pMapped = pFile->map(0, fileSize, QFileDevice::MapPrivateOption);
+    if (!pMapped) {
+        qDebug() << "ERROR: Could not map waveform file" << fileName
+                 << pFile->errorString();
+        return pWaveform.release();
+    }
+    if (!isFlatHeader(QByteArray::fromRawData(
+                reinterpret_cast<const char*>(pMapped), kFlatHeaderSize))) {
+        qDebug() << "ERROR: Unsupported waveform file" << fileName;
+        return pWaveform.release();
+    }
+    FlatHeader header;
+    std::memcpy(&header, pMapped, sizeof(header));
+    if (header.dataSize < 0 || header.dataSize > kFlatMaxDataSize ||
+            header.textureStride != computeTextureStride(header.dataSize)) {
+        qDebug() << "ERROR: Invalid waveform file" << fileName;
+        return pWaveform.release();
+    }
+    const qint64 expectedFileSize = flatFileSizeForStride(header.textureStride);
+    if (fileSize != expectedFileSize) {
+        qDebug() << "ERROR: Waveform file" << fileName << "has size" << fileSize
+                 << "instead of" << expectedFileSize;
+        return pWaveform.release();
+    }
+    // Reads every page of the data once, which the renderers would do
+    // anyway. The pages stay in the file cache.
+    const auto* pMappedData = reinterpret_cast<const WaveformData*>(pMapped + kFlatHeaderSize);
+    if (flatDataChecksum(pMappedData, header.dataSize) != header.dataChecksum) {
+        qDebug() << "ERROR: Corrupt waveform file" << fileName;
+        return pWaveform.release();
+    }
+
+    pWaveform->m_dataSize = header.dataSize;
+    pWaveform->m_textureStride = header.textureStride;
+    pWaveform->m_pData = reinterpret_cast<WaveformData*>(pMapped + kFlatHeaderSize);
+    pWaveform->m_textureSize = header.textureStride * header.textureStride;
+    pWaveform->m_visualSampleRate = header.visualSampleRate;
+    pWaveform->m_audioVisualRatio = header.audioVisualRatio;
+    pWaveform->m_completion = header.dataSize;
+    pWaveform->m_saveState = SaveState::Saved;
+    // Unmaps the file when the Waveform is destroyed
+    pWaveform->m_pMappedFile = std::move(pFile);
+    return pWaveform.release();
+}
+
 void Waveform::readByteArray(const QByteArray& data) {
     if (data.isNull()) {
         return;
@@ -191,13 +339,13 @@ void Waveform::readByteArray(const QByteArray& data) {
     bool mid_valid = mid.units() == io::Waveform::RMS;
     bool high_valid = high.units() == io::Waveform::RMS;
     for (int i = 0; i < dataSize; ++i) {
-        m_data[i].filtered.all = static_cast<unsigned char>(all.value(i));
+        m_pData[i].filtered.all = static_cast<unsigned char>(all.value(i));
         bool use_low = low_valid && i < low.value_size();
         bool use_mid = mid_valid && i < mid.value_size();
         bool use_high = high_valid && i < high.value_size();
-        m_data[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
-        m_data[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
-        m_data[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
+        m_pData[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
+        m_pData[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
+        m_pData[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
     }
     m_completion = dataSize;
     m_saveState = SaveState::Saved;
@@ -207,12 +355,16 @@ void Waveform::resize(int size) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.resize(m_textureStride * m_textureStride);
+    m_pData = m_data.data();
+    m_textureSize = static_cast<int>(m_data.size());
 }
 
 void Waveform::assign(int size, int value) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.assign(m_textureStride * m_textureStride, value);
+    m_pData = m_data.data();
+    m_textureSize = static_cast<int>(m_data.size());
     m_saveState = SaveState::SavePending;
 }
 
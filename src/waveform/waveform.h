@@ -1,15 +1,16 @@
 #pragma once
 
-#include <QAtomicInt>
 #include <QByteArray>
-#include <QMutex>
 #include <QSharedPointer>
 #include <QString>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "audio/signalinfo.h"
 #include "util/class.h"
-#include "util/compatibility/qmutex.h"
+
+class QFile;
 
 enum FilterIndex { Low = 0, Mid = 1, High = 2, FilterCount = 3};
 enum ChannelIndex { Left = 0, Right = 1, ChannelCount = 2};
@@ -27,6 +28,15 @@ union WaveformData {
     WaveformData(int i) { m_i = i;}
 };
 
+/// The waveform data is written by the analyzer while it is rendered, which
+/// is coordinated without locks:
+///  - The analyzer writes the data in ascending order and then publishes
+///    the completed range [0, completion) with setCompletion(). Readers
+///    that load the completion may access all data below it, which is never
+///    modified again.
+///  - The id, version and description must only be set before the waveform
+///    is shared with other threads, e.g. by Track::setWaveform().
+///  - Only the save state is modified afterwards, it is atomic.
 class Waveform {
   public:
     enum class SaveState {
@@ -45,45 +55,69 @@ class Waveform {
     virtual ~Waveform();
 
     int getId() const {
-        const auto locker = lockMutex(&m_mutex);
-        return m_id;
+        return m_id.load(std::memory_order_relaxed);
     }
 
-    void setId(int id) {
-        const auto locker = lockMutex(&m_mutex);
-        m_id = id;
+    // AnalysisDAO needs to be able to update the id when the waveform is
+    // saved so we mark this as const and m_id mutable.
+    void setId(int id) const {
+        m_id.store(id, std::memory_order_relaxed);
     }
 
     QString getVersion() const {
-        const auto locker = lockMutex(&m_mutex);
         return m_version;
     }
 
+    // Must not be called after the waveform has been shared
     void setVersion(const QString& version) {
-        const auto locker = lockMutex(&m_mutex);
         m_version = version;
     }
 
     QString getDescription() const {
-        const auto locker = lockMutex(&m_mutex);
         return m_description;
     }
 
+    // Must not be called after the waveform has been shared
     void setDescription(const QString& description) {
-        const auto locker = lockMutex(&m_mutex);
         m_description = description;
     }
 
     QByteArray toByteArray() const;
 
+    /// The flat format is an uncompressed alternative to the protobuf
+    /// serialization of toByteArray(). A fixed size header is followed by
+    /// the texture data, which is mapped into memory on load instead of
+    /// being parsed and copied.
+    static constexpr int kFlatHeaderSize = 64;
+    /// Returns the header and the data, without the zero padding of the
+    /// texture. The file must be extended to flatFileSize() with zeros,
+    /// e.g. with QFile::resize() that creates a sparse file on most file
+    /// systems.
+    QByteArray toFlatByteArray() const;
+    qint64 flatFileSize() const;
+    /// Checks the magic number and version of a flat file header.
+    static bool isFlatHeader(const QByteArray& header);
+    /// Maps a file that has been written in the flat format into memory.
+    /// The mapping is private, i.e. copy-on-write. The Waveform never
+    /// writes to it, so all Waveforms created from the same file share the
+    /// pages of the file cache and only the pages that are accessed are
+    /// read from disk. The checksum of the data in the header is verified.
+    /// Returns an empty Waveform if the file is invalid or corrupt.
+    static Waveform* mapFlatFile(const QString& fileName);
+
+    /// Returns true if the data is backed by a mapped flat file.
+    bool isMapped() const {
+        return static_cast<bool>(m_pMappedFile);
+    }
+
     SaveState saveState() const {
-        return m_saveState;
+        return m_saveState.load(std::memory_order_relaxed);
     }
 
     // AnalysisDAO needs to be able to change the state to savePending when finished
     // so we mark this as const and m_saveState mutable.
     void setSaveState(SaveState eState) const {
-        m_saveState = eState;
+        m_saveState.store(eState, std::memory_order_relaxed);
     }
 
     // We do not lock the mutex since m_audioVisualRatio is not changed after
@@ -93,12 +127,17 @@ class Waveform {
     }
 
     // Atomically lookup the completion of the waveform. Represents the number
-    // of data elements that have been processed out of dataSize.
+    // of data elements that have been processed out of dataSize. All data
+    // below the completion is visible to the calling thread.
     int getCompletion() const {
-        return m_completion.loadAcquire();
+        return m_completion.load(std::memory_order_acquire);
     }
+    // Publishes the data below the completion, which must not be modified
+    // afterwards. Publishing once per processed block instead of once per
+    // data element avoids that the cache line bounces between the analyzer
+    // and the readers.
     void setCompletion(int completion) {
-        m_completion = completion;
+        m_completion.store(completion, std::memory_order_release);
     }
 
     // We do not lock the mutex since m_textureStride is not changed after
@@ -107,26 +146,28 @@ class Waveform {
 
     // We do not lock the mutex since m_data is not resized after the
     // constructor runs.
-    inline int getTextureSize() const { return static_cast<int>(m_data.size()); }
+    inline int getTextureSize() const {
+        return m_textureSize;
+    }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since m_pData is not resized after the
     // constructor runs.
-    WaveformData* data() { return &m_data[0];}
+    WaveformData* data() { return m_pData;}
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since m_pData is not resized after the
     // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    const WaveformData* data() const { return m_pData;}
 
     void dump() const;
 
@@ -135,31 +176,32 @@ class Waveform {
     void resize(int size);
     void assign(int size, int value = 0);
 
-    inline WaveformData& at(int i) { return m_data[i];}
-    inline unsigned char& low(int i) { return m_data[i].filtered.low;}
-    inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
-    inline unsigned char& high(int i) { return m_data[i].filtered.high;}
-    inline unsigned char& all(int i) { return m_data[i].filtered.all;}
+    inline WaveformData& at(int i) { return m_pData[i];}
+    inline unsigned char& low(int i) { return m_pData[i].filtered.low;}
+    inline unsigned char& mid(int i) { return m_pData[i].filtered.mid;}
+    inline unsigned char& high(int i) { return m_pData[i].filtered.high;}
+    inline unsigned char& all(int i) { return m_pData[i].filtered.all;}
     double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
-    int m_id;
+    // mutable since AnalysisDAO needs to be able to set it when saving.
+    mutable std::atomic<int> m_id;
     // mutable since AnalysisDAO needs to be able to set the waveform as saved.
-    mutable SaveState m_saveState;
+    mutable std::atomic<SaveState> m_saveState;
     QString m_version;
     QString m_description;
 
-    // The size of the waveform data stored in m_data. Not allowed to change
+    // The size of the waveform data stored in m_pData. Not allowed to change
     // after the constructor runs.
     int m_dataSize;
-    // The vector storing the waveform data. It is potentially larger than
-    // m_dataSize since it includes padding for uploading the entire waveform as
-    // a texture in the GLSL renderer. The size is not allowed to change after
-    // the constructor runs. We use a std::vector to avoid the cost of bounds
-    // checking when accessing the vector.
-    // TODO(XXX): In the future we should switch to QVector and use the raw data
-    // pointer when performance matters.
+    // The waveform data, which is either owned in m_data or mapped from a
+    // flat file. It is potentially larger than m_dataSize since it includes
+    // padding for uploading the entire waveform as a texture in the GLSL
+    // renderer. The size is not allowed to change after the constructor runs.
+    WaveformData* m_pData;
+    int m_textureSize;
     std::vector<WaveformData> m_data;
+    std::unique_ptr<QFile> m_pMappedFile;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -169,11 +211,9 @@ class Waveform {
     // stride is N. Not allowed to change after the constructor runs.
     int m_textureStride;
 
-    // For performance, completion is shared as a QAtomicInt and does not lock
-    // the mutex. The completion of the waveform calculation.
-    QAtomicInt m_completion;
-
-    mutable QMutex m_mutex;
+    // The completion of the waveform calculation. It is the only member that
+    // is written while readers poll it, so it gets a cache line of its own.
+    alignas(64) std::atomic<int> m_completion;
 
     DISALLOW_COPY_AND_ASSIGN(Waveform);
 };
@@ -700,7 +700,7 @@ void WTrackTableView::dropEvent(QDropEvent * event) {
         // you can't have an empty playlist. :)
 
         // Save a list of rows (just plain ints) so we don't get screwed over
-        // when the QModelIndexes all become invalid (eg. after moveTrack()
+        // when the QModelIndexes all become invalid (eg. after moveTracks()
         // or addTrack())
         QList<int> selectedRows = getSelectedRowNumbers();
         if (selectedRows.isEmpty()) {
@@ -927,38 +927,20 @@ void WTrackTableView::moveRows(QList<int> selectedRowsIn, int destRow) {
         }
     }
 
-    if (destRow < firstSelRow) {
-        // If we're moving the tracks UP, reverse the order of the row selection
-        // to make the algorithm below work as it is
-        std::sort(selectedRows.begin(),
-                selectedRows.end(),
-                std::greater<int>());
-    } else { // Down
-        if (destRow > lastSelRow) {
-            // If we're moving the tracks DOWN, adjust the first row to reselect
-            selectionRestoreStartRow =
-                    selectionRestoreStartRow - selectedRowCount;
-        }
+    if (destRow > lastSelRow) {
+        // If we're moving the tracks DOWN, adjust the first row to reselect
+        selectionRestoreStartRow =
+                selectionRestoreStartRow - selectedRowCount;
     }
 
-    // For each row that needs to be moved...
-    while (!selectedRows.isEmpty()) {
-        int movedRow = selectedRows.takeFirst(); // Remember it's row index
-        // Move it
-        pTrackModel->moveTrack(model()->index(movedRow, 0), model()->index(destRow, 0));
-
-        // Move the row indices for rows that got bumped up
-        // into the void we left, or down because of the new spot
-        // we're taking.
-        for (int i = 0; i < selectedRows.count(); i++) {
-            if ((selectedRows[i] > movedRow) && ((destRow > selectedRows[i]))) {
-                selectedRows[i] = selectedRows[i] - 1;
-            } else if ((selectedRows[i] < movedRow) &&
-                    (destRow < selectedRows[i])) {
-                selectedRows[i] = selectedRows[i] + 1;
-            }
-        }
+    // Move all rows at once, so the positions of the other tracks are
+    // only updated once
+    QModelIndexList movedIndices;
+    movedIndices.reserve(selectedRows.size());
+    for (const int movedRow : std::as_const(selectedRows)) {
+        movedIndices.append(model()->index(movedRow, 0));
     }
+    pTrackModel->moveTracks(movedIndices, model()->index(destRow, 0));
 
     // Set current index.
     // TODO If we moved down, pick the last selected row?